@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.cpp
+// ============
+// count the heap allocations made through operator new
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// counts of all of the threads, they are constant
+	// initialized so they can be used by allocations made
+	// before main()
+	std::atomic<uint64_t> g_Allocations(0);
+	std::atomic<uint64_t> g_AllocatedBytes(0);
+
+	/***********************************************************
+	 *  CountedAllocate()
+	 *
+	 *  This function is used for counting an allocation and
+	 *  allocating it with malloc, NULL is returned when there
+	 *  is not enough memory.
+	 ***********************************************************/
+	void* CountedAllocate(size_t size)
+	{
+		g_Allocations.fetch_add(1, std::memory_order_relaxed);
+		g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+		// an allocation of zero bytes still returns a unique
+		// pointer
+		return(malloc((size > 0) ? size : 1));
+	}
+}
+
+/***********************************************************
+ *  GetAllocations()
+ *
+ *  This method is used for getting the number of heap
+ *  allocations made since the start of the process.
+ ***********************************************************/
+uint64_t AllocationCounter::GetAllocations()
+{
+	return(g_Allocations.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  GetAllocatedBytes()
+ *
+ *  This method is used for getting the number of bytes
+ *  allocated since the start of the process.
+ ***********************************************************/
+uint64_t AllocationCounter::GetAllocatedBytes()
+{
+	return(g_AllocatedBytes.load(std::memory_order_relaxed));
+}
+
+/***********************************************************
+ *  operator new()
+ *  operator new[]()
+ *  operator delete()
+ *  operator delete[]()
+ *
+ *  These functions replace the global allocation functions
+ *  of the C++ library, so that every allocation is counted.
+ ***********************************************************/
+void* operator new(size_t size)
+{
+	void* pMemory = CountedAllocate(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new[](size_t size)
+{
+	void* pMemory = CountedAllocate(size);
+	if (NULL == pMemory)
+	{
+		throw std::bad_alloc();
+	}
+	return(pMemory);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return(CountedAllocate(size));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return(CountedAllocate(size));
+}
+
+void operator delete(void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, size_t) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
+
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept
+{
+	free(pMemory);
+}
@@ -0,0 +1,29 @@
+///////////////////////////////////////////////////////////////////////////////
+// allocationcounter.h
+// ============
+// count the heap allocations made through operator new
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+/***********************************************************
+ *  AllocationCounter
+ *
+ *  This class contains the code for reading the number of
+ *  heap allocations and allocated bytes of the process.
+ *  The global operator new is replaced to count each
+ *  allocation with a relaxed atomic increment before it
+ *  passes the request on to malloc, so the counts can be
+ *  read around a frame to find the allocations it makes.
+ ***********************************************************/
+class AllocationCounter
+{
+public:
+	// get the number of allocations since the start
+	static uint64_t GetAllocations();
+	// get the number of bytes allocated since the start, the
+	// freed bytes are not subtracted
+	static uint64_t GetAllocatedBytes();
+};
@@ -0,0 +1,403 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetloader.cpp
+// ============
+// decode the scene assets on worker threads during the startup
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetLoader.h"
+#include "MeshGenerator.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <utility>
+
+// declaration of global variables
+namespace
+{
+	// names of the meshes in the startup report
+	const char* const g_MeshNames[MESH_COUNT] =
+	{
+		"plane",
+		"torus",
+		"cylinder",
+		"sphere"
+	};
+
+	/***********************************************************
+	 *  GenerateMipLevels()
+	 *
+	 *  This function is used for averaging each two by two
+	 *  block of pixels of a level into the next smaller level,
+	 *  down to a level of one pixel.  A level that has an odd
+	 *  size drops its last row or column, as the OpenGL level
+	 *  sizes do.
+	 ***********************************************************/
+	void GenerateMipLevels(AssetLoader::DECODED_IMAGE& image)
+	{
+		const unsigned char* source = image.pixels;
+		int width = image.width;
+		int height = image.height;
+		int channels = image.colorChannels;
+
+		while ((width > 1) || (height > 1))
+		{
+			int levelWidth = std::max(width / 2, 1);
+			int levelHeight = std::max(height / 2, 1);
+			std::vector<unsigned char> level((size_t)levelWidth * levelHeight * channels);
+
+			for (int y = 0; y < levelHeight; y++)
+			{
+				const unsigned char* row0 = source + ((size_t)std::min(y * 2, height - 1) * width * channels);
+				const unsigned char* row1 = source + ((size_t)std::min(y * 2 + 1, height - 1) * width * channels);
+				unsigned char* destination = &level[(size_t)y * levelWidth * channels];
+
+				for (int x = 0; x < levelWidth; x++)
+				{
+					int x0 = std::min(x * 2, width - 1) * channels;
+					int x1 = std::min(x * 2 + 1, width - 1) * channels;
+					for (int c = 0; c < channels; c++)
+					{
+						int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+						destination[(x * channels) + c] = (unsigned char)((sum + 2) / 4);
+					}
+				}
+			}
+
+			image.mipLevels.push_back(std::move(level));
+			source = image.mipLevels.back().data();
+			width = levelWidth;
+			height = levelHeight;
+		}
+	}
+}
+
+/***********************************************************
+ *  AssetLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetLoader::AssetLoader(StartupProfiler* pStartupProfiler)
+{
+	m_pStartupProfiler = pStartupProfiler;
+	m_bGenerateMipLevels = false;
+	m_taskCount = 0;
+	m_nextTask = 0;
+}
+
+/***********************************************************
+ *  ~AssetLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetLoader::~AssetLoader()
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+
+	// free the images that were never taken
+	for (size_t i = 0; i < m_tasks.size(); i++)
+	{
+		if ((m_tasks[i].bTaken == false) && (NULL != m_tasks[i].image.pixels))
+		{
+			stbi_image_free(m_tasks[i].image.pixels);
+		}
+	}
+	m_tasks.clear();
+	m_pStartupProfiler = NULL;
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for queuing the image files and
+ *  starting the workers, while the main thread creates the
+ *  window and the graphics context.  The slots of the mesh
+ *  tasks are allocated here too, and are filled in once the
+ *  quality preset is known.  Only the tasks below the task
+ *  count are published to the workers.
+ ***********************************************************/
+void AssetLoader::Start(const std::vector<std::string>& imageFiles)
+{
+	if (m_tasks.empty() == false)
+	{
+		return;
+	}
+
+	m_tasks.resize(imageFiles.size() + MESH_COUNT, LOAD_TASK());
+	for (size_t i = 0; i < imageFiles.size(); i++)
+	{
+		LOAD_TASK& task = m_tasks[i];
+		task.type = TASK_DECODE_IMAGE;
+		task.filename = imageFiles[i];
+		task.mesh = MESH_COUNT;
+	}
+
+	// the flip setting is global in stb_image, so it is set
+	// once before the workers decode the images
+	stbi_set_flip_vertically_on_load(true);
+
+	StartWorkers(imageFiles.size());
+}
+
+/***********************************************************
+ *  StartMeshes()
+ *
+ *  This method is used for queuing the shape meshes at the
+ *  detail of the chosen quality preset, so that the scene
+ *  uploads them as they are generated.
+ ***********************************************************/
+void AssetLoader::StartMeshes(int meshDetail)
+{
+	size_t firstMesh = m_taskCount;
+	if ((firstMesh + MESH_COUNT) != m_tasks.size())
+	{
+		return;
+	}
+
+	// the slots were allocated by Start(), and the workers do
+	// not read them until the task count is raised past them
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		LOAD_TASK& task = m_tasks[firstMesh + i];
+		task.type = TASK_GENERATE_MESH;
+		task.mesh = (MESH_TYPE)i;
+		task.meshDetail = meshDetail;
+	}
+
+	StartWorkers(m_tasks.size());
+}
+
+/***********************************************************
+ *  StartWorkers()
+ *
+ *  This method is used for publishing the tasks below the
+ *  passed in count, once they are filled in, and starting
+ *  workers for the ones that are not started yet.  One core
+ *  is left for the main thread.
+ ***********************************************************/
+void AssetLoader::StartWorkers(size_t taskCount)
+{
+	m_taskCount = taskCount;
+
+	unsigned int cores = std::thread::hardware_concurrency();
+	unsigned int workerCount = (cores > 1) ? (cores - 1) : 1;
+	workerCount = std::min(workerCount, (unsigned int)(m_taskCount - m_nextTask));
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&AssetLoader::WorkerMain, this));
+	}
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is used for running the queued tasks on a
+ *  worker thread until none are left.
+ ***********************************************************/
+void AssetLoader::WorkerMain()
+{
+	for (;;)
+	{
+		// the next task is only claimed when it has been queued,
+		// so that a worker that finds none does not skip the
+		// tasks that are queued later
+		size_t index = m_nextTask;
+		do
+		{
+			if (index >= m_taskCount)
+			{
+				return;
+			}
+		} while (m_nextTask.compare_exchange_weak(index, index + 1) == false);
+
+		LOAD_TASK& task = m_tasks[index];
+		double start = (NULL != m_pStartupProfiler) ? m_pStartupProfiler->GetElapsedMilliseconds() : 0.0;
+
+		RunTask(task);
+
+		if (NULL != m_pStartupProfiler)
+		{
+			std::string name = (task.type == TASK_DECODE_IMAGE) ?
+				("decode " + task.filename) : (std::string("generate ") + g_MeshNames[task.mesh]);
+			m_pStartupProfiler->AddWorkerPhase(name, start, m_pStartupProfiler->GetElapsedMilliseconds() - start);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			task.bDone = true;
+		}
+		m_taskDone.notify_all();
+	}
+}
+
+/***********************************************************
+ *  RunTask()
+ *
+ *  This method is used for decoding an image or generating
+ *  a mesh.
+ ***********************************************************/
+void AssetLoader::RunTask(LOAD_TASK& task)
+{
+	switch (task.type)
+	{
+	case TASK_DECODE_IMAGE:
+		task.image.pixels = stbi_load(
+			task.filename.c_str(),
+			&task.image.width,
+			&task.image.height,
+			&task.image.colorChannels,
+			0);
+		if (m_bGenerateMipLevels && (NULL != task.image.pixels))
+		{
+			GenerateMipLevels(task.image);
+		}
+		break;
+	case TASK_GENERATE_MESH:
+		MeshGenerator::GenerateMesh(task.mesh, task.meshDetail, task.meshData);
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  WaitForTask()
+ *
+ *  This method is used for waiting until a task is done.
+ ***********************************************************/
+void AssetLoader::WaitForTask(LOAD_TASK& task)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_taskDone.wait(lock, [&]() { return task.bDone; });
+}
+
+/***********************************************************
+ *  TakeImage()
+ *
+ *  This method is used for handing a decoded image over to
+ *  the caller, which then owns its pixels.
+ ***********************************************************/
+bool AssetLoader::TakeImage(const std::string& filename, DECODED_IMAGE& image)
+{
+	for (size_t i = 0; i < m_taskCount; i++)
+	{
+		LOAD_TASK& task = m_tasks[i];
+		if ((task.type != TASK_DECODE_IMAGE) || (task.filename != filename) || task.bTaken)
+		{
+			continue;
+		}
+
+		WaitForTask(task);
+		task.bTaken = true;
+		if (NULL == task.image.pixels)
+		{
+			return(false);
+		}
+
+		image = std::move(task.image);
+		task.image.pixels = NULL;
+		return(true);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  TakeMesh()
+ *
+ *  This method is used for handing a generated mesh over
+ *  to the caller.
+ ***********************************************************/
+bool AssetLoader::TakeMesh(MESH_TYPE mesh, RenderDevice::MESH_DATA& data)
+{
+	for (size_t i = 0; i < m_taskCount; i++)
+	{
+		LOAD_TASK& task = m_tasks[i];
+		if ((task.type != TASK_GENERATE_MESH) || (task.mesh != mesh) || task.bTaken)
+		{
+			continue;
+		}
+
+		WaitForTask(task);
+		task.bTaken = true;
+		data.vertices.swap(task.meshData.vertices);
+		data.indices.swap(task.meshData.indices);
+		return(data.indices.empty() == false);
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  IsTaskDone()
+ *
+ *  This method is used for checking whether a task is done
+ *  without waiting for it, and getting the size in bytes of
+ *  the decoded pixels or the generated vertices and indices.
+ ***********************************************************/
+bool AssetLoader::IsTaskDone(const LOAD_TASK& task, size_t& bytes)
+{
+	bytes = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (task.bDone == false)
+		{
+			return(false);
+		}
+	}
+
+	// the result is not changed by the workers once done
+	if (task.type == TASK_DECODE_IMAGE)
+	{
+		bytes = (size_t)task.image.width * task.image.height * task.image.colorChannels;
+	}
+	else
+	{
+		bytes = (task.meshData.vertices.size() * sizeof(RenderDevice::MESH_VERTEX)) +
+			(task.meshData.indices.size() * sizeof(uint32_t));
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  IsImageReady()
+ *  IsMeshReady()
+ *
+ *  These methods are used for checking whether an image or
+ *  a mesh that has not been taken yet is done, so that the
+ *  scene can take it without stalling the frame.
+ ***********************************************************/
+bool AssetLoader::IsImageReady(const std::string& filename, size_t& bytes)
+{
+	bytes = 0;
+	for (size_t i = 0; i < m_taskCount; i++)
+	{
+		const LOAD_TASK& task = m_tasks[i];
+		if ((task.type == TASK_DECODE_IMAGE) && (task.filename == filename) && (task.bTaken == false))
+		{
+			return(IsTaskDone(task, bytes));
+		}
+	}
+
+	return(false);
+}
+
+bool AssetLoader::IsMeshReady(MESH_TYPE mesh, size_t& bytes)
+{
+	bytes = 0;
+	for (size_t i = 0; i < m_taskCount; i++)
+	{
+		const LOAD_TASK& task = m_tasks[i];
+		if ((task.type == TASK_GENERATE_MESH) && (task.mesh == mesh) && (task.bTaken == false))
+		{
+			return(IsTaskDone(task, bytes));
+		}
+	}
+
+	return(false);
+}
@@ -0,0 +1,125 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetloader.h
+// ============
+// decode the scene assets on worker threads during the startup
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "StartupProfiler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  AssetLoader
+ *
+ *  This class contains the code for doing the CPU side of
+ *  the asset loading - decoding the texture images and
+ *  generating the shape meshes - on worker threads, so that
+ *  it runs while the window and the graphics context are
+ *  created.  The meshes are queued once the quality preset
+ *  that sets their detail has been chosen.  The scene takes
+ *  the results when it uploads
+ *  them to the render device, waiting only for the assets
+ *  that are not finished yet.
+ ***********************************************************/
+class AssetLoader
+{
+public:
+	// constructor - the profiler, if any, records the time
+	// that each asset took on its worker thread
+	AssetLoader(StartupProfiler* pStartupProfiler);
+	// destructor - waits for the workers to finish
+	~AssetLoader();
+
+	// decoded texture image, the pixels are freed by the
+	// caller with stbi_image_free() - the mip levels below the
+	// full size, from the next smaller one down, are only
+	// generated when they are asked for
+	struct DECODED_IMAGE
+	{
+		int width;
+		int height;
+		int colorChannels;
+		unsigned char* pixels;
+		std::vector<std::vector<unsigned char>> mipLevels;
+	};
+
+	// generate the mip levels of the images on the workers, so
+	// that the textures can be uploaded a level at a time
+	void SetGenerateMipLevels(bool bGenerate) { m_bGenerateMipLevels = bGenerate; }
+
+	// start decoding the passed in image files
+	void Start(const std::vector<std::string>& imageFiles);
+	// start generating the shape meshes with the passed in
+	// segments around their curved surfaces, once the quality
+	// preset has been chosen
+	void StartMeshes(int meshDetail);
+
+	// get a decoded image, waiting for it if it is not done -
+	// false is returned if the image was not requested or it
+	// could not be decoded
+	bool TakeImage(const std::string& filename, DECODED_IMAGE& image);
+	// get a generated shape mesh, waiting for it if needed
+	bool TakeMesh(MESH_TYPE mesh, RenderDevice::MESH_DATA& data);
+
+	// check whether an image or a mesh is done, so that it can
+	// be taken without waiting, and get the bytes it uploads
+	bool IsImageReady(const std::string& filename, size_t& bytes);
+	bool IsMeshReady(MESH_TYPE mesh, size_t& bytes);
+
+private:
+	// kinds of work done by the workers
+	enum TASK_TYPE
+	{
+		TASK_DECODE_IMAGE = 0,
+		TASK_GENERATE_MESH
+	};
+
+	// one asset and its result
+	struct LOAD_TASK
+	{
+		TASK_TYPE type;
+		std::string filename;
+		MESH_TYPE mesh;
+		int meshDetail;
+		DECODED_IMAGE image;
+		RenderDevice::MESH_DATA meshData;
+		bool bDone;
+		bool bTaken;
+	};
+
+	StartupProfiler* m_pStartupProfiler;
+	// whether the mip levels of the images are generated
+	bool m_bGenerateMipLevels;
+
+	// the slots of all the tasks are allocated up front and
+	// never move, and a task is only published by raising the
+	// task count once it is filled in, so the workers only lock
+	// to mark a task done
+	std::vector<LOAD_TASK> m_tasks;
+	std::atomic<size_t> m_taskCount;
+	std::atomic<size_t> m_nextTask;
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_taskDone;
+
+	// publish the tasks below the passed in count and start
+	// workers for them
+	void StartWorkers(size_t taskCount);
+	// worker thread function
+	void WorkerMain();
+	// do the work of one task
+	void RunTask(LOAD_TASK& task);
+	// wait for a task to be done
+	void WaitForTask(LOAD_TASK& task);
+	// check whether a task is done without waiting, and get
+	// the size of its result
+	bool IsTaskDone(const LOAD_TASK& task, size_t& bytes);
+};
@@ -0,0 +1,801 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkharness.cpp
+// ============
+// measure the CPU cost of the frames over a fixed number of frames
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BenchmarkHarness.h"
+#include "AllocationCounter.h"
+#include "JsonUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+// declaration of global variables
+namespace
+{
+	// frames that run before measuring starts, so that the
+	// first frame costs such as driver shader compiles are
+	// not included in the results
+	const int WARMUP_FRAMES = 10;
+
+	// names of the frame phases for reporting
+	const char* const PHASE_NAMES[BenchmarkHarness::PHASE_COUNT] =
+	{
+		"input",
+		"view",
+		"scene",
+		"submit"
+	};
+
+	// version of the baseline file, increased when its layout
+	// changes
+	const int BASELINE_VERSION = 1;
+
+	// metrics compared by the regression gate, a higher value
+	// is worse for all of them
+	enum METRIC
+	{
+		METRIC_FRAME_P50 = 0,
+		METRIC_FRAME_P95,
+		METRIC_FRAME_P99,
+		METRIC_SCENE_P50,
+		METRIC_DRAW_CALLS,
+		METRIC_BLOCK_UPLOADS,
+		METRIC_TEXTURE_BINDS,
+		METRIC_PIPELINE_BINDS,
+		METRIC_ALLOCATIONS,
+		METRIC_ALLOCATED_BYTES,
+		METRIC_STARTUP,
+		METRIC_COUNT
+	};
+
+	// name of each metric, and the smallest relative and
+	// absolute increase that fails the gate, so that a change
+	// too small to matter does not fail it even when it is
+	// significant, such as a few microseconds of a null device
+	// frame that differ between processes
+	struct METRIC_INFO
+	{
+		const char* name;
+		double minimumChange;
+		double minimumDifference;
+	};
+	const METRIC_INFO METRIC_INFOS[METRIC_COUNT] =
+	{
+		{ "frame_p50_ms", 0.05, 0.05 },
+		{ "frame_p95_ms", 0.05, 0.05 },
+		{ "frame_p99_ms", 0.10, 0.10 },
+		{ "scene_p50_ms", 0.05, 0.05 },
+		{ "draw_calls", 0.01, 0.5 },
+		{ "block_uploads", 0.01, 0.5 },
+		{ "texture_binds", 0.01, 0.5 },
+		{ "pipeline_binds", 0.01, 0.5 },
+		{ "allocations", 0.01, 0.5 },
+		{ "allocated_bytes", 0.01, 64.0 },
+		{ "startup_ms", 0.10, 10.0 }
+	};
+
+	/***********************************************************
+	 *  TCritical()
+	 *
+	 *  This function is used for getting the critical value of
+	 *  Student's t distribution for a two sided 95% confidence
+	 *  interval with the passed in degrees of freedom.
+	 ***********************************************************/
+	double TCritical(double degreesOfFreedom)
+	{
+		const double T_TABLE[30] =
+		{
+			12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+			2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+			2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+		};
+
+		// the value of the next lower degrees of freedom is
+		// used, which is the wider interval
+		int index = (int)degreesOfFreedom;
+		if (index < 1)
+		{
+			index = 1;
+		}
+		if (index > 30)
+		{
+			return(1.96);
+		}
+		return(T_TABLE[index - 1]);
+	}
+
+	/***********************************************************
+	 *  ConfidenceInterval()
+	 *
+	 *  This function is used for getting the half width of the
+	 *  95% confidence interval of the mean of a metric.
+	 ***********************************************************/
+	double ConfidenceInterval(const BenchmarkHarness::METRIC_STATS& metric)
+	{
+		if (metric.count < 2)
+		{
+			return(0.0);
+		}
+		return(TCritical(metric.count - 1) * metric.deviation / sqrt((double)metric.count));
+	}
+}
+
+/***********************************************************
+ *  BenchmarkHarness()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BenchmarkHarness::BenchmarkHarness(int frameCount, const char* deviceName)
+{
+	m_frameCount = frameCount;
+	m_repetitions = 1;
+	m_framesRun = 0;
+	m_deviceName = deviceName;
+	m_samples.reserve(frameCount);
+	m_frameAllocations = 0;
+	m_frameAllocatedBytes = 0;
+	m_startupMilliseconds = -1.0;
+	m_bStreaming = false;
+	m_bCounters = false;
+	memset(m_phaseStart, 0, sizeof(m_phaseStart));
+	memset(m_phaseCounts, 0, sizeof(m_phaseCounts));
+}
+
+/***********************************************************
+ *  ~BenchmarkHarness()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BenchmarkHarness::~BenchmarkHarness()
+{
+	m_samples.clear();
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for marking the start of a frame.
+ ***********************************************************/
+void BenchmarkHarness::BeginFrame()
+{
+	m_frameStart = Clock::now();
+	m_sceneEnd = m_frameStart;
+	m_frameAllocations = AllocationCounter::GetAllocations();
+	m_frameAllocatedBytes = AllocationCounter::GetAllocatedBytes();
+	if (m_bCounters)
+	{
+		memset(m_phaseCounts, 0, sizeof(m_phaseCounts));
+	}
+}
+
+/***********************************************************
+ *  SetRepetitions()
+ *
+ *  This method is used for setting the number of times that
+ *  the frames are run, one after the other.
+ ***********************************************************/
+void BenchmarkHarness::SetRepetitions(int repetitions)
+{
+	m_repetitions = std::max(repetitions, 1);
+	m_samples.reserve((size_t)m_frameCount * m_repetitions);
+}
+
+/***********************************************************
+ *  SetStartupMilliseconds()
+ *
+ *  This method is used for setting the time to the first
+ *  frame, which is compared with the baseline as a single
+ *  value.
+ ***********************************************************/
+void BenchmarkHarness::SetStartupMilliseconds(double milliseconds)
+{
+	m_startupMilliseconds = milliseconds;
+}
+
+/***********************************************************
+ *  SetStreaming()
+ *
+ *  This method is used for marking whether the assets are
+ *  still streaming in during the current frame.
+ ***********************************************************/
+void BenchmarkHarness::SetStreaming(bool bStreaming)
+{
+	m_bStreaming = bStreaming;
+}
+
+/***********************************************************
+ *  EnableCounters()
+ *
+ *  This method is used for opening the hardware counters
+ *  that are read around the frame phases.
+ ***********************************************************/
+bool BenchmarkHarness::EnableCounters()
+{
+	m_bCounters = m_counters.Open();
+	return(m_bCounters);
+}
+
+/***********************************************************
+ *  BeginPhase()
+ *  EndPhase()
+ *
+ *  These methods are used for reading the hardware counters
+ *  at the start and the end of a frame phase, and adding
+ *  the difference to the counts of the phase.
+ ***********************************************************/
+void BenchmarkHarness::BeginPhase(FRAME_PHASE phase)
+{
+	if (m_bCounters == false)
+	{
+		return;
+	}
+
+	m_counters.Read(m_phaseStart[phase]);
+}
+
+void BenchmarkHarness::EndPhase(FRAME_PHASE phase)
+{
+	if (m_bCounters == false)
+	{
+		return;
+	}
+
+	PerfCounters::COUNTER_VALUES end;
+	if (m_counters.Read(end))
+	{
+		for (int i = 0; i < PerfCounters::COUNTER_COUNT; i++)
+		{
+			m_phaseCounts[phase].values[i] += end.values[i] - m_phaseStart[phase].values[i];
+		}
+	}
+}
+
+/***********************************************************
+ *  EndScene()
+ *
+ *  This method is used for marking the end of the view and
+ *  scene code, before the buffers are swapped.
+ ***********************************************************/
+void BenchmarkHarness::EndScene()
+{
+	m_sceneEnd = Clock::now();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for marking the end of a frame and
+ *  recording its timing and command counters.
+ ***********************************************************/
+void BenchmarkHarness::EndFrame(const RenderDevice::RENDER_STATS& stats)
+{
+	Clock::time_point frameEnd = Clock::now();
+	uint64_t allocations = AllocationCounter::GetAllocations() - m_frameAllocations;
+	uint64_t allocatedBytes = AllocationCounter::GetAllocatedBytes() - m_frameAllocatedBytes;
+
+	// the streaming frames are kept apart, and the warm up
+	// starts once the assets have streamed in
+	if (m_bStreaming)
+	{
+		m_streamingMilliseconds.push_back(std::chrono::duration<double, std::milli>(frameEnd - m_frameStart).count());
+		return;
+	}
+
+	m_framesRun++;
+	if ((m_framesRun <= WARMUP_FRAMES) || IsComplete())
+	{
+		return;
+	}
+
+	FRAME_SAMPLE sample;
+	sample.sceneMilliseconds = std::chrono::duration<double, std::milli>(m_sceneEnd - m_frameStart).count();
+	sample.frameMilliseconds = std::chrono::duration<double, std::milli>(frameEnd - m_frameStart).count();
+	sample.stats = stats;
+	memcpy(sample.phaseCounts, m_phaseCounts, sizeof(sample.phaseCounts));
+	sample.allocations = allocations;
+	sample.allocatedBytes = allocatedBytes;
+	m_samples.push_back(sample);
+}
+
+/***********************************************************
+ *  IsComplete()
+ *
+ *  This method is used for checking whether all of the
+ *  requested frames have been measured.
+ ***********************************************************/
+bool BenchmarkHarness::IsComplete() const
+{
+	return((int)m_samples.size() >= m_frameCount * m_repetitions);
+}
+
+/***********************************************************
+ *  Percentile()
+ *
+ *  This method is used for getting the passed in percentile
+ *  of a list of values, using the nearest rank.
+ ***********************************************************/
+double BenchmarkHarness::Percentile(std::vector<double> values, double percent)
+{
+	if (values.empty())
+	{
+		return(0.0);
+	}
+
+	size_t rank = (size_t)((percent / 100.0) * (values.size() - 1) + 0.5);
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+
+	return(values[rank]);
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for writing the benchmark results
+ *  to the console.
+ ***********************************************************/
+void BenchmarkHarness::Report() const
+{
+	std::vector<double> sceneTimes;
+	std::vector<double> frameTimes;
+	double totalDraws = 0.0;
+	double totalUploads = 0.0;
+	double totalUploadBytes = 0.0;
+	double totalMilliseconds = 0.0;
+
+	if (m_samples.empty())
+	{
+		std::cout << "BENCHMARK: no frames were measured" << std::endl;
+		return;
+	}
+
+	for (size_t i = 0; i < m_samples.size(); i++)
+	{
+		sceneTimes.push_back(m_samples[i].sceneMilliseconds);
+		frameTimes.push_back(m_samples[i].frameMilliseconds);
+		totalDraws += m_samples[i].stats.drawCalls;
+		totalUploads += m_samples[i].stats.blockUploads;
+		totalUploadBytes += m_samples[i].stats.uploadBytes;
+		totalMilliseconds += m_samples[i].frameMilliseconds;
+	}
+
+	double frames = (double)m_samples.size();
+
+	std::cout << std::fixed << std::setprecision(4);
+	std::cout << "BENCHMARK: device " << m_deviceName << ", " << m_samples.size() << " frames" << std::endl;
+	std::cout << "BENCHMARK: scene cpu ms p50 " << Percentile(sceneTimes, 50.0)
+		<< ", p95 " << Percentile(sceneTimes, 95.0)
+		<< ", p99 " << Percentile(sceneTimes, 99.0) << std::endl;
+	std::cout << "BENCHMARK: frame ms p50 " << Percentile(frameTimes, 50.0)
+		<< ", p95 " << Percentile(frameTimes, 95.0)
+		<< ", p99 " << Percentile(frameTimes, 99.0) << std::endl;
+	if (false == m_streamingMilliseconds.empty())
+	{
+		std::cout << "BENCHMARK: streaming frame ms p50 " << Percentile(m_streamingMilliseconds, 50.0)
+			<< ", p99 " << Percentile(m_streamingMilliseconds, 99.0)
+			<< " over " << m_streamingMilliseconds.size() << " frames, steady state p99 "
+			<< Percentile(frameTimes, 99.0) << std::endl;
+	}
+	std::cout << std::setprecision(1);
+	std::cout << "BENCHMARK: per frame draws " << (totalDraws / frames)
+		<< ", block uploads " << (totalUploads / frames)
+		<< ", upload bytes " << (totalUploadBytes / frames) << std::endl;
+	// draw throughput, for comparing the devices on the same scene
+	std::cout << "BENCHMARK: draws per second " << (totalDraws * 1000.0 / std::max(totalMilliseconds, 0.001)) << std::endl;
+	std::cout.unsetf(std::ios::floatfield);
+	std::cout << std::setprecision(6);
+
+	if (m_bCounters)
+	{
+		ReportCounters();
+	}
+
+	// the confidence interval of each metric, once there is
+	// more than one repetition to take it from
+	if (m_repetitions > 1)
+	{
+		std::vector<METRIC_STATS> metrics;
+		ComputeMetrics(metrics);
+
+		char line[256];
+		for (size_t i = 0; i < metrics.size(); i++)
+		{
+			if (metrics[i].count < 2)
+			{
+				continue;
+			}
+			snprintf(line, sizeof(line), "BENCHMARK: %-16s mean %.4f +- %.4f over %d repetitions",
+				metrics[i].name.c_str(), metrics[i].mean, ConfidenceInterval(metrics[i]), metrics[i].count);
+			std::cout << line << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *  ReportCounters()
+ *
+ *  This method is used for writing the average hardware
+ *  counts of each frame phase, with the instructions per
+ *  cycle and the misses per thousand instructions.
+ ***********************************************************/
+void BenchmarkHarness::ReportCounters() const
+{
+	char line[256];
+	double frames = (double)m_samples.size();
+
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		double totals[PerfCounters::COUNTER_COUNT] = { 0.0 };
+		for (size_t i = 0; i < m_samples.size(); i++)
+		{
+			for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; counter++)
+			{
+				totals[counter] += (double)m_samples[i].phaseCounts[phase].values[counter];
+			}
+		}
+
+		int length = snprintf(line, sizeof(line), "BENCHMARK: %-6s per frame", PHASE_NAMES[phase]);
+		for (int counter = 0; counter < PerfCounters::COUNTER_COUNT; counter++)
+		{
+			if (m_counters.IsCounted((PerfCounters::COUNTER)counter))
+			{
+				length += snprintf(line + length, sizeof(line) - length, ", %s %.0f",
+					PerfCounters::GetName((PerfCounters::COUNTER)counter), totals[counter] / frames);
+			}
+		}
+		std::cout << line << std::endl;
+
+		double cycles = totals[PerfCounters::COUNTER_CYCLES];
+		double instructions = totals[PerfCounters::COUNTER_INSTRUCTIONS];
+		if ((cycles > 0.0) && (instructions > 0.0))
+		{
+			snprintf(line, sizeof(line),
+				"BENCHMARK: %-6s ipc %.2f, l1d misses per 1k instructions %.2f, llc %.3f, branch %.2f",
+				PHASE_NAMES[phase],
+				instructions / cycles,
+				totals[PerfCounters::COUNTER_L1D_MISSES] * 1000.0 / instructions,
+				totals[PerfCounters::COUNTER_LLC_MISSES] * 1000.0 / instructions,
+				totals[PerfCounters::COUNTER_BRANCH_MISSES] * 1000.0 / instructions);
+			std::cout << line << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetMetricValue()
+ *
+ *  This method is used for getting the value of a metric
+ *  over a range of the measured frames.
+ ***********************************************************/
+double BenchmarkHarness::GetMetricValue(int metric, size_t first, size_t count) const
+{
+	std::vector<double> values;
+	values.reserve(count);
+
+	for (size_t i = first; i < first + count; i++)
+	{
+		const FRAME_SAMPLE& sample = m_samples[i];
+		switch (metric)
+		{
+		case METRIC_FRAME_P50:
+		case METRIC_FRAME_P95:
+		case METRIC_FRAME_P99:
+			values.push_back(sample.frameMilliseconds);
+			break;
+		case METRIC_SCENE_P50:
+			values.push_back(sample.sceneMilliseconds);
+			break;
+		case METRIC_DRAW_CALLS:
+			values.push_back(sample.stats.drawCalls);
+			break;
+		case METRIC_BLOCK_UPLOADS:
+			values.push_back(sample.stats.blockUploads);
+			break;
+		case METRIC_TEXTURE_BINDS:
+			values.push_back(sample.stats.textureBinds);
+			break;
+		case METRIC_PIPELINE_BINDS:
+			values.push_back(sample.stats.pipelineBinds);
+			break;
+		case METRIC_ALLOCATIONS:
+			values.push_back((double)sample.allocations);
+			break;
+		case METRIC_ALLOCATED_BYTES:
+			values.push_back((double)sample.allocatedBytes);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// the times are taken as percentiles, and the counters as
+	// the average of each frame
+	switch (metric)
+	{
+	case METRIC_FRAME_P50:
+	case METRIC_SCENE_P50:
+		return(Percentile(values, 50.0));
+	case METRIC_FRAME_P95:
+		return(Percentile(values, 95.0));
+	case METRIC_FRAME_P99:
+		return(Percentile(values, 99.0));
+	default:
+		break;
+	}
+
+	double total = 0.0;
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		total += values[i];
+	}
+	return(values.empty() ? 0.0 : total / values.size());
+}
+
+/***********************************************************
+ *  ComputeMetrics()
+ *
+ *  This method is used for taking each metric from every
+ *  repetition of the frames, and getting the mean and the
+ *  standard deviation over the repetitions.
+ ***********************************************************/
+void BenchmarkHarness::ComputeMetrics(std::vector<METRIC_STATS>& metrics) const
+{
+	metrics.clear();
+
+	for (int metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		METRIC_STATS stats;
+		stats.name = METRIC_INFOS[metric].name;
+		stats.mean = 0.0;
+		stats.deviation = 0.0;
+		stats.count = 0;
+
+		std::vector<double> values;
+		if (metric == METRIC_STARTUP)
+		{
+			// the startup only happens once in a run
+			if (m_startupMilliseconds >= 0.0)
+			{
+				values.push_back(m_startupMilliseconds);
+			}
+		}
+		else
+		{
+			for (int repetition = 0; repetition < m_repetitions; repetition++)
+			{
+				size_t first = (size_t)repetition * m_frameCount;
+				if (first >= m_samples.size())
+				{
+					break;
+				}
+				size_t count = std::min((size_t)m_frameCount, m_samples.size() - first);
+				values.push_back(GetMetricValue(metric, first, count));
+			}
+		}
+		if (values.empty())
+		{
+			continue;
+		}
+
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			stats.mean += values[i];
+		}
+		stats.mean /= values.size();
+		if (values.size() > 1)
+		{
+			double squares = 0.0;
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				squares += (values[i] - stats.mean) * (values[i] - stats.mean);
+			}
+			stats.deviation = sqrt(squares / (values.size() - 1));
+		}
+		stats.count = (int)values.size();
+		metrics.push_back(stats);
+	}
+}
+
+/***********************************************************
+ *  WriteBaseline()
+ *
+ *  This method is used for writing the mean and deviation
+ *  of each metric to a JSON file, one metric on each line.
+ ***********************************************************/
+bool BenchmarkHarness::WriteBaseline(const char* filename) const
+{
+	std::vector<METRIC_STATS> metrics;
+	ComputeMetrics(metrics);
+
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: could not write the baseline " << filename << std::endl;
+		return(false);
+	}
+
+	file << std::setprecision(10);
+	file << "{\n";
+	file << "  \"version\": " << BASELINE_VERSION << ",\n";
+	file << "  \"device\": ";
+	JsonUtils::WriteString(file, m_deviceName);
+	file << ",\n";
+	file << "  \"frames\": " << m_frameCount << ",\n";
+	file << "  \"repetitions\": " << m_repetitions << ",\n";
+	file << "  \"metrics\": [";
+	for (size_t i = 0; i < metrics.size(); i++)
+	{
+		file << ((i == 0) ? "\n" : ",\n");
+		file << "    { \"name\": ";
+		JsonUtils::WriteString(file, metrics[i].name);
+		file << ", \"mean\": " << metrics[i].mean;
+		file << ", \"deviation\": " << metrics[i].deviation;
+		file << ", \"count\": " << metrics[i].count << " }";
+	}
+	file << "\n  ]\n";
+	file << "}\n";
+
+	std::cout << "INFO: wrote the baseline " << filename << " with " << metrics.size() << " metrics" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  CheckBaseline()
+ *
+ *  This method is used for comparing each metric with the
+ *  baseline.  A metric regressed when Welch's t-test finds
+ *  its increase significant at the 95% level, and the
+ *  increase is larger than the smallest relative and
+ *  absolute change that the metric fails on.  A metric with
+ *  a single value, such as the startup time, only needs to
+ *  exceed those changes.
+ ***********************************************************/
+bool BenchmarkHarness::CheckBaseline(const char* filename) const
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: could not read the baseline " << filename << std::endl;
+		return(false);
+	}
+
+	std::vector<METRIC_STATS> baseline;
+	std::string baselineDevice;
+	double baselineFrames = 0.0;
+	std::string line;
+	while (std::getline(file, line))
+	{
+		METRIC_STATS stats;
+		double value = 0.0;
+
+		if (JsonUtils::ReadString(line, "name", stats.name))
+		{
+			stats.mean = JsonUtils::ReadNumber(line, "mean", value) ? value : 0.0;
+			stats.deviation = JsonUtils::ReadNumber(line, "deviation", value) ? value : 0.0;
+			stats.count = JsonUtils::ReadNumber(line, "count", value) ? (int)value : 0;
+			baseline.push_back(stats);
+		}
+		else
+		{
+			JsonUtils::ReadString(line, "device", baselineDevice);
+			JsonUtils::ReadNumber(line, "frames", baselineFrames);
+		}
+	}
+	if (baselineDevice != m_deviceName)
+	{
+		std::cout << "WARNING: the baseline was measured on the " << baselineDevice
+			<< " device, not the " << m_deviceName << " device" << std::endl;
+	}
+	if ((int)baselineFrames != m_frameCount)
+	{
+		std::cout << "WARNING: the baseline was measured over " << (int)baselineFrames
+			<< " frames, not " << m_frameCount << " frames" << std::endl;
+	}
+
+	std::vector<METRIC_STATS> metrics;
+	ComputeMetrics(metrics);
+
+	char text[256];
+	int regressions = 0;
+	for (size_t i = 0; i < metrics.size(); i++)
+	{
+		const METRIC_STATS& current = metrics[i];
+
+		size_t match = 0;
+		while ((match < baseline.size()) && (baseline[match].name != current.name))
+		{
+			match++;
+		}
+		if (match == baseline.size())
+		{
+			std::cout << "WARNING: the baseline has no " << current.name << " metric" << std::endl;
+			continue;
+		}
+		const METRIC_STATS& base = baseline[match];
+
+		double minimumChange = 0.0;
+		double minimumDifference = 0.0;
+		for (int metric = 0; metric < METRIC_COUNT; metric++)
+		{
+			if (current.name == METRIC_INFOS[metric].name)
+			{
+				minimumChange = METRIC_INFOS[metric].minimumChange;
+				minimumDifference = METRIC_INFOS[metric].minimumDifference;
+			}
+		}
+
+		double difference = current.mean - base.mean;
+		double change = 0.0;
+		if (base.mean != 0.0)
+		{
+			change = difference / fabs(base.mean);
+		}
+		else if (difference != 0.0)
+		{
+			change = (difference > 0.0) ? std::numeric_limits<double>::infinity() : -1.0;
+		}
+
+		// Welch's t-test, which does not assume that the two
+		// runs are equally noisy
+		bool bSignificant = true;
+		if ((current.count >= 2) && (base.count >= 2))
+		{
+			double currentVariance = current.deviation * current.deviation / current.count;
+			double baseVariance = base.deviation * base.deviation / base.count;
+			double standardError = sqrt(currentVariance + baseVariance);
+			if (standardError > 0.0)
+			{
+				double degreesOfFreedom = (currentVariance + baseVariance) * (currentVariance + baseVariance) /
+					((currentVariance * currentVariance / (current.count - 1)) +
+					 (baseVariance * baseVariance / (base.count - 1)));
+				bSignificant = fabs(difference / standardError) > TCritical(degreesOfFreedom);
+			}
+			else
+			{
+				bSignificant = (difference != 0.0);
+			}
+		}
+
+		bool bLarge = (fabs(change) > minimumChange) && (fabs(difference) > minimumDifference);
+		const char* result = "ok";
+		if (bSignificant && bLarge && (difference > 0.0))
+		{
+			result = "REGRESSED";
+			regressions++;
+		}
+		else if (bSignificant && bLarge)
+		{
+			result = "improved";
+		}
+		else if (bLarge && (difference > 0.0))
+		{
+			result = "ok, not significant";
+		}
+
+		snprintf(text, sizeof(text),
+			"BENCHMARK: %-16s base %12.4f +- %-10.4f now %12.4f +- %-10.4f %+8.1f%%  %s",
+			current.name.c_str(),
+			base.mean, ConfidenceInterval(base),
+			current.mean, ConfidenceInterval(current),
+			change * 100.0,
+			result);
+		std::cout << text << std::endl;
+	}
+
+	if (regressions > 0)
+	{
+		std::cout << "ERROR: " << regressions << " metrics regressed against the baseline " << filename << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: no metric regressed against the baseline " << filename << std::endl;
+	return(true);
+}
@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkharness.h
+// ============
+// measure the CPU cost of the frames over a fixed number of frames
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "PerfCounters.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  BenchmarkHarness
+ *
+ *  This class contains the code for timing each frame of
+ *  the main loop, separating the CPU time spent in the view
+ *  and scene code from the total frame time, and reporting
+ *  the results once the requested frames have run.  The
+ *  hardware counters can also be read around the phases of
+ *  each frame, to see where the cycles and cache misses of
+ *  the frame are spent.
+ *
+ *  For the regression gate the frames are run as several
+ *  repetitions, and each metric is taken once from every
+ *  repetition, so that its mean has a confidence interval.
+ *  The means are written to a baseline file, and a later
+ *  run is compared with the baseline using Welch's t-test,
+ *  failing when a metric is significantly and noticeably
+ *  worse.
+ ***********************************************************/
+class BenchmarkHarness
+{
+public:
+	// constructor
+	BenchmarkHarness(int frameCount, const char* deviceName);
+	// destructor
+	~BenchmarkHarness();
+
+	// phases of the frame that the hardware counters are
+	// read around
+	enum FRAME_PHASE
+	{
+		PHASE_INPUT = 0,
+		PHASE_VIEW,
+		PHASE_SCENE,
+		PHASE_SUBMIT,
+		PHASE_COUNT
+	};
+
+	// timing and counters for one measured frame
+	struct FRAME_SAMPLE
+	{
+		double sceneMilliseconds;
+		double frameMilliseconds;
+		RenderDevice::RENDER_STATS stats;
+		// hardware counts of each phase, when they are read
+		PerfCounters::COUNTER_VALUES phaseCounts[PHASE_COUNT];
+		// heap allocations made during the frame
+		uint64_t allocations;
+		uint64_t allocatedBytes;
+	};
+
+	// mean and deviation of a metric over the repetitions
+	struct METRIC_STATS
+	{
+		std::string name;
+		double mean;
+		double deviation;
+		int count;
+	};
+
+	// run the frames the passed in number of times, the
+	// metrics are taken from each repetition
+	void SetRepetitions(int repetitions);
+	// set the time to the first frame, which is measured once
+	void SetStartupMilliseconds(double milliseconds);
+	// mark whether the assets are still streaming in, those
+	// frames are timed apart from the steady state frames
+	void SetStreaming(bool bStreaming);
+
+	// read the hardware counters around the frame phases,
+	// false is returned when they are not available
+	bool EnableCounters();
+	// mark the start and the end of a phase of the frame, a
+	// phase that runs more than once in a frame is summed
+	void BeginPhase(FRAME_PHASE phase);
+	void EndPhase(FRAME_PHASE phase);
+
+	// mark the start of a frame
+	void BeginFrame();
+	// mark the end of the view and scene code for the frame
+	void EndScene();
+	// mark the end of the frame after the buffers are swapped
+	void EndFrame(const RenderDevice::RENDER_STATS& stats);
+
+	// check whether all of the requested frames have run
+	bool IsComplete() const;
+
+	// output the benchmark results
+	void Report() const;
+
+	// write the metrics to a baseline file
+	bool WriteBaseline(const char* filename) const;
+	// compare the metrics with a baseline file and report the
+	// differences, false is returned when a metric regressed
+	// or the baseline could not be read
+	bool CheckBaseline(const char* filename) const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// number of frames to measure after the warm up frames,
+	// in each repetition
+	int m_frameCount;
+	int m_repetitions;
+	// number of frames that have run, including warm up
+	int m_framesRun;
+	// name of the render device for reporting
+	const char* m_deviceName;
+	// time stamps for the current frame
+	Clock::time_point m_frameStart;
+	Clock::time_point m_sceneEnd;
+	// measured frames
+	std::vector<FRAME_SAMPLE> m_samples;
+	// allocation counts at the start of the current frame
+	uint64_t m_frameAllocations;
+	uint64_t m_frameAllocatedBytes;
+	// time to the first frame, or a negative value when it
+	// was not measured
+	double m_startupMilliseconds;
+	// whether the assets are streaming in, and the times of
+	// the frames that they streamed in during
+	bool m_bStreaming;
+	std::vector<double> m_streamingMilliseconds;
+
+	// hardware counters, the counts when each phase started,
+	// and the counts of the phases in the current frame
+	PerfCounters m_counters;
+	bool m_bCounters;
+	PerfCounters::COUNTER_VALUES m_phaseStart[PHASE_COUNT];
+	PerfCounters::COUNTER_VALUES m_phaseCounts[PHASE_COUNT];
+
+	// get a percentile of the passed in values
+	static double Percentile(std::vector<double> values, double percent);
+	// output the average counts of each frame phase
+	void ReportCounters() const;
+	// get the mean and deviation of each metric
+	void ComputeMetrics(std::vector<METRIC_STATS>& metrics) const;
+	// get the value of a metric over a range of the samples
+	double GetMetricValue(int metric, size_t first, size_t count) const;
+};
@@ -0,0 +1,627 @@
+///////////////////////////////////////////////////////////////////////////////
+// capturerenderdevice.cpp
+// ============
+// render device that writes the issued commands to a trace file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CaptureRenderDevice.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <fstream>
+
+// declaration of global variables
+namespace
+{
+	// initial capacity of the trace, so that capturing does
+	// not allocate in a typical frame
+	const size_t g_InitialTraceCapacity = 1024 * 1024;
+}
+
+/***********************************************************
+ *  CaptureRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CaptureRenderDevice::CaptureRenderDevice(RenderDevice* pDevice, const char* filename, int frameCount)
+{
+	m_pDevice = pDevice;
+	m_filename = filename;
+	m_frameCount = frameCount;
+	m_framesCaptured = 0;
+	m_bComplete = false;
+	m_trace.reserve(g_InitialTraceCapacity);
+
+	// the frame count in the header is filled in once the
+	// capture has finished
+	TRACE_HEADER header;
+	memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+	header.version = TRACE_VERSION;
+	header.frameCount = 0;
+	WriteBytes(&header, sizeof(header));
+}
+
+/***********************************************************
+ *  ~CaptureRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CaptureRenderDevice::~CaptureRenderDevice()
+{
+	// keep the frames that were captured when the application
+	// is closed before the capture has finished
+	if (m_bComplete == false)
+	{
+		FinishTrace();
+	}
+
+	delete m_pDevice;
+	m_pDevice = NULL;
+}
+
+/***********************************************************
+ *  WriteCommand()
+ *
+ *  This method is used for appending a command byte to the
+ *  trace.
+ ***********************************************************/
+void CaptureRenderDevice::WriteCommand(TRACE_COMMAND command)
+{
+	m_trace.push_back((unsigned char)command);
+}
+
+/***********************************************************
+ *  WriteBytes()
+ *
+ *  This method is used for appending raw bytes to the
+ *  trace.
+ ***********************************************************/
+void CaptureRenderDevice::WriteBytes(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+
+	m_trace.insert(m_trace.end(), bytes, bytes + size);
+}
+
+/***********************************************************
+ *  WriteString()
+ *
+ *  This method is used for appending a length prefixed
+ *  string to the trace.
+ ***********************************************************/
+void CaptureRenderDevice::WriteString(const char* text)
+{
+	if (NULL == text)
+	{
+		WriteValue<uint16_t>(TRACE_NULL_STRING);
+		return;
+	}
+
+	size_t length = strlen(text);
+	if (length >= TRACE_NULL_STRING)
+	{
+		length = TRACE_NULL_STRING - 1;
+	}
+
+	WriteValue<uint16_t>((uint16_t)length);
+	WriteBytes(text, length);
+}
+
+/***********************************************************
+ *  WritePayload()
+ *
+ *  This method is used for appending a payload record the
+ *  first time its bytes are seen, and returns the hash that
+ *  the commands use to reference it.
+ ***********************************************************/
+uint64_t CaptureRenderDevice::WritePayload(const void* data, uint32_t size)
+{
+	uint64_t hash = HashTracePayload(data, size);
+
+	if (m_payloadHashes.insert(hash).second)
+	{
+		WriteCommand(TRACE_PAYLOAD);
+		WriteValue<uint64_t>(hash);
+		WriteValue<uint32_t>(size);
+		WriteBytes(data, size);
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  WriteBlock()
+ *
+ *  This method is used for recording a uniform block
+ *  update with a reference to the block data.
+ ***********************************************************/
+void CaptureRenderDevice::WriteBlock(UNIFORM_BLOCK_BINDING binding, const void* data, uint32_t size)
+{
+	if (IsCapturing() == false)
+	{
+		return;
+	}
+
+	uint64_t hash = WritePayload(data, size);
+	WriteCommand(TRACE_UPDATE_BLOCK);
+	WriteValue<uint8_t>((uint8_t)binding);
+	WriteValue<uint64_t>(hash);
+}
+
+/***********************************************************
+ *  FinishTrace()
+ *
+ *  This method is used for ending the trace, filling in the
+ *  captured frame count, and writing it to the trace file.
+ ***********************************************************/
+bool CaptureRenderDevice::FinishTrace()
+{
+	m_bComplete = true;
+
+	WriteCommand(TRACE_END);
+	TRACE_HEADER* pHeader = (TRACE_HEADER*)&m_trace[0];
+	pHeader->frameCount = (uint32_t)m_framesCaptured;
+
+	std::ofstream file(m_filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR("could not open the trace file", "file", m_filename);
+		return(false);
+	}
+	file.write((const char*)&m_trace[0], m_trace.size());
+	if (!file.good())
+	{
+		LOG_ERROR("could not write the trace file", "file", m_filename);
+		return(false);
+	}
+
+	LOG_INFO("captured trace", "file", m_filename, "frames", m_framesCaptured,
+		"payloads", m_payloadHashes.size(), "bytes", m_trace.size());
+
+	// the captured commands are no longer needed
+	std::vector<unsigned char>().swap(m_trace);
+	m_payloadHashes.clear();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for preparing the device that the
+ *  commands are passed through to.
+ ***********************************************************/
+bool CaptureRenderDevice::Initialize()
+{
+	return(m_pDevice->Initialize());
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating the pipeline and
+ *  recording its description along with the handle, so
+ *  that the replay can map the handles of later commands.
+ ***********************************************************/
+uint32_t CaptureRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	uint32_t pipeline = m_pDevice->CreatePipeline(desc);
+
+	if (IsCapturing() && (pipeline != 0))
+	{
+		WriteCommand(TRACE_CREATE_PIPELINE);
+		WriteValue<uint32_t>(pipeline);
+		WriteString(desc.vertexShaderPath);
+		WriteString(desc.fragmentShaderPath);
+		WriteString(desc.vertexBinaryPath);
+		WriteString(desc.fragmentBinaryPath);
+		WriteString(desc.vulkanVertexBinaryPath);
+		WriteString(desc.vulkanFragmentBinaryPath);
+		WriteValue<int32_t>(desc.activeLights);
+		WriteValue<uint8_t>(desc.bEnableLighting ? 1 : 0);
+		WriteValue<uint8_t>(desc.bEnableSpecular ? 1 : 0);
+	}
+
+	return(pipeline);
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for binding and recording a pipeline.
+ ***********************************************************/
+void CaptureRenderDevice::BindPipeline(uint32_t pipeline)
+{
+	m_pDevice->BindPipeline(pipeline);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_BIND_PIPELINE);
+		WriteValue<uint32_t>(pipeline);
+	}
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing and recording a pipeline.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyPipeline(uint32_t pipeline)
+{
+	m_pDevice->DestroyPipeline(pipeline);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_DESTROY_PIPELINE);
+		WriteValue<uint32_t>(pipeline);
+	}
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating the texture and
+ *  recording its size along with a reference to the pixels.
+ ***********************************************************/
+uint32_t CaptureRenderDevice::CreateTexture(
+	int width,
+	int height,
+	int colorChannels,
+	const unsigned char* pixels)
+{
+	uint32_t texture = m_pDevice->CreateTexture(width, height, colorChannels, pixels);
+
+	if (IsCapturing() && (texture != 0))
+	{
+		uint64_t hash = WritePayload(pixels, (uint32_t)(width * height * colorChannels));
+		WriteCommand(TRACE_CREATE_TEXTURE);
+		WriteValue<uint32_t>(texture);
+		WriteValue<int32_t>(width);
+		WriteValue<int32_t>(height);
+		WriteValue<int32_t>(colorChannels);
+		WriteValue<uint64_t>(hash);
+	}
+
+	return(texture);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing and recording a texture.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyTexture(uint32_t texture)
+{
+	m_pDevice->DestroyTexture(texture);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_DESTROY_TEXTURE);
+		WriteValue<uint32_t>(texture);
+	}
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding and recording a texture.
+ ***********************************************************/
+void CaptureRenderDevice::BindTexture(int slot, uint32_t texture)
+{
+	m_pDevice->BindTexture(slot, texture);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_BIND_TEXTURE);
+		WriteValue<int32_t>(slot);
+		WriteValue<uint32_t>(texture);
+	}
+}
+
+/***********************************************************
+ *  SetTextureSlot()
+ *
+ *  This method is used for setting and recording the
+ *  sampled texture slot.
+ ***********************************************************/
+void CaptureRenderDevice::SetTextureSlot(int slot)
+{
+	m_pDevice->SetTextureSlot(slot);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_SET_TEXTURE_SLOT);
+		WriteValue<int32_t>(slot);
+	}
+}
+
+/***********************************************************
+ *  CreateCubeTexture()
+ *
+ *  This method is used for creating the cube map texture
+ *  and recording its size along with a reference to the
+ *  pixels of its mip levels.
+ ***********************************************************/
+uint32_t CaptureRenderDevice::CreateCubeTexture(int faceSize, int mipLevels, const float* pixels)
+{
+	uint32_t texture = m_pDevice->CreateCubeTexture(faceSize, mipLevels, pixels);
+
+	if (IsCapturing() && (texture != 0))
+	{
+		uint64_t hash = WritePayload(pixels, (uint32_t)(GetCubeTextureFloats(faceSize, mipLevels) * sizeof(float)));
+		WriteCommand(TRACE_CREATE_CUBE_TEXTURE);
+		WriteValue<uint32_t>(texture);
+		WriteValue<int32_t>(faceSize);
+		WriteValue<int32_t>(mipLevels);
+		WriteValue<uint64_t>(hash);
+	}
+
+	return(texture);
+}
+
+/***********************************************************
+ *  BindEnvironment()
+ *
+ *  This method is used for binding and recording the
+ *  environment cube map.
+ ***********************************************************/
+void CaptureRenderDevice::BindEnvironment(uint32_t texture)
+{
+	m_pDevice->BindEnvironment(texture);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_BIND_ENVIRONMENT);
+		WriteValue<uint32_t>(texture);
+	}
+}
+
+/***********************************************************
+ *  UpdateBlock()
+ *
+ *  These methods are used for updating and recording a
+ *  uniform block.
+ ***********************************************************/
+void CaptureRenderDevice::UpdateBlock(const CAMERA_BLOCK& block)
+{
+	m_pDevice->UpdateBlock(block);
+	WriteBlock(CAMERA_BLOCK_BINDING, &block, sizeof(block));
+}
+
+void CaptureRenderDevice::UpdateBlock(const LIGHT_BLOCK& block)
+{
+	m_pDevice->UpdateBlock(block);
+	WriteBlock(LIGHT_BLOCK_BINDING, &block, sizeof(block));
+}
+
+void CaptureRenderDevice::UpdateBlock(const MATERIAL_BLOCK& block)
+{
+	m_pDevice->UpdateBlock(block);
+	WriteBlock(MATERIAL_BLOCK_BINDING, &block, sizeof(block));
+}
+
+void CaptureRenderDevice::UpdateBlock(const INSTANCE_BLOCK& block)
+{
+	m_pDevice->UpdateBlock(block);
+	WriteBlock(INSTANCE_BLOCK_BINDING, &block, sizeof(block));
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  These methods are used for loading and recording a mesh.
+ *  A mesh generated by the device is recorded by its type,
+ *  as the replay generates the same mesh, while the vertices
+ *  and indices of a mesh that was generated ahead of time
+ *  are captured, as they may be a placeholder or have the
+ *  detail of the quality preset.
+ ***********************************************************/
+void CaptureRenderDevice::LoadMesh(MESH_TYPE mesh)
+{
+	m_pDevice->LoadMesh(mesh);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_LOAD_MESH);
+		WriteValue<uint8_t>((uint8_t)mesh);
+	}
+}
+
+void CaptureRenderDevice::LoadMesh(MESH_TYPE mesh, const MESH_DATA& data)
+{
+	m_pDevice->LoadMesh(mesh, data);
+
+	if (IsCapturing())
+	{
+		uint32_t vertexCount = (uint32_t)data.vertices.size();
+		uint32_t indexCount = (uint32_t)data.indices.size();
+		uint64_t verticesHash = WritePayload(data.vertices.data(), vertexCount * sizeof(MESH_VERTEX));
+		uint64_t indicesHash = WritePayload(data.indices.data(), indexCount * sizeof(uint32_t));
+
+		WriteCommand(TRACE_LOAD_MESH_DATA);
+		WriteValue<uint8_t>((uint8_t)mesh);
+		WriteValue<uint32_t>(vertexCount);
+		WriteValue<uint32_t>(indexCount);
+		WriteValue<uint64_t>(verticesHash);
+		WriteValue<uint64_t>(indicesHash);
+	}
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing and recording a mesh.
+ ***********************************************************/
+void CaptureRenderDevice::DrawMesh(MESH_TYPE mesh)
+{
+	m_pDevice->DrawMesh(mesh);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_DRAW_MESH);
+		WriteValue<uint8_t>((uint8_t)mesh);
+	}
+}
+
+/***********************************************************
+ *  SetViews()
+ *
+ *  This method is used for setting and recording the
+ *  viewports of the views.
+ ***********************************************************/
+void CaptureRenderDevice::SetViews(const VIEWPORT* viewports, uint32_t viewCount)
+{
+	RenderDevice::SetViews(viewports, viewCount);
+	m_pDevice->SetViews(viewports, viewCount);
+
+	if (IsCapturing())
+	{
+		uint64_t hash = WritePayload(m_viewports, m_viewCount * (uint32_t)sizeof(VIEWPORT));
+		WriteCommand(TRACE_SET_VIEWS);
+		WriteValue<uint8_t>((uint8_t)m_viewCount);
+		WriteValue<uint64_t>(hash);
+	}
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used for creating and recording a layered
+ *  target.
+ ***********************************************************/
+uint32_t CaptureRenderDevice::CreateTarget(const TARGET_DESC& desc)
+{
+	uint32_t target = m_pDevice->CreateTarget(desc);
+
+	if (IsCapturing() && (target != 0))
+	{
+		WriteCommand(TRACE_CREATE_TARGET);
+		WriteValue<uint32_t>(target);
+		WriteValue<int32_t>(desc.width);
+		WriteValue<int32_t>(desc.height);
+		WriteValue<uint8_t>((uint8_t)desc.layers);
+		WriteValue<uint8_t>(desc.bCubeMap ? 1 : 0);
+	}
+
+	return(target);
+}
+
+/***********************************************************
+ *  DestroyTarget()
+ *
+ *  This method is used for freeing and recording a layered
+ *  target.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyTarget(uint32_t target)
+{
+	m_pDevice->DestroyTarget(target);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_DESTROY_TARGET);
+		WriteValue<uint32_t>(target);
+	}
+}
+
+/***********************************************************
+ *  BindTarget()
+ *
+ *  This method is used for binding and recording the target
+ *  that the views are drawn into.
+ ***********************************************************/
+void CaptureRenderDevice::BindTarget(uint32_t target)
+{
+	m_pDevice->BindTarget(target);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_BIND_TARGET);
+		WriteValue<uint32_t>(target);
+	}
+}
+
+/***********************************************************
+ *  ShowTarget()
+ *
+ *  This method is used for copying and recording the copy
+ *  of a target into the window.
+ ***********************************************************/
+void CaptureRenderDevice::ShowTarget(uint32_t target)
+{
+	m_pDevice->ShowTarget(target);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_SHOW_TARGET);
+		WriteValue<uint32_t>(target);
+	}
+}
+
+/***********************************************************
+ *  FilterTargetMips()
+ *
+ *  This method is used for filtering and recording the mip
+ *  levels of a cube map target.
+ ***********************************************************/
+void CaptureRenderDevice::FilterTargetMips(uint32_t target)
+{
+	m_pDevice->FilterTargetMips(target);
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_FILTER_TARGET);
+		WriteValue<uint32_t>(target);
+	}
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for drawing the overlay, which is not
+ *  part of the scene and is not captured.
+ ***********************************************************/
+void CaptureRenderDevice::DrawOverlay(
+	const OVERLAY_VERTEX* vertices,
+	uint32_t vertexCount,
+	uint32_t texture)
+{
+	m_pDevice->DrawOverlay(vertices, vertexCount, texture);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting and recording a frame.
+ ***********************************************************/
+void CaptureRenderDevice::BeginFrame()
+{
+	m_pDevice->BeginFrame();
+	m_stats = m_pDevice->GetStats();
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_BEGIN_FRAME);
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing and recording a frame,
+ *  and writing the trace once the last frame has ended.
+ ***********************************************************/
+void CaptureRenderDevice::EndFrame()
+{
+	m_pDevice->EndFrame();
+	m_stats = m_pDevice->GetStats();
+
+	if (IsCapturing())
+	{
+		WriteCommand(TRACE_END_FRAME);
+		m_framesCaptured++;
+		if (m_framesCaptured >= m_frameCount)
+		{
+			FinishTrace();
+		}
+	}
+}
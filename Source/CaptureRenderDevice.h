@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// capturerenderdevice.h
+// ============
+// render device that writes the issued commands to a trace file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "CommandTrace.h"
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/***********************************************************
+ *  CaptureRenderDevice
+ *
+ *  This class contains a render device that passes every
+ *  command through to another device, and serializes the
+ *  commands into a trace.  The commands issued before the
+ *  first frame, which create the pipelines, textures and
+ *  meshes, are captured along with the requested number of
+ *  frames.  The trace is kept in memory while capturing so
+ *  that the file writes do not change the frame timing, and
+ *  it is written out once the last frame has ended.
+ ***********************************************************/
+class CaptureRenderDevice : public RenderDevice
+{
+public:
+	// constructor - the passed in device is owned by the
+	// capture device and freed with it
+	CaptureRenderDevice(RenderDevice* pDevice, const char* filename, int frameCount);
+	// destructor
+	virtual ~CaptureRenderDevice();
+
+	virtual const char* GetName() const { return m_pDevice->GetName(); }
+	virtual std::string GetAdapterName() const { return m_pDevice->GetAdapterName(); }
+	virtual bool Initialize();
+
+	virtual uint32_t CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void BindPipeline(uint32_t pipeline);
+	virtual void DestroyPipeline(uint32_t pipeline);
+
+	virtual uint32_t CreateTexture(
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels);
+	virtual void DestroyTexture(uint32_t texture);
+	virtual void BindTexture(int slot, uint32_t texture);
+	virtual void SetTextureSlot(int slot);
+	virtual uint32_t CreateCubeTexture(int faceSize, int mipLevels, const float* pixels);
+	virtual void BindEnvironment(uint32_t texture);
+
+	virtual void UpdateBlock(const CAMERA_BLOCK& block);
+	virtual void UpdateBlock(const LIGHT_BLOCK& block);
+	virtual void UpdateBlock(const MATERIAL_BLOCK& block);
+	virtual void UpdateBlock(const INSTANCE_BLOCK& block);
+
+	virtual void LoadMesh(MESH_TYPE mesh);
+	virtual void LoadMesh(MESH_TYPE mesh, const MESH_DATA& data);
+	virtual void DrawMesh(MESH_TYPE mesh);
+	virtual void SetViews(const VIEWPORT* viewports, uint32_t viewCount);
+
+	virtual uint32_t CreateTarget(const TARGET_DESC& desc);
+	virtual void DestroyTarget(uint32_t target);
+	virtual void BindTarget(uint32_t target);
+	virtual void ShowTarget(uint32_t target);
+	virtual void FilterTargetMips(uint32_t target);
+	virtual bool ReadTarget(uint32_t target, std::vector<float>& pixels) { return(m_pDevice->ReadTarget(target, pixels)); }
+
+	virtual void DrawOverlay(
+		const OVERLAY_VERTEX* vertices,
+		uint32_t vertexCount,
+		uint32_t texture);
+
+	virtual void BeginFrame();
+	virtual void EndFrame();
+
+	virtual bool GetGpuFrameTime(double& milliseconds) { return(m_pDevice->GetGpuFrameTime(milliseconds)); }
+	virtual uint32_t GetError() { return(m_pDevice->GetError()); }
+
+	// check whether all of the requested frames are captured
+	bool IsComplete() const { return(m_bComplete); }
+
+private:
+	// device that executes the commands
+	RenderDevice* m_pDevice;
+	// trace file and the number of frames to capture
+	std::string m_filename;
+	int m_frameCount;
+	int m_framesCaptured;
+	bool m_bComplete;
+
+	// trace data captured so far
+	std::vector<unsigned char> m_trace;
+	// hashes of the payloads already in the trace
+	std::unordered_set<uint64_t> m_payloadHashes;
+
+	// check whether commands are still being captured
+	bool IsCapturing() const { return(!m_bComplete); }
+
+	// append values to the trace
+	void WriteCommand(TRACE_COMMAND command);
+	void WriteBytes(const void* data, size_t size);
+	void WriteString(const char* text);
+	template <typename T>
+	void WriteValue(T value) { WriteBytes(&value, sizeof(value)); }
+	// append the payload unless it is already in the trace,
+	// and get the hash that references it
+	uint64_t WritePayload(const void* data, uint32_t size);
+	// record a uniform block update
+	void WriteBlock(UNIFORM_BLOCK_BINDING binding, const void* data, uint32_t size);
+
+	// finish the trace and write it to the file
+	bool FinishTrace();
+};
@@ -0,0 +1,126 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandtrace.h
+// ============
+// binary format of the captured render device command traces
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  Command trace format
+ *
+ *  A trace starts with the TRACE_HEADER, followed by the
+ *  records.  Each record is one command byte followed by
+ *  the fixed arguments of the command, in native byte
+ *  order.  Texture pixels and uniform block data are
+ *  referenced by the hash of their bytes, and the bytes
+ *  are written once in a TRACE_PAYLOAD record before the
+ *  first command that references them, so the repeated
+ *  block data of a static scene adds little to the trace.
+ *
+ *    TRACE_PAYLOAD           uint64 hash, uint32 size, bytes
+ *    TRACE_CREATE_PIPELINE   uint32 handle, 6 strings,
+ *                            int32 activeLights,
+ *                            uint8 lighting, uint8 specular
+ *    TRACE_BIND_PIPELINE     uint32 handle
+ *    TRACE_DESTROY_PIPELINE  uint32 handle
+ *    TRACE_CREATE_TEXTURE    uint32 handle, int32 width,
+ *                            int32 height, int32 channels,
+ *                            uint64 pixels hash
+ *    TRACE_DESTROY_TEXTURE   uint32 handle
+ *    TRACE_BIND_TEXTURE      int32 slot, uint32 handle
+ *    TRACE_SET_TEXTURE_SLOT  int32 slot
+ *    TRACE_CREATE_CUBE_TEXTURE  uint32 handle,
+ *                            int32 face size, int32 mip levels,
+ *                            uint64 pixels hash
+ *    TRACE_BIND_ENVIRONMENT  uint32 handle
+ *    TRACE_UPDATE_BLOCK      uint8 binding, uint64 hash
+ *    TRACE_LOAD_MESH         uint8 mesh
+ *    TRACE_LOAD_MESH_DATA    uint8 mesh, uint32 vertex count,
+ *                            uint32 index count,
+ *                            uint64 vertices hash,
+ *                            uint64 indices hash
+ *    TRACE_DRAW_MESH         uint8 mesh
+ *    TRACE_SET_VIEWS         uint8 count, uint64 viewports hash
+ *    TRACE_CREATE_TARGET     uint32 handle, int32 width,
+ *                            int32 height, uint8 layers,
+ *                            uint8 cube map
+ *    TRACE_DESTROY_TARGET    uint32 handle
+ *    TRACE_BIND_TARGET       uint32 handle
+ *    TRACE_SHOW_TARGET       uint32 handle
+ *    TRACE_FILTER_TARGET     uint32 handle
+ *    TRACE_BEGIN_FRAME       no arguments
+ *    TRACE_END_FRAME         no arguments
+ *    TRACE_END               no arguments
+ *
+ *  Strings are a uint16 length followed by the characters,
+ *  with TRACE_NULL_STRING as the length of a NULL string.
+ ***********************************************************/
+
+// commands stored in a trace
+enum TRACE_COMMAND
+{
+	TRACE_PAYLOAD = 0,
+	TRACE_CREATE_PIPELINE,
+	TRACE_BIND_PIPELINE,
+	TRACE_DESTROY_PIPELINE,
+	TRACE_CREATE_TEXTURE,
+	TRACE_DESTROY_TEXTURE,
+	TRACE_BIND_TEXTURE,
+	TRACE_SET_TEXTURE_SLOT,
+	TRACE_CREATE_CUBE_TEXTURE,
+	TRACE_BIND_ENVIRONMENT,
+	TRACE_UPDATE_BLOCK,
+	TRACE_LOAD_MESH,
+	TRACE_LOAD_MESH_DATA,
+	TRACE_DRAW_MESH,
+	TRACE_SET_VIEWS,
+	TRACE_CREATE_TARGET,
+	TRACE_DESTROY_TARGET,
+	TRACE_BIND_TARGET,
+	TRACE_SHOW_TARGET,
+	TRACE_FILTER_TARGET,
+	TRACE_BEGIN_FRAME,
+	TRACE_END_FRAME,
+	TRACE_END,
+	TRACE_COMMAND_COUNT
+};
+
+// header at the start of a trace file
+struct TRACE_HEADER
+{
+	char magic[8];
+	uint32_t version;
+	// number of complete frames in the trace
+	uint32_t frameCount;
+};
+
+// identifies a trace file and the version of its format
+const char TRACE_MAGIC[8] = { 'S', 'C', 'N', 'T', 'R', 'A', 'C', 'E' };
+const uint32_t TRACE_VERSION = 8;
+
+// string length written for a NULL string
+const uint16_t TRACE_NULL_STRING = 0xFFFF;
+
+/***********************************************************
+ *  HashTracePayload()
+ *
+ *  This function is used for getting the 64-bit FNV-1a
+ *  hash of the passed in payload bytes.
+ ***********************************************************/
+inline uint64_t HashTracePayload(const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	uint64_t hash = 14695981039346656037ULL;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return(hash);
+}
@@ -0,0 +1,643 @@
+///////////////////////////////////////////////////////////////////////////////
+// environmentlighting.cpp
+// ============
+// prefilter the environment of the scene for the reflective materials
+///////////////////////////////////////////////////////////////////////////////
+
+#include "EnvironmentLighting.h"
+#include "CommandTrace.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+// the prefilter loops process four texels at once with SSE,
+// which every x64 compiler and the default 32-bit Visual
+// Studio settings provide
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define ENVIRONMENT_SSE 1
+#endif
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// faces of a cube map, the size of the faces of the first
+	// mip level of the specular cube map, and its mip levels,
+	// from the mirror reflection down to a 2x2 cosine blur
+	const int CUBE_FACES = 6;
+	const int FACE_SIZE = 64;
+	const int LEVEL_COUNT = 6;
+
+	// angular size of the light discs drawn into the
+	// environment, as the cosine of their radius, and the
+	// radiance of a light with a color of one
+	const float LIGHT_DISC_COSINE = 0.985f;
+	const float LIGHT_RADIANCE = 4.0f;
+	// ambient light arriving from below, relative to above
+	const float GROUND_BOUNCE = 0.5f;
+
+	// identifies an environment cache file and its version
+	const char CACHE_MAGIC[8] = { 'S', 'C', 'N', 'E', 'N', 'V', 'M', 'P' };
+	const uint32_t CACHE_VERSION = 1;
+
+	// header at the start of the cache file, followed by the
+	// diffuse coefficients and the pixels of the mip levels
+	struct CACHE_HEADER
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t faceSize;
+		uint32_t levelCount;
+		uint32_t padding;
+		uint64_t sourceHash;
+	};
+}
+
+/***********************************************************
+ *  TexelDirection()
+ *
+ *  This method is used for getting the unit direction
+ *  through the center of a texel of a cube map face, in
+ *  the OpenGL face order and orientation.
+ ***********************************************************/
+glm::vec3 EnvironmentLighting::TexelDirection(int face, int x, int y, int size)
+{
+	float u = ((2.0f * (x + 0.5f)) / size) - 1.0f;
+	float v = ((2.0f * (y + 0.5f)) / size) - 1.0f;
+	glm::vec3 direction;
+
+	switch (face)
+	{
+	case 0:
+		direction = glm::vec3(1.0f, -v, -u);
+		break;
+	case 1:
+		direction = glm::vec3(-1.0f, -v, u);
+		break;
+	case 2:
+		direction = glm::vec3(u, 1.0f, v);
+		break;
+	case 3:
+		direction = glm::vec3(u, -1.0f, -v);
+		break;
+	case 4:
+		direction = glm::vec3(u, -v, 1.0f);
+		break;
+	default:
+		direction = glm::vec3(-u, -v, -1.0f);
+		break;
+	}
+
+	return(glm::normalize(direction));
+}
+
+/***********************************************************
+ *  TexelSolidAngle()
+ *
+ *  This method is used for getting the solid angle that
+ *  a texel of a cube map face covers, which shrinks
+ *  towards the corners of the face.
+ ***********************************************************/
+float EnvironmentLighting::TexelSolidAngle(int x, int y, int size)
+{
+	float u = ((2.0f * (x + 0.5f)) / size) - 1.0f;
+	float v = ((2.0f * (y + 0.5f)) / size) - 1.0f;
+	float area = (2.0f / size) * (2.0f / size);
+	float distanceSquared = 1.0f + (u * u) + (v * v);
+
+	return(area / (distanceSquared * std::sqrt(distanceSquared)));
+}
+
+/***********************************************************
+ *  Downsample()
+ *
+ *  This method is used for averaging each 2x2 block of
+ *  texels of the RGB faces of a cube map into one texel
+ *  of the faces of half the size.
+ ***********************************************************/
+void EnvironmentLighting::Downsample(const std::vector<float>& faces, int size, std::vector<float>& half)
+{
+	int halfSize = size / 2;
+	half.resize(CUBE_FACES * halfSize * halfSize * 3);
+
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		const float* source = &faces[face * size * size * 3];
+		float* destination = &half[face * halfSize * halfSize * 3];
+		for (int y = 0; y < halfSize; y++)
+		{
+			for (int x = 0; x < halfSize; x++)
+			{
+				for (int channel = 0; channel < 3; channel++)
+				{
+					float sum = source[(((2 * y) * size) + (2 * x)) * 3 + channel] +
+						source[(((2 * y) * size) + (2 * x) + 1) * 3 + channel] +
+						source[(((2 * y + 1) * size) + (2 * x)) * 3 + channel] +
+						source[(((2 * y + 1) * size) + (2 * x) + 1) * 3 + channel];
+					destination[((y * halfSize) + x) * 3 + channel] = sum * 0.25f;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GatherSource()
+ *
+ *  This method is used for splitting the RGB faces of a
+ *  cube map into the direction, weighted radiance and
+ *  solid angle arrays that are filtered.
+ ***********************************************************/
+void EnvironmentLighting::GatherSource(const std::vector<float>& faces, int size, SOURCE_TEXELS& texels)
+{
+	size_t count = (size_t)CUBE_FACES * size * size;
+	size_t paddedCount = (count + 3) & ~(size_t)3;
+
+	texels.x.assign(paddedCount, 0.0f);
+	texels.y.assign(paddedCount, 0.0f);
+	texels.z.assign(paddedCount, 0.0f);
+	texels.red.assign(paddedCount, 0.0f);
+	texels.green.assign(paddedCount, 0.0f);
+	texels.blue.assign(paddedCount, 0.0f);
+	texels.solidAngle.assign(paddedCount, 0.0f);
+
+	size_t index = 0;
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				glm::vec3 direction = TexelDirection(face, x, y, size);
+				float solidAngle = TexelSolidAngle(x, y, size);
+
+				texels.x[index] = direction.x;
+				texels.y[index] = direction.y;
+				texels.z[index] = direction.z;
+				texels.red[index] = faces[index * 3] * solidAngle;
+				texels.green[index] = faces[index * 3 + 1] * solidAngle;
+				texels.blue[index] = faces[index * 3 + 2] * solidAngle;
+				texels.solidAngle[index] = solidAngle;
+				index++;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  FilterRow()
+ *
+ *  This method is used for convolving one row of a face
+ *  of a mip level against all of the source texels.  The
+ *  lobe is the cosine between the texel and the source
+ *  direction raised to a power of two, by squaring it the
+ *  passed in number of times, so the loop has no pow()
+ *  and runs four source texels at once.
+ ***********************************************************/
+void EnvironmentLighting::FilterRow(const SOURCE_TEXELS& source, int squarings, int face, int row, int size, float* pixels)
+{
+	size_t count = source.x.size();
+
+	for (int x = 0; x < size; x++)
+	{
+		glm::vec3 normal = TexelDirection(face, x, row, size);
+		float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+#ifdef ENVIRONMENT_SSE
+		__m128 normalX = _mm_set1_ps(normal.x);
+		__m128 normalY = _mm_set1_ps(normal.y);
+		__m128 normalZ = _mm_set1_ps(normal.z);
+		__m128 zero = _mm_setzero_ps();
+		__m128 sumRed = zero;
+		__m128 sumGreen = zero;
+		__m128 sumBlue = zero;
+		__m128 sumWeight = zero;
+
+		for (size_t i = 0; i < count; i += 4)
+		{
+			__m128 lobe = _mm_add_ps(
+				_mm_add_ps(
+					_mm_mul_ps(normalX, _mm_loadu_ps(&source.x[i])),
+					_mm_mul_ps(normalY, _mm_loadu_ps(&source.y[i]))),
+				_mm_mul_ps(normalZ, _mm_loadu_ps(&source.z[i])));
+			lobe = _mm_max_ps(lobe, zero);
+			for (int j = 0; j < squarings; j++)
+			{
+				lobe = _mm_mul_ps(lobe, lobe);
+			}
+
+			sumRed = _mm_add_ps(sumRed, _mm_mul_ps(lobe, _mm_loadu_ps(&source.red[i])));
+			sumGreen = _mm_add_ps(sumGreen, _mm_mul_ps(lobe, _mm_loadu_ps(&source.green[i])));
+			sumBlue = _mm_add_ps(sumBlue, _mm_mul_ps(lobe, _mm_loadu_ps(&source.blue[i])));
+			sumWeight = _mm_add_ps(sumWeight, _mm_mul_ps(lobe, _mm_loadu_ps(&source.solidAngle[i])));
+		}
+
+		__m128 lanes[4] = { sumRed, sumGreen, sumBlue, sumWeight };
+		for (int j = 0; j < 4; j++)
+		{
+			float values[4];
+			_mm_storeu_ps(values, lanes[j]);
+			sums[j] = values[0] + values[1] + values[2] + values[3];
+		}
+#else
+		for (size_t i = 0; i < count; i++)
+		{
+			float lobe = (normal.x * source.x[i]) + (normal.y * source.y[i]) + (normal.z * source.z[i]);
+			lobe = std::max(lobe, 0.0f);
+			for (int j = 0; j < squarings; j++)
+			{
+				lobe = lobe * lobe;
+			}
+
+			sums[0] += lobe * source.red[i];
+			sums[1] += lobe * source.green[i];
+			sums[2] += lobe * source.blue[i];
+			sums[3] += lobe * source.solidAngle[i];
+		}
+#endif
+
+		float scale = (sums[3] > 0.0f) ? (1.0f / sums[3]) : 0.0f;
+		pixels[x * 3] = sums[0] * scale;
+		pixels[x * 3 + 1] = sums[1] * scale;
+		pixels[x * 3 + 2] = sums[2] * scale;
+	}
+}
+
+/***********************************************************
+ *  RunRowsInParallel()
+ *
+ *  This method is used for running the passed in
+ *  function for each row on worker threads, one for each
+ *  core other than the calling thread, which works on the
+ *  rows as well.  The number of threads used is returned.
+ ***********************************************************/
+template<typename Function>
+unsigned int EnvironmentLighting::RunRowsInParallel(int rowCount, Function function)
+{
+	unsigned int cores = std::thread::hardware_concurrency();
+	unsigned int workerCount = (cores > 1) ? (cores - 1) : 0;
+	workerCount = std::min(workerCount, (unsigned int)rowCount);
+
+	std::atomic<int> nextRow(0);
+	auto worker = [&]()
+	{
+		for (int row = nextRow++; row < rowCount; row = nextRow++)
+		{
+			function(row);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		workers.push_back(std::thread(worker));
+	}
+	worker();
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		workers[i].join();
+	}
+
+	return(workerCount + 1);
+}
+
+/***********************************************************
+ *  EnvironmentLighting()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+EnvironmentLighting::EnvironmentLighting(RenderDevice* pRenderDevice)
+{
+	m_pRenderDevice = pRenderDevice;
+	m_sourceHash = 0;
+	m_bBuilt = false;
+	m_diffuse = SphericalHarmonics::SH_COLOR();
+	m_texture = 0;
+}
+
+/***********************************************************
+ *  ~EnvironmentLighting()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+EnvironmentLighting::~EnvironmentLighting()
+{
+	if ((NULL != m_pRenderDevice) && (m_texture != 0))
+	{
+		m_pRenderDevice->DestroyTexture(m_texture);
+	}
+	m_texture = 0;
+	m_levels.clear();
+	m_pRenderDevice = NULL;
+}
+
+/***********************************************************
+ *  SetCacheFile()
+ *
+ *  This method is used for setting the file that the
+ *  filtered environment is cached in.
+ ***********************************************************/
+void EnvironmentLighting::SetCacheFile(const char* filename)
+{
+	m_cacheFile = (NULL != filename) ? filename : "";
+}
+
+/***********************************************************
+ *  BuildFromLights()
+ *
+ *  This method is used for building the environment from
+ *  the lights of the scene.  The environment is the ambient
+ *  light of the scene, dimmer from below, with a small
+ *  bright disc in the direction of each light.
+ ***********************************************************/
+bool EnvironmentLighting::BuildFromLights(const LIGHT_BLOCK& lights, const glm::vec3& position)
+{
+	std::vector<float> faces(CUBE_FACES * FACE_SIZE * FACE_SIZE * 3);
+	glm::vec3 lightDirections[TOTAL_LIGHTS];
+	glm::vec3 lightColors[TOTAL_LIGHTS];
+
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		glm::vec3 offset = lights.lightSources[i].position - position;
+		float distance = glm::length(offset);
+		lightDirections[i] = (distance > 0.0f) ? (offset / distance) : glm::vec3(0.0f, 1.0f, 0.0f);
+		lightColors[i] = (lights.lightSources[i].diffuseColor + lights.lightSources[i].specularColor) * LIGHT_RADIANCE;
+	}
+
+	float* pixel = faces.data();
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		for (int y = 0; y < FACE_SIZE; y++)
+		{
+			for (int x = 0; x < FACE_SIZE; x++)
+			{
+				glm::vec3 direction = TexelDirection(face, x, y, FACE_SIZE);
+				glm::vec3 color = lights.globalAmbientColor * ((direction.y >= 0.0f) ? 1.0f : GROUND_BOUNCE);
+
+				// the discs fade out towards their edges
+				for (int i = 0; i < TOTAL_LIGHTS; i++)
+				{
+					float cosine = glm::dot(direction, lightDirections[i]);
+					if (cosine > LIGHT_DISC_COSINE)
+					{
+						color += lightColors[i] * ((cosine - LIGHT_DISC_COSINE) / (1.0f - LIGHT_DISC_COSINE));
+					}
+				}
+
+				pixel[0] = color.x;
+				pixel[1] = color.y;
+				pixel[2] = color.z;
+				pixel += 3;
+			}
+		}
+	}
+
+	return(BuildFromSource(faces, FACE_SIZE));
+}
+
+/***********************************************************
+ *  BuildFromTarget()
+ *
+ *  This method is used for building the environment from
+ *  the faces of a cube map target, such as a captured
+ *  reflection probe.
+ ***********************************************************/
+bool EnvironmentLighting::BuildFromTarget(uint32_t target)
+{
+	if ((NULL == m_pRenderDevice) || (target == 0))
+	{
+		return(false);
+	}
+
+	std::vector<float> faces;
+	if (m_pRenderDevice->ReadTarget(target, faces) == false)
+	{
+		return(false);
+	}
+
+	// the read back faces are square, so their size follows
+	// from the number of pixels
+	int faceSize = (int)(std::sqrt((double)(faces.size() / (CUBE_FACES * 3))) + 0.5);
+	return(BuildFromSource(faces, faceSize));
+}
+
+/***********************************************************
+ *  ApplyToLights()
+ *
+ *  This method is used for setting the diffuse coefficients
+ *  and the mip levels of the specular cube map into the
+ *  light block, with zero levels when there is no cube map
+ *  so that the shaders reflect the diffuse light instead.
+ ***********************************************************/
+void EnvironmentLighting::ApplyToLights(LIGHT_BLOCK& lights) const
+{
+	SphericalHarmonics::PackForShader(m_diffuse, lights.irradiance);
+	lights.environmentLevels = (m_texture != 0) ? (float)LEVEL_COUNT : 0.0f;
+}
+
+/***********************************************************
+ *  BuildFromSource()
+ *
+ *  This method is used for filtering the RGB faces of a
+ *  source cube map and creating the specular cube map.  The
+ *  results are read from the cache when it has the same
+ *  source, and nothing is done when the source is the one
+ *  that was built last.
+ ***********************************************************/
+bool EnvironmentLighting::BuildFromSource(const std::vector<float>& faces, int faceSize)
+{
+	if ((faceSize < FACE_SIZE) || ((faceSize & (faceSize - 1)) != 0) ||
+		(faces.size() != (size_t)CUBE_FACES * faceSize * faceSize * 3))
+	{
+		LOG_ERROR("the environment cube map has an unsupported size", "faceSize", faceSize);
+		return(false);
+	}
+
+	uint64_t sourceHash = HashTracePayload(faces.data(), faces.size() * sizeof(float));
+	if (m_bBuilt && (sourceHash == m_sourceHash))
+	{
+		return(true);
+	}
+
+	if ((m_cacheFile.empty()) || (ReadCache(sourceHash) == false))
+	{
+		Prefilter(faces, faceSize);
+		if (false == m_cacheFile.empty())
+		{
+			WriteCache(sourceHash);
+		}
+	}
+
+	if (NULL != m_pRenderDevice)
+	{
+		if (m_texture != 0)
+		{
+			m_pRenderDevice->DestroyTexture(m_texture);
+		}
+		m_texture = m_pRenderDevice->CreateCubeTexture(FACE_SIZE, LEVEL_COUNT, m_levels.data());
+	}
+
+	m_sourceHash = sourceHash;
+	m_bBuilt = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Prefilter()
+ *
+ *  This method is used for filtering the mip levels of the
+ *  specular cube map and the diffuse light.  The source is
+ *  box filtered down to the size of the first level, which
+ *  is the mirror reflection, and each further level is the
+ *  source at the size of the level convolved with a lobe
+ *  of a quarter of the power of the level before it, down
+ *  to a plain cosine at the last level.  The rows of each
+ *  level are filtered in parallel, and the diffuse light is
+ *  projected from the first level.
+ ***********************************************************/
+void EnvironmentLighting::Prefilter(const std::vector<float>& faces, int faceSize)
+{
+	Clock::time_point start = Clock::now();
+
+	std::vector<float> level = faces;
+	std::vector<float> half;
+	int size = faceSize;
+	while (size > FACE_SIZE)
+	{
+		Downsample(level, size, half);
+		level.swap(half);
+		size /= 2;
+	}
+
+	// the diffuse light, with the solid angles of the texels
+	// scaled to add up to the whole sphere
+	SphericalHarmonics::SH_COLOR projected = SphericalHarmonics::SH_COLOR();
+	float totalSolidAngle = 0.0f;
+	const float* pixel = level.data();
+	for (int face = 0; face < CUBE_FACES; face++)
+	{
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				float solidAngle = TexelSolidAngle(x, y, size);
+				SphericalHarmonics::AddLight(projected, TexelDirection(face, x, y, size),
+					glm::vec3(pixel[0], pixel[1], pixel[2]), solidAngle);
+				totalSolidAngle += solidAngle;
+				pixel += 3;
+			}
+		}
+	}
+	m_diffuse = SphericalHarmonics::SH_COLOR();
+	SphericalHarmonics::AddScaled(m_diffuse, projected, (4.0f * 3.14159265f) / totalSolidAngle);
+	SphericalHarmonics::ConvolveDiffuse(m_diffuse);
+
+	m_levels.resize(RenderDevice::GetCubeTextureFloats(FACE_SIZE, LEVEL_COUNT));
+	std::copy(level.begin(), level.end(), m_levels.begin());
+	float* levelPixels = m_levels.data() + level.size();
+	unsigned int threads = 1;
+
+	for (int levelIndex = 1; levelIndex < LEVEL_COUNT; levelIndex++)
+	{
+		Downsample(level, size, half);
+		level.swap(half);
+		size /= 2;
+
+		SOURCE_TEXELS source;
+		GatherSource(level, size, source);
+
+		// the lobe powers are 256, 64, 16, 4 and 1
+		int squarings = 2 * (LEVEL_COUNT - 1 - levelIndex);
+		int levelSize = size;
+		float* rowPixels = levelPixels;
+		threads = RunRowsInParallel(CUBE_FACES * levelSize, [&](int row)
+		{
+			FilterRow(source, squarings, row / levelSize, row % levelSize, levelSize, rowPixels + (row * levelSize * 3));
+		});
+
+		levelPixels += level.size();
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	LOG_INFO("environment lighting prefiltered", "faceSize", FACE_SIZE, "levels", LEVEL_COUNT,
+		"threads", threads, "cpuMs", milliseconds);
+}
+
+/***********************************************************
+ *  ReadCache()
+ *
+ *  This method is used for reading the filtered environment
+ *  from the cache file, when it was filtered from the same
+ *  source with the same settings.
+ ***********************************************************/
+bool EnvironmentLighting::ReadCache(uint64_t sourceHash)
+{
+	std::ifstream file(m_cacheFile.c_str(), std::ios::binary);
+	if (!file)
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	file.read((char*)&header, sizeof(header));
+	if (!file || (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) ||
+		(header.version != CACHE_VERSION) || (header.faceSize != FACE_SIZE) ||
+		(header.levelCount != LEVEL_COUNT) || (header.sourceHash != sourceHash))
+	{
+		return(false);
+	}
+
+	SphericalHarmonics::SH_COLOR diffuse;
+	std::vector<float> levels(RenderDevice::GetCubeTextureFloats(FACE_SIZE, LEVEL_COUNT));
+	file.read((char*)&diffuse, sizeof(diffuse));
+	file.read((char*)levels.data(), levels.size() * sizeof(float));
+	if (!file)
+	{
+		LOG_WARNING("the environment cache is incomplete", "file", m_cacheFile.c_str());
+		return(false);
+	}
+
+	m_diffuse = diffuse;
+	m_levels.swap(levels);
+	LOG_INFO("environment lighting read from the cache", "file", m_cacheFile.c_str());
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for writing the filtered environment
+ *  into the cache file, replacing the one it held.
+ ***********************************************************/
+bool EnvironmentLighting::WriteCache(uint64_t sourceHash) const
+{
+	std::ofstream file(m_cacheFile.c_str(), std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		LOG_ERROR("could not write the environment cache", "file", m_cacheFile.c_str());
+		return(false);
+	}
+
+	CACHE_HEADER header = CACHE_HEADER();
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.faceSize = FACE_SIZE;
+	header.levelCount = LEVEL_COUNT;
+	header.sourceHash = sourceHash;
+
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)&m_diffuse, sizeof(m_diffuse));
+	file.write((const char*)m_levels.data(), m_levels.size() * sizeof(float));
+
+	return(file.good());
+}
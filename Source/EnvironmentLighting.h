@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// environmentlighting.h
+// ============
+// prefilter the environment of the scene for the reflective materials
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "SphericalHarmonics.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  EnvironmentLighting
+ *
+ *  This class contains the code for lighting the reflective
+ *  materials with the environment around the scene.  The
+ *  environment is a cube map, read back from a reflection
+ *  probe or drawn from the lights of the scene, which is
+ *  prefiltered on the CPU while loading: each mip level of
+ *  the specular cube map is blurred with a wider lobe, so
+ *  that the shader selects the blur of a rough surface by
+ *  its mip level, and the diffuse light is projected onto
+ *  nine spherical harmonic coefficients.  The filtering is
+ *  split across threads and vectorized, and the results are
+ *  cached in a file keyed by the hash of the environment,
+ *  so that the next run with the same environment only
+ *  reads them.
+ ***********************************************************/
+class EnvironmentLighting
+{
+public:
+	// constructor
+	EnvironmentLighting(RenderDevice* pRenderDevice);
+	// destructor
+	~EnvironmentLighting();
+
+	// set the file that the filtered environment is cached
+	// in, or NULL to filter it on every run
+	void SetCacheFile(const char* filename);
+
+	// build the environment from the lights of the scene as
+	// seen from a position, for when there is no probe
+	bool BuildFromLights(const LIGHT_BLOCK& lights, const glm::vec3& position);
+	// build the environment from the faces of a cube map
+	// target, false is returned when the render device cannot
+	// read the target back
+	bool BuildFromTarget(uint32_t target);
+
+	// set the diffuse coefficients and the mip levels of the
+	// specular cube map into the light block
+	void ApplyToLights(LIGHT_BLOCK& lights) const;
+	// get the specular cube map texture, zero is returned
+	// when the render device cannot sample cube maps
+	uint32_t GetTexture() const { return(m_texture); }
+
+private:
+	// radiance of the source environment times the solid
+	// angle of each texel, in separate arrays so that four
+	// texels are filtered at once, padded to a multiple of
+	// four with texels that add nothing
+	struct SOURCE_TEXELS
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+		std::vector<float> red;
+		std::vector<float> green;
+		std::vector<float> blue;
+		std::vector<float> solidAngle;
+	};
+
+	// pointer to render device object
+	RenderDevice* m_pRenderDevice;
+	// file that the filtered environment is cached in
+	std::string m_cacheFile;
+	// hash of the source environment that was last built
+	uint64_t m_sourceHash;
+	bool m_bBuilt;
+	// RGB pixels of the filtered mip levels, and the diffuse
+	// light of the environment
+	std::vector<float> m_levels;
+	SphericalHarmonics::SH_COLOR m_diffuse;
+	// specular cube map created from the filtered levels
+	uint32_t m_texture;
+
+	// filter the RGB faces of a source cube map, or read the
+	// results from the cache, and create the cube map
+	bool BuildFromSource(const std::vector<float>& faces, int faceSize);
+	// filter the mip levels and the diffuse light
+	void Prefilter(const std::vector<float>& faces, int faceSize);
+	// get the direction through the center of a texel of a
+	// cube map face, and the solid angle that it covers
+	static glm::vec3 TexelDirection(int face, int x, int y, int size);
+	static float TexelSolidAngle(int x, int y, int size);
+	// average the RGB faces down to half their size
+	static void Downsample(const std::vector<float>& faces, int size, std::vector<float>& half);
+	// split the RGB faces into the arrays that are filtered
+	static void GatherSource(const std::vector<float>& faces, int size, SOURCE_TEXELS& texels);
+	// convolve one row of a face of a level with the source
+	static void FilterRow(
+		const SOURCE_TEXELS& source,
+		int squarings,
+		int face,
+		int row,
+		int size,
+		float* pixels);
+	// run a function for each row on all of the cores
+	template<typename Function>
+	static unsigned int RunRowsInParallel(int rowCount, Function function);
+	// read and write the filtered environment in the cache
+	bool ReadCache(uint64_t sourceHash);
+	bool WriteCache(uint64_t sourceHash) const;
+};
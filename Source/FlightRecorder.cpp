@@ -0,0 +1,422 @@
+///////////////////////////////////////////////////////////////////////////////
+// flightrecorder.cpp
+// ============
+// keep the recent frame telemetry in a memory mapped file that outlives a crash
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FlightRecorder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// identifies a flight recorder file and its layout
+	const char FLIGHT_MAGIC[8] = { 'F', 'L', 'T', 'R', 'E', 'C', 'O', 'R' };
+	const uint32_t FLIGHT_VERSION = 1;
+
+	// ticks of the clock that the record times are taken from
+	int64_t GetTicks()
+	{
+		return((int64_t)std::chrono::steady_clock::now().time_since_epoch().count());
+	}
+	const double TICKS_PER_SECOND =
+		(double)std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num;
+}
+
+/***********************************************************
+ *  FlightRecorder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FlightRecorder::FlightRecorder()
+{
+	static_assert(sizeof(FILE_HEADER) == 64, "the flight recorder header must be 64 bytes");
+	static_assert(sizeof(FLIGHT_RECORD) == 64, "the flight recorder records must be 64 bytes");
+
+	m_pHeader = NULL;
+	m_pRecords = NULL;
+	m_pWriteIndex = NULL;
+	m_mappedSize = 0;
+	m_startTicks = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+	m_fileDescriptor = -1;
+}
+
+/***********************************************************
+ *  ~FlightRecorder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FlightRecorder::~FlightRecorder()
+{
+	if (NULL != m_pHeader)
+	{
+		m_pHeader->bCleanExit = 1;
+	}
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for creating the file, sizing it for
+ *  the header and the ring of records, and mapping it into
+ *  memory.  The mapping is shared with the file, so the
+ *  records reach the file without being flushed.
+ ***********************************************************/
+bool FlightRecorder::Open(const char* filename)
+{
+	if (NULL != m_pHeader)
+	{
+		return(true);
+	}
+
+	size_t size = sizeof(FILE_HEADER) + ((size_t)RECORD_COUNT * sizeof(FLIGHT_RECORD));
+	void* pMapped = NULL;
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "ERROR: could not create the flight recorder file " << filename << std::endl;
+		return(false);
+	}
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READWRITE, 0, (DWORD)size, NULL);
+	if (NULL != mapping)
+	{
+		pMapped = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+	}
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+#else
+	int descriptor = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (descriptor < 0)
+	{
+		std::cout << "ERROR: could not create the flight recorder file " << filename << std::endl;
+		return(false);
+	}
+	if (ftruncate(descriptor, (off_t)size) == 0)
+	{
+		pMapped = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+		if (pMapped == MAP_FAILED)
+		{
+			pMapped = NULL;
+		}
+	}
+	m_fileDescriptor = descriptor;
+#endif
+
+	if (NULL == pMapped)
+	{
+		std::cout << "ERROR: could not map the flight recorder file " << filename << std::endl;
+		Close();
+		return(false);
+	}
+	m_mappedSize = size;
+
+	// a new file is zero filled, so every slot starts with a
+	// sequence of zero
+	m_pHeader = (FILE_HEADER*)pMapped;
+	m_pRecords = (FLIGHT_RECORD*)((char*)pMapped + sizeof(FILE_HEADER));
+	m_pHeader->version = FLIGHT_VERSION;
+	m_pHeader->recordSize = sizeof(FLIGHT_RECORD);
+	m_pHeader->recordCount = RECORD_COUNT;
+#ifdef _WIN32
+	m_pHeader->processId = (uint32_t)GetCurrentProcessId();
+#else
+	m_pHeader->processId = (uint32_t)getpid();
+#endif
+	m_pHeader->startTime = (int64_t)time(NULL);
+	m_pHeader->writeIndex = 0;
+	m_pHeader->bCleanExit = 0;
+	m_pWriteIndex = reinterpret_cast<std::atomic<uint64_t>*>(&m_pHeader->writeIndex);
+	m_startTicks = GetTicks();
+
+	// the magic is written last, so a file that was cut off
+	// while it was being set up is not decoded
+	memcpy(m_pHeader->magic, FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC));
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping and closing the file.
+ ***********************************************************/
+void FlightRecorder::Close()
+{
+#ifdef _WIN32
+	if (NULL != m_pHeader)
+	{
+		UnmapViewOfFile(m_pHeader);
+	}
+	if (NULL != m_mappingHandle)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+	}
+	if ((NULL != m_fileHandle) && (m_fileHandle != INVALID_HANDLE_VALUE))
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+	}
+#else
+	if (NULL != m_pHeader)
+	{
+		munmap(m_pHeader, m_mappedSize);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+	}
+#endif
+
+	m_pHeader = NULL;
+	m_pRecords = NULL;
+	m_pWriteIndex = NULL;
+	m_mappedSize = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+	m_fileDescriptor = -1;
+}
+
+/***********************************************************
+ *  BeginRecord()
+ *  EndRecord()
+ *
+ *  These methods are used for claiming the next slot in the
+ *  ring, and for publishing it once its values are written.
+ *  The sequence of the slot is cleared while it is written,
+ *  so a record cut off by a crash is skipped when decoding.
+ ***********************************************************/
+FlightRecorder::FLIGHT_RECORD* FlightRecorder::BeginRecord(uint32_t type, uint32_t frame, uint64_t& sequence)
+{
+	if (NULL == m_pRecords)
+	{
+		return(NULL);
+	}
+
+	uint64_t index = m_pWriteIndex->fetch_add(1, std::memory_order_relaxed);
+	FLIGHT_RECORD* pRecord = &m_pRecords[index % RECORD_COUNT];
+
+	pRecord->sequence = 0;
+	std::atomic_thread_fence(std::memory_order_release);
+	pRecord->time = (GetTicks() - m_startTicks) / TICKS_PER_SECOND;
+	pRecord->type = type;
+	pRecord->frame = frame;
+
+	sequence = index + 1;
+	return(pRecord);
+}
+
+void FlightRecorder::EndRecord(FLIGHT_RECORD* pRecord, uint64_t sequence)
+{
+	std::atomic_thread_fence(std::memory_order_release);
+	pRecord->sequence = sequence;
+}
+
+/***********************************************************
+ *  RecordFrame()
+ *
+ *  This method is used for writing the timing and counters
+ *  of a frame.  A negative GPU time marks a frame without
+ *  a GPU measurement.
+ ***********************************************************/
+void FlightRecorder::RecordFrame(
+	uint32_t frame,
+	float frameMilliseconds,
+	float gpuMilliseconds,
+	uint32_t drawCalls,
+	uint32_t triangles)
+{
+	uint64_t sequence = 0;
+	FLIGHT_RECORD* pRecord = BeginRecord(RECORD_FRAME, frame, sequence);
+	if (NULL == pRecord)
+	{
+		return;
+	}
+
+	pRecord->frameData.frameMilliseconds = frameMilliseconds;
+	pRecord->frameData.gpuMilliseconds = gpuMilliseconds;
+	pRecord->frameData.drawCalls = drawCalls;
+	pRecord->frameData.triangles = triangles;
+	EndRecord(pRecord, sequence);
+}
+
+/***********************************************************
+ *  RecordError()
+ *
+ *  This method is used for writing a graphics API error.
+ ***********************************************************/
+void FlightRecorder::RecordError(uint32_t frame, uint32_t code)
+{
+	uint64_t sequence = 0;
+	FLIGHT_RECORD* pRecord = BeginRecord(RECORD_ERROR, frame, sequence);
+	if (NULL == pRecord)
+	{
+		return;
+	}
+
+	pRecord->errorCode = code;
+	EndRecord(pRecord, sequence);
+}
+
+/***********************************************************
+ *  RecordMemory()
+ *
+ *  This method is used for writing the memory used by the
+ *  process.
+ ***********************************************************/
+void FlightRecorder::RecordMemory(uint32_t frame, uint64_t bytes)
+{
+	uint64_t sequence = 0;
+	FLIGHT_RECORD* pRecord = BeginRecord(RECORD_MEMORY, frame, sequence);
+	if (NULL == pRecord)
+	{
+		return;
+	}
+
+	pRecord->memoryBytes = bytes;
+	EndRecord(pRecord, sequence);
+}
+
+/***********************************************************
+ *  RecordEvent()
+ *
+ *  This method is used for writing a short event message,
+ *  which is cut to the size of a record.
+ ***********************************************************/
+void FlightRecorder::RecordEvent(uint32_t frame, const char* text)
+{
+	uint64_t sequence = 0;
+	FLIGHT_RECORD* pRecord = BeginRecord(RECORD_EVENT, frame, sequence);
+	if (NULL == pRecord)
+	{
+		return;
+	}
+
+	strncpy(pRecord->text, text, EVENT_TEXT_SIZE - 1);
+	pRecord->text[EVENT_TEXT_SIZE - 1] = '\0';
+	EndRecord(pRecord, sequence);
+}
+
+/***********************************************************
+ *  Decode()
+ *
+ *  This method is used for printing the records that are
+ *  left in a flight recorder file, from the oldest to the
+ *  newest, and whether the process that wrote them exited
+ *  normally.  A slot whose sequence does not match its place
+ *  in the ring was being written when the process stopped.
+ ***********************************************************/
+bool FlightRecorder::Decode(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+	{
+		std::cout << "ERROR: could not open the flight recorder file " << filename << std::endl;
+		return(false);
+	}
+
+	FILE_HEADER header;
+	if (!file.read((char*)&header, sizeof(header)) ||
+		(memcmp(header.magic, FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC)) != 0) ||
+		(header.version != FLIGHT_VERSION) ||
+		(header.recordSize != sizeof(FLIGHT_RECORD)) ||
+		(header.recordCount == 0))
+	{
+		std::cout << "ERROR: " << filename << " is not a flight recorder file" << std::endl;
+		return(false);
+	}
+
+	std::vector<FLIGHT_RECORD> records(header.recordCount);
+	if (!file.read((char*)records.data(), (std::streamsize)(records.size() * sizeof(FLIGHT_RECORD))))
+	{
+		std::cout << "ERROR: the flight recorder file " << filename << " is cut off" << std::endl;
+		return(false);
+	}
+
+	char line[160];
+	time_t startTime = (time_t)header.startTime;
+	char startText[64];
+	strftime(startText, sizeof(startText), "%Y-%m-%d %H:%M:%S", localtime(&startTime));
+	snprintf(line, sizeof(line), "FLIGHT: process %u started %s, %llu records written, %s",
+		header.processId, startText, (unsigned long long)header.writeIndex,
+		header.bCleanExit ? "exited normally" : "did not exit normally");
+	std::cout << line << std::endl;
+
+	uint64_t first = (header.writeIndex > header.recordCount) ? (header.writeIndex - header.recordCount) : 0;
+	int torn = 0;
+	for (uint64_t index = first; index < header.writeIndex; index++)
+	{
+		const FLIGHT_RECORD& record = records[index % header.recordCount];
+		if (record.sequence != index + 1)
+		{
+			torn++;
+			continue;
+		}
+
+		int length = snprintf(line, sizeof(line), "FLIGHT: %10.4f s frame %-7u ", record.time, record.frame);
+		char* detail = line + length;
+		size_t detailSize = sizeof(line) - length;
+		switch (record.type)
+		{
+		case RECORD_FRAME:
+			if (record.frameData.gpuMilliseconds >= 0.0f)
+			{
+				snprintf(detail, detailSize, "FRAME %8.3f ms, gpu %8.3f ms, %u draws, %u triangles",
+					record.frameData.frameMilliseconds, record.frameData.gpuMilliseconds,
+					record.frameData.drawCalls, record.frameData.triangles);
+			}
+			else
+			{
+				snprintf(detail, detailSize, "FRAME %8.3f ms, gpu      n/a, %u draws, %u triangles",
+					record.frameData.frameMilliseconds, record.frameData.drawCalls, record.frameData.triangles);
+			}
+			break;
+		case RECORD_ERROR:
+			snprintf(detail, detailSize, "ERROR 0x%04x", record.errorCode);
+			break;
+		case RECORD_MEMORY:
+			snprintf(detail, detailSize, "MEMORY %.1f MB", record.memoryBytes / (1024.0 * 1024.0));
+			break;
+		case RECORD_EVENT:
+			{
+				char text[EVENT_TEXT_SIZE];
+				memcpy(text, record.text, EVENT_TEXT_SIZE);
+				text[EVENT_TEXT_SIZE - 1] = '\0';
+				snprintf(detail, detailSize, "EVENT %s", text);
+			}
+			break;
+		default:
+			snprintf(detail, detailSize, "UNKNOWN type %u", record.type);
+			break;
+		}
+		std::cout << line << std::endl;
+	}
+
+	if (torn > 0)
+	{
+		std::cout << "FLIGHT: " << torn << " records were being written when the process stopped" << std::endl;
+	}
+
+	return(true);
+}
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// flightrecorder.h
+// ============
+// keep the recent frame telemetry in a memory mapped file that outlives a crash
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  FlightRecorder
+ *
+ *  This class contains the code for writing fixed size
+ *  records of the frame timing, the graphics API errors,
+ *  the process memory and short event messages into a ring
+ *  in a memory mapped file.  The records are written to the
+ *  mapped pages without any system call, so the operating
+ *  system keeps them in the file even when the process
+ *  crashes.  A slot is claimed with one atomic increment and
+ *  its sequence number is written last, so records can be
+ *  written from any thread without a lock, and a record that
+ *  was cut off by a crash is recognized when decoding.
+ ***********************************************************/
+class FlightRecorder
+{
+public:
+	// constructor
+	FlightRecorder();
+	// destructor - marks the file as closed cleanly
+	~FlightRecorder();
+
+	// kinds of records
+	enum RECORD_TYPE
+	{
+		RECORD_FRAME = 1,
+		RECORD_ERROR,
+		RECORD_MEMORY,
+		RECORD_EVENT
+	};
+
+	// create the file and map the ring into memory
+	bool Open(const char* filename);
+	bool IsOpen() const { return(NULL != m_pRecords); }
+
+	// write a record of the frame timing and counters
+	void RecordFrame(
+		uint32_t frame,
+		float frameMilliseconds,
+		float gpuMilliseconds,
+		uint32_t drawCalls,
+		uint32_t triangles);
+	// write a record of a graphics API error
+	void RecordError(uint32_t frame, uint32_t code);
+	// write a record of the memory used by the process
+	void RecordMemory(uint32_t frame, uint64_t bytes);
+	// write a short event message, cut to the record size
+	void RecordEvent(uint32_t frame, const char* text);
+
+	// print the records of a flight recorder file, oldest first
+	static bool Decode(const char* filename);
+
+private:
+	// number of records in the ring
+	static const uint32_t RECORD_COUNT = 4096;
+	// characters of an event message
+	static const int EVENT_TEXT_SIZE = 40;
+
+	// start of the file
+	struct FILE_HEADER
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t recordSize;
+		uint32_t recordCount;
+		uint32_t processId;
+		// wall clock time that the file was created, in seconds
+		int64_t startTime;
+		// number of records claimed so far
+		uint64_t writeIndex;
+		// set when the process closed the file normally
+		uint32_t bCleanExit;
+		uint32_t reserved[5];
+	};
+
+	// one record in the ring, the sequence is the write index
+	// plus one, so zero marks a slot that was never finished
+	struct FLIGHT_RECORD
+	{
+		uint64_t sequence;
+		// seconds since the file was created
+		double time;
+		uint32_t type;
+		uint32_t frame;
+		union
+		{
+			struct
+			{
+				float frameMilliseconds;
+				float gpuMilliseconds;
+				uint32_t drawCalls;
+				uint32_t triangles;
+			} frameData;
+			uint32_t errorCode;
+			uint64_t memoryBytes;
+			char text[EVENT_TEXT_SIZE];
+		};
+	};
+
+	FILE_HEADER* m_pHeader;
+	FLIGHT_RECORD* m_pRecords;
+	// the write index in the mapped header
+	std::atomic<uint64_t>* m_pWriteIndex;
+	// size of the mapping
+	size_t m_mappedSize;
+	// time that the file was created, for the record times
+	int64_t m_startTicks;
+
+	// handles of the file and the mapping on Windows, or the
+	// file descriptor elsewhere
+	void* m_fileHandle;
+	void* m_mappingHandle;
+	int m_fileDescriptor;
+
+	// claim the next record in the ring
+	FLIGHT_RECORD* BeginRecord(uint32_t type, uint32_t frame, uint64_t& sequence);
+	// publish a record once its values are written
+	static void EndRecord(FLIGHT_RECORD* pRecord, uint64_t sequence);
+	// unmap and close the file
+	void Close();
+};
@@ -0,0 +1,245 @@
+///////////////////////////////////////////////////////////////////////////////
+// gldebugoutput.cpp
+// ============
+// collect the OpenGL debug messages and report them once per run
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLDebugOutput.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// most messages of each group listed in the report
+	const size_t MAX_REPORTED_MESSAGES = 20;
+
+	// get the name of a message source
+	const char* GetSourceName(GLenum source)
+	{
+		switch (source)
+		{
+		case GL_DEBUG_SOURCE_API: return("api");
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return("window system");
+		case GL_DEBUG_SOURCE_SHADER_COMPILER: return("shader compiler");
+		case GL_DEBUG_SOURCE_THIRD_PARTY: return("third party");
+		case GL_DEBUG_SOURCE_APPLICATION: return("application");
+		default: return("other");
+		}
+	}
+
+	// get the name of a message type
+	const char* GetTypeName(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_DEBUG_TYPE_ERROR: return("error");
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return("deprecated");
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return("undefined");
+		case GL_DEBUG_TYPE_PORTABILITY: return("portability");
+		case GL_DEBUG_TYPE_PERFORMANCE: return("performance");
+		case GL_DEBUG_TYPE_MARKER: return("marker");
+		case GL_DEBUG_TYPE_PUSH_GROUP: return("push group");
+		case GL_DEBUG_TYPE_POP_GROUP: return("pop group");
+		default: return("other");
+		}
+	}
+
+	// get the name of a message severity
+	const char* GetSeverityName(GLenum severity)
+	{
+		switch (severity)
+		{
+		case GL_DEBUG_SEVERITY_HIGH: return("high");
+		case GL_DEBUG_SEVERITY_MEDIUM: return("medium");
+		case GL_DEBUG_SEVERITY_LOW: return("low");
+		default: return("notification");
+		}
+	}
+}
+
+/***********************************************************
+ *  GLDebugOutput()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLDebugOutput::GLDebugOutput() :
+	m_frameIndex(0),
+	m_bInstalled(false)
+{
+}
+
+/***********************************************************
+ *  ~GLDebugOutput()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLDebugOutput::~GLDebugOutput()
+{
+	if (m_bInstalled)
+	{
+		glDebugMessageCallback(NULL, NULL);
+		glDisable(GL_DEBUG_OUTPUT);
+	}
+}
+
+/***********************************************************
+ *  Install()
+ *
+ *  This method is used for enabling the debug output of the
+ *  current context and installing the message callback.
+ *  The messages are delivered on the thread that issued the
+ *  call, so that each is counted in the frame it came from.
+ ***********************************************************/
+bool GLDebugOutput::Install()
+{
+	if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+	{
+		LOG_WARNING("the OpenGL driver has no debug output");
+		return(false);
+	}
+
+	GLint contextFlags = 0;
+	glGetIntegerv(GL_CONTEXT_FLAGS, &contextFlags);
+	if ((contextFlags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+	{
+		LOG_WARNING("the OpenGL context is not a debug context, the driver may report fewer messages");
+	}
+
+	glEnable(GL_DEBUG_OUTPUT);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	glDebugMessageCallback(MessageCallback, this);
+	// every message is counted, the report sorts them out
+	glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, NULL, GL_TRUE);
+	m_bInstalled = true;
+	return(true);
+}
+
+/***********************************************************
+ *  MessageCallback()
+ *
+ *  This method is used for passing a driver message to the
+ *  object that installed the callback.
+ ***********************************************************/
+void APIENTRY GLDebugOutput::MessageCallback(
+	GLenum source,
+	GLenum type,
+	GLuint id,
+	GLenum severity,
+	GLsizei length,
+	const GLchar* message,
+	const void* userParam)
+{
+	GLDebugOutput* pDebugOutput = (GLDebugOutput*)userParam;
+	if (NULL != pDebugOutput)
+	{
+		pDebugOutput->AddMessage(source, type, id, severity, message, length);
+	}
+}
+
+/***********************************************************
+ *  AddMessage()
+ *
+ *  This method is used for counting a message, keeping the
+ *  text and the frame of the first of its kind.  Only the
+ *  first message of each kind is logged, since the drivers
+ *  repeat the same message every frame.
+ ***********************************************************/
+void GLDebugOutput::AddMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* message, GLsizei length)
+{
+	uint32_t frameIndex = m_frameIndex.load(std::memory_order_relaxed);
+	bool bFirst = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		MESSAGE_ENTRY& entry = m_messages[MESSAGE_KEY(source, type, id)];
+		entry.count++;
+		if (entry.count == 1)
+		{
+			bFirst = true;
+			entry.severity = severity;
+			entry.firstFrame = frameIndex;
+			entry.text = (length >= 0) ? std::string(message, length) : std::string(message);
+		}
+	}
+
+	if (bFirst == false)
+	{
+		return;
+	}
+
+	if ((type == GL_DEBUG_TYPE_ERROR) || (severity == GL_DEBUG_SEVERITY_HIGH))
+	{
+		LOG_ERROR("OpenGL debug message", "source", GetSourceName(source), "type", GetTypeName(type),
+			"id", id, "frame", frameIndex, "text", message);
+	}
+	else if ((type == GL_DEBUG_TYPE_PERFORMANCE) || (severity != GL_DEBUG_SEVERITY_NOTIFICATION))
+	{
+		LOG_WARNING("OpenGL debug message", "source", GetSourceName(source), "type", GetTypeName(type),
+			"id", id, "frame", frameIndex, "text", message);
+	}
+	else
+	{
+		LOG_DEBUG("OpenGL debug message", "source", GetSourceName(source), "type", GetTypeName(type),
+			"id", id, "frame", frameIndex, "text", message);
+	}
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the counted messages,
+ *  the performance messages first and then the others, each
+ *  group ordered by the number of times it was reported.
+ ***********************************************************/
+void GLDebugOutput::Report() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::vector<std::pair<MESSAGE_KEY, MESSAGE_ENTRY> > performance;
+	std::vector<std::pair<MESSAGE_KEY, MESSAGE_ENTRY> > others;
+	uint64_t totalCount = 0;
+	for (const auto& message : m_messages)
+	{
+		totalCount += message.second.count;
+		if (std::get<1>(message.first) == GL_DEBUG_TYPE_PERFORMANCE)
+		{
+			performance.push_back(message);
+		}
+		else
+		{
+			others.push_back(message);
+		}
+	}
+
+	std::cout << "GLDEBUG: " << totalCount << " messages of " << m_messages.size() << " kinds, "
+		<< performance.size() << " kinds about performance" << std::endl;
+
+	auto byCount = [](const std::pair<MESSAGE_KEY, MESSAGE_ENTRY>& left, const std::pair<MESSAGE_KEY, MESSAGE_ENTRY>& right)
+	{
+		return(left.second.count > right.second.count);
+	};
+	std::sort(performance.begin(), performance.end(), byCount);
+	std::sort(others.begin(), others.end(), byCount);
+
+	const std::vector<std::pair<MESSAGE_KEY, MESSAGE_ENTRY> >* groups[2] = { &performance, &others };
+	for (int group = 0; group < 2; group++)
+	{
+		const std::vector<std::pair<MESSAGE_KEY, MESSAGE_ENTRY> >& messages = *groups[group];
+		for (size_t i = 0; (i < messages.size()) && (i < MAX_REPORTED_MESSAGES); i++)
+		{
+			const MESSAGE_KEY& key = messages[i].first;
+			const MESSAGE_ENTRY& entry = messages[i].second;
+			std::cout << "GLDEBUG: " << GetSourceName(std::get<0>(key)) << " " << GetTypeName(std::get<1>(key))
+				<< " id " << std::get<2>(key) << " " << GetSeverityName(entry.severity)
+				<< ", " << entry.count << " times, first in frame " << entry.firstFrame
+				<< ": " << entry.text << std::endl;
+		}
+		if (messages.size() > MAX_REPORTED_MESSAGES)
+		{
+			std::cout << "GLDEBUG: " << (messages.size() - MAX_REPORTED_MESSAGES) << " more kinds not listed" << std::endl;
+		}
+	}
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// gldebugoutput.h
+// ============
+// collect the OpenGL debug messages and report them once per run
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+/***********************************************************
+ *  GLDebugOutput
+ *
+ *  This class contains the code for receiving the messages
+ *  of the KHR_debug extension, which is how the drivers
+ *  report errors and performance problems such as implicit
+ *  synchronizations, shader recompiles and slow upload
+ *  paths.  The messages are counted by their source, type
+ *  and ID instead of being printed each time, keeping the
+ *  text and the frame of the first one, and the report at
+ *  the end of the run lists the performance messages first.
+ *  The debug output needs a context created with the debug
+ *  flag to report everything on most drivers.
+ ***********************************************************/
+class GLDebugOutput
+{
+public:
+	// constructor
+	GLDebugOutput();
+	// destructor - removes the callback
+	~GLDebugOutput();
+
+	// install the message callback in the current context,
+	// false is returned when the driver has no debug output
+	bool Install();
+	// set the frame that the next messages belong to
+	void SetFrame(uint32_t frameIndex) { m_frameIndex.store(frameIndex, std::memory_order_relaxed); }
+
+	// print the counted messages
+	void Report() const;
+
+private:
+	// messages with the same source, type and ID are counted
+	// together
+	typedef std::tuple<GLenum, GLenum, GLuint> MESSAGE_KEY;
+
+	// counted message
+	struct MESSAGE_ENTRY
+	{
+		GLenum severity;
+		uint64_t count;
+		uint32_t firstFrame;
+		std::string text;
+	};
+
+	std::map<MESSAGE_KEY, MESSAGE_ENTRY> m_messages;
+	// the drivers can call back from their own threads
+	mutable std::mutex m_mutex;
+	std::atomic<uint32_t> m_frameIndex;
+	bool m_bInstalled;
+
+	// count a message, logging the first one of each kind
+	void AddMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const GLchar* message, GLsizei length);
+
+	// callback that the driver calls for each message
+	static void APIENTRY MessageCallback(
+		GLenum source,
+		GLenum type,
+		GLuint id,
+		GLenum severity,
+		GLsizei length,
+		const GLchar* message,
+		const void* userParam);
+};
@@ -0,0 +1,1288 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderdevice.cpp
+// ============
+// render device backend that issues the commands to OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLRenderDevice.h"
+#include "SpirvShaderLoader.h"
+#include "GlslShaderLoader.h"
+#include "MeshGenerator.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstddef>
+
+// declaration of global variables
+namespace
+{
+	// overlay shader files
+	const char* const g_OverlayVertexShader = "shaders/overlayVertexShader.glsl";
+	const char* const g_OverlayFragmentShader = "shaders/overlayFragmentShader.glsl";
+
+	// explicit uniform locations declared in the overlay shaders
+	const GLint g_OverlayScreenSizeLocation = 0;
+	const GLint g_OverlayTextureLocation = 1;
+
+	// texture unit for the overlay texture, above the units
+	// that are used by the scene
+	const int g_OverlayTextureUnit = 16;
+	// texture unit for the environment cube map, above the
+	// overlay texture
+	const int g_EnvironmentTextureUnit = 17;
+}
+
+/***********************************************************
+ *  GLRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLRenderDevice::GLRenderDevice()
+{
+	m_boundPipeline = 0;
+	m_pShaderBindings = NULL;
+	m_pUniformRing = new GLUniformRing();
+	m_basicMeshes = new ShapeMeshes();
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		m_meshTriangles[i] = 0;
+		m_bShapeMeshLoaded[i] = false;
+		m_generatedMeshes[i] = GL_MESH();
+	}
+	m_framebufferWidth = 0;
+	m_framebufferHeight = 0;
+	m_bViewportIndex = false;
+	m_boundTarget = 0;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_readFramebuffer = 0;
+
+	m_pOverlayShader = NULL;
+	m_overlayVAO = 0;
+	m_overlayVBO = 0;
+	m_bOverlayFailed = false;
+
+	for (int i = 0; i < TIMER_QUERIES; i++)
+	{
+		m_timerQueries[i] = 0;
+	}
+	m_timerWrite = 0;
+	m_timerPending = 0;
+	m_gpuMilliseconds = 0.0;
+	m_bGpuTimeValid = false;
+}
+
+/***********************************************************
+ *  ~GLRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLRenderDevice::~GLRenderDevice()
+{
+	m_pShaderBindings = NULL;
+	for (size_t i = 0; i < m_pipelines.size(); i++)
+	{
+		delete m_pipelines[i].pShaderBindings;
+		delete m_pipelines[i].pShaderManager;
+	}
+	m_pipelines.clear();
+	delete m_pUniformRing;
+	m_pUniformRing = NULL;
+
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		FreeGeneratedMesh((MESH_TYPE)i);
+	}
+	for (size_t i = 0; i < m_targets.size(); i++)
+	{
+		DestroyTarget((uint32_t)(i + 1));
+	}
+	m_targets.clear();
+	if (m_readFramebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &m_readFramebuffer);
+	}
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+
+	if (NULL != m_pOverlayShader)
+	{
+		glDeleteVertexArrays(1, &m_overlayVAO);
+		glDeleteBuffers(1, &m_overlayVBO);
+		delete m_pOverlayShader;
+		m_pOverlayShader = NULL;
+	}
+
+	if (m_timerQueries[0] != 0)
+	{
+		glDeleteQueries(TIMER_QUERIES, m_timerQueries);
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for setting the fixed OpenGL state
+ *  once the display window and context have been created.
+ ***********************************************************/
+bool GLRenderDevice::Initialize()
+{
+	// enable blending for supporting tranparent rendering
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// timer queries for measuring the GPU frame time
+	glGenQueries(TIMER_QUERIES, m_timerQueries);
+
+	// the initial viewport covers the default framebuffer
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	m_framebufferWidth = viewport[2];
+	m_framebufferHeight = viewport[3];
+	m_targetWidth = m_framebufferWidth;
+	m_targetHeight = m_framebufferHeight;
+	m_bViewportIndex = (GLEW_ARB_shader_viewport_layer_array != GL_FALSE);
+
+	if (m_pUniformRing->Initialize() == false)
+	{
+		LOG_ERROR("could not create the uniform buffer ring");
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadSpirvShaders()
+ *
+ *  This method is used to load the SPIR-V shader binaries
+ *  that are compiled from the GLSL files during the build.
+ ***********************************************************/
+bool GLRenderDevice::LoadSpirvShaders(ShaderManager* pShaderManager, const PIPELINE_DESC& desc)
+{
+	SpirvShaderLoader spirvLoader;
+	SpirvShaderLoader::SPECIALIZATION_CONSTANTS constants;
+	GLuint programID = 0;
+
+	if ((NULL == desc.vertexBinaryPath) || (NULL == desc.fragmentBinaryPath))
+	{
+		return(false);
+	}
+
+	constants.activeLights = desc.activeLights;
+	constants.bEnableLighting = desc.bEnableLighting;
+	constants.bEnableSpecular = desc.bEnableSpecular;
+
+	programID = spirvLoader.LoadShaders(
+		desc.vertexBinaryPath,
+		desc.fragmentBinaryPath,
+		constants);
+	if (programID == 0)
+	{
+		return(false);
+	}
+
+	pShaderManager->m_programID = programID;
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadGlslShaders()
+ *
+ *  This method is used to compile the GLSL shader files,
+ *  with the light count and feature toggles of the pipeline
+ *  that the SPIR-V binaries are specialized with.
+ ***********************************************************/
+bool GLRenderDevice::LoadGlslShaders(ShaderManager* pShaderManager, const PIPELINE_DESC& desc)
+{
+	GlslShaderLoader glslLoader;
+	SpirvShaderLoader::SPECIALIZATION_CONSTANTS constants;
+
+	constants.activeLights = desc.activeLights;
+	constants.bEnableLighting = desc.bEnableLighting;
+	constants.bEnableSpecular = desc.bEnableSpecular;
+
+	GLuint programID = glslLoader.LoadShaders(
+		desc.vertexShaderPath,
+		desc.fragmentShaderPath,
+		constants);
+	if (programID == 0)
+	{
+		return(false);
+	}
+
+	pShaderManager->m_programID = programID;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for loading the shader program for
+ *  a pipeline and validating its uniform bindings.
+ ***********************************************************/
+uint32_t GLRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	GL_PIPELINE pipeline;
+
+	pipeline.pShaderManager = new ShaderManager();
+	pipeline.pShaderBindings = new ShaderBindings();
+
+	// load the offline compiled SPIR-V shaders, and if they are not
+	// available then compile the shader code from the external GLSL files
+	if ((LoadSpirvShaders(pipeline.pShaderManager, desc) == false) &&
+		(LoadGlslShaders(pipeline.pShaderManager, desc) == false))
+	{
+		LOG_ERROR("could not load the shader program", "vertex", desc.vertexShaderPath,
+			"fragment", desc.fragmentShaderPath);
+		delete pipeline.pShaderBindings;
+		delete pipeline.pShaderManager;
+		return(0);
+	}
+	pipeline.pShaderManager->use();
+
+	// resolve the uniform locations and check them against the
+	// uniforms that are declared in the shader program
+	if (pipeline.pShaderBindings->Initialize(pipeline.pShaderManager->m_programID) == false)
+	{
+		LOG_ERROR("shader uniform bindings do not match the shader program");
+		delete pipeline.pShaderBindings;
+		delete pipeline.pShaderManager;
+		return(0);
+	}
+
+	m_pipelines.push_back(pipeline);
+	m_pShaderBindings = pipeline.pShaderBindings;
+	m_boundPipeline = (uint32_t)m_pipelines.size();
+
+	return((uint32_t)m_pipelines.size());
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for making the passed in pipeline
+ *  the active shader program.
+ ***********************************************************/
+void GLRenderDevice::BindPipeline(uint32_t pipeline)
+{
+	if ((pipeline == 0) || (pipeline > m_pipelines.size()) ||
+		(NULL == m_pipelines[pipeline - 1].pShaderManager))
+	{
+		return;
+	}
+
+	m_pipelines[pipeline - 1].pShaderManager->use();
+	m_pShaderBindings = m_pipelines[pipeline - 1].pShaderBindings;
+	m_pShaderBindings->SetSamplerCube(ShaderBindings::UNIFORM_ENVIRONMENT_MAP, g_EnvironmentTextureUnit);
+	m_boundPipeline = pipeline;
+	m_stats.pipelineBinds++;
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing the shader program of
+ *  the passed in pipeline.  The slot is kept so that the
+ *  handles of the other pipelines stay the same.
+ ***********************************************************/
+void GLRenderDevice::DestroyPipeline(uint32_t pipeline)
+{
+	if ((pipeline == 0) || (pipeline > m_pipelines.size()) ||
+		(NULL == m_pipelines[pipeline - 1].pShaderManager))
+	{
+		return;
+	}
+
+	GL_PIPELINE& destroyed = m_pipelines[pipeline - 1];
+	if (m_boundPipeline == pipeline)
+	{
+		glUseProgram(0);
+		m_pShaderBindings = NULL;
+		m_boundPipeline = 0;
+	}
+
+	glDeleteProgram(destroyed.pShaderManager->m_programID);
+	destroyed.pShaderManager->m_programID = 0;
+	delete destroyed.pShaderBindings;
+	delete destroyed.pShaderManager;
+	destroyed.pShaderBindings = NULL;
+	destroyed.pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for configuring the texture mapping
+ *  parameters in OpenGL, loading the decoded image data and
+ *  generating the mipmaps.
+ ***********************************************************/
+uint32_t GLRenderDevice::CreateTexture(
+	int width,
+	int height,
+	int colorChannels,
+	const unsigned char* pixels)
+{
+	GLuint textureID = 0;
+
+	// only RGB and RGBA images are supported
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		LOG_ERROR("images with this number of channels are not supported", "channels", colorChannels);
+		return(0);
+	}
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// if the loaded image is in RGB format
+	if (colorChannels == 3)
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, pixels);
+	// if the loaded image is in RGBA format - it supports transparency
+	else
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	// generate the texture mipmaps for mapping textures to lower resolutions
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing the passed in texture.
+ ***********************************************************/
+void GLRenderDevice::DestroyTexture(uint32_t texture)
+{
+	GLuint textureID = texture;
+
+	glDeleteTextures(1, &textureID);
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding the passed in texture
+ *  to one of the OpenGL texture memory slots.
+ ***********************************************************/
+void GLRenderDevice::BindTexture(int slot, uint32_t texture)
+{
+	glActiveTexture(GL_TEXTURE0 + slot);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	m_stats.textureBinds++;
+}
+
+/***********************************************************
+ *  SetTextureSlot()
+ *
+ *  This method is used for setting the texture slot that
+ *  the shader samples the object texture from.
+ ***********************************************************/
+void GLRenderDevice::SetTextureSlot(int slot)
+{
+	if (NULL != m_pShaderBindings)
+	{
+		m_pShaderBindings->SetSampler2D(ShaderBindings::UNIFORM_OBJECT_TEXTURE, slot);
+	}
+}
+
+/***********************************************************
+ *  CreateStreamedTexture()
+ *
+ *  This method is used for creating a texture with every
+ *  mip level allocated but not uploaded.  The texture only
+ *  samples the levels that have been uploaded, starting
+ *  with the smallest one.
+ ***********************************************************/
+uint32_t GLRenderDevice::CreateStreamedTexture(int width, int height, int colorChannels, int mipLevels)
+{
+	GLuint textureID = 0;
+
+	// only RGB and RGBA images are supported
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		LOG_ERROR("images with this number of channels are not supported", "channels", colorChannels);
+		return(0);
+	}
+
+	GLint internalFormat = (colorChannels == 3) ? GL_RGB8 : GL_RGBA8;
+	GLenum format = (colorChannels == 3) ? GL_RGB : GL_RGBA;
+
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// set the same wrapping and filtering as the textures that
+	// are uploaded whole
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	for (int level = 0; level < mipLevels; level++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, level, internalFormat,
+			std::max(width >> level, 1), std::max(height >> level, 1), 0, format, GL_UNSIGNED_BYTE, NULL);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, mipLevels - 1);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  UploadTextureLevel()
+ *
+ *  This method is used for uploading one mip level of a
+ *  streamed texture, and sampling the texture from it.
+ ***********************************************************/
+void GLRenderDevice::UploadTextureLevel(
+	uint32_t texture,
+	int level,
+	int width,
+	int height,
+	int colorChannels,
+	const unsigned char* pixels)
+{
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// the rows of the smaller RGB levels are not padded to
+	// four bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height,
+		(colorChannels == 3) ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/***********************************************************
+ *  CreateCubeTexture()
+ *
+ *  This method is used for creating a cube map texture with
+ *  the passed in mip levels, which are sampled as they are
+ *  rather than generated from the first level.
+ ***********************************************************/
+uint32_t GLRenderDevice::CreateCubeTexture(int faceSize, int mipLevels, const float* pixels)
+{
+	if ((faceSize <= 0) || (mipLevels <= 0) || ((faceSize >> (mipLevels - 1)) == 0) || (NULL == pixels))
+	{
+		return(0);
+	}
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+	glTexStorage2D(GL_TEXTURE_CUBE_MAP, mipLevels, GL_RGBA16F, faceSize, faceSize);
+
+	const float* levelPixels = pixels;
+	for (int level = 0; level < mipLevels; level++)
+	{
+		GLsizei size = faceSize >> level;
+		for (int face = 0; face < 6; face++)
+		{
+			glTexSubImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, 0, 0, size, size, GL_RGB, GL_FLOAT, levelPixels);
+			levelPixels += size * size * 3;
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, mipLevels - 1);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	// the blurred levels blend across the edges of the faces
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  BindEnvironment()
+ *
+ *  This method is used for binding the environment cube map
+ *  to its own texture unit, which the shader programs
+ *  sample it from.
+ ***********************************************************/
+void GLRenderDevice::BindEnvironment(uint32_t texture)
+{
+	glActiveTexture(GL_TEXTURE0 + g_EnvironmentTextureUnit);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+	// the cube map targets are bound on the first unit, so
+	// they never replace the environment
+	glActiveTexture(GL_TEXTURE0);
+	m_stats.textureBinds++;
+}
+
+/***********************************************************
+ *  UpdateBlock()
+ *
+ *  These methods are used for copying the passed in uniform
+ *  block struct into the next free range of the uniform
+ *  buffer ring.
+ ***********************************************************/
+void GLRenderDevice::UpdateBlock(const CAMERA_BLOCK& block)
+{
+	if (NULL != m_pShaderBindings)
+	{
+		m_pUniformRing->Upload(CAMERA_BLOCK_BINDING, &block, sizeof(block));
+		m_stats.blockUploads++;
+		m_stats.uploadBytes += sizeof(block);
+	}
+}
+
+void GLRenderDevice::UpdateBlock(const LIGHT_BLOCK& block)
+{
+	if (NULL != m_pShaderBindings)
+	{
+		m_pUniformRing->Upload(LIGHT_BLOCK_BINDING, &block, sizeof(block));
+		m_stats.blockUploads++;
+		m_stats.uploadBytes += sizeof(block);
+	}
+}
+
+void GLRenderDevice::UpdateBlock(const MATERIAL_BLOCK& block)
+{
+	if (NULL != m_pShaderBindings)
+	{
+		m_pUniformRing->Upload(MATERIAL_BLOCK_BINDING, &block, sizeof(block));
+		m_stats.blockUploads++;
+		m_stats.uploadBytes += sizeof(block);
+	}
+}
+
+void GLRenderDevice::UpdateBlock(const INSTANCE_BLOCK& block)
+{
+	m_instanceViewMask = block.viewMask;
+	if (NULL != m_pShaderBindings)
+	{
+		m_pUniformRing->Upload(INSTANCE_BLOCK_BINDING, &block, sizeof(block));
+		m_stats.blockUploads++;
+		m_stats.uploadBytes += sizeof(block);
+	}
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  These methods are used for creating the vertex buffers
+ *  for one of the basic shape meshes.  Without data the
+ *  shape meshes generate their own vertices at full detail,
+ *  and keep their buffers when loaded again.  Generated data
+ *  is copied into buffers of its own, which replace the
+ *  buffers of an earlier load, so that a mesh can be drawn
+ *  at another detail.
+ ***********************************************************/
+void GLRenderDevice::LoadMesh(MESH_TYPE mesh)
+{
+	MeshGenerator::MESH_DATA data;
+
+	if ((mesh < 0) || (mesh >= MESH_COUNT))
+	{
+		return;
+	}
+
+	FreeGeneratedMesh(mesh);
+	if (m_bShapeMeshLoaded[mesh] == false)
+	{
+		switch (mesh)
+		{
+		case MESH_PLANE:
+			m_basicMeshes->LoadPlaneMesh();
+			break;
+		case MESH_TORUS:
+			m_basicMeshes->LoadTorusMesh();
+			break;
+		case MESH_CYLINDER:
+			m_basicMeshes->LoadCylinderMesh();
+			break;
+		case MESH_SPHERE:
+			m_basicMeshes->LoadSphereMesh();
+			break;
+		default:
+			return;
+		}
+		m_bShapeMeshLoaded[mesh] = true;
+	}
+
+	// the shape meshes do not report their sizes, so count
+	// the triangles of the matching generated mesh
+	m_meshTriangles[mesh] = MeshGenerator::CountTriangles(mesh, MeshGenerator::DEFAULT_DETAIL);
+
+	// the shape meshes are drawn without instances, so the
+	// generated mesh is drawn in their place in several views
+	if (m_viewCount > 1)
+	{
+		MeshGenerator::GenerateMesh(mesh, MeshGenerator::DEFAULT_DETAIL, data);
+		LoadMesh(mesh, data);
+	}
+}
+
+void GLRenderDevice::LoadMesh(MESH_TYPE mesh, const MESH_DATA& data)
+{
+	if ((mesh < 0) || (mesh >= MESH_COUNT))
+	{
+		return;
+	}
+
+	FreeGeneratedMesh(mesh);
+	GL_MESH& glMesh = m_generatedMeshes[mesh];
+
+	glGenVertexArrays(1, &glMesh.vao);
+	glBindVertexArray(glMesh.vao);
+	glGenBuffers(1, &glMesh.vbo);
+	glBindBuffer(GL_ARRAY_BUFFER, glMesh.vbo);
+	glBufferData(GL_ARRAY_BUFFER, data.vertices.size() * sizeof(MESH_VERTEX), data.vertices.data(), GL_STATIC_DRAW);
+	glGenBuffers(1, &glMesh.ebo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, glMesh.ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size() * sizeof(uint32_t), data.indices.data(), GL_STATIC_DRAW);
+
+	GLsizei stride = sizeof(MESH_VERTEX);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, position));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, normal));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(MESH_VERTEX, textureCoordinate));
+	glEnableVertexAttribArray(2);
+
+	glBindVertexArray(0);
+
+	glMesh.indexCount = (GLsizei)data.indices.size();
+	m_meshTriangles[mesh] = (uint32_t)(data.indices.size() / 3);
+}
+
+/***********************************************************
+ *  FreeGeneratedMesh()
+ *
+ *  This method is used for freeing the buffers of a mesh
+ *  that was loaded from generated data.
+ ***********************************************************/
+void GLRenderDevice::FreeGeneratedMesh(MESH_TYPE mesh)
+{
+	GL_MESH& glMesh = m_generatedMeshes[mesh];
+	if (glMesh.vao == 0)
+	{
+		return;
+	}
+
+	glDeleteVertexArrays(1, &glMesh.vao);
+	glDeleteBuffers(1, &glMesh.vbo);
+	glDeleteBuffers(1, &glMesh.ebo);
+	glMesh = GL_MESH();
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for drawing one of the loaded basic
+ *  shape meshes.
+ ***********************************************************/
+void GLRenderDevice::DrawMesh(MESH_TYPE mesh)
+{
+	if ((mesh >= 0) && (mesh < MESH_COUNT) && (m_generatedMeshes[mesh].vao != 0))
+	{
+		uint32_t viewMask = GetDrawViewMask();
+		uint32_t views = CountViews(viewMask);
+		if (views == 0)
+		{
+			return;
+		}
+
+		glBindVertexArray(m_generatedMeshes[mesh].vao);
+		if (m_viewCount == 1)
+		{
+			glDrawElements(GL_TRIANGLES, m_generatedMeshes[mesh].indexCount, GL_UNSIGNED_INT, NULL);
+			m_stats.drawCalls++;
+		}
+		else if (m_bViewportIndex)
+		{
+			// one instance for each view of the object, the vertex
+			// shader selects the view matrices and the viewport by
+			// the instance
+			glDrawElementsInstanced(GL_TRIANGLES, m_generatedMeshes[mesh].indexCount, GL_UNSIGNED_INT, NULL, views);
+			m_stats.drawCalls++;
+		}
+		else
+		{
+			// the instance is passed as the base instance, and the
+			// viewport is set before the draw of each view
+			uint32_t instance = 0;
+			for (uint32_t i = 0; i < m_viewCount; i++)
+			{
+				if ((viewMask & (1u << i)) == 0)
+				{
+					continue;
+				}
+				ApplyViewport(0, m_viewports[i]);
+				glDrawElementsInstancedBaseInstance(GL_TRIANGLES, m_generatedMeshes[mesh].indexCount,
+					GL_UNSIGNED_INT, NULL, 1, instance);
+				instance++;
+			}
+			m_stats.drawCalls += views;
+		}
+		glBindVertexArray(0);
+		m_stats.triangles += m_meshTriangles[mesh] * views;
+		return;
+	}
+
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case MESH_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	case MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case MESH_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	default:
+		return;
+	}
+	m_stats.drawCalls++;
+	m_stats.triangles += m_meshTriangles[mesh];
+}
+
+/***********************************************************
+ *  SetViews()
+ *
+ *  This method is used for setting the viewports of the
+ *  views.  Drawing several views needs the instanced draws
+ *  of the generated meshes, so the meshes that were loaded
+ *  as shape meshes are generated again.
+ ***********************************************************/
+void GLRenderDevice::SetViews(const VIEWPORT* viewports, uint32_t viewCount)
+{
+	RenderDevice::SetViews(viewports, viewCount);
+
+	if (m_viewCount > 1)
+	{
+		for (int i = 0; i < MESH_COUNT; i++)
+		{
+			if (m_bShapeMeshLoaded[i] && (m_generatedMeshes[i].vao == 0))
+			{
+				MeshGenerator::MESH_DATA data;
+				MeshGenerator::GenerateMesh((MESH_TYPE)i, MeshGenerator::DEFAULT_DETAIL, data);
+				LoadMesh((MESH_TYPE)i, data);
+			}
+		}
+	}
+
+	ApplyViewports();
+}
+
+/***********************************************************
+ *  ApplyViewport()
+ *  ApplyViewports()
+ *
+ *  These methods are used for converting the viewports of
+ *  the views into pixels of the bound framebuffer and
+ *  setting them into the viewport array.
+ ***********************************************************/
+void GLRenderDevice::ApplyViewport(GLuint index, const VIEWPORT& viewport)
+{
+	glViewportIndexedf(index,
+		viewport.x * m_targetWidth,
+		viewport.y * m_targetHeight,
+		viewport.width * m_targetWidth,
+		viewport.height * m_targetHeight);
+}
+
+void GLRenderDevice::ApplyViewports()
+{
+	for (uint32_t i = 0; i < m_viewCount; i++)
+	{
+		ApplyViewport(i, m_viewports[i]);
+	}
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used for creating a color and a depth
+ *  texture array with a layer for each view, attached as a
+ *  layered framebuffer.  The layer of each view is selected
+ *  by the vertex shader, which needs the same extension as
+ *  selecting the viewport.  A cube map target is made of
+ *  cube map textures instead, with half float colors for
+ *  the lighting that is taken from it and a full chain of
+ *  mip levels.
+ ***********************************************************/
+uint32_t GLRenderDevice::CreateTarget(const TARGET_DESC& desc)
+{
+	if (m_bViewportIndex == false)
+	{
+		LOG_WARNING("the OpenGL driver cannot select the layer in the vertex shader");
+		return(0);
+	}
+	if ((desc.width <= 0) || (desc.height <= 0) || (desc.layers == 0) || (desc.layers > (uint32_t)MAX_VIEWS))
+	{
+		return(0);
+	}
+	if (desc.bCubeMap && ((desc.layers != 6) || (desc.width != desc.height)))
+	{
+		return(0);
+	}
+
+	GL_TARGET target;
+	target.desc = desc;
+
+	if (desc.bCubeMap)
+	{
+		GLsizei mipLevels = 1;
+		while ((desc.width >> mipLevels) > 0)
+		{
+			mipLevels++;
+		}
+
+		glGenTextures(1, &target.colorTexture);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, target.colorTexture);
+		glTexStorage2D(GL_TEXTURE_CUBE_MAP, mipLevels, GL_RGBA16F, desc.width, desc.height);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glGenTextures(1, &target.depthTexture);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, target.depthTexture);
+		glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_DEPTH_COMPONENT24, desc.width, desc.height);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+		// the filtered levels blend across the edges of the faces
+		glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+	}
+	else
+	{
+		glGenTextures(1, &target.colorTexture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, target.colorTexture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, desc.width, desc.height, desc.layers);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glGenTextures(1, &target.depthTexture);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, target.depthTexture);
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, desc.width, desc.height, desc.layers);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	glGenFramebuffers(1, &target.framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target.colorTexture, 0);
+	glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, target.depthTexture, 0);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	BindFramebuffer(m_boundTarget);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		LOG_ERROR("the layered target is not complete", "status", status);
+		glDeleteFramebuffers(1, &target.framebuffer);
+		glDeleteTextures(1, &target.colorTexture);
+		glDeleteTextures(1, &target.depthTexture);
+		return(0);
+	}
+
+	m_targets.push_back(target);
+	return((uint32_t)m_targets.size());
+}
+
+/***********************************************************
+ *  DestroyTarget()
+ *
+ *  This method is used for freeing the textures and the
+ *  framebuffer of a layered target.
+ ***********************************************************/
+void GLRenderDevice::DestroyTarget(uint32_t target)
+{
+	if ((target == 0) || (target > m_targets.size()) || (m_targets[target - 1].framebuffer == 0))
+	{
+		return;
+	}
+
+	if (m_boundTarget == target)
+	{
+		BindFramebuffer(0);
+	}
+
+	GL_TARGET& glTarget = m_targets[target - 1];
+	glDeleteFramebuffers(1, &glTarget.framebuffer);
+	glDeleteTextures(1, &glTarget.colorTexture);
+	glDeleteTextures(1, &glTarget.depthTexture);
+	glTarget = GL_TARGET();
+}
+
+/***********************************************************
+ *  BindFramebuffer()
+ *
+ *  This method is used for drawing into the window or into
+ *  the layers of a target, without clearing it.
+ ***********************************************************/
+void GLRenderDevice::BindFramebuffer(uint32_t target)
+{
+	if ((target == 0) || (target > m_targets.size()) || (m_targets[target - 1].framebuffer == 0))
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		m_boundTarget = 0;
+		m_targetWidth = m_framebufferWidth;
+		m_targetHeight = m_framebufferHeight;
+		return;
+	}
+
+	const GL_TARGET& glTarget = m_targets[target - 1];
+	glBindFramebuffer(GL_FRAMEBUFFER, glTarget.framebuffer);
+	m_boundTarget = target;
+	m_targetWidth = glTarget.desc.width;
+	m_targetHeight = glTarget.desc.height;
+}
+
+/***********************************************************
+ *  BindTarget()
+ *
+ *  This method is used for drawing the views into the
+ *  layers of a target, clearing all of its layers.
+ ***********************************************************/
+void GLRenderDevice::BindTarget(uint32_t target)
+{
+	BindFramebuffer(target);
+	ApplyViewports();
+
+	if (m_boundTarget != 0)
+	{
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+}
+
+/***********************************************************
+ *  ShowTarget()
+ *
+ *  This method is used for copying each layer of a target
+ *  into its own column of the window, so the layers that
+ *  are handed on can also be seen.
+ ***********************************************************/
+void GLRenderDevice::ShowTarget(uint32_t target)
+{
+	if ((target == 0) || (target > m_targets.size()) || (m_targets[target - 1].framebuffer == 0))
+	{
+		return;
+	}
+
+	const GL_TARGET& glTarget = m_targets[target - 1];
+	if (m_readFramebuffer == 0)
+	{
+		glGenFramebuffers(1, &m_readFramebuffer);
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, m_readFramebuffer);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	for (uint32_t layer = 0; layer < glTarget.desc.layers; layer++)
+	{
+		GLint left = (GLint)((m_framebufferWidth * layer) / glTarget.desc.layers);
+		GLint right = (GLint)((m_framebufferWidth * (layer + 1)) / glTarget.desc.layers);
+
+		glFramebufferTextureLayer(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, glTarget.colorTexture, 0, layer);
+		glBlitFramebuffer(0, 0, glTarget.desc.width, glTarget.desc.height,
+			left, 0, right, m_framebufferHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	}
+
+	BindFramebuffer(0);
+	ApplyViewports();
+}
+
+/***********************************************************
+ *  FilterTargetMips()
+ *
+ *  This method is used for filtering the mip levels of a
+ *  cube map target down from its drawn faces, each level
+ *  averaging the one above it.
+ ***********************************************************/
+void GLRenderDevice::FilterTargetMips(uint32_t target)
+{
+	if ((target == 0) || (target > m_targets.size()) || (m_targets[target - 1].desc.bCubeMap == false))
+	{
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_CUBE_MAP, m_targets[target - 1].colorTexture);
+	glGenerateMipmap(GL_TEXTURE_CUBE_MAP);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+}
+
+/***********************************************************
+ *  ReadTarget()
+ *
+ *  This method is used for reading the first mip level of
+ *  the layers of a target back into memory.  The read waits
+ *  for the GPU to finish drawing the target, so it is only
+ *  done while loading.
+ ***********************************************************/
+bool GLRenderDevice::ReadTarget(uint32_t target, std::vector<float>& pixels)
+{
+	if ((target == 0) || (target > m_targets.size()))
+	{
+		return(false);
+	}
+
+	const GL_TARGET& glTarget = m_targets[target - 1];
+	size_t layerFloats = (size_t)glTarget.desc.width * glTarget.desc.height * 3;
+	pixels.resize(layerFloats * glTarget.desc.layers);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+	if (glTarget.desc.bCubeMap)
+	{
+		glBindTexture(GL_TEXTURE_CUBE_MAP, glTarget.colorTexture);
+		for (int face = 0; face < 6; face++)
+		{
+			glGetTexImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGB, GL_FLOAT, &pixels[face * layerFloats]);
+		}
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, glTarget.colorTexture);
+		glGetTexImage(GL_TEXTURE_2D_ARRAY, 0, GL_RGB, GL_FLOAT, pixels.data());
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateOverlayResources()
+ *
+ *  This method is used for compiling the overlay shaders
+ *  and creating the vertex array that the overlay vertices
+ *  are streamed through.
+ ***********************************************************/
+bool GLRenderDevice::CreateOverlayResources()
+{
+	m_pOverlayShader = new ShaderManager();
+	if (m_pOverlayShader->LoadShaders(g_OverlayVertexShader, g_OverlayFragmentShader) == 0)
+	{
+		LOG_ERROR("could not load the overlay shaders");
+		delete m_pOverlayShader;
+		m_pOverlayShader = NULL;
+		return(false);
+	}
+	glProgramUniform1i(m_pOverlayShader->m_programID, g_OverlayTextureLocation, g_OverlayTextureUnit);
+
+	glGenVertexArrays(1, &m_overlayVAO);
+	glBindVertexArray(m_overlayVAO);
+	glGenBuffers(1, &m_overlayVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_overlayVBO);
+
+	GLsizei stride = sizeof(OVERLAY_VERTEX);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(OVERLAY_VERTEX, x));
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(OVERLAY_VERTEX, u));
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(OVERLAY_VERTEX, color));
+	glEnableVertexAttribArray(2);
+
+	glBindVertexArray(0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for streaming the overlay vertices
+ *  into the overlay vertex buffer and drawing them over the
+ *  scene.  The scene pipeline is bound again afterwards.
+ ***********************************************************/
+void GLRenderDevice::DrawOverlay(
+	const OVERLAY_VERTEX* vertices,
+	uint32_t vertexCount,
+	uint32_t texture)
+{
+	if ((NULL == vertices) || (vertexCount == 0) || m_bOverlayFailed)
+	{
+		return;
+	}
+	if ((NULL == m_pOverlayShader) && (CreateOverlayResources() == false))
+	{
+		m_bOverlayFailed = true;
+		return;
+	}
+
+	// the overlay covers the whole window whatever the views
+	uint32_t boundTarget = m_boundTarget;
+	BindFramebuffer(0);
+	glViewport(0, 0, m_framebufferWidth, m_framebufferHeight);
+
+	m_pOverlayShader->use();
+	glUniform2f(g_OverlayScreenSizeLocation, (GLfloat)m_framebufferWidth, (GLfloat)m_framebufferHeight);
+	glActiveTexture(GL_TEXTURE0 + g_OverlayTextureUnit);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	// orphan the previous contents so the upload does not
+	// wait for the GPU to finish the previous overlay draw
+	glBindVertexArray(m_overlayVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, m_overlayVBO);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(OVERLAY_VERTEX), NULL, GL_STREAM_DRAW);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * sizeof(OVERLAY_VERTEX), vertices);
+
+	glDisable(GL_DEPTH_TEST);
+	glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+	glEnable(GL_DEPTH_TEST);
+
+	glBindVertexArray(0);
+	if ((m_boundPipeline > 0) && (m_boundPipeline <= m_pipelines.size()))
+	{
+		m_pipelines[m_boundPipeline - 1].pShaderManager->use();
+	}
+	BindFramebuffer(boundTarget);
+	ApplyViewports();
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the frame and z buffers
+ *  at the start of a frame.
+ ***********************************************************/
+void GLRenderDevice::BeginFrame()
+{
+	ResetStats();
+	m_pUniformRing->BeginFrame();
+
+	ReadTimerQueries();
+	if (m_timerQueries[0] != 0)
+	{
+		glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_timerWrite]);
+	}
+
+	// Enable z-depth
+	glEnable(GL_DEPTH_TEST);
+
+	// each frame starts drawing into the window
+	if (m_boundTarget != 0)
+	{
+		BindFramebuffer(0);
+		ApplyViewports();
+	}
+
+	// Clear the frame and z buffers
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the commands for a
+ *  frame.  The window buffers are swapped by the caller.
+ ***********************************************************/
+void GLRenderDevice::EndFrame()
+{
+	if (m_timerQueries[0] != 0)
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		m_timerWrite = (m_timerWrite + 1) % TIMER_QUERIES;
+		m_timerPending = std::min(m_timerPending + 1, TIMER_QUERIES);
+	}
+}
+
+/***********************************************************
+ *  ReadTimerQueries()
+ *
+ *  This method is used for reading the results of the frame
+ *  timer queries that the GPU has finished, oldest first.
+ *  When all of the queries are in use the oldest result is
+ *  waited for, so that its query can be used again.
+ ***********************************************************/
+void GLRenderDevice::ReadTimerQueries()
+{
+	while (m_timerPending > 0)
+	{
+		int oldest = (m_timerWrite - m_timerPending + TIMER_QUERIES) % TIMER_QUERIES;
+		GLuint available = GL_FALSE;
+
+		if (m_timerPending < TIMER_QUERIES)
+		{
+			glGetQueryObjectuiv(m_timerQueries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available == GL_FALSE)
+			{
+				return;
+			}
+		}
+
+		GLuint64 nanoseconds = 0;
+		glGetQueryObjectui64v(m_timerQueries[oldest], GL_QUERY_RESULT, &nanoseconds);
+		m_gpuMilliseconds = (double)nanoseconds / 1000000.0;
+		m_bGpuTimeValid = true;
+		m_timerPending--;
+	}
+}
+
+/***********************************************************
+ *  GetGpuFrameTime()
+ *
+ *  This method is used for getting the GPU time of the
+ *  latest frame that the timer queries have measured.
+ ***********************************************************/
+bool GLRenderDevice::GetGpuFrameTime(double& milliseconds)
+{
+	if (m_bGpuTimeValid == false)
+	{
+		return(false);
+	}
+
+	milliseconds = m_gpuMilliseconds;
+	return(true);
+}
+
+/***********************************************************
+ *  GetAdapterName()
+ *
+ *  This method is used for getting the renderer and the
+ *  version strings of the driver.
+ ***********************************************************/
+std::string GLRenderDevice::GetAdapterName() const
+{
+	const GLubyte* renderer = glGetString(GL_RENDERER);
+	const GLubyte* version = glGetString(GL_VERSION);
+	if ((NULL == renderer) || (NULL == version))
+	{
+		return(GetName());
+	}
+	return(std::string((const char*)renderer) + " " + (const char*)version);
+}
+
+/***********************************************************
+ *  GetError()
+ *
+ *  This method is used for getting the first OpenGL error
+ *  flag that is set, and clearing the other flags.  The
+ *  number of flags is limited, so that a lost context that
+ *  keeps reporting an error does not loop forever.
+ ***********************************************************/
+uint32_t GLRenderDevice::GetError()
+{
+	const int maxErrorFlags = 8;
+	GLenum error = glGetError();
+
+	for (int i = 0; (error != GL_NO_ERROR) && (i < maxErrorFlags) && (glGetError() != GL_NO_ERROR); i++)
+	{
+	}
+
+	return((uint32_t)error);
+}
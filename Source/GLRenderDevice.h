@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderdevice.h
+// ============
+// render device backend that issues the commands to OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "ShaderManager.h"
+#include "ShaderBindings.h"
+#include "GLUniformRing.h"
+#include "ShapeMeshes.h"
+
+#include <vector>
+
+/***********************************************************
+ *  GLRenderDevice
+ *
+ *  This class contains the OpenGL implementation of the
+ *  render device interface.
+ ***********************************************************/
+class GLRenderDevice : public RenderDevice
+{
+public:
+	// constructor
+	GLRenderDevice();
+	// destructor
+	virtual ~GLRenderDevice();
+
+	virtual const char* GetName() const { return "OpenGL"; }
+	virtual std::string GetAdapterName() const;
+	virtual bool Initialize();
+
+	virtual uint32_t CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void BindPipeline(uint32_t pipeline);
+	virtual void DestroyPipeline(uint32_t pipeline);
+
+	virtual uint32_t CreateTexture(
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels);
+	virtual void DestroyTexture(uint32_t texture);
+	virtual void BindTexture(int slot, uint32_t texture);
+	virtual void SetTextureSlot(int slot);
+	virtual uint32_t CreateStreamedTexture(int width, int height, int colorChannels, int mipLevels);
+	virtual void UploadTextureLevel(
+		uint32_t texture,
+		int level,
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels);
+	virtual uint32_t CreateCubeTexture(int faceSize, int mipLevels, const float* pixels);
+	virtual void BindEnvironment(uint32_t texture);
+
+	virtual void UpdateBlock(const CAMERA_BLOCK& block);
+	virtual void UpdateBlock(const LIGHT_BLOCK& block);
+	virtual void UpdateBlock(const MATERIAL_BLOCK& block);
+	virtual void UpdateBlock(const INSTANCE_BLOCK& block);
+
+	virtual void LoadMesh(MESH_TYPE mesh);
+	virtual void LoadMesh(MESH_TYPE mesh, const MESH_DATA& data);
+	virtual void DrawMesh(MESH_TYPE mesh);
+	virtual void SetViews(const VIEWPORT* viewports, uint32_t viewCount);
+
+	virtual uint32_t CreateTarget(const TARGET_DESC& desc);
+	virtual void DestroyTarget(uint32_t target);
+	virtual void BindTarget(uint32_t target);
+	virtual void ShowTarget(uint32_t target);
+	virtual void FilterTargetMips(uint32_t target);
+	virtual bool ReadTarget(uint32_t target, std::vector<float>& pixels);
+
+	virtual void DrawOverlay(
+		const OVERLAY_VERTEX* vertices,
+		uint32_t vertexCount,
+		uint32_t texture);
+
+	virtual void BeginFrame();
+	virtual void EndFrame();
+
+	virtual bool GetGpuFrameTime(double& milliseconds);
+	virtual uint32_t GetError();
+
+private:
+	// shader program and uniform bindings for a pipeline
+	struct GL_PIPELINE
+	{
+		ShaderManager* pShaderManager;
+		ShaderBindings* pShaderBindings;
+	};
+
+	// vertex buffers of a mesh loaded from generated data
+	struct GL_MESH
+	{
+		GLuint vao;
+		GLuint vbo;
+		GLuint ebo;
+		GLsizei indexCount;
+	};
+
+	// layered framebuffer that the views are drawn into
+	struct GL_TARGET
+	{
+		GLuint framebuffer;
+		GLuint colorTexture;
+		GLuint depthTexture;
+		TARGET_DESC desc;
+	};
+
+	// timer queries kept in flight, so that the result of a
+	// frame is read once the GPU has finished it
+	static const int TIMER_QUERIES = 4;
+
+	// created pipelines, the handle is the index plus one
+	std::vector<GL_PIPELINE> m_pipelines;
+	// bound pipeline and its uniform bindings
+	uint32_t m_boundPipeline;
+	ShaderBindings* m_pShaderBindings;
+	// ring that the uniform block data of the draws is
+	// streamed through
+	GLUniformRing* m_pUniformRing;
+	// pointer to basic shapes object
+	ShapeMeshes* m_basicMeshes;
+	// triangles in each of the loaded meshes
+	uint32_t m_meshTriangles[MESH_COUNT];
+	// shape meshes that have created their buffers, and the
+	// meshes loaded from generated data, which are drawn in
+	// place of the shape meshes
+	bool m_bShapeMeshLoaded[MESH_COUNT];
+	GL_MESH m_generatedMeshes[MESH_COUNT];
+
+	// size of the default framebuffer that the viewports of
+	// the views are fractions of
+	GLint m_framebufferWidth;
+	GLint m_framebufferHeight;
+	// the vertex shader selects the viewport and the layer of
+	// each view, so the views of a draw are one instanced draw
+	bool m_bViewportIndex;
+
+	// created layered targets, the handle is the index plus
+	// one, and the bound target with the size of its layers
+	std::vector<GL_TARGET> m_targets;
+	uint32_t m_boundTarget;
+	GLint m_targetWidth;
+	GLint m_targetHeight;
+	// framebuffer that the target layers are copied from
+	GLuint m_readFramebuffer;
+
+	// overlay shader program and streamed vertex buffer
+	ShaderManager* m_pOverlayShader;
+	GLuint m_overlayVAO;
+	GLuint m_overlayVBO;
+	bool m_bOverlayFailed;
+
+	// ring of GPU frame timer queries
+	GLuint m_timerQueries[TIMER_QUERIES];
+	int m_timerWrite;
+	int m_timerPending;
+	double m_gpuMilliseconds;
+	bool m_bGpuTimeValid;
+
+	// load the offline compiled SPIR-V shader binaries
+	bool LoadSpirvShaders(ShaderManager* pShaderManager, const PIPELINE_DESC& desc);
+	// compile the GLSL shader files with the constants defined
+	bool LoadGlslShaders(ShaderManager* pShaderManager, const PIPELINE_DESC& desc);
+	// create the overlay shader program and vertex buffer
+	bool CreateOverlayResources();
+	// read the timer queries that the GPU has finished
+	void ReadTimerQueries();
+	// free the buffers of a mesh loaded from generated data
+	void FreeGeneratedMesh(MESH_TYPE mesh);
+	// set the viewport of one view, or of all the views
+	void ApplyViewport(GLuint index, const VIEWPORT& viewport);
+	void ApplyViewports();
+	// draw into the window, or into the layers of a target
+	void BindFramebuffer(uint32_t target);
+};
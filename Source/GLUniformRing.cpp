@@ -0,0 +1,268 @@
+///////////////////////////////////////////////////////////////////////////////
+// gluniformring.cpp
+// ============
+// stream the uniform block data of each draw through a ring of frame regions
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLUniformRing.h"
+#include "Logger.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// size of the region of each frame when the ring is
+	// created, which holds a few thousand draws
+	const GLsizeiptr INITIAL_REGION_SIZE = 1024 * 1024;
+	// time that a fence is waited for before waiting again
+	const GLuint64 FENCE_TIMEOUT = 1000000000;
+}
+
+/***********************************************************
+ *  GLUniformRing()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLUniformRing::GLUniformRing()
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_regionSize = 0;
+	m_alignment = 256;
+	m_region = 0;
+	m_offset = 0;
+	for (int i = 0; i < RING_FRAMES; i++)
+	{
+		m_fences[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  ~GLUniformRing()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLUniformRing::~GLUniformRing()
+{
+	DestroyBuffer();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for reading the uniform buffer offset
+ *  alignment of the driver and creating the buffer.
+ ***********************************************************/
+bool GLUniformRing::Initialize()
+{
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_alignment);
+	if (m_alignment <= 0)
+	{
+		m_alignment = 256;
+	}
+
+	CreateBuffer(INITIAL_REGION_SIZE);
+
+	return(m_buffer != 0);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating the buffer with a region
+ *  of the passed in size for each frame in flight, mapped
+ *  persistently when buffer storage is supported.
+ ***********************************************************/
+void GLUniformRing::CreateBuffer(GLsizeiptr regionSize)
+{
+	m_regionSize = ((regionSize + m_alignment - 1) / m_alignment) * m_alignment;
+	m_region = 0;
+	m_offset = 0;
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+
+	if ((GLEW_VERSION_4_4 != GL_FALSE) || (GLEW_ARB_buffer_storage != GL_FALSE))
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		glBufferStorage(GL_UNIFORM_BUFFER, m_regionSize * RING_FRAMES, NULL, flags);
+		m_pMapped = (uint8_t*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, m_regionSize * RING_FRAMES, flags);
+	}
+
+	// without a persistent mapping the one region is orphaned
+	// at the start of each frame
+	if (NULL == m_pMapped)
+	{
+		glBufferData(GL_UNIFORM_BUFFER, m_regionSize, NULL, GL_STREAM_DRAW);
+	}
+
+	LOG_INFO("uniform ring created", "regionBytes", (int64_t)m_regionSize, "alignment", m_alignment,
+		"persistent", (NULL != m_pMapped));
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for freeing the buffer and the
+ *  fences of its regions.
+ ***********************************************************/
+void GLUniformRing::DestroyBuffer()
+{
+	for (int i = 0; i < RING_FRAMES; i++)
+	{
+		if (m_fences[i] != 0)
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = 0;
+		}
+	}
+
+	if (m_buffer != 0)
+	{
+		if (NULL != m_pMapped)
+		{
+			glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+			glUnmapBuffer(GL_UNIFORM_BUFFER);
+			m_pMapped = NULL;
+		}
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+}
+
+/***********************************************************
+ *  GrowBuffer()
+ *
+ *  This method is used for making the ring larger when the
+ *  region of the current frame is full.  The GPU is waited
+ *  for once, the buffer is created again with regions of
+ *  twice the size, and the latest data of every block is
+ *  written into the new buffer.
+ ***********************************************************/
+void GLUniformRing::GrowBuffer()
+{
+	LOG_WARNING("the uniform ring is full and is made larger", "regionBytes", (int64_t)m_regionSize);
+
+	glFinish();
+	GLsizeiptr regionSize = m_regionSize * 2;
+	DestroyBuffer();
+	CreateBuffer(regionSize);
+
+	for (int i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		if (false == m_blockData[i].empty())
+		{
+			WriteBlock(i);
+		}
+	}
+}
+
+/***********************************************************
+ *  WriteBlock()
+ *
+ *  This method is used for writing the latest data of a
+ *  block into a free range and binding the range.  When
+ *  the region is full the buffer is grown, which writes
+ *  the block along with the others.
+ ***********************************************************/
+void GLUniformRing::WriteBlock(int binding)
+{
+	GLsizeiptr size = (GLsizeiptr)m_blockData[binding].size();
+	GLsizeiptr alignedSize = ((size + m_alignment - 1) / m_alignment) * m_alignment;
+
+	if (m_offset + alignedSize > m_regionSize)
+	{
+		GrowBuffer();
+		return;
+	}
+
+	GLsizeiptr offset = (m_region * m_regionSize) + m_offset;
+	m_offset += alignedSize;
+
+	if (NULL != m_pMapped)
+	{
+		memcpy(m_pMapped + offset, m_blockData[binding].data(), size);
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferSubData(GL_UNIFORM_BUFFER, offset, size, m_blockData[binding].data());
+	}
+	glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_buffer, offset, size);
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for keeping the passed in block data
+ *  and writing it into the ring.  The range that is bound
+ *  for a block always holds its latest data in the region
+ *  of the current frame, so the data is only written when
+ *  it has changed.
+ ***********************************************************/
+void GLUniformRing::Upload(UNIFORM_BLOCK_BINDING binding, const void* data, GLsizeiptr size)
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	std::vector<uint8_t>& blockData = m_blockData[binding];
+	if ((blockData.size() == (size_t)size) && (memcmp(blockData.data(), data, size) == 0))
+	{
+		return;
+	}
+
+	const uint8_t* bytes = (const uint8_t*)data;
+	blockData.assign(bytes, bytes + size);
+	WriteBlock(binding);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for fencing the commands that read
+ *  the region of the frame that ended, and moving on to the
+ *  next region once the GPU has finished the frame that
+ *  last used it.  The latest data of every block is written
+ *  into the new region, so the bound ranges never point
+ *  into a region that is about to be written again.
+ ***********************************************************/
+void GLUniformRing::BeginFrame()
+{
+	if (m_buffer == 0)
+	{
+		return;
+	}
+
+	if (NULL != m_pMapped)
+	{
+		m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_region = (m_region + 1) % RING_FRAMES;
+
+		if (m_fences[m_region] != 0)
+		{
+			while (glClientWaitSync(m_fences[m_region], GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+			{
+			}
+			glDeleteSync(m_fences[m_region]);
+			m_fences[m_region] = 0;
+		}
+	}
+	else
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+		glBufferData(GL_UNIFORM_BUFFER, m_regionSize, NULL, GL_STREAM_DRAW);
+	}
+	m_offset = 0;
+
+	for (int i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		if (false == m_blockData[i].empty())
+		{
+			WriteBlock(i);
+		}
+	}
+}
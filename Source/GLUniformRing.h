@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+// gluniformring.h
+// ============
+// stream the uniform block data of each draw through a ring of frame regions
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "UniformBlocks.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  GLUniformRing
+ *
+ *  This class contains the code for streaming the uniform
+ *  blocks into one uniform buffer.  The buffer is split
+ *  into a region for each frame in flight, and every block
+ *  update is written to the next free range of the region
+ *  of the current frame, aligned to the uniform buffer
+ *  offset alignment, and bound to its binding point with
+ *  glBindBufferRange.  No range is written while a draw
+ *  that reads it can still be in flight, so the updates
+ *  never make the driver wait for the GPU or rename the
+ *  buffer.  The buffer is mapped persistently when buffer
+ *  storage is supported, and otherwise it is orphaned at
+ *  the start of each frame and written with
+ *  glBufferSubData.  The latest data of each block is kept,
+ *  so that the blocks that are not updated in a frame are
+ *  written again into its region, and an update with the
+ *  same data as the bound range is skipped.
+ ***********************************************************/
+class GLUniformRing
+{
+public:
+	// constructor
+	GLUniformRing();
+	// destructor
+	~GLUniformRing();
+
+	// create the buffer in the current context
+	bool Initialize();
+	// copy block data into the ring and bind its range to the
+	// binding point of the block
+	void Upload(UNIFORM_BLOCK_BINDING binding, const void* data, GLsizeiptr size);
+	// move on to the region of the next frame, waiting for the
+	// GPU to finish the frame that last used it
+	void BeginFrame();
+
+private:
+	// frames that can be in flight, each with its own region
+	static const int RING_FRAMES = 3;
+
+	// uniform buffer and its persistent mapping, which is NULL
+	// when the buffer is orphaned instead
+	GLuint m_buffer;
+	uint8_t* m_pMapped;
+	// size of the region of each frame, the alignment of the
+	// ranges, the region of the current frame and the offset
+	// of its next free range
+	GLsizeiptr m_regionSize;
+	GLint m_alignment;
+	int m_region;
+	GLsizeiptr m_offset;
+	// fences of the frames that last used each region
+	GLsync m_fences[RING_FRAMES];
+	// latest data of each of the uniform blocks
+	std::vector<uint8_t> m_blockData[UNIFORM_BLOCK_COUNT];
+
+	// create and free the buffer with regions of the passed
+	// in size
+	void CreateBuffer(GLsizeiptr regionSize);
+	void DestroyBuffer();
+	// create the buffer again with regions of twice the size,
+	// and write the latest data of every block into it
+	void GrowBuffer();
+	// write the latest data of a block into a free range in
+	// the region of the current frame, growing the buffer
+	// when the region is full
+	void WriteBlock(int binding);
+};
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// glslshaderloader.cpp
+// ============
+// compile the GLSL shader sources with the specialization constants defined
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlslShaderLoader.h"
+#include "Logger.h"
+
+#include <fstream>
+#include <sstream>
+
+/***********************************************************
+ *  GlslShaderLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GlslShaderLoader::GlslShaderLoader()
+{
+}
+
+/***********************************************************
+ *  ~GlslShaderLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GlslShaderLoader::~GlslShaderLoader()
+{
+}
+
+/***********************************************************
+ *  ReadTextFile()
+ *
+ *  This method is used for reading the contents of the
+ *  passed in text file into memory.
+ ***********************************************************/
+bool GlslShaderLoader::ReadTextFile(const char* filename, std::string& text)
+{
+	std::ifstream file(filename);
+	if (!file.is_open())
+	{
+		LOG_ERROR("could not open the shader source", "file", filename);
+		return(false);
+	}
+
+	std::stringstream contents;
+	contents << file.rdbuf();
+	text = contents.str();
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateShader()
+ *
+ *  This method is used for compiling a shader object from
+ *  the passed in GLSL source.  The defines are added after
+ *  the #version line, which has to come first, and a #line
+ *  directive keeps the line numbers of the compile errors
+ *  the same as in the file.
+ ***********************************************************/
+GLuint GlslShaderLoader::CreateShader(
+	GLenum shaderType,
+	const char* filename,
+	const std::string& defines)
+{
+	std::string source;
+
+	if (ReadTextFile(filename, source) == false)
+	{
+		return(0);
+	}
+
+	size_t versionEnd = 0;
+	if (source.compare(0, 8, "#version") == 0)
+	{
+		versionEnd = source.find('\n');
+		versionEnd = (versionEnd == std::string::npos) ? source.size() : versionEnd + 1;
+	}
+
+	std::string header = source.substr(0, versionEnd);
+	std::string body = defines + "#line 2\n" + source.substr(versionEnd);
+	const GLchar* strings[2] = { header.c_str(), body.c_str() };
+
+	GLuint shaderID = glCreateShader(shaderType);
+	glShaderSource(shaderID, 2, strings, NULL);
+	glCompileShader(shaderID);
+
+	GLint bSuccess = GL_FALSE;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &bSuccess);
+	if (bSuccess == GL_FALSE)
+	{
+		char infoLog[512];
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		LOG_ERROR("failed to compile the GLSL shader", "file", filename, "log", (const char*)infoLog);
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  LoadShaders()
+ *
+ *  This method is used for compiling the GLSL vertex and
+ *  fragment shader files with the values of the constants
+ *  defined, and linking them into a shader program.  Zero
+ *  is returned if the program could not be created.
+ ***********************************************************/
+GLuint GlslShaderLoader::LoadShaders(
+	const char* vertexShaderPath,
+	const char* fragmentShaderPath,
+	const SpirvShaderLoader::SPECIALIZATION_CONSTANTS& constants)
+{
+	// the shaders use these in place of the constants that
+	// are specialized in the SPIR-V binaries
+	std::stringstream defines;
+	defines << "#define ACTIVE_LIGHTS_VALUE " << constants.activeLights << "\n";
+	defines << "#define ENABLE_LIGHTING_VALUE " << (constants.bEnableLighting ? "true" : "false") << "\n";
+	defines << "#define ENABLE_SPECULAR_VALUE " << (constants.bEnableSpecular ? "true" : "false") << "\n";
+
+	GLuint vertexShaderID = CreateShader(
+		GL_VERTEX_SHADER, vertexShaderPath, defines.str());
+	if (vertexShaderID == 0)
+	{
+		return(0);
+	}
+
+	GLuint fragmentShaderID = CreateShader(
+		GL_FRAGMENT_SHADER, fragmentShaderPath, defines.str());
+	if (fragmentShaderID == 0)
+	{
+		glDeleteShader(vertexShaderID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, vertexShaderID);
+	glAttachShader(programID, fragmentShaderID);
+	glLinkProgram(programID);
+
+	// the shader objects are no longer needed once linked
+	glDetachShader(programID, vertexShaderID);
+	glDetachShader(programID, fragmentShaderID);
+	glDeleteShader(vertexShaderID);
+	glDeleteShader(fragmentShaderID);
+
+	GLint bSuccess = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &bSuccess);
+	if (bSuccess == GL_FALSE)
+	{
+		char infoLog[512];
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		LOG_ERROR("failed to link the GLSL shader program", "log", (const char*)infoLog);
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	LOG_INFO("compiled GLSL shaders", "vertex", vertexShaderPath, "fragment", fragmentShaderPath,
+		"activeLights", constants.activeLights);
+
+	return(programID);
+}
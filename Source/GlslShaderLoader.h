@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+// glslshaderloader.h
+// ============
+// compile the GLSL shader sources with the specialization constants defined
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SpirvShaderLoader.h"
+
+#include <string>
+
+/***********************************************************
+ *  GlslShaderLoader
+ *
+ *  This class contains the code for compiling the GLSL
+ *  shader files at runtime, when the SPIR-V binaries can
+ *  not be used.  The values of the specialization constants
+ *  are defined as macros after the #version line of each
+ *  source, so that the runtime compiled shaders follow the
+ *  quality preset in the same way as the SPIR-V shaders.
+ ***********************************************************/
+class GlslShaderLoader
+{
+public:
+	// constructor
+	GlslShaderLoader();
+	// destructor
+	~GlslShaderLoader();
+
+	// compile the GLSL shader sources with the constants
+	// defined and link them
+	GLuint LoadShaders(
+		const char* vertexShaderPath,
+		const char* fragmentShaderPath,
+		const SpirvShaderLoader::SPECIALIZATION_CONSTANTS& constants);
+
+private:
+	// read the contents of a text file into memory
+	bool ReadTextFile(const char* filename, std::string& text);
+
+	// create a shader object from a GLSL source with the
+	// passed in lines added after its #version line
+	GLuint CreateShader(
+		GLenum shaderType,
+		const char* filename,
+		const std::string& defines);
+};
@@ -0,0 +1,358 @@
+///////////////////////////////////////////////////////////////////////////////
+// hitchdetector.cpp
+// ============
+// detect frame time spikes and write the recent frames to a trace file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "HitchDetector.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// declaration of global variables
+namespace
+{
+	// default multiple of the median frame time that is a hitch
+	const double DEFAULT_THRESHOLD = 3.0;
+	// a hitch must also be this much slower than the median, so
+	// that the noise of very short frames is not reported
+	const double MIN_HITCH_MILLISECONDS = 2.0;
+	// frames between the refreshes of the median
+	const int MEDIAN_INTERVAL = 16;
+	// seconds of frames written for a hitch
+	const double TRACE_WINDOW_SECONDS = 5.0;
+	// seconds after a hitch before another one is written, and
+	// the most trace files written in one run
+	const double HITCH_COOLDOWN_SECONDS = 2.0;
+	const int MAX_HITCH_TRACES = 16;
+
+	// trace event thread ids of the CPU zones and the GPU time
+	const int CPU_TRACK = 1;
+	const int GPU_TRACK = 2;
+}
+
+/***********************************************************
+ *  HitchDetector()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+HitchDetector::HitchDetector()
+{
+	m_threshold = DEFAULT_THRESHOLD;
+	m_outputDirectory = ".";
+	m_sceneCopies = 1;
+	m_cameraPosition = glm::vec3(0.0f);
+	m_cameraFront = glm::vec3(0.0f, 0.0f, -1.0f);
+
+	// the rings are filled in before they are read, so they
+	// are not cleared
+	m_zones = new ZONE_RECORD[ZONE_RING_SIZE];
+	m_zoneNext = 0;
+	m_frames = new FRAME_RECORD[FRAME_RING_SIZE];
+	m_frameNext = 0;
+	m_openZoneCount = 0;
+	m_frameIndex = 0;
+	m_bFrameStarted = false;
+
+	for (int i = 0; i < MEDIAN_SAMPLES; i++)
+	{
+		m_medianSamples[i] = 0.0f;
+	}
+	m_medianSampleCount = 0;
+	m_medianNext = 0;
+	m_framesSinceMedian = 0;
+	m_medianMilliseconds = 0.0;
+
+	m_hitchesWritten = 0;
+	m_lastHitch = Clock::time_point();
+}
+
+/***********************************************************
+ *  ~HitchDetector()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+HitchDetector::~HitchDetector()
+{
+	delete[] m_zones;
+	m_zones = NULL;
+	delete[] m_frames;
+	m_frames = NULL;
+}
+
+/***********************************************************
+ *  SetCameraPose()
+ *
+ *  This method is used for setting the camera pose that is
+ *  written with a hitch in the current frame.
+ ***********************************************************/
+void HitchDetector::SetCameraPose(const glm::vec3& position, const glm::vec3& front)
+{
+	m_cameraPosition = position;
+	m_cameraFront = front;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for marking the start of a frame.
+ ***********************************************************/
+void HitchDetector::BeginFrame()
+{
+	m_frameStart = Clock::now();
+	m_bFrameStarted = true;
+	m_openZoneCount = 0;
+}
+
+/***********************************************************
+ *  BeginZone()
+ *
+ *  This method is used for starting a timed zone of the
+ *  frame, nested in the zone that is running.  The zone is
+ *  written over the oldest zone in the ring.
+ ***********************************************************/
+void HitchDetector::BeginZone(const char* name)
+{
+	if ((m_threshold <= 0.0) || (m_bFrameStarted == false))
+	{
+		return;
+	}
+
+	if (m_openZoneCount < MAX_ZONE_DEPTH)
+	{
+		ZONE_RECORD& zone = m_zones[m_zoneNext % ZONE_RING_SIZE];
+		zone.name = name;
+		zone.frame = m_frameIndex;
+		zone.start = Clock::now();
+		zone.end = Clock::time_point();
+		m_openZones[m_openZoneCount] = m_zoneNext;
+		m_zoneNext++;
+	}
+	m_openZoneCount++;
+}
+
+/***********************************************************
+ *  EndZone()
+ *
+ *  This method is used for ending the most recently started
+ *  zone.
+ ***********************************************************/
+void HitchDetector::EndZone()
+{
+	if ((m_threshold <= 0.0) || (m_openZoneCount == 0))
+	{
+		return;
+	}
+
+	m_openZoneCount--;
+	if (m_openZoneCount < MAX_ZONE_DEPTH)
+	{
+		uint64_t index = m_openZones[m_openZoneCount];
+		if (m_zoneNext - index <= (uint64_t)ZONE_RING_SIZE)
+		{
+			m_zones[index % ZONE_RING_SIZE].end = Clock::now();
+		}
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for recording the end of the frame
+ *  and checking whether it was a hitch.  The running median
+ *  is only used once enough frames have run, so the slow
+ *  frames of the startup are not reported.
+ ***********************************************************/
+bool HitchDetector::EndFrame(const RenderDevice::RENDER_STATS& stats, bool bGpuTime, double gpuMilliseconds)
+{
+	if ((m_threshold <= 0.0) || (m_bFrameStarted == false))
+	{
+		return(false);
+	}
+	m_bFrameStarted = false;
+
+	FRAME_RECORD& frame = m_frames[m_frameNext % FRAME_RING_SIZE];
+	frame.frame = m_frameIndex;
+	frame.start = m_frameStart;
+	frame.end = Clock::now();
+	frame.bGpuTime = bGpuTime;
+	frame.gpuMilliseconds = gpuMilliseconds;
+	frame.stats = stats;
+	m_frameNext++;
+	m_frameIndex++;
+
+	double frameMilliseconds = std::chrono::duration<double, std::milli>(frame.end - frame.start).count();
+	bool bHitch =
+		(m_medianSampleCount == MEDIAN_SAMPLES) &&
+		(frameMilliseconds > m_medianMilliseconds * m_threshold) &&
+		(frameMilliseconds - m_medianMilliseconds >= MIN_HITCH_MILLISECONDS) &&
+		(m_hitchesWritten < MAX_HITCH_TRACES) &&
+		((m_hitchesWritten == 0) ||
+			(std::chrono::duration<double>(frame.end - m_lastHitch).count() >= HITCH_COOLDOWN_SECONDS));
+
+	m_medianSamples[m_medianNext] = (float)frameMilliseconds;
+	m_medianNext = (m_medianNext + 1) % MEDIAN_SAMPLES;
+	m_medianSampleCount = std::min(m_medianSampleCount + 1, MEDIAN_SAMPLES);
+	m_framesSinceMedian++;
+	if ((m_framesSinceMedian >= MEDIAN_INTERVAL) || (m_medianSampleCount < MEDIAN_SAMPLES))
+	{
+		UpdateMedian();
+	}
+
+	if (bHitch == false)
+	{
+		return(false);
+	}
+
+	m_hitchesWritten++;
+	m_lastHitch = frame.end;
+	WriteTrace(frame, frameMilliseconds);
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateMedian()
+ *
+ *  This method is used for refreshing the median of the
+ *  recent frame times.
+ ***********************************************************/
+void HitchDetector::UpdateMedian()
+{
+	float sorted[MEDIAN_SAMPLES];
+	std::copy(m_medianSamples, m_medianSamples + m_medianSampleCount, sorted);
+
+	float* middle = sorted + (m_medianSampleCount / 2);
+	std::nth_element(sorted, middle, sorted + m_medianSampleCount);
+	m_medianMilliseconds = *middle;
+	m_framesSinceMedian = 0;
+}
+
+/***********************************************************
+ *  WriteTrace()
+ *
+ *  This method is used for formatting the frames and zones
+ *  of the last few seconds as a trace that can be opened in
+ *  chrome://tracing or Perfetto.  The GPU time of each
+ *  frame is that of the most recent frame that the GPU had
+ *  finished, so it is drawn on its own track at the start
+ *  of the frame it was read in.  The file is written by the
+ *  logger thread, so the frame after the hitch does not
+ *  also wait for the disk.
+ ***********************************************************/
+void HitchDetector::WriteTrace(const FRAME_RECORD& hitchFrame, double frameMilliseconds)
+{
+	char filename[64];
+	snprintf(filename, sizeof(filename), "hitch_%u.json", hitchFrame.frame);
+	std::string path = m_outputDirectory + "/" + filename;
+
+	Clock::time_point windowStart = hitchFrame.end -
+		std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(TRACE_WINDOW_SECONDS));
+	uint64_t firstFrame = (m_frameNext > (uint64_t)FRAME_RING_SIZE) ? (m_frameNext - FRAME_RING_SIZE) : 0;
+	uint64_t firstZone = (m_zoneNext > (uint64_t)ZONE_RING_SIZE) ? (m_zoneNext - ZONE_RING_SIZE) : 0;
+
+	// the times are written in microseconds from the first
+	// frame in the window
+	Clock::time_point origin = hitchFrame.start;
+	for (uint64_t i = firstFrame; i < m_frameNext; i++)
+	{
+		const FRAME_RECORD& frame = m_frames[i % FRAME_RING_SIZE];
+		if (frame.start >= windowStart)
+		{
+			origin = frame.start;
+			break;
+		}
+	}
+
+	// the zones take the most room, about a line of text each
+	std::string text;
+	text.reserve((size_t)((m_zoneNext - firstZone) + (m_frameNext - firstFrame)) * 160);
+
+	char line[256];
+	text += "{\n";
+	text += "  \"traceEvents\": [\n";
+	snprintf(line, sizeof(line),
+		"    { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": { \"name\": \"CPU\" } },\n"
+		"    { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": { \"name\": \"GPU\" } }",
+		CPU_TRACK, GPU_TRACK);
+	text += line;
+
+	for (uint64_t i = firstFrame; i < m_frameNext; i++)
+	{
+		const FRAME_RECORD& frame = m_frames[i % FRAME_RING_SIZE];
+		if (frame.start < origin)
+		{
+			continue;
+		}
+
+		double start = std::chrono::duration<double, std::micro>(frame.start - origin).count();
+		double duration = std::chrono::duration<double, std::micro>(frame.end - frame.start).count();
+		snprintf(line, sizeof(line),
+			",\n    { \"name\": \"Frame %u\", \"cat\": \"frame\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d,"
+			" \"args\": { \"drawCalls\": %u, \"triangles\": %u } }",
+			frame.frame, start, duration, CPU_TRACK, frame.stats.drawCalls, frame.stats.triangles);
+		text += line;
+
+		if (frame.bGpuTime)
+		{
+			snprintf(line, sizeof(line),
+				",\n    { \"name\": \"GPU frame\", \"cat\": \"gpu\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d }",
+				start, frame.gpuMilliseconds * 1000.0, GPU_TRACK);
+			text += line;
+		}
+	}
+
+	// the zone names are string literals from the main loop,
+	// so they are written without escaping
+	for (uint64_t i = firstZone; i < m_zoneNext; i++)
+	{
+		const ZONE_RECORD& zone = m_zones[i % ZONE_RING_SIZE];
+		if ((zone.start < origin) || (zone.end < zone.start))
+		{
+			continue;
+		}
+
+		snprintf(line, sizeof(line),
+			",\n    { \"name\": \"%s\", \"cat\": \"zone\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %d }",
+			zone.name,
+			std::chrono::duration<double, std::micro>(zone.start - origin).count(),
+			std::chrono::duration<double, std::micro>(zone.end - zone.start).count(),
+			CPU_TRACK);
+		text += line;
+	}
+	text += "\n  ],\n";
+
+	const RenderDevice::RENDER_STATS& stats = hitchFrame.stats;
+	text += "  \"otherData\": {\n";
+	snprintf(line, sizeof(line),
+		"    \"frame\": %u,\n    \"frameMs\": %.3f,\n    \"medianMs\": %.3f,\n    \"threshold\": %.2f,\n",
+		hitchFrame.frame, frameMilliseconds, m_medianMilliseconds, m_threshold);
+	text += line;
+	if (hitchFrame.bGpuTime)
+	{
+		snprintf(line, sizeof(line), "    \"gpuMs\": %.3f,\n", hitchFrame.gpuMilliseconds);
+		text += line;
+	}
+	else
+	{
+		text += "    \"gpuMs\": null,\n";
+	}
+	snprintf(line, sizeof(line),
+		"    \"cameraPosition\": [ %.3f, %.3f, %.3f ],\n    \"cameraFront\": [ %.3f, %.3f, %.3f ],\n",
+		m_cameraPosition.x, m_cameraPosition.y, m_cameraPosition.z,
+		m_cameraFront.x, m_cameraFront.y, m_cameraFront.z);
+	text += line;
+	snprintf(line, sizeof(line),
+		"    \"sceneCopies\": %d,\n    \"drawCalls\": %u,\n    \"triangles\": %u,\n    \"blockUploads\": %u,\n"
+		"    \"uploadBytes\": %u,\n    \"textureBinds\": %u,\n    \"pipelineBinds\": %u\n",
+		m_sceneCopies, stats.drawCalls, stats.triangles, stats.blockUploads,
+		stats.uploadBytes, stats.textureBinds, stats.pipelineBinds);
+	text += line;
+	text += "  }\n";
+	text += "}\n";
+
+	Logger::WriteFile(path, text);
+
+	LOG_WARNING("hitch trace queued for writing", "frame", hitchFrame.frame, "frameMs", frameMilliseconds,
+		"medianMs", m_medianMilliseconds, "file", path);
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// hitchdetector.h
+// ============
+// detect frame time spikes and write the recent frames to a trace file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  HitchDetector
+ *
+ *  This class contains the code for keeping a rolling trace
+ *  of the timed zones of the last frames in fixed rings of
+ *  records, and for comparing each frame time against the
+ *  running median of the recent frames.  When a frame takes
+ *  longer than the set multiple of the median, the frames
+ *  of the last few seconds are written to a trace file in
+ *  the Chrome trace event format, along with the camera
+ *  pose and the render counters of the slow frame.  The
+ *  zones only store a name pointer and two time stamps, so
+ *  the detector can stay on in every run.
+ ***********************************************************/
+class HitchDetector
+{
+public:
+	// constructor
+	HitchDetector();
+	// destructor
+	~HitchDetector();
+
+	// set the multiple of the median frame time that counts as
+	// a hitch, zero turns the detector off
+	void SetThreshold(double medianMultiple) { m_threshold = medianMultiple; }
+	// set the directory that the trace files are written to
+	void SetOutputDirectory(const char* directory) { m_outputDirectory = directory; }
+	// set the number of scene copies reported with a hitch
+	void SetSceneCopies(int copies) { m_sceneCopies = copies; }
+	// set the camera pose of the current frame
+	void SetCameraPose(const glm::vec3& position, const glm::vec3& front);
+
+	// mark the start of a frame
+	void BeginFrame();
+	// time a zone of the frame, the name must be a string
+	// literal since only its pointer is kept
+	void BeginZone(const char* name);
+	void EndZone();
+	// mark the end of the frame, with the GPU time of the most
+	// recent frame the GPU finished if it is measured - true is
+	// returned when the frame was a hitch and its trace was
+	// handed to the logger thread to write
+	bool EndFrame(const RenderDevice::RENDER_STATS& stats, bool bGpuTime, double gpuMilliseconds);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// records kept in the rings, enough for a few seconds of
+	// frames at a high frame rate
+	static const int ZONE_RING_SIZE = 16384;
+	static const int FRAME_RING_SIZE = 2048;
+	// frames that the running median is taken over
+	static const int MEDIAN_SAMPLES = 121;
+	// deepest zone nesting that is recorded
+	static const int MAX_ZONE_DEPTH = 16;
+
+	// one timed zone
+	struct ZONE_RECORD
+	{
+		const char* name;
+		uint32_t frame;
+		Clock::time_point start;
+		Clock::time_point end;
+	};
+
+	// one frame
+	struct FRAME_RECORD
+	{
+		uint32_t frame;
+		Clock::time_point start;
+		Clock::time_point end;
+		bool bGpuTime;
+		double gpuMilliseconds;
+		RenderDevice::RENDER_STATS stats;
+	};
+
+	double m_threshold;
+	std::string m_outputDirectory;
+	int m_sceneCopies;
+	glm::vec3 m_cameraPosition;
+	glm::vec3 m_cameraFront;
+
+	// rings of the recent zones and frames, the next index is
+	// the total number written so far
+	ZONE_RECORD* m_zones;
+	uint64_t m_zoneNext;
+	FRAME_RECORD* m_frames;
+	uint64_t m_frameNext;
+	// ring indices of the zones that have not ended
+	uint64_t m_openZones[MAX_ZONE_DEPTH];
+	int m_openZoneCount;
+	uint32_t m_frameIndex;
+	Clock::time_point m_frameStart;
+	bool m_bFrameStarted;
+
+	// recent frame times and their median, which is refreshed
+	// every few frames rather than every frame
+	float m_medianSamples[MEDIAN_SAMPLES];
+	int m_medianSampleCount;
+	int m_medianNext;
+	int m_framesSinceMedian;
+	double m_medianMilliseconds;
+
+	// written trace files, and the time of the last one
+	int m_hitchesWritten;
+	Clock::time_point m_lastHitch;
+
+	// refresh the median of the recent frame times
+	void UpdateMedian();
+	// write the frames of the last few seconds to a trace file
+	void WriteTrace(const FRAME_RECORD& hitchFrame, double frameMilliseconds);
+};
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////////////
+// jsonutils.cpp
+// ============
+// write and read the JSON strings and numbers of the reports and caches
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JsonUtils.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+/***********************************************************
+ *  AppendString()
+ *
+ *  This method is used for appending a quoted JSON string,
+ *  escaping the quotes, the backslashes and the control
+ *  characters.
+ ***********************************************************/
+void JsonUtils::AppendString(std::string& text, const char* value)
+{
+	text += '"';
+	for (const char* pCharacter = value; *pCharacter != '\0'; pCharacter++)
+	{
+		char character = *pCharacter;
+		if ((character == '"') || (character == '\\'))
+		{
+			text += '\\';
+			text += character;
+		}
+		else if ((unsigned char)character < 0x20)
+		{
+			char escaped[8];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)character);
+			text += escaped;
+		}
+		else
+		{
+			text += character;
+		}
+	}
+	text += '"';
+}
+
+/***********************************************************
+ *  WriteString()
+ *
+ *  This method is used for writing a quoted JSON string to
+ *  the passed in stream.
+ ***********************************************************/
+void JsonUtils::WriteString(std::ostream& stream, const std::string& value)
+{
+	std::string quoted;
+
+	AppendString(quoted, value.c_str());
+	stream << quoted;
+}
+
+/***********************************************************
+ *  ReadString()
+ *
+ *  This method is used for reading the string value of a
+ *  key from a line, undoing the escapes that AppendString()
+ *  adds.
+ ***********************************************************/
+bool JsonUtils::ReadString(const std::string& line, const char* key, std::string& value)
+{
+	std::string pattern = std::string("\"") + key + "\": \"";
+	size_t start = line.find(pattern);
+	if (start == std::string::npos)
+	{
+		return(false);
+	}
+
+	value.clear();
+	for (size_t i = start + pattern.size(); (i < line.size()) && (line[i] != '"'); i++)
+	{
+		if ((line[i] == '\\') && (i + 1 < line.size()))
+		{
+			i++;
+			if ((line[i] == 'u') && (i + 4 < line.size()))
+			{
+				value += (char)strtol(line.substr(i + 1, 4).c_str(), NULL, 16);
+				i += 4;
+				continue;
+			}
+		}
+		value += line[i];
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  ReadNumber()
+ *
+ *  This method is used for reading the number value of a
+ *  key from a line.
+ ***********************************************************/
+bool JsonUtils::ReadNumber(const std::string& line, const char* key, double& value)
+{
+	std::string pattern = std::string("\"") + key + "\": ";
+	size_t start = line.find(pattern);
+	if (start == std::string::npos)
+	{
+		return(false);
+	}
+
+	value = strtod(line.c_str() + start + pattern.size(), NULL);
+	return(true);
+}
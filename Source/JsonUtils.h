@@ -0,0 +1,35 @@
+///////////////////////////////////////////////////////////////////////////////
+// jsonutils.h
+// ============
+// write and read the JSON strings and numbers of the reports and caches
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <ostream>
+#include <string>
+
+/***********************************************************
+ *  JsonUtils
+ *
+ *  This class contains the code shared by the files that
+ *  are written as JSON - the reports, the caches and the
+ *  log lines.  The files are written with one object per
+ *  line, so the values are read back by finding their key
+ *  in a line rather than by parsing the whole document.
+ ***********************************************************/
+class JsonUtils
+{
+public:
+	// append a quoted string, escaping the characters that
+	// JSON does not allow
+	static void AppendString(std::string& text, const char* value);
+	// write a quoted string, escaping the characters that
+	// JSON does not allow
+	static void WriteString(std::ostream& stream, const std::string& value);
+
+	// read the value of a key from a line, false is returned
+	// when the line does not have the key
+	static bool ReadString(const std::string& line, const char* key, std::string& value);
+	static bool ReadNumber(const std::string& line, const char* key, double& value);
+};
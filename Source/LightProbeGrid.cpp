@@ -0,0 +1,421 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightprobegrid.cpp
+// ============
+// bake a grid of light probes for the diffuse light around moving objects
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightProbeGrid.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	const float PI = 3.14159265358979f;
+	// angle between the rays spread over the sphere, which
+	// places each ray away from the rays before it
+	const float GOLDEN_ANGLE = 2.39996323f;
+
+	// rays cast from each probe unless set otherwise
+	const int DEFAULT_RAY_COUNT = 256;
+	// distance that the rays from a hit point start off the
+	// surface, so that the box that was hit does not block them
+	const float RAY_OFFSET = 0.001f;
+	// distance of the rays that do not hit anything
+	const float RAY_DISTANCE = 1000.0f;
+}
+
+/***********************************************************
+ *  LightProbeGrid()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightProbeGrid::LightProbeGrid()
+{
+	m_minimum = glm::vec3(0.0f);
+	m_maximum = glm::vec3(0.0f);
+	m_counts[0] = 1;
+	m_counts[1] = 1;
+	m_counts[2] = 1;
+	m_rayCount = DEFAULT_RAY_COUNT;
+}
+
+/***********************************************************
+ *  ~LightProbeGrid()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightProbeGrid::~LightProbeGrid()
+{
+	m_probes.clear();
+}
+
+/***********************************************************
+ *  SetBounds()
+ *
+ *  This method is used for setting the box that the probes
+ *  are spread over, with a probe at each of its corners.
+ *  The probes that were baked are discarded.
+ ***********************************************************/
+void LightProbeGrid::SetBounds(const glm::vec3& minimum, const glm::vec3& maximum, int countX, int countY, int countZ)
+{
+	m_minimum = minimum;
+	m_maximum = maximum;
+	m_counts[0] = std::max(countX, 1);
+	m_counts[1] = std::max(countY, 1);
+	m_counts[2] = std::max(countZ, 1);
+	m_probes.clear();
+}
+
+/***********************************************************
+ *  SetRayCount()
+ *
+ *  This method is used for setting the number of rays cast
+ *  from each probe when it is baked.
+ ***********************************************************/
+void LightProbeGrid::SetRayCount(int rays)
+{
+	m_rayCount = std::max(rays, 1);
+}
+
+/***********************************************************
+ *  MakeOccluder()
+ *
+ *  This method is used for getting the box around a shape
+ *  mesh in the scene, by moving the corner of its box into
+ *  the scene and scaling its edges with the axes of the
+ *  model transformation.
+ ***********************************************************/
+LightProbeGrid::PROBE_OCCLUDER LightProbeGrid::MakeOccluder(
+	const glm::mat4& model,
+	const glm::vec3& minimum,
+	const glm::vec3& maximum,
+	const glm::vec3& albedo)
+{
+	PROBE_OCCLUDER occluder;
+
+	occluder.corner = glm::vec3(model * glm::vec4(minimum, 1.0f));
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec3 axis = glm::vec3(model[i]);
+		float scale = glm::length(axis);
+
+		occluder.axes[i] = (scale > 0.0f) ? (axis / scale) : glm::vec3(0.0f);
+		occluder.size[i] = scale * (maximum[i] - minimum[i]);
+	}
+	occluder.albedo = albedo;
+
+	return(occluder);
+}
+
+/***********************************************************
+ *  GetProbePosition()
+ *
+ *  This method is used for getting the position of a probe
+ *  from its coordinates in the grid.
+ ***********************************************************/
+glm::vec3 LightProbeGrid::GetProbePosition(int x, int y, int z) const
+{
+	int coordinates[3] = { x, y, z };
+	glm::vec3 position;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float t = (m_counts[i] > 1) ? ((float)coordinates[i] / (float)(m_counts[i] - 1)) : 0.5f;
+		position[i] = m_minimum[i] + ((m_maximum[i] - m_minimum[i]) * t);
+	}
+
+	return(position);
+}
+
+/***********************************************************
+ *  GetProbe()
+ *
+ *  This method is used for getting the baked probe at the
+ *  passed in coordinates in the grid.
+ ***********************************************************/
+const SphericalHarmonics::SH_COLOR& LightProbeGrid::GetProbe(int x, int y, int z) const
+{
+	return(m_probes[(((z * m_counts[1]) + y) * m_counts[0]) + x]);
+}
+
+/***********************************************************
+ *  RayDirection()
+ *
+ *  This method is used for getting one of a number of unit
+ *  directions spread evenly over the sphere, by stepping
+ *  down in equal heights while turning by the golden angle.
+ ***********************************************************/
+glm::vec3 LightProbeGrid::RayDirection(int index, int count)
+{
+	float y = 1.0f - ((2.0f * (index + 0.5f)) / count);
+	float radius = std::sqrt(std::max(1.0f - (y * y), 0.0f));
+	float angle = GOLDEN_ANGLE * index;
+
+	return(glm::vec3(std::cos(angle) * radius, y, std::sin(angle) * radius));
+}
+
+/***********************************************************
+ *  IntersectOccluder()
+ *
+ *  This method is used for finding where a ray enters a
+ *  box, by clipping the ray between the two sides of the
+ *  box along each of its axes.  Rays that start inside the
+ *  box do not hit it, so that a probe inside an object is
+ *  not blocked by that object.
+ ***********************************************************/
+bool LightProbeGrid::IntersectOccluder(
+	const PROBE_OCCLUDER& occluder,
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	float& distance,
+	glm::vec3& normal)
+{
+	glm::vec3 offset = origin - occluder.corner;
+	float enter = 0.0f;
+	float leave = maxDistance;
+	int enterAxis = -1;
+	float enterSide = 0.0f;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float start = glm::dot(offset, occluder.axes[i]);
+		float step = glm::dot(direction, occluder.axes[i]);
+
+		// a ray along the sides misses unless it is between them
+		if (std::fabs(step) < 1.0e-8f)
+		{
+			if ((start < 0.0f) || (start > occluder.size[i]))
+			{
+				return(false);
+			}
+			continue;
+		}
+
+		float nearSide = -start / step;
+		float farSide = (occluder.size[i] - start) / step;
+		float side = -1.0f;
+		if (step < 0.0f)
+		{
+			std::swap(nearSide, farSide);
+			side = 1.0f;
+		}
+
+		if (nearSide > enter)
+		{
+			enter = nearSide;
+			enterAxis = i;
+			enterSide = side;
+		}
+		leave = std::min(leave, farSide);
+
+		if (enter > leave)
+		{
+			return(false);
+		}
+	}
+
+	if (enterAxis < 0)
+	{
+		return(false);
+	}
+
+	distance = enter;
+	normal = occluder.axes[enterAxis] * enterSide;
+
+	return(true);
+}
+
+/***********************************************************
+ *  TraceRay()
+ *
+ *  This method is used for finding the nearest box that a
+ *  ray hits, and the distance to it and the normal of the
+ *  side that it hits.
+ ***********************************************************/
+int LightProbeGrid::TraceRay(
+	const std::vector<PROBE_OCCLUDER>& occluders,
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	float& distance,
+	glm::vec3& normal)
+{
+	int nearest = -1;
+
+	distance = maxDistance;
+	for (size_t i = 0; i < occluders.size(); i++)
+	{
+		float hitDistance = 0.0f;
+		glm::vec3 hitNormal;
+
+		if (IntersectOccluder(occluders[i], origin, direction, distance, hitDistance, hitNormal))
+		{
+			nearest = (int)i;
+			distance = hitDistance;
+			normal = hitNormal;
+		}
+	}
+
+	return(nearest);
+}
+
+/***********************************************************
+ *  ShadeHit()
+ *
+ *  This method is used for getting the light that a point
+ *  of a box reflects towards the probe.  Each light that
+ *  is not blocked by another box adds its diffuse color,
+ *  scaled by the angle between the light and the surface,
+ *  as the fragment shader lights the surfaces.
+ ***********************************************************/
+glm::vec3 LightProbeGrid::ShadeHit(
+	const LIGHT_BLOCK& lights,
+	const std::vector<PROBE_OCCLUDER>& occluders,
+	const glm::vec3& point,
+	const glm::vec3& normal,
+	const glm::vec3& albedo)
+{
+	glm::vec3 light = lights.globalAmbientColor;
+	glm::vec3 origin = point + (normal * RAY_OFFSET);
+
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		glm::vec3 offset = lights.lightSources[i].position - origin;
+		float lightDistance = glm::length(offset);
+		if (lightDistance <= 0.0f)
+		{
+			continue;
+		}
+
+		glm::vec3 lightDirection = offset / lightDistance;
+		float impact = glm::dot(normal, lightDirection);
+		if (impact <= 0.0f)
+		{
+			continue;
+		}
+
+		float distance = 0.0f;
+		glm::vec3 blockNormal;
+		if (TraceRay(occluders, origin, lightDirection, lightDistance, distance, blockNormal) < 0)
+		{
+			light += lights.lightSources[i].diffuseColor * impact;
+		}
+	}
+
+	return(albedo * light);
+}
+
+/***********************************************************
+ *  Bake()
+ *
+ *  This method is used for baking the probes.  Each probe
+ *  casts rays evenly over the sphere, the rays that hit a
+ *  box add the light that the box reflects and the others
+ *  add the ambient light, and the light is projected onto
+ *  the coefficients of the probe and convolved with a
+ *  cosine lobe.  The lights reach the objects directly in
+ *  the fragment shader, so the probes only hold the light
+ *  that bounces off the scene.
+ ***********************************************************/
+void LightProbeGrid::Bake(const LIGHT_BLOCK& lights, const std::vector<PROBE_OCCLUDER>& occluders)
+{
+	Clock::time_point start = Clock::now();
+	float solidAngle = (4.0f * PI) / m_rayCount;
+
+	m_probes.assign(m_counts[0] * m_counts[1] * m_counts[2], SphericalHarmonics::SH_COLOR());
+
+	int probe = 0;
+	for (int z = 0; z < m_counts[2]; z++)
+	{
+		for (int y = 0; y < m_counts[1]; y++)
+		{
+			for (int x = 0; x < m_counts[0]; x++)
+			{
+				glm::vec3 position = GetProbePosition(x, y, z);
+				SphericalHarmonics::SH_COLOR& sh = m_probes[probe++];
+
+				for (int ray = 0; ray < m_rayCount; ray++)
+				{
+					glm::vec3 direction = RayDirection(ray, m_rayCount);
+					glm::vec3 color = lights.globalAmbientColor;
+					float distance = 0.0f;
+					glm::vec3 normal;
+
+					int hit = TraceRay(occluders, position, direction, RAY_DISTANCE, distance, normal);
+					if (hit >= 0)
+					{
+						color = ShadeHit(lights, occluders, position + (direction * distance), normal, occluders[hit].albedo);
+					}
+
+					SphericalHarmonics::AddLight(sh, direction, color, solidAngle);
+				}
+
+				SphericalHarmonics::ConvolveDiffuse(sh);
+			}
+		}
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	LOG_INFO("light probes baked", "probes", (int)m_probes.size(), "rays", m_rayCount,
+		"occluders", (int)occluders.size(), "cpuMs", milliseconds);
+}
+
+/***********************************************************
+ *  Sample()
+ *
+ *  This method is used for blending the eight probes of the
+ *  grid cell around a position, weighted by how near the
+ *  position is to each of them.
+ ***********************************************************/
+void LightProbeGrid::Sample(const glm::vec3& position, SphericalHarmonics::SH_COLOR& sh) const
+{
+	sh = SphericalHarmonics::SH_COLOR();
+	if (m_probes.empty())
+	{
+		return;
+	}
+
+	int lower[3];
+	int upper[3];
+	float blend[3];
+	for (int i = 0; i < 3; i++)
+	{
+		float extent = m_maximum[i] - m_minimum[i];
+		float cell = 0.0f;
+
+		if ((m_counts[i] > 1) && (extent > 0.0f))
+		{
+			cell = ((position[i] - m_minimum[i]) / extent) * (m_counts[i] - 1);
+			cell = std::min(std::max(cell, 0.0f), (float)(m_counts[i] - 1));
+		}
+
+		lower[i] = std::min((int)cell, std::max(m_counts[i] - 2, 0));
+		upper[i] = std::min(lower[i] + 1, m_counts[i] - 1);
+		blend[i] = cell - lower[i];
+	}
+
+	for (int corner = 0; corner < 8; corner++)
+	{
+		int coordinates[3];
+		float weight = 1.0f;
+
+		for (int i = 0; i < 3; i++)
+		{
+			bool bUpper = ((corner >> i) & 1) != 0;
+			coordinates[i] = bUpper ? upper[i] : lower[i];
+			weight *= bUpper ? blend[i] : (1.0f - blend[i]);
+		}
+
+		if (weight > 0.0f)
+		{
+			SphericalHarmonics::AddScaled(sh, GetProbe(coordinates[0], coordinates[1], coordinates[2]), weight);
+		}
+	}
+}
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightprobegrid.h
+// ============
+// bake a grid of light probes for the diffuse light around moving objects
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "UniformBlocks.h"
+#include "SphericalHarmonics.h"
+
+#include <vector>
+
+/***********************************************************
+ *  LightProbeGrid
+ *
+ *  This class contains the code for baking the light that
+ *  bounces off the scene into a grid of light probes, each
+ *  stored as the nine spherical harmonic coefficients of
+ *  its diffuse light.  The probes are baked on the CPU
+ *  while loading, by casting rays from each probe against
+ *  boxes around the objects of the scene and lighting the
+ *  boxes that the rays hit with the lights of the scene.
+ *  The eight probes around an object are blended for it
+ *  each time that it moves, so that an object that moves
+ *  through the scene picks up the indirect light of the
+ *  place that it is in.
+ ***********************************************************/
+class LightProbeGrid
+{
+public:
+	// a box of the scene that blocks the light arriving at the
+	// probes and reflects the light of the scene onto them, as
+	// a corner, three perpendicular unit axes and the length
+	// of the box along each axis, and its diffuse color
+	struct PROBE_OCCLUDER
+	{
+		glm::vec3 corner;
+		glm::vec3 axes[3];
+		glm::vec3 size;
+		glm::vec3 albedo;
+	};
+
+	// constructor
+	LightProbeGrid();
+	// destructor
+	~LightProbeGrid();
+
+	// set the box that the probes are spread over, and the
+	// number of probes along each axis of the box
+	void SetBounds(const glm::vec3& minimum, const glm::vec3& maximum, int countX, int countY, int countZ);
+	// set the number of rays cast from each probe
+	void SetRayCount(int rays);
+
+	// bake the probes from the lights of the scene and the
+	// boxes around its objects
+	void Bake(const LIGHT_BLOCK& lights, const std::vector<PROBE_OCCLUDER>& occluders);
+	// blend the eight probes around a position, positions
+	// outside the grid take the probes at its nearest edge
+	void Sample(const glm::vec3& position, SphericalHarmonics::SH_COLOR& sh) const;
+	// true once the probes have been baked
+	bool IsBaked() const { return(false == m_probes.empty()); }
+
+	// get the box around a shape mesh with the passed in model
+	// transformation, which has no shear, from the box around
+	// the mesh in its own coordinates
+	static PROBE_OCCLUDER MakeOccluder(
+		const glm::mat4& model,
+		const glm::vec3& minimum,
+		const glm::vec3& maximum,
+		const glm::vec3& albedo);
+
+private:
+	// box that the probes are spread over, and the number of
+	// probes along each of its axes
+	glm::vec3 m_minimum;
+	glm::vec3 m_maximum;
+	int m_counts[3];
+	// number of rays cast from each probe
+	int m_rayCount;
+	// diffuse light of the probes, X first and then Y and Z
+	std::vector<SphericalHarmonics::SH_COLOR> m_probes;
+
+	// get the position of a probe from its grid coordinates
+	glm::vec3 GetProbePosition(int x, int y, int z) const;
+	// get the probe at grid coordinates
+	const SphericalHarmonics::SH_COLOR& GetProbe(int x, int y, int z) const;
+	// get one of a number of unit directions that are spread
+	// evenly over the sphere
+	static glm::vec3 RayDirection(int index, int count);
+	// find the distance to a box along a ray that starts
+	// outside of it, and the normal of the side that is hit
+	static bool IntersectOccluder(
+		const PROBE_OCCLUDER& occluder,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& distance,
+		glm::vec3& normal);
+	// find the nearest box that a ray hits before the passed
+	// in distance, -1 is returned when there is none
+	static int TraceRay(
+		const std::vector<PROBE_OCCLUDER>& occluders,
+		const glm::vec3& origin,
+		const glm::vec3& direction,
+		float maxDistance,
+		float& distance,
+		glm::vec3& normal);
+	// get the light reflected by a point of a box that is
+	// hit by a ray, from the lights that are not blocked
+	static glm::vec3 ShadeHit(
+		const LIGHT_BLOCK& lights,
+		const std::vector<PROBE_OCCLUDER>& occluders,
+		const glm::vec3& point,
+		const glm::vec3& normal,
+		const glm::vec3& albedo);
+};
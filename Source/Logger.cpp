@@ -0,0 +1,633 @@
+///////////////////////////////////////////////////////////////////////////////
+// logger.cpp
+// ============
+// log structured messages from any thread without waiting for the output
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Logger.h"
+#include "JsonUtils.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// bytes in the ring of each thread
+	const size_t RING_SIZE = 64 * 1024;
+	// level of the records that only fill the end of a ring
+	const uint16_t PADDING_LEVEL = 0xFFFF;
+	// time that the writer sleeps when there is nothing to write
+	const int WRITER_INTERVAL_MILLISECONDS = 10;
+
+	// names of the levels, which start the console lines
+	const char* const LEVEL_NAMES[] =
+	{
+		"DEBUG",
+		"INFO",
+		"WARNING",
+		"ERROR"
+	};
+
+	// ring of records written by one thread and read by the
+	// writer thread - the positions only ever increase, and
+	// the offset in the ring is the position modulo its size
+	struct THREAD_RING
+	{
+		alignas(8) char data[RING_SIZE];
+		std::atomic<uint64_t> head;
+		std::atomic<uint64_t> tail;
+		// records dropped because the ring was full
+		std::atomic<uint64_t> dropped;
+		// padding in front of the record being written
+		size_t pendingPadding;
+		// order in which the thread first logged
+		int index;
+	};
+
+	// formatted record waiting to be written
+	struct LOG_ENTRY
+	{
+		int64_t time;
+		std::string line;
+		std::string jsonLine;
+	};
+
+	// file waiting to be written by the writer thread
+	struct PENDING_FILE
+	{
+		std::string path;
+		std::string contents;
+	};
+
+	// rings of all the threads that have logged, they are kept
+	// until the process exits so the writer can always read them
+	std::mutex g_RingMutex;
+	std::vector<THREAD_RING*> g_Rings;
+	thread_local THREAD_RING* t_pRing = NULL;
+
+	// state of the writer thread
+	std::atomic<bool> g_bRunning(false);
+	std::thread g_Writer;
+	std::mutex g_WriterMutex;
+	std::condition_variable g_WriterWake;
+	std::condition_variable g_FlushDone;
+	bool g_bStopRequested = false;
+	uint64_t g_flushRequested = 0;
+	uint64_t g_flushCompleted = 0;
+	std::ofstream g_File;
+	std::vector<PENDING_FILE> g_PendingFiles;
+
+	// serializes the messages written directly
+	std::mutex g_DirectMutex;
+
+	const Clock::time_point g_ClockStart = Clock::now();
+
+	/***********************************************************
+	 *  GetRing()
+	 *
+	 *  This function is used for getting the ring of the
+	 *  calling thread, creating it the first time.
+	 ***********************************************************/
+	THREAD_RING* GetRing()
+	{
+		if (NULL == t_pRing)
+		{
+			THREAD_RING* pRing = new THREAD_RING();
+			pRing->head.store(0);
+			pRing->tail.store(0);
+			pRing->dropped.store(0);
+			pRing->pendingPadding = 0;
+
+			std::lock_guard<std::mutex> lock(g_RingMutex);
+			pRing->index = (int)g_Rings.size();
+			g_Rings.push_back(pRing);
+			t_pRing = pRing;
+		}
+		return(t_pRing);
+	}
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the writer thread, and
+ *  opening the file that the JSON lines are written to.
+ ***********************************************************/
+bool Logger::Start(const char* filename)
+{
+	if (g_bRunning)
+	{
+		return(true);
+	}
+
+	if (NULL != filename)
+	{
+		g_File.open(filename);
+		if (!g_File)
+		{
+			std::cout << "ERROR: could not open the log file " << filename << std::endl;
+			return(false);
+		}
+	}
+
+	g_bStopRequested = false;
+	g_bRunning = true;
+	g_Writer = std::thread(WriterLoop);
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the writer thread once
+ *  it has written the messages and files that are waiting.
+ ***********************************************************/
+void Logger::Stop()
+{
+	if (g_bRunning == false)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(g_WriterMutex);
+		g_bStopRequested = true;
+	}
+	g_WriterWake.notify_one();
+	g_Writer.join();
+	g_bRunning = false;
+
+	// the files and messages published while the writer was
+	// stopping
+	std::vector<PENDING_FILE> files;
+	{
+		std::lock_guard<std::mutex> lock(g_WriterMutex);
+		files.swap(g_PendingFiles);
+	}
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		SaveFile(files[i].path, files[i].contents);
+	}
+	WriteRecords();
+	if (g_File.is_open())
+	{
+		g_File.close();
+	}
+}
+
+/***********************************************************
+ *  Flush()
+ *
+ *  This method is used for waiting until the writer has
+ *  written the messages that were logged, and the files
+ *  that were handed to it, before the call.
+ ***********************************************************/
+void Logger::Flush()
+{
+	if (g_bRunning == false)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(g_WriterMutex);
+	uint64_t request = ++g_flushRequested;
+	g_WriterWake.notify_one();
+	g_FlushDone.wait(lock, [request] { return(g_flushCompleted >= request); });
+}
+
+/***********************************************************
+ *  WriteFile()
+ *
+ *  This method is used for handing a file to the writer
+ *  thread, which writes it along with the messages.  When
+ *  the writer is not running the file is written directly.
+ ***********************************************************/
+void Logger::WriteFile(const std::string& path, std::string& contents)
+{
+	if (g_bRunning == false)
+	{
+		SaveFile(path, contents);
+		contents.clear();
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(g_WriterMutex);
+		PENDING_FILE file;
+		file.path = path;
+		g_PendingFiles.push_back(file);
+		g_PendingFiles.back().contents.swap(contents);
+	}
+	g_WriterWake.notify_one();
+}
+
+/***********************************************************
+ *  SaveFile()
+ *
+ *  This method is used for writing the contents of a file.
+ ***********************************************************/
+void Logger::SaveFile(const std::string& path, const std::string& contents)
+{
+	std::ofstream file(path.c_str(), std::ios::binary);
+	if (file)
+	{
+		file.write(contents.data(), (std::streamsize)contents.size());
+	}
+	if (!file)
+	{
+		LOG_ERROR("could not write the file", "file", path);
+	}
+}
+
+/***********************************************************
+ *  GetTime()
+ *
+ *  This method is used for getting the nanoseconds since
+ *  the logger clock started.
+ ***********************************************************/
+int64_t Logger::GetTime()
+{
+	return(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - g_ClockStart).count());
+}
+
+/***********************************************************
+ *  TextLength()
+ *
+ *  This method is used for getting the number of characters
+ *  of a text value that are kept.
+ ***********************************************************/
+size_t Logger::TextLength(const char* value)
+{
+	if (NULL == value)
+	{
+		return(0);
+	}
+	return(std::min(strlen(value), (size_t)MAX_TEXT_LENGTH));
+}
+
+/***********************************************************
+ *  WriteText()
+ *
+ *  This method is used for copying a text value into a
+ *  record, without its terminating zero.
+ ***********************************************************/
+char* Logger::WriteText(char* pField, const char* key, const char* value)
+{
+	size_t length = TextLength(value);
+	FIELD_HEADER header = { key, (uint32_t)FIELD_TEXT, (uint32_t)length };
+	memcpy(pField, &header, sizeof(header));
+	if (length > 0)
+	{
+		memcpy(pField + sizeof(header), value, length);
+	}
+	return(pField + sizeof(header) + Align(length));
+}
+
+/***********************************************************
+ *  BeginRecord()
+ *
+ *  This method is used for reserving the space of a record
+ *  in the ring of the calling thread.  A record is never
+ *  split over the end of the ring - the end is filled with
+ *  padding and the record starts again at the front.
+ ***********************************************************/
+char* Logger::BeginRecord(size_t size)
+{
+	THREAD_RING* pRing = GetRing();
+	if (size > RING_SIZE / 2)
+	{
+		pRing->dropped.fetch_add(1, std::memory_order_relaxed);
+		return(NULL);
+	}
+
+	uint64_t head = pRing->head.load(std::memory_order_relaxed);
+	uint64_t tail = pRing->tail.load(std::memory_order_acquire);
+	size_t offset = (size_t)(head % RING_SIZE);
+	size_t padding = ((RING_SIZE - offset) < size) ? (RING_SIZE - offset) : 0;
+	if ((head + padding + size - tail) > RING_SIZE)
+	{
+		pRing->dropped.fetch_add(1, std::memory_order_relaxed);
+		return(NULL);
+	}
+
+	// the reader skips an end that is too small for a header
+	// on its own, a larger end is marked with a padding record
+	if (padding >= sizeof(RECORD_HEADER))
+	{
+		RECORD_HEADER header = RECORD_HEADER();
+		header.size = (uint32_t)padding;
+		header.level = PADDING_LEVEL;
+		memcpy(pRing->data + offset, &header, sizeof(header));
+	}
+	pRing->pendingPadding = padding;
+
+	return(pRing->data + ((head + padding) % RING_SIZE));
+}
+
+/***********************************************************
+ *  EndRecord()
+ *
+ *  This method is used for publishing a record to the
+ *  writer thread.  When the writer is not running the
+ *  record is written directly instead, and its space in
+ *  the ring is used again.
+ ***********************************************************/
+void Logger::EndRecord(char* pRecord)
+{
+	if (g_bRunning == false)
+	{
+		WriteDirect(pRecord);
+		return;
+	}
+
+	RECORD_HEADER header;
+	memcpy(&header, pRecord, sizeof(header));
+
+	THREAD_RING* pRing = t_pRing;
+	uint64_t head = pRing->head.load(std::memory_order_relaxed);
+	uint64_t tail = pRing->tail.load(std::memory_order_relaxed);
+	uint64_t newHead = head + pRing->pendingPadding + header.size;
+	pRing->head.store(newHead, std::memory_order_release);
+
+	// errors are written without waiting for the interval, and
+	// so is a ring once it becomes half full
+	bool bHalfFull = ((head - tail) <= RING_SIZE / 2) && ((newHead - tail) > RING_SIZE / 2);
+	if ((header.level >= LEVEL_ERROR) || bHalfFull)
+	{
+		g_WriterWake.notify_one();
+	}
+}
+
+/***********************************************************
+ *  FormatRecord()
+ *
+ *  This method is used for formatting a record as a console
+ *  line, with the fields as names and values after the
+ *  message, and as a JSON object on one line.
+ ***********************************************************/
+void Logger::FormatRecord(const char* pRecord, int thread, std::string& line, std::string& jsonLine)
+{
+	RECORD_HEADER header;
+	memcpy(&header, pRecord, sizeof(header));
+
+	char number[64];
+	int level = std::min((int)header.level, (int)LEVEL_ERROR);
+
+	line = LEVEL_NAMES[level];
+	line += ": ";
+	line += header.message;
+
+	snprintf(number, sizeof(number), "%.6f", header.time / 1000000000.0);
+	jsonLine = "{\"time\":";
+	jsonLine += number;
+	jsonLine += ",\"thread\":" + std::to_string(thread);
+	jsonLine += ",\"level\":\"";
+	jsonLine += LEVEL_NAMES[level];
+	jsonLine += "\",\"message\":";
+	JsonUtils::AppendString(jsonLine, header.message);
+
+	const char* pField = pRecord + sizeof(header);
+	for (int i = 0; i < header.fieldCount; i++)
+	{
+		FIELD_HEADER field;
+		memcpy(&field, pField, sizeof(field));
+		const char* pValue = pField + sizeof(field);
+
+		int64_t integer = 0;
+		double value = 0.0;
+		std::string text;
+		switch (field.type)
+		{
+		case FIELD_INTEGER:
+			memcpy(&integer, pValue, sizeof(integer));
+			snprintf(number, sizeof(number), "%lld", (long long)integer);
+			text = number;
+			break;
+		case FIELD_UNSIGNED:
+			memcpy(&integer, pValue, sizeof(integer));
+			snprintf(number, sizeof(number), "%llu", (unsigned long long)integer);
+			text = number;
+			break;
+		case FIELD_NUMBER:
+			memcpy(&value, pValue, sizeof(value));
+			snprintf(number, sizeof(number), "%g", value);
+			text = number;
+			break;
+		case FIELD_BOOLEAN:
+			memcpy(&integer, pValue, sizeof(integer));
+			text = (integer != 0) ? "true" : "false";
+			break;
+		default:
+			text.assign(pValue, field.length);
+			break;
+		}
+
+		line += ' ';
+		line += field.key;
+		line += '=';
+		jsonLine += ',';
+		JsonUtils::AppendString(jsonLine, field.key);
+		jsonLine += ':';
+		if (field.type == FIELD_TEXT)
+		{
+			// text with spaces is quoted so the fields can be split
+			if (text.find(' ') != std::string::npos)
+			{
+				line += '"' + text + '"';
+			}
+			else
+			{
+				line += text;
+			}
+			JsonUtils::AppendString(jsonLine, text.c_str());
+		}
+		else
+		{
+			line += text;
+			jsonLine += text;
+		}
+
+		pField = pValue + ((field.type == FIELD_TEXT) ? Align(field.length) : 8);
+	}
+	jsonLine += '}';
+}
+
+/***********************************************************
+ *  WriteDirect()
+ *
+ *  This method is used for writing a record from the thread
+ *  that logged it, when the writer is not running.
+ ***********************************************************/
+void Logger::WriteDirect(const char* pRecord)
+{
+	std::string line;
+	std::string jsonLine;
+	FormatRecord(pRecord, t_pRing->index, line, jsonLine);
+
+	std::lock_guard<std::mutex> lock(g_DirectMutex);
+	std::cout << line << std::endl;
+}
+
+/***********************************************************
+ *  WriteRecords()
+ *
+ *  This method is used for formatting the records that all
+ *  of the threads have published, writing them in the order
+ *  of their times, and freeing their space in the rings.
+ ***********************************************************/
+bool Logger::WriteRecords()
+{
+	std::vector<THREAD_RING*> rings;
+	{
+		std::lock_guard<std::mutex> lock(g_RingMutex);
+		rings = g_Rings;
+	}
+
+	std::vector<LOG_ENTRY> entries;
+	for (size_t i = 0; i < rings.size(); i++)
+	{
+		THREAD_RING* pRing = rings[i];
+		uint64_t head = pRing->head.load(std::memory_order_acquire);
+		uint64_t tail = pRing->tail.load(std::memory_order_relaxed);
+
+		while (tail < head)
+		{
+			size_t offset = (size_t)(tail % RING_SIZE);
+			if ((RING_SIZE - offset) < sizeof(RECORD_HEADER))
+			{
+				tail += RING_SIZE - offset;
+				continue;
+			}
+
+			RECORD_HEADER header;
+			memcpy(&header, pRing->data + offset, sizeof(header));
+			if (header.level != PADDING_LEVEL)
+			{
+				LOG_ENTRY entry;
+				entry.time = header.time;
+				FormatRecord(pRing->data + offset, pRing->index, entry.line, entry.jsonLine);
+				entries.push_back(entry);
+			}
+			tail += header.size;
+		}
+		pRing->tail.store(tail, std::memory_order_release);
+
+		uint64_t dropped = pRing->dropped.exchange(0, std::memory_order_relaxed);
+		if (dropped > 0)
+		{
+			LOG_ENTRY entry;
+			entry.time = GetTime();
+			entry.line = "WARNING: log messages were dropped because the ring was full thread=" +
+				std::to_string(pRing->index) + " dropped=" + std::to_string(dropped);
+			entry.jsonLine = "{\"level\":\"WARNING\",\"message\":\"log messages were dropped\",\"thread\":" +
+				std::to_string(pRing->index) + ",\"dropped\":" + std::to_string(dropped) + "}";
+			entries.push_back(entry);
+		}
+	}
+
+	if (entries.empty())
+	{
+		return(false);
+	}
+
+	std::stable_sort(entries.begin(), entries.end(),
+		[](const LOG_ENTRY& first, const LOG_ENTRY& second) { return(first.time < second.time); });
+
+	// the output is flushed once for all of the entries
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		std::cout << entries[i].line << '\n';
+		if (g_File.is_open())
+		{
+			g_File << entries[i].jsonLine << '\n';
+		}
+	}
+	std::cout.flush();
+	if (g_File.is_open())
+	{
+		g_File.flush();
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriterLoop()
+ *
+ *  This method is used for running the writer thread, which
+ *  writes the published records and the files handed to it
+ *  at a fixed interval, or as soon as an error, a file or a
+ *  flush is waiting.
+ ***********************************************************/
+void Logger::WriterLoop()
+{
+	std::vector<PENDING_FILE> files;
+	std::unique_lock<std::mutex> lock(g_WriterMutex);
+	while (true)
+	{
+		g_WriterWake.wait_for(lock, std::chrono::milliseconds(WRITER_INTERVAL_MILLISECONDS));
+		bool bStop = g_bStopRequested;
+		uint64_t request = g_flushRequested;
+		files.swap(g_PendingFiles);
+
+		lock.unlock();
+		for (size_t i = 0; i < files.size(); i++)
+		{
+			SaveFile(files[i].path, files[i].contents);
+		}
+		files.clear();
+		WriteRecords();
+		lock.lock();
+
+		g_flushCompleted = request;
+		g_FlushDone.notify_all();
+		if (bStop)
+		{
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  RateLimit()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Logger::RateLimit::RateLimit(double intervalMilliseconds)
+	: m_nextTime(0), m_suppressed(0)
+{
+	m_intervalNanoseconds = (int64_t)(intervalMilliseconds * 1000000.0);
+}
+
+/***********************************************************
+ *  Allow()
+ *
+ *  This method is used for checking whether the interval
+ *  has passed since the last message was let through.  Only
+ *  one thread takes the next interval when several threads
+ *  check at the same time.
+ ***********************************************************/
+bool Logger::RateLimit::Allow(uint32_t& suppressed)
+{
+	int64_t time = GetTime();
+	int64_t nextTime = m_nextTime.load(std::memory_order_relaxed);
+	if ((time < nextTime) ||
+		(m_nextTime.compare_exchange_strong(nextTime, time + m_intervalNanoseconds) == false))
+	{
+		m_suppressed.fetch_add(1, std::memory_order_relaxed);
+		return(false);
+	}
+
+	suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+	return(true);
+}
@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////
+// logger.h
+// ============
+// log structured messages from any thread without waiting for the output
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// messages below this level are compiled out - the debug
+// messages are only kept in debug builds
+#ifndef LOG_COMPILED_LEVEL
+#ifdef NDEBUG
+#define LOG_COMPILED_LEVEL 1
+#else
+#define LOG_COMPILED_LEVEL 0
+#endif
+#endif
+
+// log a message followed by pairs of field names and values,
+// such as LOG_INFO("loaded image", "file", filename, "width", width)
+#if LOG_COMPILED_LEVEL <= 0
+#define LOG_DEBUG(...) Logger::Log(Logger::LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+#if LOG_COMPILED_LEVEL <= 1
+#define LOG_INFO(...) Logger::Log(Logger::LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+#if LOG_COMPILED_LEVEL <= 2
+#define LOG_WARNING(...) Logger::Log(Logger::LEVEL_WARNING, __VA_ARGS__)
+#else
+#define LOG_WARNING(...) ((void)0)
+#endif
+#define LOG_ERROR(...) Logger::Log(Logger::LEVEL_ERROR, __VA_ARGS__)
+
+// log a message at most once in the passed in interval, for
+// the messages that can happen every frame - the number of
+// messages left out since the last one is added as a field
+#define LOG_RATE_LIMITED(milliseconds, LOG_MACRO, ...) \
+	do \
+	{ \
+		static Logger::RateLimit rateLimit(milliseconds); \
+		uint32_t suppressed = 0; \
+		if (rateLimit.Allow(suppressed)) \
+		{ \
+			LOG_MACRO(__VA_ARGS__, "suppressed", suppressed); \
+		} \
+	} while (false)
+
+/***********************************************************
+ *  Logger
+ *
+ *  This class contains the code for logging messages with
+ *  named fields.  Each thread writes its messages into its
+ *  own ring buffer, copying only the field values, and a
+ *  background thread formats them and writes them to the
+ *  console, and to a file as JSON lines, so that the thread
+ *  that logs never waits for a lock or for the output.  A
+ *  message is dropped and counted when the ring of its
+ *  thread is full.  The message text and the field names
+ *  must be string literals, as only their pointers are kept.
+ *  Before the logger is started, and after it is stopped,
+ *  the messages are written directly.
+ ***********************************************************/
+class Logger
+{
+public:
+	// importance of a message
+	enum LOG_LEVEL
+	{
+		LEVEL_DEBUG = 0,
+		LEVEL_INFO,
+		LEVEL_WARNING,
+		LEVEL_ERROR
+	};
+
+	// start the background writer, the messages are also
+	// written to the file when a name is passed in
+	static bool Start(const char* filename);
+	// write the messages that are waiting and stop the writer
+	static void Stop();
+	// wait until the messages logged so far are written
+	static void Flush();
+	// write a file on the writer thread, so that the calling
+	// thread does not wait for the disk - the contents are
+	// moved out of the passed in string
+	static void WriteFile(const std::string& path, std::string& contents);
+
+	// log a message with pairs of field names and values
+	template<typename... ARGUMENTS>
+	static void Log(LOG_LEVEL level, const char* message, const ARGUMENTS&... arguments);
+
+	/***********************************************************
+	 *  RateLimit
+	 *
+	 *  This class contains the code for letting a message
+	 *  through at most once in an interval, counting the
+	 *  messages that are left out.
+	 ***********************************************************/
+	class RateLimit
+	{
+	public:
+		// constructor
+		RateLimit(double intervalMilliseconds);
+
+		// check whether a message can be logged now, the number
+		// of messages left out since the last one is returned
+		bool Allow(uint32_t& suppressed);
+
+	private:
+		int64_t m_intervalNanoseconds;
+		std::atomic<int64_t> m_nextTime;
+		std::atomic<uint32_t> m_suppressed;
+	};
+
+private:
+	// longest text value that is kept, longer text is cut
+	static const size_t MAX_TEXT_LENGTH = 4096;
+
+	// types of the field values
+	enum FIELD_TYPE
+	{
+		FIELD_INTEGER = 0,
+		FIELD_UNSIGNED,
+		FIELD_NUMBER,
+		FIELD_BOOLEAN,
+		FIELD_TEXT
+	};
+
+	// start of each message in a ring, followed by its fields
+	struct RECORD_HEADER
+	{
+		// bytes of the record, including the fields
+		uint32_t size;
+		uint16_t level;
+		uint16_t fieldCount;
+		// nanoseconds since the logger clock started
+		int64_t time;
+		const char* message;
+	};
+
+	// start of each field, followed by the value, which is
+	// 8 bytes or the text padded to 8 bytes
+	struct FIELD_HEADER
+	{
+		const char* key;
+		uint32_t type;
+		uint32_t length;
+	};
+
+	// reserve a record in the ring of the calling thread, NULL
+	// is returned when the ring is full
+	static char* BeginRecord(size_t size);
+	// publish the record, or write it directly when the
+	// writer is not running
+	static void EndRecord(char* pRecord);
+	// nanoseconds since the logger clock started
+	static int64_t GetTime();
+
+	// round a size up to a multiple of 8 bytes
+	static size_t Align(size_t size) { return((size + 7) & ~(size_t)7); }
+
+	// get the bytes of the fields of a message
+	static size_t FieldsSize() { return(0); }
+	template<typename VALUE, typename... REST>
+	static size_t FieldsSize(const char* key, const VALUE& value, const REST&... rest)
+	{
+		return(FieldSize(value) + FieldsSize(rest...));
+	}
+	static size_t FieldSize(int) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(unsigned int) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(long) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(unsigned long) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(long long) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(unsigned long long) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(double) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(bool) { return(sizeof(FIELD_HEADER) + 8); }
+	static size_t FieldSize(const char* value) { return(sizeof(FIELD_HEADER) + Align(TextLength(value))); }
+	static size_t FieldSize(const std::string& value) { return(sizeof(FIELD_HEADER) + Align(TextLength(value.c_str()))); }
+	static size_t TextLength(const char* value);
+
+	// copy the fields of a message into a record
+	static void WriteFields(char*) {}
+	template<typename VALUE, typename... REST>
+	static void WriteFields(char* pField, const char* key, const VALUE& value, const REST&... rest)
+	{
+		WriteFields(WriteField(pField, key, value), rest...);
+	}
+	static char* WriteField(char* pField, const char* key, int value) { return(WriteValue(pField, key, FIELD_INTEGER, (int64_t)value)); }
+	static char* WriteField(char* pField, const char* key, unsigned int value) { return(WriteValue(pField, key, FIELD_UNSIGNED, (uint64_t)value)); }
+	static char* WriteField(char* pField, const char* key, long value) { return(WriteValue(pField, key, FIELD_INTEGER, (int64_t)value)); }
+	static char* WriteField(char* pField, const char* key, unsigned long value) { return(WriteValue(pField, key, FIELD_UNSIGNED, (uint64_t)value)); }
+	static char* WriteField(char* pField, const char* key, long long value) { return(WriteValue(pField, key, FIELD_INTEGER, (int64_t)value)); }
+	static char* WriteField(char* pField, const char* key, unsigned long long value) { return(WriteValue(pField, key, FIELD_UNSIGNED, (uint64_t)value)); }
+	static char* WriteField(char* pField, const char* key, double value) { return(WriteValue(pField, key, FIELD_NUMBER, value)); }
+	static char* WriteField(char* pField, const char* key, bool value) { return(WriteValue(pField, key, FIELD_BOOLEAN, (uint64_t)value)); }
+	static char* WriteField(char* pField, const char* key, const char* value) { return(WriteText(pField, key, value)); }
+	static char* WriteField(char* pField, const char* key, const std::string& value) { return(WriteText(pField, key, value.c_str())); }
+	template<typename VALUE>
+	static char* WriteValue(char* pField, const char* key, FIELD_TYPE type, VALUE value)
+	{
+		FIELD_HEADER header = { key, (uint32_t)type, 8 };
+		memcpy(pField, &header, sizeof(header));
+		memcpy(pField + sizeof(header), &value, 8);
+		return(pField + sizeof(header) + 8);
+	}
+	static char* WriteText(char* pField, const char* key, const char* value);
+
+	// format a record as a console line and as a JSON line
+	static void FormatRecord(const char* pRecord, int thread, std::string& line, std::string& jsonLine);
+	// write a record when the writer is not running
+	static void WriteDirect(const char* pRecord);
+	// write the contents of a file, logging an error when it
+	// could not be written
+	static void SaveFile(const std::string& path, const std::string& contents);
+	// the loop of the writer thread
+	static void WriterLoop();
+	// move the published records of all the threads to the
+	// output, true is returned when any were written
+	static bool WriteRecords();
+};
+
+/***********************************************************
+ *  Log()
+ *
+ *  This method is used for copying a message and its field
+ *  values into the ring of the calling thread.
+ ***********************************************************/
+template<typename... ARGUMENTS>
+void Logger::Log(LOG_LEVEL level, const char* message, const ARGUMENTS&... arguments)
+{
+	static_assert((sizeof...(ARGUMENTS) % 2) == 0, "the fields are passed as pairs of names and values");
+
+	size_t size = sizeof(RECORD_HEADER) + FieldsSize(arguments...);
+	char* pRecord = BeginRecord(size);
+	if (NULL == pRecord)
+	{
+		return;
+	}
+
+	RECORD_HEADER header;
+	header.size = (uint32_t)size;
+	header.level = (uint16_t)level;
+	header.fieldCount = (uint16_t)(sizeof...(ARGUMENTS) / 2);
+	header.time = GetTime();
+	header.message = message;
+	memcpy(pRecord, &header, sizeof(header));
+	WriteFields(pRecord + sizeof(header), arguments...);
+
+	EndRecord(pRecord);
+}
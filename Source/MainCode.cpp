@@ -20,8 +20,30 @@
 
 #include "SceneManager.h"
 #include "ViewManager.h"
-#include "ShapeMeshes.h"
-#include "ShaderManager.h"
+#include "GLRenderDevice.h"
+#include "NullRenderDevice.h"
+#include "MicroBenchmarks.h"
+#include "Logger.h"
+#include "VulkanRenderDevice.h"
+#include "BenchmarkHarness.h"
+#include "CaptureRenderDevice.h"
+#include "TraceReplayer.h"
+#include "PerformanceHud.h"
+#include "StartupProfiler.h"
+#include "AssetLoader.h"
+#include "HitchDetector.h"
+#include "FlightRecorder.h"
+#include "MetricsRegistry.h"
+#include "GLDebugOutput.h"
+#include "QualityTuner.h"
+#include "ReflectionProbes.h"
+#include "EnvironmentLighting.h"
+#include "LightProbeGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 
 // Namespace for declaring global variables
 namespace
@@ -34,16 +56,196 @@ namespace
 
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
+	// render device object for issuing commands to the graphics API
+	RenderDevice* g_RenderDevice = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// benchmark object for timing the frames, when enabled
+	BenchmarkHarness* g_Benchmark = nullptr;
+	// capture device wrapping the render device, when capturing
+	CaptureRenderDevice* g_CaptureDevice = nullptr;
+	// trace replayer that issues the frames instead of the scene
+	TraceReplayer* g_Replayer = nullptr;
+	// performance overlay drawn over the scene
+	PerformanceHud* g_PerformanceHud = nullptr;
+	// profiler timing the startup up to the first frame
+	StartupProfiler* g_StartupProfiler = nullptr;
+	// loader decoding the scene assets during the startup
+	AssetLoader* g_AssetLoader = nullptr;
+	// set once the startup report has been printed
+	bool g_bStartupReported = false;
+	// detector writing a trace of the recent frames on a hitch
+	HitchDetector* g_HitchDetector = nullptr;
+	// recorder keeping the recent frames in a file that outlives
+	// a crash, and the number of frames run so far
+	FlightRecorder* g_FlightRecorder = nullptr;
+	uint32_t g_FrameIndex = 0;
+
+	// registry of the runtime metrics that are exported for
+	// scraping, when enabled, and the metrics updated each frame
+	MetricsRegistry* g_Metrics = nullptr;
+	struct FRAME_METRICS
+	{
+		MetricsRegistry::Counter* pFrames;
+		MetricsRegistry::Histogram* pFrameTime;
+		MetricsRegistry::Histogram* pGpuFrameTime;
+		MetricsRegistry::Gauge* pDrawCalls;
+		MetricsRegistry::Counter* pDrawCallsTotal;
+		MetricsRegistry::Gauge* pTriangles;
+		MetricsRegistry::Gauge* pTextureBytes;
+		MetricsRegistry::Gauge* pUploadQueueDepth;
+		MetricsRegistry::Gauge* pCulledObjects;
+		MetricsRegistry::Gauge* pProbeUpdates;
+		MetricsRegistry::Counter* pHitches;
+		MetricsRegistry::Gauge* pProcessMemory;
+	};
+	FRAME_METRICS g_FrameMetrics = {};
+	// collector of the OpenGL debug messages, when enabled
+	GLDebugOutput* g_DebugOutput = nullptr;
+	// cube maps of the scene captured around the probe positions
+	ReflectionProbes* g_ReflectionProbes = nullptr;
+	// prefiltered environment of the reflective materials, when
+	// enabled
+	EnvironmentLighting* g_EnvironmentLighting = nullptr;
+	// light probes of the diffuse light around the moving
+	// objects, when enabled
+	LightProbeGrid* g_LightProbeGrid = nullptr;
+
+	// frames between the records of the process memory
+	const uint32_t MEMORY_RECORD_INTERVAL = 60;
+	// upper bounds of the frame time histogram buckets, which
+	// put the common refresh rates on bucket edges
+	const double FRAME_TIME_BUCKETS[] = { 1.0, 2.0, 4.0, 8.0, 16.7, 33.3, 50.0, 100.0, 250.0 };
+
+	// number of light sources configured in the 3D scene
+	const int SCENE_LIGHT_COUNT = 4;
+	// point that the environment is seen from when there is no
+	// reflection probe, above the middle of the scene
+	const glm::vec3 ENVIRONMENT_POSITION = glm::vec3(0.0f, 2.0f, 0.0f);
+	// frames measured by the null device when no count is given
+	const int DEFAULT_BENCHMARK_FRAMES = 1000;
+	// number of times the benchmark frames are run when they
+	// are compared with a baseline
+	const int DEFAULT_GATE_REPETITIONS = 5;
+
+	// render device backends that can be selected
+	enum DEVICE_BACKEND
+	{
+		BACKEND_GL = 0,
+		BACKEND_NULL,
+		BACKEND_VULKAN
+	};
+
+	// options that are read from the command line
+	struct APPLICATION_OPTIONS
+	{
+		DEVICE_BACKEND backend = BACKEND_GL;
+		// prefer a CPU implementation such as lavapipe for Vulkan
+		bool bPreferCpuDevice = false;
+		int benchmarkFrames = 0;
+		// number of copies of the scene drawn for stress testing
+		int sceneCopies = 1;
+		// trace file written for the given number of frames
+		const char* captureFile = NULL;
+		int captureFrames = 0;
+		// trace file replayed in place of the scene
+		const char* replayFile = NULL;
+		// show the performance overlay from the first frame
+		bool bShowHud = false;
+		// print the startup phases, and write them to this file
+		const char* startupReportFile = NULL;
+		// load the assets on the main thread after the context
+		// is created, for comparing with the overlapped startup
+		bool bSerialStartup = false;
+		// stream the assets in while benchmarking, for measuring
+		// the frame times during the streaming
+		bool bProgressive = false;
+		// time and kilobytes that the streamed uploads of one
+		// frame can take, zero keeps the scene defaults
+		double uploadBudgetMilliseconds = 0.0;
+		int uploadBudgetKilobytes = 0;
+		// multiple of the median frame time that is a hitch, a
+		// negative value keeps the default, and the directory
+		// that the hitch traces are written to
+		double hitchThreshold = -1.0;
+		const char* hitchDirectory = ".";
+		// flight recorder file written during the run, or NULL,
+		// and a file to decode instead of running
+		const char* flightRecorderFile = "flightrecorder.bin";
+		const char* decodeFile = NULL;
+		// read the hardware counters around the frame phases
+		// while benchmarking
+		bool bPerfCounters = false;
+		// JSON file that the microbenchmarks are written to and
+		// its label, or the two files that are compared
+		const char* microbenchFile = NULL;
+		const char* microbenchLabel = NULL;
+		const char* compareFiles[2] = { NULL, NULL };
+		// number of times the benchmark frames are run, or zero
+		// for the default
+		int repetitions = 0;
+		// baseline file that the benchmark is compared with, or
+		// that its results are written to
+		const char* baselineFile = NULL;
+		const char* updateBaselineFile = NULL;
+		// file that the log messages are written to as JSON
+		// lines, in addition to the console
+		const char* logFile = NULL;
+		// file and Unix socket that the metrics are exported
+		// to, and the seconds between the file exports
+		const char* metricsFile = NULL;
+		const char* metricsSocket = NULL;
+		double metricsInterval = 5.0;
+		// create an OpenGL debug context and report the messages
+		// of the debug output
+		bool bGLDebug = false;
+		// quality preset, or "auto" to choose it from a
+		// calibration, the frame time that the chosen preset
+		// has to fit in, and the file that the calibration of
+		// each machine is cached in
+		const char* qualityPreset = NULL;
+		double targetFrameMilliseconds = 16.7;
+		const char* qualityCacheFile = "qualitycache.json";
+		bool bRecalibrate = false;
+		// number of views drawn each frame, the camera view and
+		// the orthographic side views
+		int viewCount = 1;
+		// output of the left and right eye views, and the
+		// distance between the eyes in scene units
+		ViewManager::STEREO_MODE stereoMode = ViewManager::STEREO_OFF;
+		float eyeSeparation = 0.3f;
+		// positions that the reflection probes are captured at
+		int probeCount = 0;
+		glm::vec3 probePositions[ReflectionProbes::MAX_PROBES] = {};
+		// light the reflective materials with the prefiltered
+		// environment, and the file that it is cached in, or NULL
+		bool bEnvironment = true;
+		const char* environmentCacheFile = "environment.bin";
+		// light the objects with the light bounced off the scene
+		// from the baked light probes
+		bool bLightProbes = true;
+	};
+	APPLICATION_OPTIONS g_Options;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
+bool ParseCommandLine(int argc, char* argv[]);
+bool CreateScene();
+bool SelectQuality(const RenderDevice::PIPELINE_DESC& desc, QualityTuner::QUALITY_PRESET& preset, double& uploadBandwidth);
+bool StartReplay();
+void FinishAssetLoading();
+void BuildEnvironment();
+void ReportStartup();
+void RecordFlightData(double frameMilliseconds, bool bGpuTime, double gpuMilliseconds, bool bHitch);
+bool StartMetrics();
+void UpdateMetrics(double frameMilliseconds, bool bGpuTime, double gpuMilliseconds, bool bHitch);
+void BeginBenchmarkPhase(BenchmarkHarness::FRAME_PHASE phase);
+void EndBenchmarkPhase(BenchmarkHarness::FRAME_PHASE phase);
+bool UseProgressiveLoading();
 bool InitializeGLFW();
 bool InitializeGLEW();
+bool IsRunning();
 
 
 /***********************************************************
@@ -54,63 +256,454 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// the startup is timed from here to the first presented frame
+	g_StartupProfiler = new StartupProfiler();
+
+	// if the command line is not valid, then terminate the application
+	if (ParseCommandLine(argc, argv) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// the log messages are written by a background thread, which
+	// writes the remaining messages when the application exits
+	if (Logger::Start(g_Options.logFile) == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	atexit(Logger::Stop);
+
+	// print a flight recorder file left by an earlier run
+	if (NULL != g_Options.decodeFile)
+	{
+		return(FlightRecorder::Decode(g_Options.decodeFile) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// compare the results of two microbenchmark runs
+	if (NULL != g_Options.compareFiles[0])
+	{
+		return(MicroBenchmarks::Compare(g_Options.compareFiles[0], g_Options.compareFiles[1]) ?
+			EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// time the hot functions of the scene and view code on
+	// their own, the view code reads the GLFW timer
+	if (NULL != g_Options.microbenchFile)
+	{
+		if (InitializeGLFW() == false)
+		{
+			LOG_ERROR("the microbenchmarks could not initialize GLFW");
+			return(EXIT_FAILURE);
+		}
+		MicroBenchmarks* pMicroBenchmarks = new MicroBenchmarks();
+		pMicroBenchmarks->Run();
+		bool bWritten = pMicroBenchmarks->WriteReport(g_Options.microbenchFile, g_Options.microbenchLabel);
+		delete pMicroBenchmarks;
+		glfwTerminate();
+		return(bWritten ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	// the flight recorder is opened first, so that it holds the
+	// events of a run that fails during the startup
+	if (NULL != g_Options.flightRecorderFile)
+	{
+		g_FlightRecorder = new FlightRecorder();
+		g_FlightRecorder->Open(g_Options.flightRecorderFile);
+		g_FlightRecorder->RecordEvent(0, "startup");
+	}
+
+	// start decoding the scene assets on worker threads, so
+	// that only their upload waits for the graphics context
+	if ((NULL == g_Options.replayFile) && (g_Options.bSerialStartup == false))
+	{
+		g_AssetLoader = new AssetLoader(g_StartupProfiler);
+		// the streamed textures are uploaded a mip level at a time
+		g_AssetLoader->SetGenerateMipLevels(UseProgressiveLoading());
+		g_AssetLoader->Start(SceneManager::GetTextureFiles());
+	}
+
 	// if GLFW fails initialization, then terminate the application
+	g_StartupProfiler->BeginPhase("InitializeGLFW");
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
+	g_StartupProfiler->EndPhase();
 
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
+	// try to create a new render device object - the null device
+	// records the commands without a window or OpenGL context
+#ifdef ENABLE_VULKAN
+	VulkanRenderDevice* pVulkanDevice = NULL;
+#endif
+	switch (g_Options.backend)
+	{
+	case BACKEND_NULL:
+		g_RenderDevice = new NullRenderDevice();
+		break;
+#ifdef ENABLE_VULKAN
+	case BACKEND_VULKAN:
+		// the swapchain is presented without waiting for the
+		// vertical blank while benchmarking or replaying
+		pVulkanDevice = new VulkanRenderDevice(
+			g_Options.bPreferCpuDevice,
+			(g_Options.benchmarkFrames > 0) || (NULL != g_Options.replayFile));
+		g_RenderDevice = pVulkanDevice;
+		// the Vulkan window does not have an OpenGL context
+		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+		break;
+#endif
+	default:
+		g_RenderDevice = new GLRenderDevice();
+		break;
+	}
+	// the capture device passes the commands through to the
+	// render device, writing them into the trace
+	if (NULL != g_Options.captureFile)
+	{
+		g_CaptureDevice = new CaptureRenderDevice(
+			g_RenderDevice,
+			g_Options.captureFile,
+			g_Options.captureFrames);
+		g_RenderDevice = g_CaptureDevice;
+	}
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_RenderDevice);
+	g_ViewManager->SetViewCount(g_Options.viewCount);
+	if (g_Options.stereoMode != ViewManager::STEREO_OFF)
+	{
+		g_ViewManager->SetStereo(g_Options.stereoMode, g_Options.eyeSeparation);
+	}
+
+	if (g_Options.backend != BACKEND_NULL)
+	{
+		// try to create the main display window
+		g_StartupProfiler->BeginPhase("CreateDisplayWindow");
+		g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+		if (NULL == g_Window)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_StartupProfiler->EndPhase();
+	}
+
+	if (g_Options.backend == BACKEND_GL)
+	{
+		// if GLEW fails initialization, then terminate the application
+		g_StartupProfiler->BeginPhase("InitializeGLEW");
+		if (InitializeGLEW() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_StartupProfiler->EndPhase();
+
+		// count the driver messages, such as the performance
+		// warnings, for the report at the end of the run
+		if (g_Options.bGLDebug)
+		{
+			g_DebugOutput = new GLDebugOutput();
+			if (g_DebugOutput->Install() == false)
+			{
+				delete g_DebugOutput;
+				g_DebugOutput = NULL;
+			}
+		}
+
+		// do not wait for the vertical blank while benchmarking,
+		// and replay the trace as fast as possible
+		if ((g_Options.benchmarkFrames > 0) || (NULL != g_Options.replayFile))
+		{
+			glfwSwapInterval(0);
+		}
+	}
+#ifdef ENABLE_VULKAN
+	else if (NULL != pVulkanDevice)
+	{
+		pVulkanDevice->SetWindow(g_Window);
+	}
+#endif
 
-	// try to create the main display window
-	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	g_StartupProfiler->BeginPhase("InitializeRenderDevice");
+	if (g_RenderDevice->Initialize() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+	g_StartupProfiler->EndPhase();
 
-	// if GLEW fails initialization, then terminate the application
-	if (InitializeGLEW() == false)
+	// a replayed trace creates its own pipelines and textures,
+	// and issues the captured frames in place of the scene
+	if (NULL != g_Options.replayFile)
+	{
+		g_StartupProfiler->BeginPhase("StartReplay");
+		if (StartReplay() == false)
+		{
+			return(EXIT_FAILURE);
+		}
+		g_StartupProfiler->EndPhase();
+		g_StartupProfiler->MarkSceneComplete();
+	}
+	else if (CreateScene() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	// the overlay can be shown with the F1 key at any time
+	g_PerformanceHud = new PerformanceHud(g_RenderDevice);
+	g_PerformanceHud->SetVisible(g_Options.bShowHud);
+	g_ViewManager->SetPerformanceHud(g_PerformanceHud);
 
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+	if (g_Options.benchmarkFrames > 0)
+	{
+		g_Benchmark = new BenchmarkHarness(g_Options.benchmarkFrames, g_RenderDevice->GetName());
+		if (g_Options.bPerfCounters)
+		{
+			g_Benchmark->EnableCounters();
+		}
+		g_Benchmark->SetRepetitions(g_Options.repetitions);
+	}
 
-	// loop will keep running until the application is closed 
-	// or until an error has occurred
-	while (!glfwWindowShouldClose(g_Window))
+	// the hitch detector is always on unless turned off
+	g_HitchDetector = new HitchDetector();
+	if (g_Options.hitchThreshold >= 0.0)
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		g_HitchDetector->SetThreshold(g_Options.hitchThreshold);
+	}
+	g_HitchDetector->SetOutputDirectory(g_Options.hitchDirectory);
+	g_HitchDetector->SetSceneCopies(g_Options.sceneCopies);
+
+	if (StartMetrics() == false)
+	{
+		return(EXIT_FAILURE);
+	}
+
+	// loop will keep running until the application is closed,
+	// the benchmark has finished, or until an error has occurred
+	while (IsRunning())
+	{
+		if (NULL != g_DebugOutput)
+		{
+			g_DebugOutput->SetFrame(g_FrameIndex);
+		}
+		if (NULL != g_Benchmark)
+		{
+			g_Benchmark->BeginFrame();
+		}
+		std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+		g_PerformanceHud->BeginFrame();
+		g_HitchDetector->BeginFrame();
+
+		if (NULL != g_Replayer)
+		{
+			// issue the commands of the next captured frame
+			g_HitchDetector->BeginZone("ReplayFrame");
+			BeginBenchmarkPhase(BenchmarkHarness::PHASE_SCENE);
+			g_Replayer->ReplayFrame(g_RenderDevice);
+			EndBenchmarkPhase(BenchmarkHarness::PHASE_SCENE);
+			g_HitchDetector->EndZone();
+		}
+		else
+		{
+			// swap in the assets that finished loading since the
+			// last frame, in place of their placeholders
+			if (NULL != g_AssetLoader)
+			{
+				g_HitchDetector->BeginZone("LoadArrivedAssets");
+				bool bComplete = g_SceneManager->LoadArrivedAssets();
+				g_HitchDetector->EndZone();
+				const SceneManager::UPLOAD_STATS& uploadStats = g_SceneManager->GetUploadStats();
+				g_PerformanceHud->SetUploadQueue(uploadStats.queuedAssets, uploadStats.deferredBytes);
+				if (NULL != g_Benchmark)
+				{
+					g_Benchmark->SetStreaming(bComplete == false);
+				}
+				if (bComplete)
+				{
+					FinishAssetLoading();
+				}
+			}
+
+			// Clear the frame and z buffers
+			g_HitchDetector->BeginZone("BeginFrame");
+			g_RenderDevice->BeginFrame();
+			g_HitchDetector->EndZone();
+
+			// draw the scene into the cube maps of the probes that
+			// are out of date, before the views of the frame
+			if (g_ReflectionProbes->NeedsCapture())
+			{
+				g_HitchDetector->BeginZone("CaptureProbes");
+				g_ReflectionProbes->CaptureProbes();
+				g_HitchDetector->EndZone();
+				g_HitchDetector->BeginZone("BuildEnvironment");
+				BuildEnvironment();
+				g_HitchDetector->EndZone();
+			}
 
-		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			// convert from 3D object space to 2D view
+			g_HitchDetector->BeginZone("PrepareSceneView");
+			BeginBenchmarkPhase(BenchmarkHarness::PHASE_VIEW);
+			g_ViewManager->PrepareSceneView();
+			// the scene is culled once against all of the views
+			g_SceneManager->SetCullingViews(g_ViewManager->GetCameraData(), g_ViewManager->GetViewCount());
+			EndBenchmarkPhase(BenchmarkHarness::PHASE_VIEW);
+			g_HitchDetector->EndZone();
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+			// refresh the 3D scene
+			g_HitchDetector->BeginZone("RenderScene");
+			BeginBenchmarkPhase(BenchmarkHarness::PHASE_SCENE);
+			g_SceneManager->RenderScene();
+			g_ViewManager->FinishSceneView();
+			EndBenchmarkPhase(BenchmarkHarness::PHASE_SCENE);
+			g_HitchDetector->EndZone();
+			g_PerformanceHud->SetCulledObjects(g_SceneManager->GetCulledObjects());
+		}
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+		// draw the performance overlay over the finished scene
+		g_HitchDetector->BeginZone("PerformanceHud");
+		g_PerformanceHud->Render();
+		g_HitchDetector->EndZone();
 
+		if (NULL != g_Benchmark)
+		{
+			g_Benchmark->EndScene();
+		}
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+		g_HitchDetector->BeginZone("EndFrame");
+		BeginBenchmarkPhase(BenchmarkHarness::PHASE_SUBMIT);
+		g_RenderDevice->EndFrame();
+		EndBenchmarkPhase(BenchmarkHarness::PHASE_SUBMIT);
+		g_HitchDetector->EndZone();
+
+		if (NULL != g_Window)
+		{
+			// Flips the the back buffer with the front buffer every frame,
+			// the Vulkan device presents its swapchain image in EndFrame
+			if (g_Options.backend == BACKEND_GL)
+			{
+				g_HitchDetector->BeginZone("SwapBuffers");
+				BeginBenchmarkPhase(BenchmarkHarness::PHASE_SUBMIT);
+				glfwSwapBuffers(g_Window);
+				EndBenchmarkPhase(BenchmarkHarness::PHASE_SUBMIT);
+				g_HitchDetector->EndZone();
+			}
+
+			// query the latest GLFW events
+			g_HitchDetector->BeginZone("PollEvents");
+			BeginBenchmarkPhase(BenchmarkHarness::PHASE_INPUT);
+			glfwPollEvents();
+			EndBenchmarkPhase(BenchmarkHarness::PHASE_INPUT);
+			g_HitchDetector->EndZone();
+		}
+
+		if (g_bStartupReported == false)
+		{
+			ReportStartup();
+		}
+
+		if (NULL != g_Benchmark)
+		{
+			g_Benchmark->EndFrame(g_RenderDevice->GetStats());
+		}
+
+		// compare the frame with the recent frames
+		glm::vec3 cameraPosition;
+		glm::vec3 cameraFront;
+		double gpuMilliseconds = 0.0;
+		bool bGpuTime = g_RenderDevice->GetGpuFrameTime(gpuMilliseconds);
+		g_ViewManager->GetCameraPose(cameraPosition, cameraFront);
+		g_HitchDetector->SetCameraPose(cameraPosition, cameraFront);
+		bool bHitch = g_HitchDetector->EndFrame(g_RenderDevice->GetStats(), bGpuTime, gpuMilliseconds);
+
+		double frameMilliseconds = std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - frameStart).count();
+		RecordFlightData(frameMilliseconds, bGpuTime, gpuMilliseconds, bHitch);
+		UpdateMetrics(frameMilliseconds, bGpuTime, gpuMilliseconds, bHitch);
+		g_FrameIndex++;
+	}
+
+	if (NULL != g_DebugOutput)
+	{
+		Logger::Flush();
+		g_DebugOutput->Report();
+	}
 
-		// query the latest GLFW events
-		glfwPollEvents();
+	// the run fails when the benchmark regressed
+	int exitCode = EXIT_SUCCESS;
+	if (NULL != g_Benchmark)
+	{
+		if (g_StartupProfiler->HasFirstFrame())
+		{
+			g_Benchmark->SetStartupMilliseconds(g_StartupProfiler->GetFirstFrameMilliseconds());
+		}
+		Logger::Flush();
+		g_Benchmark->Report();
+		if (NULL != g_Options.updateBaselineFile)
+		{
+			g_Benchmark->WriteBaseline(g_Options.updateBaselineFile);
+		}
+		if ((NULL != g_Options.baselineFile) && (g_Benchmark->CheckBaseline(g_Options.baselineFile) == false))
+		{
+			exitCode = EXIT_FAILURE;
+		}
+		delete g_Benchmark;
+		g_Benchmark = NULL;
 	}
 
-	// clear the allocated manager objects from memory
+	// clear the allocated manager objects from memory, the
+	// loader waits for any asset that is still being loaded
+	if (NULL != g_AssetLoader)
+	{
+		delete g_AssetLoader;
+		g_AssetLoader = NULL;
+	}
+	if (NULL != g_Metrics)
+	{
+		// the metrics file is written a last time when freed
+		delete g_Metrics;
+		g_Metrics = NULL;
+	}
+	if (NULL != g_HitchDetector)
+	{
+		delete g_HitchDetector;
+		g_HitchDetector = NULL;
+	}
+	if (NULL != g_FlightRecorder)
+	{
+		// the file is marked as closed normally when freed
+		g_FlightRecorder->RecordEvent(g_FrameIndex, "exit");
+		delete g_FlightRecorder;
+		g_FlightRecorder = NULL;
+	}
+	if (NULL != g_StartupProfiler)
+	{
+		delete g_StartupProfiler;
+		g_StartupProfiler = NULL;
+	}
+	if (NULL != g_PerformanceHud)
+	{
+		delete g_PerformanceHud;
+		g_PerformanceHud = NULL;
+	}
+	if (NULL != g_Replayer)
+	{
+		delete g_Replayer;
+		g_Replayer = NULL;
+	}
+	if (NULL != g_EnvironmentLighting)
+	{
+		delete g_EnvironmentLighting;
+		g_EnvironmentLighting = NULL;
+	}
+	if (NULL != g_LightProbeGrid)
+	{
+		delete g_LightProbeGrid;
+		g_LightProbeGrid = NULL;
+	}
+	if (NULL != g_ReflectionProbes)
+	{
+		delete g_ReflectionProbes;
+		g_ReflectionProbes = NULL;
+	}
 	if (NULL != g_SceneManager)
 	{
 		delete g_SceneManager;
@@ -121,14 +714,945 @@ int main(int argc, char* argv[])
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
-	if (NULL != g_ShaderManager)
+	if (NULL != g_RenderDevice)
+	{
+		// the capture device writes any unfinished trace and
+		// frees the render device that it wraps
+		delete g_RenderDevice;
+		g_RenderDevice = NULL;
+		g_CaptureDevice = NULL;
+	}
+	if (NULL != g_DebugOutput)
+	{
+		// the callback is kept until the render device has freed
+		// its objects, then removed
+		delete g_DebugOutput;
+		g_DebugOutput = NULL;
+	}
+
+	// Terminates the program
+	exit(exitCode);
+}
+
+/***********************************************************
+ *	CreateScene()
+ *
+ *  This function is used to create the shader pipeline and
+ *  prepare the 3D scene.
+ ***********************************************************/
+bool CreateScene()
+{
+	// load the shader code, using the offline compiled SPIR-V
+	// binaries when they are available
+	RenderDevice::PIPELINE_DESC pipelineDesc;
+	pipelineDesc.vertexShaderPath = "shaders/vertexShader.glsl";
+	pipelineDesc.fragmentShaderPath = "shaders/fragmentShader.glsl";
+	pipelineDesc.vertexBinaryPath = "shaders/vertexShader.spv";
+	pipelineDesc.fragmentBinaryPath = "shaders/fragmentShader.spv";
+	pipelineDesc.vulkanVertexBinaryPath = "shaders/vertexShader.vk.spv";
+	pipelineDesc.vulkanFragmentBinaryPath = "shaders/fragmentShader.vk.spv";
+	pipelineDesc.activeLights = SCENE_LIGHT_COUNT;
+	pipelineDesc.bEnableLighting = true;
+	pipelineDesc.bEnableSpecular = true;
+
+	// the lights, specular term and mesh detail of the scene
+	// come from the quality preset
+	QualityTuner::QUALITY_PRESET preset = QualityTuner::PRESET_ULTRA;
+	double uploadBandwidth = 0.0;
+	if (SelectQuality(pipelineDesc, preset, uploadBandwidth) == false)
+	{
+		return(false);
+	}
+	const QualityTuner::QUALITY_SETTINGS& quality = QualityTuner::GetSettings(preset);
+	// the loader generates the meshes at the detail of the preset
+	if (NULL != g_AssetLoader)
+	{
+		g_AssetLoader->StartMeshes(quality.meshDetail);
+	}
+	pipelineDesc.activeLights = std::min(quality.lightCount, SCENE_LIGHT_COUNT);
+	pipelineDesc.bEnableSpecular = quality.bSpecular;
+
+	g_StartupProfiler->BeginPhase("LoadShaders");
+	uint32_t pipeline = g_RenderDevice->CreatePipeline(pipelineDesc);
+	g_StartupProfiler->EndPhase();
+	if (pipeline == 0)
+	{
+		std::cerr << "Failed to create the shader pipeline" << std::endl;
+		return(false);
+	}
+	g_RenderDevice->BindPipeline(pipeline);
+
+	// try to create a new scene manager object and prepare the 3D scene,
+	// the first frames are drawn with placeholders while the assets
+	// load, except when benchmarking or capturing, which need the
+	// complete scene from the first frame
+	g_SceneManager = new SceneManager(g_RenderDevice);
+	g_SceneManager->SetStartupProfiler(g_StartupProfiler);
+	g_SceneManager->SetAssetLoader(g_AssetLoader);
+	g_SceneManager->SetMeshDetail(quality.meshDetail);
+	g_SceneManager->SetProgressiveLoading(UseProgressiveLoading());
+	if (g_Options.uploadBudgetMilliseconds > 0.0)
+	{
+		g_SceneManager->SetUploadBudget(
+			g_Options.uploadBudgetMilliseconds,
+			(size_t)g_Options.uploadBudgetKilobytes * 1024);
+	}
+	else if (uploadBandwidth > 0.0)
+	{
+		// the bytes that the measured bandwidth uploads in the
+		// time that the uploads of a frame can take
+		double milliseconds = g_SceneManager->GetUploadBudgetMilliseconds();
+		g_SceneManager->SetUploadBudget(milliseconds, (size_t)(uploadBandwidth * 1024.0 * milliseconds));
+	}
+	g_StartupProfiler->BeginPhase("PrepareScene");
+	g_SceneManager->PrepareScene();
+	g_StartupProfiler->EndPhase();
+	g_SceneManager->SetSceneCopies(g_Options.sceneCopies);
+
+	// the probes are captured at the start of the first frame
+	g_ReflectionProbes = new ReflectionProbes(g_RenderDevice, g_SceneManager);
+	for (int i = 0; i < g_Options.probeCount; i++)
+	{
+		g_ReflectionProbes->AddProbe(g_Options.probePositions[i]);
+	}
+
+	// the environment is drawn from the lights until a probe
+	// has been captured
+	if (g_Options.bEnvironment)
+	{
+		g_EnvironmentLighting = new EnvironmentLighting(g_RenderDevice);
+		g_EnvironmentLighting->SetCacheFile(g_Options.environmentCacheFile);
+		g_StartupProfiler->BeginPhase("BuildEnvironment");
+		BuildEnvironment();
+		g_StartupProfiler->EndPhase();
+	}
+
+	// the probes are baked once, the objects blend them again
+	// whenever they move
+	if (g_Options.bLightProbes)
+	{
+		g_LightProbeGrid = new LightProbeGrid();
+		g_StartupProfiler->BeginPhase("BakeLightProbes");
+		g_SceneManager->BakeLightProbes(g_LightProbeGrid);
+		g_StartupProfiler->EndPhase();
+	}
+
+	if ((NULL == g_AssetLoader) || g_SceneManager->LoadArrivedAssets())
+	{
+		FinishAssetLoading();
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *	SelectQuality()
+ *
+ *  This function is used to choose the quality preset of
+ *  the scene.  A preset given on the command line is used
+ *  as it is, and the benchmark and capture runs keep the
+ *  full quality so that they can be compared between
+ *  machines.  Otherwise the preset is chosen from the
+ *  calibration of this machine, which is run with a full
+ *  quality pipeline when it is not in the cache, and the
+ *  pipeline is freed afterwards.  The measured upload
+ *  bandwidth, in megabytes per second, is passed back for
+ *  sizing the streamed uploads.
+ ***********************************************************/
+bool SelectQuality(const RenderDevice::PIPELINE_DESC& desc, QualityTuner::QUALITY_PRESET& preset, double& uploadBandwidth)
+{
+	preset = QualityTuner::PRESET_ULTRA;
+	uploadBandwidth = 0.0;
+
+	bool bAutomatic = (NULL == g_Options.qualityPreset) ?
+		((g_Options.benchmarkFrames <= 0) && (NULL == g_Options.captureFile)) :
+		(strcmp(g_Options.qualityPreset, "auto") == 0);
+	if (bAutomatic == false)
+	{
+		if (NULL != g_Options.qualityPreset)
+		{
+			QualityTuner::FindPreset(g_Options.qualityPreset, preset);
+		}
+		return(true);
+	}
+
+	QualityTuner* pTuner = new QualityTuner(g_RenderDevice, g_Options.targetFrameMilliseconds);
+	if (g_Options.bRecalibrate || (pTuner->LoadCache(g_Options.qualityCacheFile) == false))
+	{
+		g_StartupProfiler->BeginPhase("CalibrateQuality");
+		uint32_t pipeline = g_RenderDevice->CreatePipeline(desc);
+		if (pipeline == 0)
+		{
+			std::cerr << "Failed to create the shader pipeline" << std::endl;
+			delete pTuner;
+			return(false);
+		}
+		g_RenderDevice->BindPipeline(pipeline);
+		pTuner->Calibrate();
+		pTuner->SaveCache(g_Options.qualityCacheFile);
+		// the scene pipeline is created and bound for the chosen
+		// preset once the calibration is done
+		g_RenderDevice->DestroyPipeline(pipeline);
+		g_StartupProfiler->EndPhase();
+	}
+
+	preset = pTuner->ChoosePreset(g_Options.sceneCopies);
+	uploadBandwidth = pTuner->GetResults().uploadMegabytesPerSecond;
+	delete pTuner;
+	return(true);
+}
+
+/***********************************************************
+ *	StartReplay()
+ *
+ *  This function is used to load the trace file that is
+ *  replayed, and to create the resources it uses.
+ ***********************************************************/
+bool StartReplay()
+{
+	g_Replayer = new TraceReplayer();
+	if ((g_Replayer->Load(g_Options.replayFile) == false) ||
+		(g_Replayer->ReplaySetup(g_RenderDevice) == false))
+	{
+		return(false);
+	}
+
+	// time each captured frame once when no count is given
+	if (g_Options.benchmarkFrames <= 0)
+	{
+		g_Options.benchmarkFrames = g_Replayer->GetFrameCount();
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *	FinishAssetLoading()
+ *
+ *  This function is used to free the asset loader once the
+ *  scene has taken all of its assets, and to record the
+ *  time at which the scene was complete.
+ ***********************************************************/
+void FinishAssetLoading()
+{
+	g_SceneManager->SetStartupProfiler(NULL);
+	g_SceneManager->SetAssetLoader(NULL);
+	if (NULL != g_AssetLoader)
+	{
+		delete g_AssetLoader;
+		g_AssetLoader = NULL;
+	}
+	g_StartupProfiler->MarkSceneComplete();
+	// the probes captured with the placeholders are out of date
+	g_ReflectionProbes->Invalidate();
+
+	if (NULL != g_FlightRecorder)
+	{
+		g_FlightRecorder->RecordEvent(g_FrameIndex, "scene complete");
+	}
+}
+
+/***********************************************************
+ *	BuildEnvironment()
+ *
+ *  This function is used to build the environment lighting
+ *  of the reflective materials, from the first reflection
+ *  probe once it has been captured, or from the lights of
+ *  the scene when there is no probe or the render device
+ *  cannot read it back.
+ ***********************************************************/
+void BuildEnvironment()
+{
+	if (NULL == g_EnvironmentLighting)
+	{
+		return;
+	}
+
+	bool bBuilt = g_EnvironmentLighting->BuildFromTarget(g_ReflectionProbes->GetProbeTarget(0));
+	if (bBuilt == false)
+	{
+		glm::vec3 position = (g_ReflectionProbes->GetProbeCount() > 0) ?
+			g_ReflectionProbes->GetProbePosition(0) : ENVIRONMENT_POSITION;
+		bBuilt = g_EnvironmentLighting->BuildFromLights(g_SceneManager->GetLightData(), position);
+	}
+
+	if (bBuilt)
+	{
+		g_SceneManager->SetEnvironmentLighting(g_EnvironmentLighting);
+	}
+}
+
+/***********************************************************
+ *	ReportStartup()
+ *
+ *  This function is used to record the time to the first
+ *  presented frame, once the first frame has been swapped,
+ *  and to report the startup phases once the scene is also
+ *  complete.  The OpenGL commands are finished first so that
+ *  the time includes the GPU work of the frame and not only
+ *  its submission.
+ ***********************************************************/
+void ReportStartup()
+{
+	if (g_StartupProfiler->HasFirstFrame() == false)
+	{
+		if (g_Options.backend == BACKEND_GL)
+		{
+			glFinish();
+		}
+		g_StartupProfiler->MarkFirstFrame();
+		if (NULL != g_FlightRecorder)
+		{
+			g_FlightRecorder->RecordEvent(g_FrameIndex, "first frame presented");
+		}
+	}
+
+	if (g_StartupProfiler->HasSceneComplete() == false)
+	{
+		return;
+	}
+	g_bStartupReported = true;
+
+	if (NULL != g_Options.startupReportFile)
+	{
+		Logger::Flush();
+		g_StartupProfiler->Report(g_RenderDevice->GetName());
+		if (g_Options.startupReportFile[0] != '\0')
+		{
+			g_StartupProfiler->WriteReport(g_Options.startupReportFile, g_RenderDevice->GetName());
+		}
+	}
+}
+
+/***********************************************************
+ *	RecordFlightData()
+ *
+ *  This function is used to write the timing and counters
+ *  of the frame to the flight recorder, along with any
+ *  graphics API error raised during the frame, and the
+ *  process memory every few frames.
+ ***********************************************************/
+void RecordFlightData(double frameMilliseconds, bool bGpuTime, double gpuMilliseconds, bool bHitch)
+{
+	if (NULL == g_FlightRecorder)
+	{
+		return;
+	}
+
+	const RenderDevice::RENDER_STATS& stats = g_RenderDevice->GetStats();
+	g_FlightRecorder->RecordFrame(
+		g_FrameIndex,
+		(float)frameMilliseconds,
+		bGpuTime ? (float)gpuMilliseconds : -1.0f,
+		stats.drawCalls,
+		stats.triangles);
+
+	uint32_t error = g_RenderDevice->GetError();
+	if (error != 0)
+	{
+		g_FlightRecorder->RecordError(g_FrameIndex, error);
+	}
+
+	if ((g_FrameIndex % MEMORY_RECORD_INTERVAL) == 0)
+	{
+		g_FlightRecorder->RecordMemory(g_FrameIndex, PerformanceHud::GetProcessMemory());
+	}
+
+	if (bHitch)
+	{
+		g_FlightRecorder->RecordEvent(g_FrameIndex, "hitch trace written");
+	}
+}
+
+/***********************************************************
+ *	StartMetrics()
+ *
+ *  This function is used to register the runtime metrics
+ *  and start exporting them, when a metrics file or socket
+ *  was given on the command line.
+ ***********************************************************/
+bool StartMetrics()
+{
+	if ((NULL == g_Options.metricsFile) && (NULL == g_Options.metricsSocket))
+	{
+		return(true);
+	}
+
+	g_Metrics = new MetricsRegistry();
+	g_Metrics->AddLabel("device", g_RenderDevice->GetName());
+
+	g_FrameMetrics.pFrames = g_Metrics->AddCounter(
+		"app_frames_total", "Frames drawn since the start.");
+	g_FrameMetrics.pFrameTime = g_Metrics->AddHistogram(
+		"app_frame_time_milliseconds", "CPU time of each frame.",
+		FRAME_TIME_BUCKETS, sizeof(FRAME_TIME_BUCKETS) / sizeof(FRAME_TIME_BUCKETS[0]));
+	g_FrameMetrics.pGpuFrameTime = g_Metrics->AddHistogram(
+		"app_gpu_frame_time_milliseconds", "GPU time of each frame, when the device measures it.",
+		FRAME_TIME_BUCKETS, sizeof(FRAME_TIME_BUCKETS) / sizeof(FRAME_TIME_BUCKETS[0]));
+	g_FrameMetrics.pDrawCalls = g_Metrics->AddGauge(
+		"app_draw_calls", "Draw calls of the last frame.");
+	g_FrameMetrics.pDrawCallsTotal = g_Metrics->AddCounter(
+		"app_draw_calls_total", "Draw calls since the start.");
+	g_FrameMetrics.pTriangles = g_Metrics->AddGauge(
+		"app_triangles", "Triangles drawn in the last frame.");
+	g_FrameMetrics.pTextureBytes = g_Metrics->AddGauge(
+		"app_texture_bytes", "Bytes of the image data of the loaded textures.");
+	g_FrameMetrics.pUploadQueueDepth = g_Metrics->AddGauge(
+		"app_upload_queue_depth", "Loaded assets waiting for a later frame to be uploaded.");
+	g_FrameMetrics.pCulledObjects = g_Metrics->AddGauge(
+		"app_culled_objects", "Objects outside all of the views in the last frame.");
+	g_FrameMetrics.pProbeUpdates = g_Metrics->AddGauge(
+		"app_probe_updates", "Objects that the light probes were blended for in the last frame.");
+	g_FrameMetrics.pHitches = g_Metrics->AddCounter(
+		"app_hitches_total", "Frames reported as hitches since the start.");
+	g_FrameMetrics.pProcessMemory = g_Metrics->AddGauge(
+		"app_process_memory_bytes", "Resident memory of the process.");
+
+	return(g_Metrics->StartExport(g_Options.metricsFile, g_Options.metricsSocket, g_Options.metricsInterval));
+}
+
+/***********************************************************
+ *	UpdateMetrics()
+ *
+ *  This function is used to update the runtime metrics with
+ *  the counters of the frame.  The updates are atomic and do
+ *  not allocate, the export thread formats them.
+ ***********************************************************/
+void UpdateMetrics(double frameMilliseconds, bool bGpuTime, double gpuMilliseconds, bool bHitch)
+{
+	if (NULL == g_Metrics)
+	{
+		return;
+	}
+
+	const RenderDevice::RENDER_STATS& stats = g_RenderDevice->GetStats();
+	g_FrameMetrics.pFrames->Increment();
+	g_FrameMetrics.pFrameTime->Observe(frameMilliseconds);
+	if (bGpuTime)
+	{
+		g_FrameMetrics.pGpuFrameTime->Observe(gpuMilliseconds);
+	}
+	g_FrameMetrics.pDrawCalls->Set(stats.drawCalls);
+	g_FrameMetrics.pDrawCallsTotal->Increment(stats.drawCalls);
+	g_FrameMetrics.pTriangles->Set(stats.triangles);
+	if (bHitch)
+	{
+		g_FrameMetrics.pHitches->Increment();
+	}
+
+	if (NULL != g_SceneManager)
+	{
+		g_FrameMetrics.pTextureBytes->Set((double)g_SceneManager->GetTextureBytes());
+		g_FrameMetrics.pUploadQueueDepth->Set(g_SceneManager->GetUploadStats().queuedAssets);
+		g_FrameMetrics.pCulledObjects->Set(g_SceneManager->GetCulledObjects());
+		g_FrameMetrics.pProbeUpdates->Set(g_SceneManager->GetProbeUpdates());
+	}
+
+	if ((g_FrameIndex % MEMORY_RECORD_INTERVAL) == 0)
+	{
+		g_FrameMetrics.pProcessMemory->Set((double)PerformanceHud::GetProcessMemory());
+	}
+}
+
+/***********************************************************
+ *	BeginBenchmarkPhase()
+ *	EndBenchmarkPhase()
+ *
+ *  These functions are used to mark a phase of the frame
+ *  that the benchmark reads the hardware counters around.
+ ***********************************************************/
+void BeginBenchmarkPhase(BenchmarkHarness::FRAME_PHASE phase)
+{
+	if (NULL != g_Benchmark)
+	{
+		g_Benchmark->BeginPhase(phase);
+	}
+}
+
+void EndBenchmarkPhase(BenchmarkHarness::FRAME_PHASE phase)
+{
+	if (NULL != g_Benchmark)
+	{
+		g_Benchmark->EndPhase(phase);
+	}
+}
+
+/***********************************************************
+ *	ParseCommandLine()
+ *
+ *  This function is used to read the options passed on the
+ *  command line:
+ *    --device gl|vulkan|vulkan-cpu|null
+ *                         select the render device backend, the
+ *                         vulkan-cpu backend prefers a CPU driver
+ *                         such as lavapipe over the GPUs
+ *    --benchmark frames   time the given number of frames
+ *    --stress copies      draw the given number of scene copies
+ *    --capture file frames
+ *                         write the render device commands of the
+ *                         given number of frames to a trace file
+ *    --replay file        issue the frames of a trace file in place
+ *                         of the scene, timing each frame
+ *    --hud                show the performance overlay, which can
+ *                         also be toggled with the F1 key
+ *    --startup-report [file]
+ *                         print the time of each startup phase and
+ *                         the time to the first frame, and write
+ *                         them to a JSON file when one is given
+ *    --serial-startup     decode the assets after the window and
+ *                         context are created instead of during
+ *    --progressive        draw placeholders while the assets stream
+ *                         in, also when benchmarking
+ *    --upload-budget ms kilobytes
+ *                         limit the streamed uploads of each frame
+ *    --hitch-threshold multiple
+ *                         write a trace of the last seconds when a
+ *                         frame takes this multiple of the median
+ *                         frame time, zero turns the detector off
+ *    --hitch-dir directory
+ *                         directory that the hitch traces go to
+ *    --flight-recorder file|off
+ *                         file that the recent frames are kept in,
+ *                         flightrecorder.bin when not given
+ *    --decode-flight-recorder file
+ *                         print the records of a flight recorder
+ *                         file and exit
+ *    --perf-counters      report the hardware counters of the input,
+ *                         view, scene and submit phases of the frame
+ *                         when benchmarking, on Linux
+ *    --microbench file    time the hot scene and view functions on
+ *                         their own, write the results to a JSON
+ *                         file and exit
+ *    --microbench-label name
+ *                         name of the build or implementation that
+ *                         is written into the microbenchmark file
+ *    --microbench-compare base file
+ *                         print the results of two microbenchmark
+ *                         files side by side and exit
+ *    --repetitions count  run the benchmark frames the given number
+ *                         of times, for the confidence intervals
+ *    --baseline file      compare the benchmark with a baseline file
+ *                         and fail when a metric regressed
+ *    --update-baseline file
+ *                         write the benchmark results to a baseline
+ *                         file
+ *    --log-file file      also write the log messages to a file, one
+ *                         JSON object on each line
+ *    --metrics-file file  write the runtime metrics to a file in the
+ *                         Prometheus text format every few seconds
+ *    --metrics-socket path
+ *                         answer each connection to a Unix socket
+ *                         with the runtime metrics
+ *    --metrics-interval seconds
+ *                         seconds between the metrics file writes,
+ *                         5 when not given
+ *    --gl-debug           create an OpenGL debug context, and report
+ *                         the debug messages of the driver, counted
+ *                         by kind, at the end of the run
+ *    --quality low|medium|high|ultra|auto
+ *                         quality preset of the scene, auto chooses
+ *                         it from a calibration of the machine and
+ *                         is the default unless benchmarking or
+ *                         capturing, which use ultra
+ *    --target-frame-ms ms frame time that the automatic preset has
+ *                         to fit in, 16.7 when not given
+ *    --quality-cache file file that the calibration of each machine
+ *                         is cached in, qualitycache.json when not
+ *                         given
+ *    --recalibrate        run the calibration even when it is cached
+ *    --views count        draw the camera view beside orthographic
+ *                         views from the top and the front, up to 3
+ *                         views in one pass over the scene
+ *    --stereo mode        draw the left and right eye views in one
+ *                         pass over the scene, side-by-side in the
+ *                         window or into the two layers of a target
+ *                         with layers
+ *    --eye-separation d   distance between the eyes in scene units,
+ *                         0.3 when not given
+ *    --probe x,y,z        capture a reflection probe cube map at the
+ *                         position, up to 8 probes
+ *    --no-environment     light the reflective materials with the
+ *                         scene lights only
+ *    --environment-cache file|off
+ *                         file that the prefiltered environment is
+ *                         cached in, environment.bin when not given
+ *    --no-light-probes    light the objects without the light bounced
+ *                         off the scene from the baked light probes
+ ***********************************************************/
+bool ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--device") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "null") == 0)
+			{
+				g_Options.backend = BACKEND_NULL;
+			}
+			else if (strcmp(argv[i], "gl") == 0)
+			{
+				g_Options.backend = BACKEND_GL;
+			}
+#ifdef ENABLE_VULKAN
+			else if (strcmp(argv[i], "vulkan") == 0)
+			{
+				g_Options.backend = BACKEND_VULKAN;
+				g_Options.bPreferCpuDevice = false;
+			}
+			else if (strcmp(argv[i], "vulkan-cpu") == 0)
+			{
+				g_Options.backend = BACKEND_VULKAN;
+				g_Options.bPreferCpuDevice = true;
+			}
+#else
+			else if (strncmp(argv[i], "vulkan", 6) == 0)
+			{
+				std::cerr << "This build does not include the Vulkan render device, "
+					<< "build with EnableVulkan=true to use it" << std::endl;
+				return(false);
+			}
+#endif
+			else
+			{
+				std::cerr << "Unknown render device: " << argv[i] << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--benchmark") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.benchmarkFrames = atoi(argv[i]);
+		}
+		else if ((strcmp(argv[i], "--stress") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.sceneCopies = atoi(argv[i]);
+		}
+		else if ((strcmp(argv[i], "--capture") == 0) && (i + 2 < argc))
+		{
+			g_Options.captureFile = argv[i + 1];
+			g_Options.captureFrames = atoi(argv[i + 2]);
+			i += 2;
+		}
+		else if ((strcmp(argv[i], "--replay") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.replayFile = argv[i];
+		}
+		else if (strcmp(argv[i], "--hud") == 0)
+		{
+			g_Options.bShowHud = true;
+		}
+		else if (strcmp(argv[i], "--serial-startup") == 0)
+		{
+			g_Options.bSerialStartup = true;
+		}
+		else if (strcmp(argv[i], "--progressive") == 0)
+		{
+			g_Options.bProgressive = true;
+		}
+		else if ((strcmp(argv[i], "--upload-budget") == 0) && (i + 2 < argc))
+		{
+			g_Options.uploadBudgetMilliseconds = atof(argv[i + 1]);
+			g_Options.uploadBudgetKilobytes = atoi(argv[i + 2]);
+			i += 2;
+		}
+		else if ((strcmp(argv[i], "--hitch-threshold") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.hitchThreshold = atof(argv[i]);
+			if (g_Options.hitchThreshold < 0.0)
+			{
+				std::cerr << "The hitch threshold cannot be negative" << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--hitch-dir") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.hitchDirectory = argv[i];
+		}
+		else if ((strcmp(argv[i], "--flight-recorder") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.flightRecorderFile = (strcmp(argv[i], "off") == 0) ? NULL : argv[i];
+		}
+		else if ((strcmp(argv[i], "--decode-flight-recorder") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.decodeFile = argv[i];
+		}
+		else if (strcmp(argv[i], "--perf-counters") == 0)
+		{
+			g_Options.bPerfCounters = true;
+		}
+		else if ((strcmp(argv[i], "--microbench") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.microbenchFile = argv[i];
+		}
+		else if ((strcmp(argv[i], "--microbench-label") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.microbenchLabel = argv[i];
+		}
+		else if ((strcmp(argv[i], "--microbench-compare") == 0) && (i + 2 < argc))
+		{
+			g_Options.compareFiles[0] = argv[i + 1];
+			g_Options.compareFiles[1] = argv[i + 2];
+			i += 2;
+		}
+		else if ((strcmp(argv[i], "--repetitions") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.repetitions = atoi(argv[i]);
+		}
+		else if ((strcmp(argv[i], "--baseline") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.baselineFile = argv[i];
+		}
+		else if ((strcmp(argv[i], "--update-baseline") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.updateBaselineFile = argv[i];
+		}
+		else if ((strcmp(argv[i], "--log-file") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.logFile = argv[i];
+		}
+		else if ((strcmp(argv[i], "--metrics-file") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.metricsFile = argv[i];
+		}
+		else if ((strcmp(argv[i], "--metrics-socket") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.metricsSocket = argv[i];
+		}
+		else if ((strcmp(argv[i], "--metrics-interval") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.metricsInterval = atof(argv[i]);
+			if (g_Options.metricsInterval <= 0.0)
+			{
+				std::cerr << "The metrics interval must be positive" << std::endl;
+				return(false);
+			}
+		}
+		else if (strcmp(argv[i], "--gl-debug") == 0)
+		{
+			g_Options.bGLDebug = true;
+		}
+		else if ((strcmp(argv[i], "--quality") == 0) && (i + 1 < argc))
+		{
+			i++;
+			QualityTuner::QUALITY_PRESET preset;
+			if ((strcmp(argv[i], "auto") != 0) && (QualityTuner::FindPreset(argv[i], preset) == false))
+			{
+				std::cerr << "Unknown quality preset: " << argv[i] << std::endl;
+				return(false);
+			}
+			g_Options.qualityPreset = argv[i];
+		}
+		else if ((strcmp(argv[i], "--target-frame-ms") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.targetFrameMilliseconds = atof(argv[i]);
+			if (g_Options.targetFrameMilliseconds <= 0.0)
+			{
+				std::cerr << "The target frame time must be positive" << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--quality-cache") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.qualityCacheFile = argv[i];
+		}
+		else if (strcmp(argv[i], "--recalibrate") == 0)
+		{
+			g_Options.bRecalibrate = true;
+		}
+		else if ((strcmp(argv[i], "--views") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.viewCount = atoi(argv[i]);
+			if ((g_Options.viewCount < 1) || (g_Options.viewCount > ViewManager::GetMaxViewCount()))
+			{
+				std::cerr << "The view count must be from 1 to " << ViewManager::GetMaxViewCount() << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--stereo") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "side-by-side") == 0)
+			{
+				g_Options.stereoMode = ViewManager::STEREO_SIDE_BY_SIDE;
+			}
+			else if (strcmp(argv[i], "layers") == 0)
+			{
+				g_Options.stereoMode = ViewManager::STEREO_LAYERS;
+			}
+			else
+			{
+				std::cerr << "Unknown stereo mode: " << argv[i] << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--eye-separation") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.eyeSeparation = (float)atof(argv[i]);
+			if (g_Options.eyeSeparation < 0.0f)
+			{
+				std::cerr << "The eye separation cannot be negative" << std::endl;
+				return(false);
+			}
+		}
+		else if ((strcmp(argv[i], "--probe") == 0) && (i + 1 < argc))
+		{
+			i++;
+			glm::vec3 position;
+			if (g_Options.probeCount >= ReflectionProbes::MAX_PROBES)
+			{
+				std::cerr << "At most " << ReflectionProbes::MAX_PROBES << " probes can be placed" << std::endl;
+				return(false);
+			}
+			if (sscanf(argv[i], "%f,%f,%f", &position.x, &position.y, &position.z) != 3)
+			{
+				std::cerr << "The probe position must be x,y,z: " << argv[i] << std::endl;
+				return(false);
+			}
+			g_Options.probePositions[g_Options.probeCount] = position;
+			g_Options.probeCount++;
+		}
+		else if (strcmp(argv[i], "--no-environment") == 0)
+		{
+			g_Options.bEnvironment = false;
+		}
+		else if ((strcmp(argv[i], "--environment-cache") == 0) && (i + 1 < argc))
+		{
+			i++;
+			g_Options.environmentCacheFile = (strcmp(argv[i], "off") == 0) ? NULL : argv[i];
+		}
+		else if (strcmp(argv[i], "--no-light-probes") == 0)
+		{
+			g_Options.bLightProbes = false;
+		}
+		else if (strcmp(argv[i], "--startup-report") == 0)
+		{
+			// the file name is optional
+			g_Options.startupReportFile = "";
+			if ((i + 1 < argc) && (strncmp(argv[i + 1], "--", 2) != 0))
+			{
+				i++;
+				g_Options.startupReportFile = argv[i];
+			}
+		}
+		else
+		{
+			std::cerr << "Unknown option: " << argv[i] << std::endl;
+			return(false);
+		}
+	}
+
+	if ((NULL != g_Options.captureFile) && (NULL != g_Options.replayFile))
+	{
+		std::cerr << "The --capture and --replay options cannot be combined" << std::endl;
+		return(false);
+	}
+	if (g_Options.bGLDebug && (g_Options.backend != BACKEND_GL))
+	{
+		std::cerr << "The --gl-debug option needs the OpenGL device" << std::endl;
+		return(false);
+	}
+	if ((g_Options.uploadBudgetMilliseconds < 0.0) || (g_Options.uploadBudgetKilobytes < 0) ||
+		((g_Options.uploadBudgetMilliseconds > 0.0) != (g_Options.uploadBudgetKilobytes > 0)))
+	{
+		std::cerr << "The upload budget needs a positive time and size" << std::endl;
+		return(false);
+	}
+	if ((NULL != g_Options.captureFile) && (g_Options.captureFrames <= 0))
+	{
+		std::cerr << "The number of frames to capture must be positive" << std::endl;
+		return(false);
+	}
+	if ((g_Options.stereoMode != ViewManager::STEREO_OFF) && (g_Options.viewCount > 1))
+	{
+		std::cerr << "The --stereo and --views options cannot be combined" << std::endl;
+		return(false);
+	}
+
+	// comparing with a baseline needs the benchmark frames,
+	// and several repetitions for the confidence intervals
+	if ((NULL != g_Options.baselineFile) || (NULL != g_Options.updateBaselineFile))
+	{
+		if (g_Options.benchmarkFrames <= 0)
+		{
+			g_Options.benchmarkFrames = DEFAULT_BENCHMARK_FRAMES;
+		}
+		if (g_Options.repetitions <= 0)
+		{
+			g_Options.repetitions = DEFAULT_GATE_REPETITIONS;
+		}
+	}
+
+	// the null device has no window to close, so it always
+	// runs for a fixed number of frames, unless it is capturing
+	// or replaying a trace which sets its own frame count
+	if ((g_Options.backend == BACKEND_NULL) && (g_Options.benchmarkFrames <= 0) &&
+		(NULL == g_Options.captureFile) && (NULL == g_Options.replayFile))
+	{
+		g_Options.benchmarkFrames = DEFAULT_BENCHMARK_FRAMES;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *	IsRunning()
+ *
+ *  This function is used to check whether the main loop
+ *  should keep running.
+ ***********************************************************/
+bool IsRunning()
+{
+	if ((NULL != g_Benchmark) && g_Benchmark->IsComplete())
+	{
+		return(false);
+	}
+
+	// a capture stops the application once the trace is written
+	if ((NULL != g_CaptureDevice) && g_CaptureDevice->IsComplete())
 	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
+		return(false);
 	}
 
-	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	if (NULL != g_Window)
+	{
+		return(!glfwWindowShouldClose(g_Window));
+	}
+
+	// without a window only the benchmark or capture frames are run
+	return((NULL != g_Benchmark) || (NULL != g_CaptureDevice));
+}
+
+/***********************************************************
+ *	UseProgressiveLoading()
+ *
+ *  This function is used for checking whether the first
+ *  frames are drawn with placeholders while the assets
+ *  stream in, which the benchmark only does when asked and
+ *  a capture never does.
+ ***********************************************************/
+bool UseProgressiveLoading()
+{
+	return((NULL == g_Options.captureFile) && ((g_Options.benchmarkFrames <= 0) || g_Options.bProgressive));
 }
 
 /***********************************************************
@@ -140,7 +1664,11 @@ bool InitializeGLFW()
 {
 	// GLFW: initialize and configure library
 	// --------------------------------------
-	glfwInit();
+	if (glfwInit() == GLFW_FALSE)
+	{
+		LOG_ERROR("GLFW could not be initialized");
+		return(false);
+	}
 
 #ifdef __APPLE__
 	// set the version of OpenGL and profile to use
@@ -153,6 +1681,13 @@ bool InitializeGLFW()
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #endif
+
+	// a debug context makes the drivers report their performance
+	// warnings through the debug output
+	if (g_Options.bGLDebug)
+	{
+		glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+	}
 	// GLFW: end -------------------------------
 
 	return(true);
@@ -173,14 +1708,13 @@ bool InitializeGLEW()
 	GLEWInitResult = glewInit();
 	if (GLEW_OK != GLEWInitResult)
 	{
-		std::cerr << glewGetErrorString(GLEWInitResult) << std::endl;
+		LOG_ERROR("could not initialize GLEW", "error", (const char*)glewGetErrorString(GLEWInitResult));
 		return false;
 	}
 	// GLEW: end -------------------------------
 
 	// Displays a successful OpenGL initialization message
-	std::cout << "INFO: OpenGL Successfully Initialized\n";
-	std::cout << "INFO: OpenGL Version: " << glGetString(GL_VERSION) << "\n" << std::endl;
+	LOG_INFO("OpenGL initialized", "version", (const char*)glGetString(GL_VERSION));
 
 	return(true);
 }
\ No newline at end of file
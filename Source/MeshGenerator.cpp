@@ -0,0 +1,303 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.cpp
+// ============
+// generate the vertex and index data for the basic shape meshes on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshGenerator.h"
+
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265358979f;
+
+	// tube radius of the torus, matching the ShapeMeshes default
+	const float TORUS_THICKNESS = 0.1f;
+
+	// add a vertex to the generated mesh
+	void AddVertex(
+		MeshGenerator::MESH_DATA& data,
+		glm::vec3 position,
+		glm::vec3 normal,
+		glm::vec2 textureCoordinate)
+	{
+		MeshGenerator::MESH_VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.textureCoordinate = textureCoordinate;
+		data.vertices.push_back(vertex);
+	}
+
+	// add the two triangles of a quad to the generated mesh
+	void AddQuad(
+		MeshGenerator::MESH_DATA& data,
+		uint32_t a,
+		uint32_t b,
+		uint32_t c,
+		uint32_t d)
+	{
+		data.indices.push_back(a);
+		data.indices.push_back(b);
+		data.indices.push_back(c);
+		data.indices.push_back(a);
+		data.indices.push_back(c);
+		data.indices.push_back(d);
+	}
+}
+
+/***********************************************************
+ *  GenerateMesh()
+ *
+ *  This method is used for generating the vertex and index
+ *  data for the passed in shape mesh.
+ ***********************************************************/
+void MeshGenerator::GenerateMesh(MESH_TYPE mesh, int detail, MESH_DATA& data)
+{
+	data.vertices.clear();
+	data.indices.clear();
+
+	// curved surfaces need at least a few segments
+	if (detail < 3)
+	{
+		detail = 3;
+	}
+
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		GeneratePlane(data);
+		break;
+	case MESH_TORUS:
+		GenerateTorus(detail, TORUS_THICKNESS, data);
+		break;
+	case MESH_CYLINDER:
+		GenerateCylinder(detail, data);
+		break;
+	case MESH_SPHERE:
+		GenerateSphere(detail, data);
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  CountTriangles()
+ *
+ *  This method is used for getting the number of triangles
+ *  of a shape mesh from its segments, which has to follow
+ *  the loops of the Generate methods.
+ ***********************************************************/
+uint32_t MeshGenerator::CountTriangles(MESH_TYPE mesh, int detail)
+{
+	if (detail < 3)
+	{
+		detail = 3;
+	}
+
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		return(2);
+	case MESH_TORUS:
+	{
+		// a quad for each segment around the torus and the tube
+		int tubeSegments = (detail / 2 > 3) ? (detail / 2) : 3;
+		return((uint32_t)(detail * tubeSegments * 2));
+	}
+	case MESH_CYLINDER:
+		// a quad for each side segment and a triangle for each
+		// segment of the two caps
+		return((uint32_t)(detail * 4));
+	case MESH_SPHERE:
+	{
+		// a quad for each segment of each stack
+		int stacks = (detail / 2 > 2) ? (detail / 2) : 2;
+		return((uint32_t)(stacks * detail * 2));
+	}
+	default:
+		break;
+	}
+
+	return(0);
+}
+
+/***********************************************************
+ *  GetMeshBounds()
+ *
+ *  This method is used for getting the box around one of
+ *  the shape meshes, which is used in place of the curved
+ *  surfaces when they are only needed roughly.
+ ***********************************************************/
+void MeshGenerator::GetMeshBounds(MESH_TYPE mesh, glm::vec3& minimum, glm::vec3& maximum)
+{
+	switch (mesh)
+	{
+	case MESH_PLANE:
+		minimum = glm::vec3(-1.0f, 0.0f, -1.0f);
+		maximum = glm::vec3(1.0f, 0.0f, 1.0f);
+		break;
+	case MESH_TORUS:
+		minimum = glm::vec3(-1.0f - TORUS_THICKNESS, -1.0f - TORUS_THICKNESS, -TORUS_THICKNESS);
+		maximum = glm::vec3(1.0f + TORUS_THICKNESS, 1.0f + TORUS_THICKNESS, TORUS_THICKNESS);
+		break;
+	case MESH_CYLINDER:
+		minimum = glm::vec3(-1.0f, 0.0f, -1.0f);
+		maximum = glm::vec3(1.0f, 1.0f, 1.0f);
+		break;
+	default:
+		minimum = glm::vec3(-1.0f);
+		maximum = glm::vec3(1.0f);
+		break;
+	}
+}
+
+/***********************************************************
+ *  GeneratePlane()
+ *
+ *  This method is used for generating a plane from -1 to 1
+ *  on the X and Z axes with the normal facing up.
+ ***********************************************************/
+void MeshGenerator::GeneratePlane(MESH_DATA& data)
+{
+	glm::vec3 normal(0.0f, 1.0f, 0.0f);
+
+	AddVertex(data, glm::vec3(-1.0f, 0.0f, 1.0f), normal, glm::vec2(0.0f, 0.0f));
+	AddVertex(data, glm::vec3(1.0f, 0.0f, 1.0f), normal, glm::vec2(1.0f, 0.0f));
+	AddVertex(data, glm::vec3(1.0f, 0.0f, -1.0f), normal, glm::vec2(1.0f, 1.0f));
+	AddVertex(data, glm::vec3(-1.0f, 0.0f, -1.0f), normal, glm::vec2(0.0f, 1.0f));
+
+	AddQuad(data, 0, 1, 2, 3);
+}
+
+/***********************************************************
+ *  GenerateTorus()
+ *
+ *  This method is used for generating a torus that lies in
+ *  the XY plane, with a main radius of 1 and the passed in
+ *  tube thickness.
+ ***********************************************************/
+void MeshGenerator::GenerateTorus(int detail, float thickness, MESH_DATA& data)
+{
+	int tubeSegments = (detail / 2 > 3) ? (detail / 2) : 3;
+
+	for (int i = 0; i <= detail; i++)
+	{
+		float u = (float)i / (float)detail;
+		float mainAngle = u * 2.0f * PI;
+		glm::vec3 center(cosf(mainAngle), sinf(mainAngle), 0.0f);
+
+		for (int j = 0; j <= tubeSegments; j++)
+		{
+			float v = (float)j / (float)tubeSegments;
+			float tubeAngle = v * 2.0f * PI;
+			glm::vec3 normal = (center * cosf(tubeAngle)) + glm::vec3(0.0f, 0.0f, sinf(tubeAngle));
+
+			AddVertex(data, center + (normal * thickness), normal, glm::vec2(u, v));
+		}
+	}
+
+	uint32_t stride = (uint32_t)tubeSegments + 1;
+	for (uint32_t i = 0; i < (uint32_t)detail; i++)
+	{
+		for (uint32_t j = 0; j < (uint32_t)tubeSegments; j++)
+		{
+			AddQuad(data,
+				(i * stride) + j,
+				((i + 1) * stride) + j,
+				((i + 1) * stride) + j + 1,
+				(i * stride) + j + 1);
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateCylinder()
+ *
+ *  This method is used for generating a cylinder of radius
+ *  1 from 0 to 1 on the Y axis, with top and bottom caps.
+ ***********************************************************/
+void MeshGenerator::GenerateCylinder(int detail, MESH_DATA& data)
+{
+	// sides
+	for (int i = 0; i <= detail; i++)
+	{
+		float u = (float)i / (float)detail;
+		float angle = u * 2.0f * PI;
+		glm::vec3 normal(cosf(angle), 0.0f, sinf(angle));
+
+		AddVertex(data, glm::vec3(normal.x, 0.0f, normal.z), normal, glm::vec2(u, 0.0f));
+		AddVertex(data, glm::vec3(normal.x, 1.0f, normal.z), normal, glm::vec2(u, 1.0f));
+	}
+	for (uint32_t i = 0; i < (uint32_t)detail; i++)
+	{
+		AddQuad(data, (i * 2), (i * 2) + 1, (i * 2) + 3, (i * 2) + 2);
+	}
+
+	// caps, as triangle fans around a center vertex
+	for (int cap = 0; cap < 2; cap++)
+	{
+		float y = (float)cap;
+		glm::vec3 normal(0.0f, (cap == 0) ? -1.0f : 1.0f, 0.0f);
+		uint32_t center = (uint32_t)data.vertices.size();
+
+		AddVertex(data, glm::vec3(0.0f, y, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+		for (int i = 0; i <= detail; i++)
+		{
+			float angle = ((float)i / (float)detail) * 2.0f * PI;
+			float x = cosf(angle);
+			float z = sinf(angle);
+			AddVertex(data, glm::vec3(x, y, z), normal, glm::vec2((x * 0.5f) + 0.5f, (z * 0.5f) + 0.5f));
+		}
+		for (uint32_t i = 0; i < (uint32_t)detail; i++)
+		{
+			data.indices.push_back(center);
+			data.indices.push_back(center + 1 + ((cap == 0) ? i : i + 1));
+			data.indices.push_back(center + 1 + ((cap == 0) ? i + 1 : i));
+		}
+	}
+}
+
+/***********************************************************
+ *  GenerateSphere()
+ *
+ *  This method is used for generating a sphere of radius 1
+ *  around the origin.
+ ***********************************************************/
+void MeshGenerator::GenerateSphere(int detail, MESH_DATA& data)
+{
+	int stacks = (detail / 2 > 2) ? (detail / 2) : 2;
+
+	for (int i = 0; i <= stacks; i++)
+	{
+		float v = (float)i / (float)stacks;
+		float polar = v * PI;
+
+		for (int j = 0; j <= detail; j++)
+		{
+			float u = (float)j / (float)detail;
+			float azimuth = u * 2.0f * PI;
+			glm::vec3 normal(
+				sinf(polar) * cosf(azimuth),
+				cosf(polar),
+				sinf(polar) * sinf(azimuth));
+
+			AddVertex(data, normal, normal, glm::vec2(u, 1.0f - v));
+		}
+	}
+
+	uint32_t stride = (uint32_t)detail + 1;
+	for (uint32_t i = 0; i < (uint32_t)stacks; i++)
+	{
+		for (uint32_t j = 0; j < (uint32_t)detail; j++)
+		{
+			AddQuad(data,
+				(i * stride) + j,
+				(i * stride) + j + 1,
+				((i + 1) * stride) + j + 1,
+				((i + 1) * stride) + j);
+		}
+	}
+}
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// generate the vertex and index data for the basic shape meshes on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  This class contains the code for generating the unit
+ *  shapes drawn by the scene - the same shapes created by
+ *  ShapeMeshes - into plain vertex and index arrays, for
+ *  the render devices that do not use OpenGL buffers.
+ ***********************************************************/
+class MeshGenerator
+{
+public:
+	// interleaved vertex layout used by the shaders, and the
+	// generated triangle list
+	typedef RenderDevice::MESH_VERTEX MESH_VERTEX;
+	typedef RenderDevice::MESH_DATA MESH_DATA;
+
+	// generate one of the shape meshes, the detail is the
+	// number of segments around curved surfaces
+	static void GenerateMesh(MESH_TYPE mesh, int detail, MESH_DATA& data);
+	// get the number of triangles that GenerateMesh() makes
+	// for a shape mesh, without generating it
+	static uint32_t CountTriangles(MESH_TYPE mesh, int detail);
+	// get the box around one of the shape meshes, in the
+	// coordinates of the mesh
+	static void GetMeshBounds(MESH_TYPE mesh, glm::vec3& minimum, glm::vec3& maximum);
+
+	// default number of segments around curved surfaces
+	static const int DEFAULT_DETAIL = 36;
+	// segments of the coarse meshes drawn while the default
+	// meshes are still being generated
+	static const int PLACEHOLDER_DETAIL = 8;
+
+private:
+	// plane from -1 to 1 on the X and Z axes, facing up
+	static void GeneratePlane(MESH_DATA& data);
+	// torus in the XY plane with a main radius of 1
+	static void GenerateTorus(int detail, float thickness, MESH_DATA& data);
+	// cylinder of radius 1 from 0 to 1 on the Y axis
+	static void GenerateCylinder(int detail, MESH_DATA& data);
+	// sphere of radius 1 around the origin
+	static void GenerateSphere(int detail, MESH_DATA& data);
+};
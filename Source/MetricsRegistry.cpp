@@ -0,0 +1,504 @@
+///////////////////////////////////////////////////////////////////////////////
+// metricsregistry.cpp
+// ============
+// keep the runtime counters, gauges and histograms and export them for scraping
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MetricsRegistry.h"
+#include "Logger.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// longest time that the export thread waits before it
+	// checks whether it has to stop
+	const int EXPORT_POLL_MILLISECONDS = 100;
+
+	// format a number the way the text format expects it
+	std::string FormatNumber(double value)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%.9g", value);
+		return(text);
+	}
+
+	// escape a label value for the text format
+	std::string EscapeLabel(const std::string& value)
+	{
+		std::string escaped;
+		for (char character : value)
+		{
+			if (character == '\\' || character == '"')
+			{
+				escaped += '\\';
+				escaped += character;
+			}
+			else if (character == '\n')
+			{
+				escaped += "\\n";
+			}
+			else
+			{
+				escaped += character;
+			}
+		}
+		return(escaped);
+	}
+}
+
+/***********************************************************
+ *  MetricsRegistry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MetricsRegistry::MetricsRegistry() :
+	m_intervalSeconds(5.0),
+	m_socket(-1),
+	m_bStopExport(false),
+	m_bExporting(false)
+{
+	// the instances running on one machine are told apart by
+	// their process ids
+#ifdef _WIN32
+	AddLabel("pid", std::to_string(_getpid()));
+#else
+	AddLabel("pid", std::to_string(getpid()));
+#endif
+}
+
+/***********************************************************
+ *  ~MetricsRegistry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MetricsRegistry::~MetricsRegistry()
+{
+	StopExport();
+
+	for (METRIC_ENTRY& entry : m_metrics)
+	{
+		delete entry.pCounter;
+		delete entry.pGauge;
+		delete entry.pHistogram;
+	}
+	m_metrics.clear();
+}
+
+/***********************************************************
+ *  Histogram()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MetricsRegistry::Histogram::Histogram() :
+	m_boundCount(0),
+	m_sum(0.0)
+{
+	for (int i = 0; i < MAX_BOUNDS; i++)
+	{
+		m_bounds[i] = 0.0;
+	}
+	for (int i = 0; i <= MAX_BOUNDS; i++)
+	{
+		m_buckets[i] = 0;
+	}
+}
+
+/***********************************************************
+ *  Observe()
+ *
+ *  This method is used for counting a value in the first
+ *  bucket whose upper bound is not below it.  Only the
+ *  bucket is counted, the buckets are added up into the
+ *  cumulative counts of the text format when they are
+ *  exported.
+ ***********************************************************/
+void MetricsRegistry::Histogram::Observe(double value)
+{
+	int bucket = 0;
+	while ((bucket < m_boundCount) && (value > m_bounds[bucket]))
+	{
+		bucket++;
+	}
+	m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+	// there is no atomic add for doubles before C++20
+	double sum = m_sum.load(std::memory_order_relaxed);
+	while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed))
+	{
+	}
+}
+
+/***********************************************************
+ *  AddCounter()
+ *
+ *  This method is used for registering a counter.
+ ***********************************************************/
+MetricsRegistry::Counter* MetricsRegistry::AddCounter(const char* name, const char* help)
+{
+	METRIC_ENTRY entry = { name, help, METRIC_COUNTER, new Counter(), NULL, NULL };
+	m_metrics.push_back(entry);
+	return(entry.pCounter);
+}
+
+/***********************************************************
+ *  AddGauge()
+ *
+ *  This method is used for registering a gauge.
+ ***********************************************************/
+MetricsRegistry::Gauge* MetricsRegistry::AddGauge(const char* name, const char* help)
+{
+	METRIC_ENTRY entry = { name, help, METRIC_GAUGE, NULL, new Gauge(), NULL };
+	m_metrics.push_back(entry);
+	return(entry.pGauge);
+}
+
+/***********************************************************
+ *  AddHistogram()
+ *
+ *  This method is used for registering a histogram with the
+ *  passed in upper bounds, which must be in increasing order.
+ ***********************************************************/
+MetricsRegistry::Histogram* MetricsRegistry::AddHistogram(const char* name, const char* help, const double* bounds, int boundCount)
+{
+	Histogram* pHistogram = new Histogram();
+	if (boundCount > Histogram::MAX_BOUNDS)
+	{
+		LOG_WARNING("histogram has too many buckets, the highest are left out", "metric", name, "buckets", boundCount);
+		boundCount = Histogram::MAX_BOUNDS;
+	}
+	for (int i = 0; i < boundCount; i++)
+	{
+		pHistogram->m_bounds[i] = bounds[i];
+	}
+	pHistogram->m_boundCount = boundCount;
+
+	METRIC_ENTRY entry = { name, help, METRIC_HISTOGRAM, NULL, NULL, pHistogram };
+	m_metrics.push_back(entry);
+	return(pHistogram);
+}
+
+/***********************************************************
+ *  AddLabel()
+ *
+ *  This method is used for adding a label to every sample.
+ ***********************************************************/
+void MetricsRegistry::AddLabel(const char* name, const std::string& value)
+{
+	if (!m_labels.empty())
+	{
+		m_labels += ",";
+	}
+	m_labels += std::string(name) + "=\"" + EscapeLabel(value) + "\"";
+}
+
+/***********************************************************
+ *  FormatLabels()
+ *
+ *  This method is used for formatting the labels of a
+ *  sample, including the extra label when a name is passed
+ *  in.
+ ***********************************************************/
+std::string MetricsRegistry::FormatLabels(const char* extraName, const std::string& extraValue) const
+{
+	std::string labels = m_labels;
+	if (NULL != extraName)
+	{
+		if (!labels.empty())
+		{
+			labels += ",";
+		}
+		labels += std::string(extraName) + "=\"" + extraValue + "\"";
+	}
+
+	if (labels.empty())
+	{
+		return(labels);
+	}
+	return("{" + labels + "}");
+}
+
+/***********************************************************
+ *  Format()
+ *
+ *  This method is used for formatting the current values
+ *  of all the metrics in the Prometheus text format.  The
+ *  values are read one at a time, so the sum of a histogram
+ *  can be an observation apart from its count while it is
+ *  updated.
+ ***********************************************************/
+std::string MetricsRegistry::Format() const
+{
+	std::string labels = FormatLabels(NULL, "");
+	std::string text;
+
+	for (const METRIC_ENTRY& entry : m_metrics)
+	{
+		text += "# HELP " + entry.name + " " + entry.help + "\n";
+
+		switch (entry.type)
+		{
+		case METRIC_COUNTER:
+			text += "# TYPE " + entry.name + " counter\n";
+			text += entry.name + labels + " " + std::to_string(entry.pCounter->Get()) + "\n";
+			break;
+
+		case METRIC_GAUGE:
+			text += "# TYPE " + entry.name + " gauge\n";
+			text += entry.name + labels + " " + FormatNumber(entry.pGauge->Get()) + "\n";
+			break;
+
+		case METRIC_HISTOGRAM:
+		{
+			const Histogram* pHistogram = entry.pHistogram;
+			text += "# TYPE " + entry.name + " histogram\n";
+
+			uint64_t cumulative = 0;
+			for (int i = 0; i <= pHistogram->m_boundCount; i++)
+			{
+				cumulative += pHistogram->m_buckets[i].load(std::memory_order_relaxed);
+				std::string bound = "+Inf";
+				if (i < pHistogram->m_boundCount)
+				{
+					bound = FormatNumber(pHistogram->m_bounds[i]);
+				}
+				text += entry.name + "_bucket" + FormatLabels("le", bound) + " " + std::to_string(cumulative) + "\n";
+			}
+			text += entry.name + "_sum" + labels + " " + FormatNumber(pHistogram->m_sum.load(std::memory_order_relaxed)) + "\n";
+			text += entry.name + "_count" + labels + " " + std::to_string(cumulative) + "\n";
+			break;
+		}
+		}
+	}
+
+	return(text);
+}
+
+/***********************************************************
+ *  StartExport()
+ *
+ *  This method is used for starting the thread that writes
+ *  the metrics to the file every interval and answers the
+ *  connections to the socket.
+ ***********************************************************/
+bool MetricsRegistry::StartExport(const char* filename, const char* socketPath, double intervalSeconds)
+{
+	if (m_bExporting)
+	{
+		return(true);
+	}
+
+	m_filename = (NULL != filename) ? filename : "";
+	m_socketPath = (NULL != socketPath) ? socketPath : "";
+	m_intervalSeconds = (intervalSeconds > 0.0) ? intervalSeconds : 5.0;
+
+	if (!m_filename.empty() && !WriteFile())
+	{
+		return(false);
+	}
+	if (!m_socketPath.empty() && !OpenSocket())
+	{
+		return(false);
+	}
+
+	m_bStopExport = false;
+	m_bExporting = true;
+	m_exportThread = std::thread(&MetricsRegistry::ExportLoop, this);
+	return(true);
+}
+
+/***********************************************************
+ *  StopExport()
+ *
+ *  This method is used for stopping the export thread,
+ *  writing the file a last time so that it holds the final
+ *  values, and closing the socket.
+ ***********************************************************/
+void MetricsRegistry::StopExport()
+{
+	if (m_bExporting == false)
+	{
+		return;
+	}
+
+	m_bStopExport = true;
+	m_exportThread.join();
+	m_bExporting = false;
+
+	if (!m_filename.empty())
+	{
+		WriteFile();
+	}
+
+#ifndef _WIN32
+	if (m_socket >= 0)
+	{
+		close(m_socket);
+		unlink(m_socketPath.c_str());
+		m_socket = -1;
+	}
+#endif
+}
+
+/***********************************************************
+ *  WriteFile()
+ *
+ *  This method is used for writing the metrics to a file
+ *  next to the export file and renaming it over the export
+ *  file, so that a reader sees either the old or the new
+ *  metrics and never a part of them.
+ ***********************************************************/
+bool MetricsRegistry::WriteFile() const
+{
+	std::string tempFilename = m_filename + ".tmp";
+	{
+		std::ofstream file(tempFilename, std::ios::binary);
+		if (!file)
+		{
+			LOG_ERROR("could not write the metrics file", "file", tempFilename);
+			return(false);
+		}
+		file << Format();
+	}
+
+#ifdef _WIN32
+	// rename does not replace an existing file on Windows
+	std::remove(m_filename.c_str());
+#endif
+	if (std::rename(tempFilename.c_str(), m_filename.c_str()) != 0)
+	{
+		LOG_ERROR("could not replace the metrics file", "file", m_filename);
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  OpenSocket()
+ *
+ *  This method is used for opening the Unix socket that
+ *  the metrics are written to on each connection, removing
+ *  a socket left behind by an earlier run.
+ ***********************************************************/
+bool MetricsRegistry::OpenSocket()
+{
+#ifdef _WIN32
+	LOG_WARNING("metrics sockets are not supported on this platform", "socket", m_socketPath);
+	return(true);
+#else
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (m_socketPath.size() >= sizeof(address.sun_path))
+	{
+		LOG_ERROR("metrics socket path is too long", "socket", m_socketPath);
+		return(false);
+	}
+	strcpy(address.sun_path, m_socketPath.c_str());
+
+	m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_socket < 0)
+	{
+		LOG_ERROR("could not create the metrics socket", "socket", m_socketPath);
+		return(false);
+	}
+
+	unlink(m_socketPath.c_str());
+	if ((bind(m_socket, (sockaddr*)&address, sizeof(address)) != 0) ||
+		(listen(m_socket, 4) != 0))
+	{
+		LOG_ERROR("could not listen on the metrics socket", "socket", m_socketPath);
+		close(m_socket);
+		m_socket = -1;
+		return(false);
+	}
+	return(true);
+#endif
+}
+
+/***********************************************************
+ *  AnswerSocket()
+ *
+ *  This method is used for writing the current metrics to
+ *  each connection waiting on the socket and closing it.
+ ***********************************************************/
+void MetricsRegistry::AnswerSocket(int timeoutMilliseconds) const
+{
+#ifndef _WIN32
+	pollfd request = { m_socket, POLLIN, 0 };
+	if (poll(&request, 1, timeoutMilliseconds) <= 0)
+	{
+		return;
+	}
+
+	int connection = accept(m_socket, NULL, NULL);
+	if (connection < 0)
+	{
+		return;
+	}
+
+	std::string text = Format();
+	size_t written = 0;
+	while (written < text.size())
+	{
+#ifdef MSG_NOSIGNAL
+		ssize_t result = send(connection, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+#else
+		ssize_t result = send(connection, text.data() + written, text.size() - written, 0);
+#endif
+		if (result <= 0)
+		{
+			break;
+		}
+		written += (size_t)result;
+	}
+	close(connection);
+#endif
+}
+
+/***********************************************************
+ *  ExportLoop()
+ *
+ *  This method is used for running the export thread, which
+ *  answers the socket as connections arrive and writes the
+ *  file each time the interval has passed.
+ ***********************************************************/
+void MetricsRegistry::ExportLoop()
+{
+	Clock::duration interval = std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(m_intervalSeconds));
+	Clock::time_point nextWrite = Clock::now() + interval;
+
+	while (m_bStopExport == false)
+	{
+		if (m_socket >= 0)
+		{
+			AnswerSocket(EXPORT_POLL_MILLISECONDS);
+		}
+		else
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(EXPORT_POLL_MILLISECONDS));
+		}
+
+		if (!m_filename.empty() && (Clock::now() >= nextWrite))
+		{
+			WriteFile();
+			nextWrite = Clock::now() + interval;
+		}
+	}
+}
@@ -0,0 +1,161 @@
+///////////////////////////////////////////////////////////////////////////////
+// metricsregistry.h
+// ============
+// keep the runtime counters, gauges and histograms and export them for scraping
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  MetricsRegistry
+ *
+ *  This class contains the code for registering named
+ *  metrics at startup and exporting them in the Prometheus
+ *  text format.  The metrics are updated with atomic
+ *  operations only, so any thread can update them without
+ *  a lock and without allocating.  A background thread
+ *  writes the metrics to a file at a fixed interval, which
+ *  is replaced in one step so a scraper never reads half of
+ *  it, and can also answer each connection to a Unix socket
+ *  with the current metrics.
+ ***********************************************************/
+class MetricsRegistry
+{
+public:
+	// constructor
+	MetricsRegistry();
+	// destructor - stops the export
+	~MetricsRegistry();
+
+	/***********************************************************
+	 *  Counter
+	 *
+	 *  This class contains a value that only increases.
+	 ***********************************************************/
+	class Counter
+	{
+	public:
+		Counter() : m_value(0) {}
+		void Increment(uint64_t amount = 1) { m_value.fetch_add(amount, std::memory_order_relaxed); }
+		uint64_t Get() const { return(m_value.load(std::memory_order_relaxed)); }
+
+	private:
+		std::atomic<uint64_t> m_value;
+	};
+
+	/***********************************************************
+	 *  Gauge
+	 *
+	 *  This class contains a value that is set to the latest
+	 *  measurement.
+	 ***********************************************************/
+	class Gauge
+	{
+	public:
+		Gauge() : m_value(0.0) {}
+		void Set(double value) { m_value.store(value, std::memory_order_relaxed); }
+		double Get() const { return(m_value.load(std::memory_order_relaxed)); }
+
+	private:
+		std::atomic<double> m_value;
+	};
+
+	/***********************************************************
+	 *  Histogram
+	 *
+	 *  This class contains the number of observed values that
+	 *  fall into each bucket, with fixed upper bounds that are
+	 *  set when the histogram is registered.
+	 ***********************************************************/
+	class Histogram
+	{
+	public:
+		// most upper bounds of a histogram, the last bucket
+		// holds the values above the highest bound
+		static const int MAX_BOUNDS = 15;
+
+		Histogram();
+		// count a value in its bucket
+		void Observe(double value);
+
+	private:
+		friend class MetricsRegistry;
+
+		double m_bounds[MAX_BOUNDS];
+		int m_boundCount;
+		std::atomic<uint64_t> m_buckets[MAX_BOUNDS + 1];
+		std::atomic<double> m_sum;
+	};
+
+	// register the metrics, which must be done before the
+	// export is started - the returned metrics are owned by
+	// the registry
+	Counter* AddCounter(const char* name, const char* help);
+	Gauge* AddGauge(const char* name, const char* help);
+	Histogram* AddHistogram(const char* name, const char* help, const double* bounds, int boundCount);
+	// add a label to all of the metrics, to tell the instances
+	// apart when several of them are scraped - the process id
+	// is always added
+	void AddLabel(const char* name, const std::string& value);
+
+	// start writing the metrics to a file and answering a Unix
+	// socket, either can be NULL
+	bool StartExport(const char* filename, const char* socketPath, double intervalSeconds);
+	// stop the export thread, the file is written a last time
+	void StopExport();
+
+	// format the current values in the Prometheus text format
+	std::string Format() const;
+
+private:
+	// kinds of metrics
+	enum METRIC_TYPE
+	{
+		METRIC_COUNTER = 0,
+		METRIC_GAUGE,
+		METRIC_HISTOGRAM
+	};
+
+	// registered metric
+	struct METRIC_ENTRY
+	{
+		std::string name;
+		std::string help;
+		METRIC_TYPE type;
+		Counter* pCounter;
+		Gauge* pGauge;
+		Histogram* pHistogram;
+	};
+
+	std::vector<METRIC_ENTRY> m_metrics;
+	// labels added to every sample, formatted once
+	std::string m_labels;
+
+	// export settings and thread
+	std::string m_filename;
+	std::string m_socketPath;
+	double m_intervalSeconds;
+	int m_socket;
+	std::thread m_exportThread;
+	std::atomic<bool> m_bStopExport;
+	bool m_bExporting;
+
+	// write the current values to the file
+	bool WriteFile() const;
+	// open the Unix socket that is answered
+	bool OpenSocket();
+	// answer the connections that are waiting on the socket,
+	// waiting for one at most the passed in time
+	void AnswerSocket(int timeoutMilliseconds) const;
+	// the loop of the export thread
+	void ExportLoop();
+	// format the labels of a sample, with an extra label
+	std::string FormatLabels(const char* extraName, const std::string& extraValue) const;
+};
@@ -0,0 +1,453 @@
+///////////////////////////////////////////////////////////////////////////////
+// microbenchmarks.cpp
+// ============
+// time the hot functions of the scene and view code in isolation
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MicroBenchmarks.h"
+#include "JsonUtils.h"
+#include "MeshGenerator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// version of the JSON report, increased when its layout
+	// changes
+	const int MICROBENCH_REPORT_VERSION = 1;
+
+	// number of timed batches of each function, and the time
+	// that one batch should take at least
+	const int BENCHMARK_REPETITIONS = 15;
+	const double MIN_BATCH_MILLISECONDS = 2.0;
+	const int MAX_BATCH_ITERATIONS = 1 << 24;
+
+	// tags of the scene textures, in the order they are loaded
+	const char* const TEXTURE_TAGS[] =
+	{
+		"blackmetal",
+		"carbonfiber",
+		"metal",
+		"greyplastic"
+	};
+	const int TEXTURE_TAG_COUNT = (int)(sizeof(TEXTURE_TAGS) / sizeof(TEXTURE_TAGS[0]));
+
+	// tags looked up by the benchmarks, the clay material has
+	// no texture so its texture lookup misses
+	const char* const LOOKUP_TAGS[] =
+	{
+		"carbonfiber",
+		"metal",
+		"blackmetal",
+		"greyplastic",
+		"clay"
+	};
+	const int LOOKUP_TAG_COUNT = (int)(sizeof(LOOKUP_TAGS) / sizeof(LOOKUP_TAGS[0]));
+}
+
+/***********************************************************
+ *  MicroBenchmarks()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MicroBenchmarks::MicroBenchmarks()
+{
+	m_pRenderDevice = new NullRenderDevice();
+	m_pRenderDevice->Initialize();
+	m_pSceneManager = new SceneManager(m_pRenderDevice);
+	m_pViewManager = new ViewManager(m_pRenderDevice);
+	m_sink = 0.0;
+
+	// the scene has its textures and materials, without
+	// reading the image files
+	LoadTestTextures();
+	m_pSceneManager->DefineObjectMaterials();
+}
+
+/***********************************************************
+ *  ~MicroBenchmarks()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MicroBenchmarks::~MicroBenchmarks()
+{
+	delete m_pViewManager;
+	m_pViewManager = NULL;
+	delete m_pSceneManager;
+	m_pSceneManager = NULL;
+	delete m_pRenderDevice;
+	m_pRenderDevice = NULL;
+}
+
+/***********************************************************
+ *  LoadTestTextures()
+ *
+ *  This method is used for loading a one pixel texture for
+ *  each of the scene texture tags, so the texture lookups
+ *  search the same list as in the scene.
+ ***********************************************************/
+void MicroBenchmarks::LoadTestTextures()
+{
+	const unsigned char pixel[4] = { 255, 255, 255, 255 };
+
+	for (int i = 0; i < TEXTURE_TAG_COUNT; i++)
+	{
+		int slot = m_pSceneManager->m_loadedTextures;
+		m_pSceneManager->m_textureIDs[slot].tag = TEXTURE_TAGS[i];
+		m_pSceneManager->m_textureIDs[slot].ID = m_pRenderDevice->CreateTexture(1, 1, 4, pixel);
+		m_pSceneManager->m_loadedTextures++;
+	}
+}
+
+/***********************************************************
+ *  RunBenchmark()
+ *
+ *  This method is used for timing a function.  The number
+ *  of calls in a batch is doubled until the batch takes
+ *  long enough to time, then the batches are repeated and
+ *  the time per call is taken from each of them.
+ ***********************************************************/
+void MicroBenchmarks::RunBenchmark(const char* name, BENCHMARK_FUNCTION function)
+{
+	int iterations = 1;
+	while (true)
+	{
+		m_pRenderDevice->BeginFrame();
+		Clock::time_point start = Clock::now();
+		(this->*function)(iterations);
+		double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		if ((milliseconds >= MIN_BATCH_MILLISECONDS) || (iterations >= MAX_BATCH_ITERATIONS))
+		{
+			break;
+		}
+		iterations *= 2;
+	}
+
+	std::vector<double> times;
+	times.reserve(BENCHMARK_REPETITIONS);
+	for (int i = 0; i < BENCHMARK_REPETITIONS; i++)
+	{
+		// the null device drops the commands of the last batch
+		m_pRenderDevice->BeginFrame();
+		Clock::time_point start = Clock::now();
+		(this->*function)(iterations);
+		double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		times.push_back(nanoseconds / iterations);
+	}
+	std::sort(times.begin(), times.end());
+
+	BENCHMARK_RESULT result;
+	result.name = name;
+	result.iterations = iterations;
+	result.repetitions = BENCHMARK_REPETITIONS;
+	result.medianNanoseconds = times[times.size() / 2];
+	result.minNanoseconds = times[0];
+	result.meanNanoseconds = 0.0;
+	for (size_t i = 0; i < times.size(); i++)
+	{
+		result.meanNanoseconds += times[i];
+	}
+	result.meanNanoseconds /= times.size();
+	m_results.push_back(result);
+
+	char line[160];
+	snprintf(line, sizeof(line), "MICROBENCH: %-20s median %10.1f ns, min %10.1f ns, mean %10.1f ns",
+		name, result.medianNanoseconds, result.minNanoseconds, result.meanNanoseconds);
+	std::cout << line << std::endl;
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running all of the benchmarks.
+ ***********************************************************/
+void MicroBenchmarks::Run()
+{
+	m_results.clear();
+
+	RunBenchmark("SetTransformations", &MicroBenchmarks::BenchmarkSetTransformations);
+	RunBenchmark("FindTextureSlot", &MicroBenchmarks::BenchmarkFindTextureSlot);
+	RunBenchmark("FindMaterial", &MicroBenchmarks::BenchmarkFindMaterial);
+	RunBenchmark("SetShaderMaterial", &MicroBenchmarks::BenchmarkSetShaderMaterial);
+	RunBenchmark("PrepareSceneView", &MicroBenchmarks::BenchmarkPrepareSceneView);
+	RunBenchmark("GeneratePlane", &MicroBenchmarks::BenchmarkGeneratePlane);
+	RunBenchmark("GenerateTorus", &MicroBenchmarks::BenchmarkGenerateTorus);
+	RunBenchmark("GenerateCylinder", &MicroBenchmarks::BenchmarkGenerateCylinder);
+	RunBenchmark("GenerateSphere", &MicroBenchmarks::BenchmarkGenerateSphere);
+}
+
+/***********************************************************
+ *  BenchmarkSetTransformations()
+ *
+ *  This method is used for timing the building of the
+ *  model matrix of an object.
+ ***********************************************************/
+void MicroBenchmarks::BenchmarkSetTransformations(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		float angle = (float)(i & 255);
+		m_pSceneManager->SetTransformations(
+			glm::vec3(1.0f, 2.0f, 1.0f),
+			angle,
+			90.0f - angle,
+			angle * 0.5f,
+			glm::vec3(0.5f, 1.0f, -2.0f));
+		m_sink = m_sink + m_pSceneManager->m_instanceData.model[3][0];
+	}
+}
+
+/***********************************************************
+ *  BenchmarkFindTextureSlot()
+ *
+ *  This method is used for timing the lookup of a texture
+ *  slot by tag, the tags are passed as string literals in
+ *  the same way as the scene code passes them.
+ ***********************************************************/
+void MicroBenchmarks::BenchmarkFindTextureSlot(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		m_sink = m_sink + m_pSceneManager->FindTextureSlot(LOOKUP_TAGS[i % LOOKUP_TAG_COUNT]);
+	}
+}
+
+/***********************************************************
+ *  BenchmarkFindMaterial()
+ *
+ *  This method is used for timing the lookup of a material
+ *  by tag.
+ ***********************************************************/
+void MicroBenchmarks::BenchmarkFindMaterial(int iterations)
+{
+	SceneManager::OBJECT_MATERIAL material;
+
+	for (int i = 0; i < iterations; i++)
+	{
+		m_pSceneManager->FindMaterial(LOOKUP_TAGS[i % LOOKUP_TAG_COUNT], material);
+		m_sink = m_sink + material.shininess;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkSetShaderMaterial()
+ *
+ *  This method is used for timing the lookup of a material
+ *  and the update of the material block.
+ ***********************************************************/
+void MicroBenchmarks::BenchmarkSetShaderMaterial(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		m_pSceneManager->SetShaderMaterial(LOOKUP_TAGS[i % LOOKUP_TAG_COUNT]);
+	}
+	m_sink = m_sink + m_pRenderDevice->GetCommands().size();
+}
+
+/***********************************************************
+ *  BenchmarkPrepareSceneView()
+ *
+ *  This method is used for timing the computing of the view
+ *  and projection matrices and the update of the camera
+ *  block.
+ ***********************************************************/
+void MicroBenchmarks::BenchmarkPrepareSceneView(int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		m_pViewManager->PrepareSceneView();
+	}
+	m_sink = m_sink + m_pRenderDevice->GetCommands().size();
+}
+
+/***********************************************************
+ *  BenchmarkGeneratePlane()
+ *  BenchmarkGenerateTorus()
+ *  BenchmarkGenerateCylinder()
+ *  BenchmarkGenerateSphere()
+ *
+ *  These methods are used for timing the generation of
+ *  each of the shape meshes.
+ ***********************************************************/
+void MicroBenchmarks::BenchmarkGeneratePlane(int iterations)
+{
+	GenerateMeshes(MESH_PLANE, iterations);
+}
+
+void MicroBenchmarks::BenchmarkGenerateTorus(int iterations)
+{
+	GenerateMeshes(MESH_TORUS, iterations);
+}
+
+void MicroBenchmarks::BenchmarkGenerateCylinder(int iterations)
+{
+	GenerateMeshes(MESH_CYLINDER, iterations);
+}
+
+void MicroBenchmarks::BenchmarkGenerateSphere(int iterations)
+{
+	GenerateMeshes(MESH_SPHERE, iterations);
+}
+
+/***********************************************************
+ *  GenerateMeshes()
+ *
+ *  This method is used for generating a mesh at the default
+ *  detail into new arrays, as the asset loader does.
+ ***********************************************************/
+void MicroBenchmarks::GenerateMeshes(MESH_TYPE mesh, int iterations)
+{
+	for (int i = 0; i < iterations; i++)
+	{
+		MeshGenerator::MESH_DATA data;
+		MeshGenerator::GenerateMesh(mesh, MeshGenerator::DEFAULT_DETAIL, data);
+		m_sink = m_sink + data.vertices.size();
+	}
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the results to a JSON
+ *  file, one benchmark on each line.
+ ***********************************************************/
+bool MicroBenchmarks::WriteReport(const char* filename, const char* label) const
+{
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: could not write the microbenchmark report " << filename << std::endl;
+		return(false);
+	}
+
+	file << "{\n";
+	file << "  \"version\": " << MICROBENCH_REPORT_VERSION << ",\n";
+	file << "  \"label\": ";
+	JsonUtils::WriteString(file, (NULL != label) ? label : "");
+	file << ",\n";
+	file << "  \"benchmarks\": [";
+	for (size_t i = 0; i < m_results.size(); i++)
+	{
+		const BENCHMARK_RESULT& result = m_results[i];
+
+		file << ((i == 0) ? "\n" : ",\n");
+		file << "    { \"name\": ";
+		JsonUtils::WriteString(file, result.name);
+		file << ", \"iterations\": " << result.iterations;
+		file << ", \"repetitions\": " << result.repetitions;
+		file << ", \"medianNs\": " << result.medianNanoseconds;
+		file << ", \"minNs\": " << result.minNanoseconds;
+		file << ", \"meanNs\": " << result.meanNanoseconds << " }";
+	}
+	file << "\n  ]\n";
+	file << "}\n";
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadReport()
+ *
+ *  This method is used for reading the label and the
+ *  results of a report written by WriteReport().
+ ***********************************************************/
+bool MicroBenchmarks::ReadReport(
+	const char* filename,
+	std::string& label,
+	std::vector<BENCHMARK_RESULT>& results)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: could not read the microbenchmark report " << filename << std::endl;
+		return(false);
+	}
+
+	label.clear();
+	results.clear();
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		BENCHMARK_RESULT result;
+		double value = 0.0;
+
+		if (JsonUtils::ReadString(line, "name", result.name))
+		{
+			result.iterations = JsonUtils::ReadNumber(line, "iterations", value) ? (int)value : 0;
+			result.repetitions = JsonUtils::ReadNumber(line, "repetitions", value) ? (int)value : 0;
+			result.medianNanoseconds = JsonUtils::ReadNumber(line, "medianNs", value) ? value : 0.0;
+			result.minNanoseconds = JsonUtils::ReadNumber(line, "minNs", value) ? value : 0.0;
+			result.meanNanoseconds = JsonUtils::ReadNumber(line, "meanNs", value) ? value : 0.0;
+			results.push_back(result);
+		}
+		else
+		{
+			JsonUtils::ReadString(line, "label", label);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Compare()
+ *
+ *  This method is used for printing the median times of
+ *  two reports side by side, with the ratio of the second
+ *  to the first.
+ ***********************************************************/
+bool MicroBenchmarks::Compare(const char* baseFilename, const char* filename)
+{
+	std::string baseLabel;
+	std::string label;
+	std::vector<BENCHMARK_RESULT> baseResults;
+	std::vector<BENCHMARK_RESULT> results;
+
+	if ((ReadReport(baseFilename, baseLabel, baseResults) == false) ||
+		(ReadReport(filename, label, results) == false))
+	{
+		return(false);
+	}
+
+	char line[160];
+	snprintf(line, sizeof(line), "MICROBENCH: %-20s %14s %14s %8s",
+		"median ns", baseLabel.empty() ? baseFilename : baseLabel.c_str(),
+		label.empty() ? filename : label.c_str(), "ratio");
+	std::cout << line << std::endl;
+
+	for (size_t i = 0; i < baseResults.size(); i++)
+	{
+		const BENCHMARK_RESULT& base = baseResults[i];
+
+		size_t match = 0;
+		while ((match < results.size()) && (results[match].name != base.name))
+		{
+			match++;
+		}
+		if (match == results.size())
+		{
+			snprintf(line, sizeof(line), "MICROBENCH: %-20s %14.1f %14s", base.name.c_str(),
+				base.medianNanoseconds, "-");
+		}
+		else
+		{
+			double ratio = (base.medianNanoseconds > 0.0) ?
+				results[match].medianNanoseconds / base.medianNanoseconds : 0.0;
+			snprintf(line, sizeof(line), "MICROBENCH: %-20s %14.1f %14.1f %8.2f", base.name.c_str(),
+				base.medianNanoseconds, results[match].medianNanoseconds, ratio);
+		}
+		std::cout << line << std::endl;
+	}
+
+	return(true);
+}
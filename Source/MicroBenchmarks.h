@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+// microbenchmarks.h
+// ============
+// time the hot functions of the scene and view code in isolation
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NullRenderDevice.h"
+#include "SceneManager.h"
+#include "ViewManager.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MicroBenchmarks
+ *
+ *  This class contains the code for timing the functions
+ *  that the scene and view code run for every object or
+ *  every frame - the transformations, the texture and
+ *  material lookups, the view and projection matrices and
+ *  the mesh generation - each on its own, against the null
+ *  render device so that no graphics context is needed.
+ *  Each function is run in batches that are long enough to
+ *  time reliably, and the median time per call over the
+ *  batches is reported and written to a JSON file, so that
+ *  the results of two builds or two implementations can be
+ *  compared side by side.
+ ***********************************************************/
+class MicroBenchmarks
+{
+public:
+	// constructor
+	MicroBenchmarks();
+	// destructor
+	~MicroBenchmarks();
+
+	// timing of one benchmarked function
+	struct BENCHMARK_RESULT
+	{
+		std::string name;
+		// calls in each timed batch, and the number of batches
+		int iterations;
+		int repetitions;
+		// time per call over the batches, in nanoseconds
+		double medianNanoseconds;
+		double minNanoseconds;
+		double meanNanoseconds;
+	};
+
+	// run all of the benchmarks, printing the results
+	void Run();
+	// write the results to a JSON file, labeled with the name
+	// of the build or the implementation being measured
+	bool WriteReport(const char* filename, const char* label) const;
+
+	// print the results of two JSON files side by side
+	static bool Compare(const char* baseFilename, const char* filename);
+
+private:
+	// a benchmarked function that makes the passed in number
+	// of calls
+	typedef void (MicroBenchmarks::*BENCHMARK_FUNCTION)(int iterations);
+
+	NullRenderDevice* m_pRenderDevice;
+	SceneManager* m_pSceneManager;
+	ViewManager* m_pViewManager;
+	std::vector<BENCHMARK_RESULT> m_results;
+	// values read from the results of each call, so that the
+	// compiler cannot remove the calls
+	volatile double m_sink;
+
+	// load small textures with the scene tags into the scene
+	void LoadTestTextures();
+	// time a function and add its result
+	void RunBenchmark(const char* name, BENCHMARK_FUNCTION function);
+
+	// the benchmarked functions
+	void BenchmarkSetTransformations(int iterations);
+	void BenchmarkFindTextureSlot(int iterations);
+	void BenchmarkFindMaterial(int iterations);
+	void BenchmarkSetShaderMaterial(int iterations);
+	void BenchmarkPrepareSceneView(int iterations);
+	void BenchmarkGeneratePlane(int iterations);
+	void BenchmarkGenerateTorus(int iterations);
+	void BenchmarkGenerateCylinder(int iterations);
+	void BenchmarkGenerateSphere(int iterations);
+	void GenerateMeshes(MESH_TYPE mesh, int iterations);
+
+	// read the results of a JSON file written by WriteReport()
+	static bool ReadReport(
+		const char* filename,
+		std::string& label,
+		std::vector<BENCHMARK_RESULT>& results);
+};
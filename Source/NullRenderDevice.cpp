@@ -0,0 +1,420 @@
+///////////////////////////////////////////////////////////////////////////////
+// nullrenderdevice.cpp
+// ============
+// render device backend that records the commands without executing them
+///////////////////////////////////////////////////////////////////////////////
+
+#include "NullRenderDevice.h"
+#include "MeshGenerator.h"
+
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// initial capacity of the command list and payload storage,
+	// so that recording does not allocate in a typical frame
+	const size_t g_InitialCommandCapacity = 1024;
+	const size_t g_InitialPayloadCapacity = 64 * 1024;
+}
+
+/***********************************************************
+ *  NullRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+NullRenderDevice::NullRenderDevice()
+{
+	m_pipelineCount = 0;
+	m_textureCount = 0;
+	m_targetCount = 0;
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		m_meshTriangles[i] = 0;
+	}
+	m_commands.reserve(g_InitialCommandCapacity);
+	m_payload.reserve(g_InitialPayloadCapacity);
+}
+
+/***********************************************************
+ *  ~NullRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+NullRenderDevice::~NullRenderDevice()
+{
+	m_commands.clear();
+	m_payload.clear();
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for preparing the device, which has
+ *  no state to set up.
+ ***********************************************************/
+bool NullRenderDevice::Initialize()
+{
+	return(true);
+}
+
+/***********************************************************
+ *  RecordCommand()
+ *
+ *  This method is used for adding a command to the command
+ *  list of the current frame.
+ ***********************************************************/
+void NullRenderDevice::RecordCommand(
+	COMMAND_TYPE type,
+	uint32_t argument0,
+	uint32_t argument1,
+	const void* payload,
+	uint32_t payloadSize)
+{
+	RENDER_COMMAND command;
+
+	command.type = type;
+	command.argument0 = argument0;
+	command.argument1 = argument1;
+	command.payloadOffset = (uint32_t)m_payload.size();
+
+	if ((NULL != payload) && (payloadSize > 0))
+	{
+		m_payload.resize(m_payload.size() + payloadSize);
+		memcpy(&m_payload[command.payloadOffset], payload, payloadSize);
+	}
+
+	m_commands.push_back(command);
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a pipeline handle, the
+ *  shader files are not read.
+ ***********************************************************/
+uint32_t NullRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	m_pipelineCount++;
+	return(m_pipelineCount);
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for recording a pipeline bind.
+ ***********************************************************/
+void NullRenderDevice::BindPipeline(uint32_t pipeline)
+{
+	RecordCommand(COMMAND_BIND_PIPELINE, pipeline, 0);
+	m_stats.pipelineBinds++;
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing a pipeline handle.
+ ***********************************************************/
+void NullRenderDevice::DestroyPipeline(uint32_t pipeline)
+{
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture handle, the
+ *  image data is not copied.
+ ***********************************************************/
+uint32_t NullRenderDevice::CreateTexture(
+	int width,
+	int height,
+	int colorChannels,
+	const unsigned char* pixels)
+{
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		return(0);
+	}
+
+	m_textureCount++;
+	return(m_textureCount);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing a texture handle.
+ ***********************************************************/
+void NullRenderDevice::DestroyTexture(uint32_t texture)
+{
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for recording a texture bind.
+ ***********************************************************/
+void NullRenderDevice::BindTexture(int slot, uint32_t texture)
+{
+	RecordCommand(COMMAND_BIND_TEXTURE, (uint32_t)slot, texture);
+	m_stats.textureBinds++;
+}
+
+/***********************************************************
+ *  SetTextureSlot()
+ *
+ *  This method is used for recording the sampled slot.
+ ***********************************************************/
+void NullRenderDevice::SetTextureSlot(int slot)
+{
+	RecordCommand(COMMAND_SET_TEXTURE_SLOT, (uint32_t)slot, 0);
+}
+
+/***********************************************************
+ *  CreateStreamedTexture()
+ *
+ *  This method is used for creating a texture handle for a
+ *  texture that is uploaded a mip level at a time.
+ ***********************************************************/
+uint32_t NullRenderDevice::CreateStreamedTexture(int width, int height, int colorChannels, int mipLevels)
+{
+	if (((colorChannels != 3) && (colorChannels != 4)) || (mipLevels <= 0))
+	{
+		return(0);
+	}
+
+	m_textureCount++;
+	return(m_textureCount);
+}
+
+/***********************************************************
+ *  UploadTextureLevel()
+ *
+ *  This method is used for uploading a mip level, the image
+ *  data is not copied.
+ ***********************************************************/
+void NullRenderDevice::UploadTextureLevel(
+	uint32_t texture,
+	int level,
+	int width,
+	int height,
+	int colorChannels,
+	const unsigned char* pixels)
+{
+}
+
+/***********************************************************
+ *  CreateCubeTexture()
+ *
+ *  This method is used for creating a cube map texture
+ *  handle, the pixels are not copied.
+ ***********************************************************/
+uint32_t NullRenderDevice::CreateCubeTexture(int faceSize, int mipLevels, const float* pixels)
+{
+	if ((faceSize <= 0) || (mipLevels <= 0) || ((faceSize >> (mipLevels - 1)) == 0) || (NULL == pixels))
+	{
+		return(0);
+	}
+
+	m_textureCount++;
+	return(m_textureCount);
+}
+
+/***********************************************************
+ *  BindEnvironment()
+ *
+ *  This method is used for recording an environment bind.
+ ***********************************************************/
+void NullRenderDevice::BindEnvironment(uint32_t texture)
+{
+	RecordCommand(COMMAND_BIND_ENVIRONMENT, texture, 0);
+	m_stats.textureBinds++;
+}
+
+/***********************************************************
+ *  UpdateBlock()
+ *
+ *  These methods are used for recording a uniform block
+ *  update along with a copy of the block data.
+ ***********************************************************/
+void NullRenderDevice::UpdateBlock(const CAMERA_BLOCK& block)
+{
+	RecordCommand(COMMAND_UPDATE_BLOCK, CAMERA_BLOCK_BINDING, sizeof(block), &block, sizeof(block));
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+void NullRenderDevice::UpdateBlock(const LIGHT_BLOCK& block)
+{
+	RecordCommand(COMMAND_UPDATE_BLOCK, LIGHT_BLOCK_BINDING, sizeof(block), &block, sizeof(block));
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+void NullRenderDevice::UpdateBlock(const MATERIAL_BLOCK& block)
+{
+	RecordCommand(COMMAND_UPDATE_BLOCK, MATERIAL_BLOCK_BINDING, sizeof(block), &block, sizeof(block));
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+void NullRenderDevice::UpdateBlock(const INSTANCE_BLOCK& block)
+{
+	m_instanceViewMask = block.viewMask;
+	RecordCommand(COMMAND_UPDATE_BLOCK, INSTANCE_BLOCK_BINDING, sizeof(block), &block, sizeof(block));
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  This method is used for loading a mesh, which has no
+ *  vertex data in this device, so only its triangles are
+ *  counted.
+ ***********************************************************/
+void NullRenderDevice::LoadMesh(MESH_TYPE mesh)
+{
+	if ((mesh < 0) || (mesh >= MESH_COUNT))
+	{
+		return;
+	}
+
+	m_meshTriangles[mesh] = MeshGenerator::CountTriangles(mesh, MeshGenerator::DEFAULT_DETAIL);
+}
+
+void NullRenderDevice::LoadMesh(MESH_TYPE mesh, const MESH_DATA& data)
+{
+	if ((mesh < 0) || (mesh >= MESH_COUNT))
+	{
+		return;
+	}
+
+	m_meshTriangles[mesh] = (uint32_t)(data.indices.size() / 3);
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for recording a mesh draw, with one
+ *  instance for each view of the object as the OpenGL
+ *  device draws it.
+ ***********************************************************/
+void NullRenderDevice::DrawMesh(MESH_TYPE mesh)
+{
+	uint32_t views = CountViews(GetDrawViewMask());
+	if (views == 0)
+	{
+		return;
+	}
+
+	RecordCommand(COMMAND_DRAW_MESH, (uint32_t)mesh, views);
+	m_stats.drawCalls++;
+	if ((mesh >= 0) && (mesh < MESH_COUNT))
+	{
+		m_stats.triangles += m_meshTriangles[mesh] * views;
+	}
+}
+
+/***********************************************************
+ *  SetViews()
+ *
+ *  This method is used for recording the viewports of the
+ *  views along with a copy of them.
+ ***********************************************************/
+void NullRenderDevice::SetViews(const VIEWPORT* viewports, uint32_t viewCount)
+{
+	RenderDevice::SetViews(viewports, viewCount);
+	RecordCommand(COMMAND_SET_VIEWS, m_viewCount, 0, m_viewports, m_viewCount * (uint32_t)sizeof(VIEWPORT));
+}
+
+/***********************************************************
+ *  CreateTarget()
+ *
+ *  This method is used for creating a layered target
+ *  handle, no storage is allocated for the layers.
+ ***********************************************************/
+uint32_t NullRenderDevice::CreateTarget(const TARGET_DESC& desc)
+{
+	if ((desc.width <= 0) || (desc.height <= 0) || (desc.layers == 0) || (desc.layers > (uint32_t)MAX_VIEWS))
+	{
+		return(0);
+	}
+	if (desc.bCubeMap && ((desc.layers != 6) || (desc.width != desc.height)))
+	{
+		return(0);
+	}
+
+	m_targetCount++;
+	return(m_targetCount);
+}
+
+/***********************************************************
+ *  BindTarget()
+ *
+ *  This method is used for recording a target bind.
+ ***********************************************************/
+void NullRenderDevice::BindTarget(uint32_t target)
+{
+	RecordCommand(COMMAND_BIND_TARGET, target, 0);
+}
+
+/***********************************************************
+ *  ShowTarget()
+ *
+ *  This method is used for recording the copy of a target
+ *  into the window.
+ ***********************************************************/
+void NullRenderDevice::ShowTarget(uint32_t target)
+{
+	RecordCommand(COMMAND_SHOW_TARGET, target, 0);
+}
+
+/***********************************************************
+ *  FilterTargetMips()
+ *
+ *  This method is used for recording the filtering of the
+ *  mip levels of a cube map target.
+ ***********************************************************/
+void NullRenderDevice::FilterTargetMips(uint32_t target)
+{
+	RecordCommand(COMMAND_FILTER_TARGET_MIPS, target, 0);
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for recording an overlay draw along
+ *  with a copy of the vertices.
+ ***********************************************************/
+void NullRenderDevice::DrawOverlay(
+	const OVERLAY_VERTEX* vertices,
+	uint32_t vertexCount,
+	uint32_t texture)
+{
+	RecordCommand(COMMAND_DRAW_OVERLAY, vertexCount, texture,
+		vertices, vertexCount * (uint32_t)sizeof(OVERLAY_VERTEX));
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for resetting the command list at
+ *  the start of a frame, keeping the allocated storage.
+ ***********************************************************/
+void NullRenderDevice::BeginFrame()
+{
+	ResetStats();
+	m_commands.clear();
+	m_payload.clear();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing a frame, the recorded
+ *  commands are kept until the next frame begins.
+ ***********************************************************/
+void NullRenderDevice::EndFrame()
+{
+}
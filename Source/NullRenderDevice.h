@@ -0,0 +1,127 @@
+///////////////////////////////////////////////////////////////////////////////
+// nullrenderdevice.h
+// ============
+// render device backend that records the commands without executing them
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <vector>
+
+/***********************************************************
+ *  NullRenderDevice
+ *
+ *  This class contains a render device that only records
+ *  the issued commands into a command list, which is reset
+ *  at the start of each frame.  No graphics context is
+ *  needed, so the CPU cost of the scene code can be
+ *  measured without a GPU driver in the loop.
+ ***********************************************************/
+class NullRenderDevice : public RenderDevice
+{
+public:
+	// constructor
+	NullRenderDevice();
+	// destructor
+	virtual ~NullRenderDevice();
+
+	// types of the recorded commands
+	enum COMMAND_TYPE
+	{
+		COMMAND_BIND_PIPELINE = 0,
+		COMMAND_BIND_TEXTURE,
+		COMMAND_SET_TEXTURE_SLOT,
+		COMMAND_UPDATE_BLOCK,
+		COMMAND_DRAW_MESH,
+		COMMAND_DRAW_OVERLAY,
+		COMMAND_SET_VIEWS,
+		COMMAND_BIND_TARGET,
+		COMMAND_SHOW_TARGET,
+		COMMAND_FILTER_TARGET_MIPS,
+		COMMAND_BIND_ENVIRONMENT
+	};
+
+	// recorded command, the uniform block data is copied into
+	// the payload storage in the same way the driver would
+	struct RENDER_COMMAND
+	{
+		COMMAND_TYPE type;
+		uint32_t argument0;
+		uint32_t argument1;
+		uint32_t payloadOffset;
+	};
+
+	virtual const char* GetName() const { return "Null"; }
+	virtual bool Initialize();
+
+	virtual uint32_t CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void BindPipeline(uint32_t pipeline);
+	virtual void DestroyPipeline(uint32_t pipeline);
+
+	virtual uint32_t CreateTexture(
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels);
+	virtual void DestroyTexture(uint32_t texture);
+	virtual void BindTexture(int slot, uint32_t texture);
+	virtual void SetTextureSlot(int slot);
+	virtual uint32_t CreateStreamedTexture(int width, int height, int colorChannels, int mipLevels);
+	virtual void UploadTextureLevel(
+		uint32_t texture,
+		int level,
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels);
+	virtual uint32_t CreateCubeTexture(int faceSize, int mipLevels, const float* pixels);
+	virtual void BindEnvironment(uint32_t texture);
+
+	virtual void UpdateBlock(const CAMERA_BLOCK& block);
+	virtual void UpdateBlock(const LIGHT_BLOCK& block);
+	virtual void UpdateBlock(const MATERIAL_BLOCK& block);
+	virtual void UpdateBlock(const INSTANCE_BLOCK& block);
+
+	virtual void LoadMesh(MESH_TYPE mesh);
+	virtual void LoadMesh(MESH_TYPE mesh, const MESH_DATA& data);
+	virtual void DrawMesh(MESH_TYPE mesh);
+	virtual void SetViews(const VIEWPORT* viewports, uint32_t viewCount);
+
+	virtual uint32_t CreateTarget(const TARGET_DESC& desc);
+	virtual void BindTarget(uint32_t target);
+	virtual void ShowTarget(uint32_t target);
+	virtual void FilterTargetMips(uint32_t target);
+
+	virtual void DrawOverlay(
+		const OVERLAY_VERTEX* vertices,
+		uint32_t vertexCount,
+		uint32_t texture);
+
+	virtual void BeginFrame();
+	virtual void EndFrame();
+
+	// get the commands recorded during the current frame
+	const std::vector<RENDER_COMMAND>& GetCommands() const { return m_commands; }
+
+private:
+	// commands recorded during the current frame
+	std::vector<RENDER_COMMAND> m_commands;
+	// storage for the uniform block data of the commands
+	std::vector<unsigned char> m_payload;
+	// number of created pipelines, textures and targets
+	uint32_t m_pipelineCount;
+	uint32_t m_textureCount;
+	uint32_t m_targetCount;
+	// triangles in each loaded mesh, for the frame counters
+	uint32_t m_meshTriangles[MESH_COUNT];
+
+	// record a command and optionally copy its payload
+	void RecordCommand(
+		COMMAND_TYPE type,
+		uint32_t argument0,
+		uint32_t argument1,
+		const void* payload = NULL,
+		uint32_t payloadSize = 0);
+};
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// perfcounters.cpp
+// ============
+// read the CPU hardware performance counters of the main thread
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerfCounters.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const char* const COUNTER_NAMES[PerfCounters::COUNTER_COUNT] =
+	{
+		"cycles",
+		"instructions",
+		"l1d misses",
+		"llc misses",
+		"branch misses"
+	};
+
+#ifdef __linux__
+	// event type and config of each counter
+	struct COUNTER_EVENT
+	{
+		uint32_t type;
+		uint64_t config;
+	};
+	const COUNTER_EVENT COUNTER_EVENTS[PerfCounters::COUNTER_COUNT] =
+	{
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		{ PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D |
+			(PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+		{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES }
+	};
+
+	// open one counter of the calling thread in user mode, in
+	// the group of the passed in leader
+	int OpenCounter(const COUNTER_EVENT& event, int groupLeader)
+	{
+		perf_event_attr attributes;
+		memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = event.type;
+		attributes.config = event.config;
+		attributes.disabled = (groupLeader < 0) ? 1 : 0;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		attributes.read_format = PERF_FORMAT_GROUP |
+			PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+		return((int)syscall(__NR_perf_event_open, &attributes, 0, -1, groupLeader, 0));
+	}
+#endif
+}
+
+/***********************************************************
+ *  PerfCounters()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerfCounters::PerfCounters()
+{
+	m_leader = -1;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_descriptors[i] = -1;
+		m_groupSlots[i] = -1;
+	}
+	m_groupSize = 0;
+}
+
+/***********************************************************
+ *  ~PerfCounters()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PerfCounters::~PerfCounters()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for opening the counters as a group
+ *  and starting them.  The first counter that opens leads
+ *  the group, and the counters that cannot be opened are
+ *  left out.
+ ***********************************************************/
+bool PerfCounters::Open()
+{
+	if (IsOpen())
+	{
+		return(true);
+	}
+
+#ifdef __linux__
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		int descriptor = OpenCounter(COUNTER_EVENTS[i], m_leader);
+		if (descriptor < 0)
+		{
+			continue;
+		}
+
+		if (m_leader < 0)
+		{
+			m_leader = descriptor;
+		}
+		m_descriptors[i] = descriptor;
+		m_groupSlots[i] = m_groupSize;
+		m_groupSize++;
+	}
+
+	if (m_leader < 0)
+	{
+		std::cout << "WARNING: the hardware counters could not be opened, "
+			"check /proc/sys/kernel/perf_event_paranoid" << std::endl;
+		return(false);
+	}
+
+	ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	return(true);
+#else
+	std::cout << "WARNING: the hardware counters are only read on Linux" << std::endl;
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for closing the counters.
+ ***********************************************************/
+void PerfCounters::Close()
+{
+#ifdef __linux__
+	// the leader is closed last, after the counters in its group
+	for (int i = COUNTER_COUNT - 1; i >= 0; i--)
+	{
+		if (m_descriptors[i] >= 0)
+		{
+			close(m_descriptors[i]);
+		}
+	}
+#endif
+
+	m_leader = -1;
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		m_descriptors[i] = -1;
+		m_groupSlots[i] = -1;
+	}
+	m_groupSize = 0;
+}
+
+/***********************************************************
+ *  Read()
+ *
+ *  This method is used for reading all of the counters with
+ *  one system call, scaling them when the group was only
+ *  counting for part of the time.  The counters that are
+ *  not counted read as zero.
+ ***********************************************************/
+bool PerfCounters::Read(COUNTER_VALUES& values) const
+{
+	memset(&values, 0, sizeof(values));
+	if (IsOpen() == false)
+	{
+		return(false);
+	}
+
+#ifdef __linux__
+	// number of values, the enabled and running times, and
+	// the value of each counter in the group
+	uint64_t buffer[3 + COUNTER_COUNT];
+	ssize_t size = read(m_leader, buffer, sizeof(buffer));
+	if ((size < (ssize_t)(3 * sizeof(uint64_t))) || (buffer[0] != (uint64_t)m_groupSize) || (buffer[2] == 0))
+	{
+		return(false);
+	}
+
+	uint64_t timeEnabled = buffer[1];
+	uint64_t timeRunning = buffer[2];
+	for (int i = 0; i < COUNTER_COUNT; i++)
+	{
+		if (m_groupSlots[i] < 0)
+		{
+			continue;
+		}
+
+		uint64_t value = buffer[3 + m_groupSlots[i]];
+		if (timeRunning < timeEnabled)
+		{
+			value = (uint64_t)((double)value * timeEnabled / timeRunning);
+		}
+		values.values[i] = value;
+	}
+	return(true);
+#else
+	return(false);
+#endif
+}
+
+/***********************************************************
+ *  GetName()
+ *
+ *  This method is used for getting the name of a counter.
+ ***********************************************************/
+const char* PerfCounters::GetName(COUNTER counter)
+{
+	if ((counter < 0) || (counter >= COUNTER_COUNT))
+	{
+		return("unknown");
+	}
+
+	return(COUNTER_NAMES[counter]);
+}
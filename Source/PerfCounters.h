@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// perfcounters.h
+// ============
+// read the CPU hardware performance counters of the main thread
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+
+/***********************************************************
+ *  PerfCounters
+ *
+ *  This class contains the code for counting the cycles,
+ *  the instructions, the cache misses and the mispredicted
+ *  branches of the calling thread with perf_event_open on
+ *  Linux.  The counters are opened as one group, so they
+ *  are scheduled onto the CPU together and read with one
+ *  system call.  When the CPU has fewer counters than the
+ *  group needs, the kernel time slices the group, and the
+ *  values are scaled up to the whole time it was enabled.
+ *  Counters that the CPU does not support are left out.
+ *  On other systems the counters are not available.
+ ***********************************************************/
+class PerfCounters
+{
+public:
+	// constructor
+	PerfCounters();
+	// destructor
+	~PerfCounters();
+
+	// counted events
+	enum COUNTER
+	{
+		COUNTER_CYCLES = 0,
+		COUNTER_INSTRUCTIONS,
+		COUNTER_L1D_MISSES,
+		COUNTER_LLC_MISSES,
+		COUNTER_BRANCH_MISSES,
+		COUNTER_COUNT
+	};
+
+	// values of all the counters
+	struct COUNTER_VALUES
+	{
+		uint64_t values[COUNTER_COUNT];
+	};
+
+	// open and start the counters for the calling thread,
+	// false is returned when none of them can be opened
+	bool Open();
+	bool IsOpen() const { return(m_leader >= 0); }
+	// check whether a counter is being counted
+	bool IsCounted(COUNTER counter) const { return(m_groupSlots[counter] >= 0); }
+
+	// read the counts since the counters were opened, false
+	// is returned when the group could not be scheduled
+	bool Read(COUNTER_VALUES& values) const;
+
+	// name of a counter for reporting
+	static const char* GetName(COUNTER counter);
+
+private:
+	// file descriptor of the group leader, and of each counter
+	int m_leader;
+	int m_descriptors[COUNTER_COUNT];
+	// position of each counter in the group read, or -1 when
+	// the counter is not counted
+	int m_groupSlots[COUNTER_COUNT];
+	int m_groupSize;
+
+	// close the counters
+	void Close();
+};
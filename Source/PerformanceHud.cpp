@@ -0,0 +1,574 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancehud.cpp
+// ============
+// on-screen overlay of the frame timing and render counters
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerformanceHud.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// characters in the font, in the order of the glyphs
+	const char* const FONT_CHARACTERS = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:/%-()|";
+
+	// 5x7 glyphs, one byte per row with the leftmost pixel
+	// in the fifth bit
+	const int GLYPH_WIDTH = 5;
+	const int GLYPH_HEIGHT = 7;
+	const unsigned char FONT_GLYPHS[][GLYPH_HEIGHT] =
+	{
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },	// space
+		{ 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },	// 0
+		{ 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },	// 1
+		{ 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },	// 2
+		{ 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },	// 3
+		{ 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },	// 4
+		{ 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },	// 5
+		{ 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },	// 6
+		{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },	// 7
+		{ 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },	// 8
+		{ 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },	// 9
+		{ 0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },	// A
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },	// B
+		{ 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },	// C
+		{ 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },	// D
+		{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },	// E
+		{ 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },	// F
+		{ 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },	// G
+		{ 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },	// H
+		{ 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },	// I
+		{ 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },	// J
+		{ 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },	// K
+		{ 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },	// L
+		{ 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },	// M
+		{ 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },	// N
+		{ 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },	// O
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },	// P
+		{ 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },	// Q
+		{ 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },	// R
+		{ 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },	// S
+		{ 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },	// T
+		{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },	// U
+		{ 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },	// V
+		{ 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },	// W
+		{ 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },	// X
+		{ 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },	// Y
+		{ 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },	// Z
+		{ 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },	// .
+		{ 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },	// :
+		{ 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },	// /
+		{ 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },	// %
+		{ 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },	// -
+		{ 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },	// (
+		{ 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },	// )
+		{ 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }	// |
+	};
+
+	// each glyph is drawn at twice its size in a cell with a
+	// blank column and row, so that filtering does not bleed
+	// between the glyphs
+	const int GLYPH_SCALE = 2;
+	const int CELL_WIDTH = (GLYPH_WIDTH + 1) * GLYPH_SCALE;
+	const int CELL_HEIGHT = (GLYPH_HEIGHT + 1) * GLYPH_SCALE;
+	const int ATLAS_COLUMNS = 16;
+	const int ATLAS_WIDTH = 256;
+	const int ATLAS_HEIGHT = 64;
+	// opaque region to the right of the glyphs for solid quads
+	const int SOLID_X = ATLAS_COLUMNS * CELL_WIDTH;
+	const float SOLID_U = (SOLID_X + ((ATLAS_WIDTH - SOLID_X) * 0.5f)) / ATLAS_WIDTH;
+	const float SOLID_V = (CELL_HEIGHT * 0.5f) / ATLAS_HEIGHT;
+
+	// panel layout in pixels
+	const float PANEL_X = 8.0f;
+	const float PANEL_Y = 8.0f;
+	const float PANEL_PADDING = 6.0f;
+	const float PANEL_WIDTH = 330.0f;
+	const float GRAPH_HEIGHT = 64.0f;
+	const float GRAPH_BAR_WIDTH = 2.0f;
+	const float LINE_HEIGHT = CELL_HEIGHT + 2.0f;
+	const int TEXT_LINES = 9;
+
+	// frame time shown at the top of the graph, and the frame
+	// times of 60 and 30 frames per second that set the colors
+	const float GRAPH_MAX_MILLISECONDS = 50.0f;
+	const float TARGET_MILLISECONDS = 1000.0f / 60.0f;
+	const float SLOW_MILLISECONDS = 1000.0f / 30.0f;
+
+	// time between the text refreshes
+	const double TEXT_REFRESH_SECONDS = 0.25;
+
+	// vertices reserved for the panel, which covers the graph
+	// bars and a few hundred characters
+	const size_t RESERVED_VERTICES = 4096;
+
+	// pack a color into the RGBA byte order of the vertices
+	uint32_t MakeColor(unsigned char r, unsigned char g, unsigned char b, unsigned char a)
+	{
+		unsigned char bytes[4] = { r, g, b, a };
+		uint32_t color = 0;
+		memcpy(&color, bytes, sizeof(color));
+		return(color);
+	}
+
+	const uint32_t COLOR_BACKGROUND = MakeColor(0, 0, 0, 170);
+	const uint32_t COLOR_TEXT = MakeColor(255, 255, 255, 255);
+	const uint32_t COLOR_GUIDE = MakeColor(255, 255, 255, 70);
+	const uint32_t COLOR_CPU = MakeColor(80, 140, 230, 255);
+	const uint32_t COLOR_FAST = MakeColor(80, 200, 80, 255);
+	const uint32_t COLOR_MEDIUM = MakeColor(230, 200, 40, 255);
+	const uint32_t COLOR_SLOW = MakeColor(220, 60, 60, 255);
+}
+
+/***********************************************************
+ *  PerformanceHud()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerformanceHud::PerformanceHud(RenderDevice* pDevice)
+{
+	m_pDevice = pDevice;
+	m_bVisible = false;
+
+	m_atlasTexture = 0;
+	m_bAtlasFailed = false;
+	for (int i = 0; i < 128; i++)
+	{
+		m_glyphCells[i] = -1;
+	}
+	for (int i = 0; FONT_CHARACTERS[i] != '\0'; i++)
+	{
+		m_glyphCells[(int)FONT_CHARACTERS[i]] = i;
+	}
+
+	m_bFrameStarted = false;
+	m_cpuMilliseconds = 0.0;
+	m_hudMilliseconds = 0.0;
+	for (int i = 0; i < GRAPH_SAMPLES; i++)
+	{
+		m_samples[i].frameMilliseconds = 0.0f;
+		m_samples[i].cpuMilliseconds = 0.0f;
+	}
+	m_sampleNext = 0;
+	m_sampleCount = 0;
+
+	m_queuedUploads = 0;
+	m_deferredUploadBytes = 0;
+	m_culledObjects = 0;
+
+	m_lastRefresh = Clock::time_point();
+	m_frameTotal = 0.0;
+	m_cpuTotal = 0.0;
+	m_gpuTotal = 0.0;
+	m_frameTotalCount = 0;
+	m_gpuTotalCount = 0;
+
+	m_textVertices.reserve(RESERVED_VERTICES);
+	m_vertices.reserve(RESERVED_VERTICES);
+}
+
+/***********************************************************
+ *  ~PerformanceHud()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PerformanceHud::~PerformanceHud()
+{
+	if ((NULL != m_pDevice) && (m_atlasTexture != 0))
+	{
+		m_pDevice->DestroyTexture(m_atlasTexture);
+	}
+	m_atlasTexture = 0;
+	m_pDevice = NULL;
+}
+
+/***********************************************************
+ *  CreateAtlas()
+ *
+ *  This method is used for expanding the font glyphs into
+ *  the RGBA atlas texture.  The glyphs are white so that
+ *  the vertex color sets the color of the text.
+ ***********************************************************/
+bool PerformanceHud::CreateAtlas()
+{
+	std::vector<unsigned char> pixels(ATLAS_WIDTH * ATLAS_HEIGHT * 4, 0);
+	int glyphCount = (int)(sizeof(FONT_GLYPHS) / sizeof(FONT_GLYPHS[0]));
+
+	for (int glyph = 0; glyph < glyphCount; glyph++)
+	{
+		int cellX = (glyph % ATLAS_COLUMNS) * CELL_WIDTH;
+		int cellY = (glyph / ATLAS_COLUMNS) * CELL_HEIGHT;
+
+		for (int y = 0; y < GLYPH_HEIGHT * GLYPH_SCALE; y++)
+		{
+			unsigned char row = FONT_GLYPHS[glyph][y / GLYPH_SCALE];
+			for (int x = 0; x < GLYPH_WIDTH * GLYPH_SCALE; x++)
+			{
+				if (row & (0x10 >> (x / GLYPH_SCALE)))
+				{
+					unsigned char* pPixel = &pixels[(((cellY + y) * ATLAS_WIDTH) + cellX + x) * 4];
+					pPixel[0] = 255;
+					pPixel[1] = 255;
+					pPixel[2] = 255;
+					pPixel[3] = 255;
+				}
+			}
+		}
+	}
+
+	// solid region used by the background and graph quads
+	for (int y = 0; y < CELL_HEIGHT; y++)
+	{
+		memset(&pixels[((y * ATLAS_WIDTH) + SOLID_X) * 4], 255, (ATLAS_WIDTH - SOLID_X) * 4);
+	}
+
+	m_atlasTexture = m_pDevice->CreateTexture(ATLAS_WIDTH, ATLAS_HEIGHT, 4, pixels.data());
+	if (m_atlasTexture == 0)
+	{
+		LOG_ERROR("could not create the performance overlay font texture");
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for marking the start of a frame,
+ *  which also ends the previous frame and records its time
+ *  in the graph.
+ ***********************************************************/
+void PerformanceHud::BeginFrame()
+{
+	Clock::time_point now = Clock::now();
+
+	if (m_bFrameStarted)
+	{
+		FRAME_SAMPLE& sample = m_samples[m_sampleNext];
+		sample.frameMilliseconds = (float)std::chrono::duration<double, std::milli>(now - m_frameStart).count();
+		sample.cpuMilliseconds = (float)m_cpuMilliseconds;
+		m_sampleNext = (m_sampleNext + 1) % GRAPH_SAMPLES;
+		m_sampleCount = std::min(m_sampleCount + 1, GRAPH_SAMPLES);
+
+		m_frameTotal += sample.frameMilliseconds;
+		m_cpuTotal += sample.cpuMilliseconds;
+		m_frameTotalCount++;
+	}
+
+	m_frameStart = now;
+	m_bFrameStarted = true;
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for ending the CPU time of the frame
+ *  and, when the panel is visible, building its vertices
+ *  and drawing them in one overlay draw.
+ ***********************************************************/
+void PerformanceHud::Render()
+{
+	Clock::time_point start = Clock::now();
+	double gpuMilliseconds = 0.0;
+
+	if ((NULL == m_pDevice) || (m_bFrameStarted == false))
+	{
+		return;
+	}
+	m_cpuMilliseconds = std::chrono::duration<double, std::milli>(start - m_frameStart).count();
+
+	if (m_pDevice->GetGpuFrameTime(gpuMilliseconds))
+	{
+		m_gpuTotal += gpuMilliseconds;
+		m_gpuTotalCount++;
+	}
+
+	if ((m_bVisible == false) || m_bAtlasFailed)
+	{
+		return;
+	}
+	if ((m_atlasTexture == 0) && (CreateAtlas() == false))
+	{
+		m_bAtlasFailed = true;
+		return;
+	}
+
+	if ((m_textVertices.empty()) ||
+		(std::chrono::duration<double>(start - m_lastRefresh).count() >= TEXT_REFRESH_SECONDS))
+	{
+		RefreshText(m_pDevice->GetStats());
+		m_lastRefresh = start;
+	}
+
+	m_vertices.clear();
+	float panelHeight = (PANEL_PADDING * 3.0f) + GRAPH_HEIGHT + (TEXT_LINES * LINE_HEIGHT);
+	AddSolidQuad(m_vertices, PANEL_X, PANEL_Y, PANEL_X + PANEL_WIDTH, PANEL_Y + panelHeight, COLOR_BACKGROUND);
+	BuildGraph();
+	m_vertices.insert(m_vertices.end(), m_textVertices.begin(), m_textVertices.end());
+
+	m_pDevice->DrawOverlay(m_vertices.data(), (uint32_t)m_vertices.size(), m_atlasTexture);
+
+	m_hudMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/***********************************************************
+ *  SetUploadQueue()
+ *
+ *  This method is used for setting the streamed uploads
+ *  that were deferred to later frames by the upload budget.
+ ***********************************************************/
+void PerformanceHud::SetUploadQueue(int queuedAssets, size_t deferredBytes)
+{
+	m_queuedUploads = queuedAssets;
+	m_deferredUploadBytes = deferredBytes;
+}
+
+/***********************************************************
+ *  RefreshText()
+ *
+ *  This method is used for rebuilding the text lines from
+ *  the values averaged since the previous refresh, and the
+ *  counters of the current frame.
+ ***********************************************************/
+void PerformanceHud::RefreshText(const RenderDevice::RENDER_STATS& stats)
+{
+	char line[64];
+	float x = PANEL_X + PANEL_PADDING;
+	float y = PANEL_Y + (PANEL_PADDING * 2.0f) + GRAPH_HEIGHT;
+
+	double frameMilliseconds = (m_frameTotalCount > 0) ? (m_frameTotal / m_frameTotalCount) : 0.0;
+	double cpuMilliseconds = (m_frameTotalCount > 0) ? (m_cpuTotal / m_frameTotalCount) : m_cpuMilliseconds;
+	double framesPerSecond = (frameMilliseconds > 0.0) ? (1000.0 / frameMilliseconds) : 0.0;
+	size_t memoryBytes = GetProcessMemory();
+
+	m_textVertices.clear();
+
+	snprintf(line, sizeof(line), "FRAME  %6.2f MS %5.0f FPS", frameMilliseconds, framesPerSecond);
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "CPU    %6.2f MS", cpuMilliseconds);
+	AddText(m_textVertices, x, y, line, COLOR_CPU);
+	y += LINE_HEIGHT;
+
+	if (m_gpuTotalCount > 0)
+	{
+		snprintf(line, sizeof(line), "GPU    %6.2f MS", m_gpuTotal / m_gpuTotalCount);
+	}
+	else
+	{
+		snprintf(line, sizeof(line), "GPU       N/A");
+	}
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "DRAWS  %u", stats.drawCalls);
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "TRIS   %u", stats.triangles);
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "CULLED %d", m_culledObjects);
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	if (memoryBytes > 0)
+	{
+		snprintf(line, sizeof(line), "MEMORY %6.1f MB", memoryBytes / (1024.0 * 1024.0));
+	}
+	else
+	{
+		snprintf(line, sizeof(line), "MEMORY    N/A");
+	}
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "QUEUE  %3d %8.1f KB", m_queuedUploads, m_deferredUploadBytes / 1024.0);
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+	y += LINE_HEIGHT;
+
+	snprintf(line, sizeof(line), "HUD    %6.3f MS", m_hudMilliseconds);
+	AddText(m_textVertices, x, y, line, COLOR_TEXT);
+
+	m_frameTotal = 0.0;
+	m_cpuTotal = 0.0;
+	m_gpuTotal = 0.0;
+	m_frameTotalCount = 0;
+	m_gpuTotalCount = 0;
+}
+
+/***********************************************************
+ *  BuildGraph()
+ *
+ *  This method is used for adding a bar for each of the
+ *  recent frames, oldest on the left.  The bar is colored
+ *  by whether the frame made 60 or 30 frames per second,
+ *  with the CPU part of the frame drawn over its base.
+ ***********************************************************/
+void PerformanceHud::BuildGraph()
+{
+	float left = PANEL_X + PANEL_PADDING;
+	float bottom = PANEL_Y + PANEL_PADDING + GRAPH_HEIGHT;
+	float scale = GRAPH_HEIGHT / GRAPH_MAX_MILLISECONDS;
+	float right = left + (GRAPH_SAMPLES * GRAPH_BAR_WIDTH);
+
+	// guide lines at the 60 and 30 frames per second times
+	AddSolidQuad(m_vertices, left, bottom - (TARGET_MILLISECONDS * scale),
+		right, bottom - (TARGET_MILLISECONDS * scale) + 1.0f, COLOR_GUIDE);
+	AddSolidQuad(m_vertices, left, bottom - (SLOW_MILLISECONDS * scale),
+		right, bottom - (SLOW_MILLISECONDS * scale) + 1.0f, COLOR_GUIDE);
+
+	for (int i = 0; i < m_sampleCount; i++)
+	{
+		int index = (m_sampleNext - m_sampleCount + i + GRAPH_SAMPLES) % GRAPH_SAMPLES;
+		const FRAME_SAMPLE& sample = m_samples[index];
+		float x = left + ((GRAPH_SAMPLES - m_sampleCount + i) * GRAPH_BAR_WIDTH);
+		float frameHeight = std::min(sample.frameMilliseconds, GRAPH_MAX_MILLISECONDS) * scale;
+		float cpuHeight = std::min(sample.cpuMilliseconds, sample.frameMilliseconds);
+		cpuHeight = std::min(cpuHeight, GRAPH_MAX_MILLISECONDS) * scale;
+
+		uint32_t color = COLOR_FAST;
+		if (sample.frameMilliseconds > SLOW_MILLISECONDS)
+		{
+			color = COLOR_SLOW;
+		}
+		else if (sample.frameMilliseconds > TARGET_MILLISECONDS)
+		{
+			color = COLOR_MEDIUM;
+		}
+
+		AddSolidQuad(m_vertices, x, bottom - frameHeight, x + GRAPH_BAR_WIDTH, bottom - cpuHeight, color);
+		AddSolidQuad(m_vertices, x, bottom - cpuHeight, x + GRAPH_BAR_WIDTH, bottom, COLOR_CPU);
+	}
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  This method is used for appending the two triangles of
+ *  a textured quad to the passed in vertex list.
+ ***********************************************************/
+void PerformanceHud::AddQuad(
+	std::vector<OVERLAY_VERTEX>& vertices,
+	float x0, float y0, float x1, float y1,
+	float u0, float v0, float u1, float v1,
+	uint32_t color)
+{
+	OVERLAY_VERTEX corners[4] =
+	{
+		{ x0, y0, u0, v0, color },
+		{ x1, y0, u1, v0, color },
+		{ x1, y1, u1, v1, color },
+		{ x0, y1, u0, v1, color }
+	};
+
+	vertices.push_back(corners[0]);
+	vertices.push_back(corners[1]);
+	vertices.push_back(corners[2]);
+	vertices.push_back(corners[0]);
+	vertices.push_back(corners[2]);
+	vertices.push_back(corners[3]);
+}
+
+/***********************************************************
+ *  AddSolidQuad()
+ *
+ *  This method is used for appending a quad of one color,
+ *  which samples the opaque region of the atlas.
+ ***********************************************************/
+void PerformanceHud::AddSolidQuad(
+	std::vector<OVERLAY_VERTEX>& vertices,
+	float x0, float y0, float x1, float y1,
+	uint32_t color)
+{
+	if (y1 <= y0)
+	{
+		return;
+	}
+
+	AddQuad(vertices, x0, y0, x1, y1, SOLID_U, SOLID_V, SOLID_U, SOLID_V, color);
+}
+
+/***********************************************************
+ *  AddText()
+ *
+ *  This method is used for appending a quad for each of the
+ *  characters in the passed in text.  Lower case letters
+ *  use the upper case glyphs, and spaces and characters
+ *  that are not in the font only advance the position.
+ ***********************************************************/
+void PerformanceHud::AddText(
+	std::vector<OVERLAY_VERTEX>& vertices,
+	float x, float y,
+	const char* text,
+	uint32_t color) const
+{
+	for (const char* pChar = text; *pChar != '\0'; pChar++)
+	{
+		int character = (unsigned char)*pChar;
+		if ((character >= 'a') && (character <= 'z'))
+		{
+			character -= 'a' - 'A';
+		}
+
+		int cell = (character < 128) ? m_glyphCells[character] : -1;
+		if (cell > 0)
+		{
+			float u = (float)((cell % ATLAS_COLUMNS) * CELL_WIDTH) / ATLAS_WIDTH;
+			float v = (float)((cell / ATLAS_COLUMNS) * CELL_HEIGHT) / ATLAS_HEIGHT;
+			AddQuad(vertices, x, y, x + CELL_WIDTH, y + CELL_HEIGHT,
+				u, v, u + ((float)CELL_WIDTH / ATLAS_WIDTH), v + ((float)CELL_HEIGHT / ATLAS_HEIGHT),
+				color);
+		}
+		x += CELL_WIDTH;
+	}
+}
+
+/***********************************************************
+ *  GetProcessMemory()
+ *
+ *  This method is used for getting the physical memory in
+ *  use by the process, which is the working set on Windows
+ *  and the resident set on Linux.
+ ***********************************************************/
+size_t PerformanceHud::GetProcessMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return((size_t)counters.WorkingSetSize);
+	}
+#elif defined(__linux__)
+	FILE* pFile = fopen("/proc/self/statm", "r");
+	if (NULL != pFile)
+	{
+		unsigned long totalPages = 0;
+		unsigned long residentPages = 0;
+		int fields = fscanf(pFile, "%lu %lu", &totalPages, &residentPages);
+		fclose(pFile);
+		if (fields == 2)
+		{
+			return((size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE));
+		}
+	}
+#endif
+	return(0);
+}
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancehud.h
+// ============
+// on-screen overlay of the frame timing and render counters
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  PerformanceHud
+ *
+ *  This class contains the code for drawing a panel over
+ *  the scene with a graph of the recent frame times, split
+ *  into the CPU and the total time, and text lines with the
+ *  GPU time, the render counters and the process memory.
+ *  The text and the graph are drawn from one glyph atlas
+ *  texture, so the whole panel is a single overlay draw.
+ *  The text is only rebuilt a few times per second, which
+ *  also keeps it readable while the values change.
+ ***********************************************************/
+class PerformanceHud
+{
+public:
+	// constructor
+	PerformanceHud(RenderDevice* pDevice);
+	// destructor
+	~PerformanceHud();
+
+	// show or hide the panel, the frame times are recorded
+	// while it is hidden so the graph is full when shown
+	void SetVisible(bool bVisible) { m_bVisible = bVisible; }
+	void ToggleVisible() { m_bVisible = !m_bVisible; }
+	bool IsVisible() const { return(m_bVisible); }
+
+	// get the memory used by the process, or zero if unknown
+	static size_t GetProcessMemory();
+
+	// set the streamed assets that are queued for upload in
+	// later frames, and the bytes that they hold
+	void SetUploadQueue(int queuedAssets, size_t deferredBytes);
+	// set the objects that were culled from the current frame
+	void SetCulledObjects(int culledObjects) { m_culledObjects = culledObjects; }
+
+	// mark the start of a frame
+	void BeginFrame();
+	// mark the end of the CPU work for the frame and draw
+	// the panel, called after the scene has been drawn
+	void Render();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	typedef RenderDevice::OVERLAY_VERTEX OVERLAY_VERTEX;
+
+	// frames shown in the frame time graph
+	static const int GRAPH_SAMPLES = 120;
+
+	// timing of one frame in the graph
+	struct FRAME_SAMPLE
+	{
+		float frameMilliseconds;
+		float cpuMilliseconds;
+	};
+
+	// device that draws the panel
+	RenderDevice* m_pDevice;
+	bool m_bVisible;
+
+	// glyph atlas texture, created when first drawn
+	uint32_t m_atlasTexture;
+	bool m_bAtlasFailed;
+	// atlas cell of each character, or -1 if not in the font
+	int m_glyphCells[128];
+
+	// frame timing
+	Clock::time_point m_frameStart;
+	bool m_bFrameStarted;
+	double m_cpuMilliseconds;
+	double m_hudMilliseconds;
+	FRAME_SAMPLE m_samples[GRAPH_SAMPLES];
+	int m_sampleNext;
+	int m_sampleCount;
+
+	// values averaged between the text refreshes
+	Clock::time_point m_lastRefresh;
+	double m_frameTotal;
+	double m_cpuTotal;
+	double m_gpuTotal;
+	int m_frameTotalCount;
+	int m_gpuTotalCount;
+
+	// streamed uploads left for later frames
+	int m_queuedUploads;
+	size_t m_deferredUploadBytes;
+	// objects culled from the current frame
+	int m_culledObjects;
+
+	// vertices of the text, kept between the refreshes, and
+	// of the whole panel for the current frame
+	std::vector<OVERLAY_VERTEX> m_textVertices;
+	std::vector<OVERLAY_VERTEX> m_vertices;
+
+	// create the glyph atlas texture
+	bool CreateAtlas();
+	// rebuild the text lines from the averaged values
+	void RefreshText(const RenderDevice::RENDER_STATS& stats);
+	// append the vertices of the graph to the panel
+	void BuildGraph();
+
+	// append a quad or a line of text to a vertex list
+	static void AddQuad(
+		std::vector<OVERLAY_VERTEX>& vertices,
+		float x0, float y0, float x1, float y1,
+		float u0, float v0, float u1, float v1,
+		uint32_t color);
+	static void AddSolidQuad(
+		std::vector<OVERLAY_VERTEX>& vertices,
+		float x0, float y0, float x1, float y1,
+		uint32_t color);
+	void AddText(
+		std::vector<OVERLAY_VERTEX>& vertices,
+		float x, float y,
+		const char* text,
+		uint32_t color) const;
+};
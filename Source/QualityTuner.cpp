@@ -0,0 +1,534 @@
+///////////////////////////////////////////////////////////////////////////////
+// qualitytuner.cpp
+// ============
+// pick the quality settings that fit the frame time on this machine
+///////////////////////////////////////////////////////////////////////////////
+
+#include "QualityTuner.h"
+#include "JsonUtils.h"
+#include "Logger.h"
+#include "MeshGenerator.h"
+#include "NullRenderDevice.h"
+#include "SceneManager.h"
+
+// GLM Math Header inclusions
+#include <glm/gtx/transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// settings of each preset, the ultra preset is the full
+	// quality that the scene was drawn with before tuning
+	const QualityTuner::QUALITY_SETTINGS PRESETS[QualityTuner::PRESET_COUNT] =
+	{
+		{ "low", 12, 1, false },
+		{ "medium", 18, 2, true },
+		{ "high", 24, TOTAL_LIGHTS, true },
+		{ "ultra", MeshGenerator::DEFAULT_DETAIL, TOTAL_LIGHTS, true }
+	};
+
+	// version of the cache file layout
+	const int CACHE_VERSION = 1;
+
+	// frames drawn before the timed frames of each test, more
+	// than the GPU timer results lag behind, and timed frames
+	const int WARMUP_FRAMES = 6;
+	const int TIMED_FRAMES = 12;
+	// draw calls of the draw call test, drawn with a coarse
+	// mesh shrunk to a few pixels
+	const int SMALL_MESH_DRAWS = 1000;
+	// segments and draws of the dense mesh of the triangle test
+	const int DENSE_MESH_DETAIL = 256;
+	const int DENSE_MESH_DRAWS = 8;
+	// full screen layers of the fill test
+	const int SCREEN_LAYERS = 8;
+	// size and number of the textures of the upload test
+	const int UPLOAD_TEXTURE_SIZE = 1024;
+	const int UPLOAD_TEXTURES = 4;
+
+	// times the scene covers the screen, counting the overlap
+	const double SCENE_SCREEN_COVERAGE = 1.5;
+	// part of the target frame time that the estimate can use,
+	// leaving room for the frames that are slower than average
+	const double TARGET_HEADROOM = 0.8;
+	// shading cost of the specular term relative to the
+	// diffuse term of a light
+	const double SPECULAR_COST = 0.5;
+
+	/***********************************************************
+	 *  GetMedian()
+	 *
+	 *  This function is used for getting the median of the
+	 *  passed in times, zero is returned when there are none.
+	 ***********************************************************/
+	double GetMedian(std::vector<double> times)
+	{
+		if (times.empty())
+		{
+			return(0.0);
+		}
+		std::sort(times.begin(), times.end());
+		return(times[times.size() / 2]);
+	}
+
+	/***********************************************************
+	 *  GetShadingScale()
+	 *
+	 *  This function is used for getting the shading cost of
+	 *  a preset relative to the cost with all the lights and
+	 *  the specular term that the fill test measures.
+	 ***********************************************************/
+	double GetShadingScale(const QualityTuner::QUALITY_SETTINGS& settings)
+	{
+		double lightCost = 1.0 + (settings.bSpecular ? SPECULAR_COST : 0.0);
+		return((1.0 + settings.lightCount * lightCost) / (1.0 + TOTAL_LIGHTS * (1.0 + SPECULAR_COST)));
+	}
+}
+
+/***********************************************************
+ *  QualityTuner()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+QualityTuner::QualityTuner(RenderDevice* pRenderDevice, double targetMilliseconds)
+{
+	m_pRenderDevice = pRenderDevice;
+	m_targetMilliseconds = targetMilliseconds;
+	m_results = CALIBRATION_RESULTS();
+	m_bCalibrated = false;
+
+	// the key is written into the cache as a JSON string
+	m_machineKey = std::string(pRenderDevice->GetName()) + " " + pRenderDevice->GetAdapterName();
+	m_machineKey.erase(std::remove(m_machineKey.begin(), m_machineKey.end(), '"'), m_machineKey.end());
+	m_machineKey.erase(std::remove(m_machineKey.begin(), m_machineKey.end(), '\\'), m_machineKey.end());
+}
+
+/***********************************************************
+ *  ~QualityTuner()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+QualityTuner::~QualityTuner()
+{
+	m_pRenderDevice = NULL;
+}
+
+/***********************************************************
+ *  GetSettings()
+ *
+ *  This method is used for getting the settings of a preset.
+ ***********************************************************/
+const QualityTuner::QUALITY_SETTINGS& QualityTuner::GetSettings(QUALITY_PRESET preset)
+{
+	if ((preset < 0) || (preset >= PRESET_COUNT))
+	{
+		preset = PRESET_ULTRA;
+	}
+	return(PRESETS[preset]);
+}
+
+/***********************************************************
+ *  FindPreset()
+ *
+ *  This method is used for finding a preset by its name.
+ ***********************************************************/
+bool QualityTuner::FindPreset(const char* name, QUALITY_PRESET& preset)
+{
+	for (int i = 0; i < PRESET_COUNT; i++)
+	{
+		if (std::string(PRESETS[i].name) == name)
+		{
+			preset = (QUALITY_PRESET)i;
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  LoadCache()
+ *
+ *  This method is used for reading the calibration results
+ *  that an earlier run cached for this machine.
+ ***********************************************************/
+bool QualityTuner::LoadCache(const char* filename)
+{
+	std::ifstream file(filename);
+	if (!file)
+	{
+		return(false);
+	}
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::string key;
+		if ((JsonUtils::ReadString(line, "key", key) == false) || (key != m_machineKey))
+		{
+			continue;
+		}
+
+		bool bValid = JsonUtils::ReadNumber(line, "empty_ms", m_results.emptyMilliseconds) &&
+			JsonUtils::ReadNumber(line, "draw_us", m_results.drawMicroseconds) &&
+			JsonUtils::ReadNumber(line, "triangle_ns", m_results.triangleNanoseconds) &&
+			JsonUtils::ReadNumber(line, "fill_ms", m_results.fillMilliseconds) &&
+			JsonUtils::ReadNumber(line, "upload_mbps", m_results.uploadMegabytesPerSecond);
+		if (bValid)
+		{
+			m_bCalibrated = true;
+			LOG_INFO("quality calibration read from the cache", "file", filename, "machine", m_machineKey);
+		}
+		return(bValid);
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  SaveCache()
+ *
+ *  This method is used for writing the calibration results
+ *  of this machine into the cache, keeping the results of
+ *  the other machines that share the file.
+ ***********************************************************/
+bool QualityTuner::SaveCache(const char* filename) const
+{
+	std::vector<std::string> machines;
+	{
+		std::ifstream file(filename);
+		std::string line;
+		while (std::getline(file, line))
+		{
+			std::string key;
+			if (JsonUtils::ReadString(line, "key", key) && (key != m_machineKey))
+			{
+				// the entries are rewritten with their own commas
+				while (!line.empty() && ((line.back() == ',') || (line.back() == '\r')))
+				{
+					line.pop_back();
+				}
+				machines.push_back(line);
+			}
+		}
+	}
+
+	std::ostringstream entry;
+	entry << std::setprecision(6);
+	entry << "    { \"key\": ";
+	JsonUtils::WriteString(entry, m_machineKey);
+	entry << ", \"empty_ms\": " << m_results.emptyMilliseconds;
+	entry << ", \"draw_us\": " << m_results.drawMicroseconds;
+	entry << ", \"triangle_ns\": " << m_results.triangleNanoseconds;
+	entry << ", \"fill_ms\": " << m_results.fillMilliseconds;
+	entry << ", \"upload_mbps\": " << m_results.uploadMegabytesPerSecond << " }";
+	machines.push_back(entry.str());
+
+	std::ofstream file(filename);
+	if (!file)
+	{
+		LOG_ERROR("could not write the quality cache", "file", filename);
+		return(false);
+	}
+
+	file << "{\n";
+	file << "  \"version\": " << CACHE_VERSION << ",\n";
+	file << "  \"machines\": [";
+	for (size_t i = 0; i < machines.size(); i++)
+	{
+		file << ((i == 0) ? "\n" : ",\n") << machines[i];
+	}
+	file << "\n  ]\n";
+	file << "}\n";
+	return(true);
+}
+
+/***********************************************************
+ *  Calibrate()
+ *
+ *  This method is used for measuring the cost of the parts
+ *  of a frame.  Each test draws its load for a few frames,
+ *  and the cost of the load is its frame time above the
+ *  empty frame, less the cost of the parts that the earlier
+ *  tests measured.  The tests replace the loaded meshes, so
+ *  the scene meshes have to be loaded afterwards.
+ ***********************************************************/
+void QualityTuner::Calibrate()
+{
+	Clock::time_point start = Clock::now();
+
+	// coarse mesh for the draw calls, a dense mesh for the
+	// triangles and the plane for the screen layers
+	RenderDevice::MESH_DATA data;
+	MeshGenerator::GenerateMesh(MESH_SPHERE, MeshGenerator::PLACEHOLDER_DETAIL, data);
+	m_pRenderDevice->LoadMesh(MESH_SPHERE, data);
+	MeshGenerator::GenerateMesh(MESH_TORUS, DENSE_MESH_DETAIL, data);
+	m_pRenderDevice->LoadMesh(MESH_TORUS, data);
+	uint32_t denseTriangles = (uint32_t)(data.indices.size() / 3);
+	MeshGenerator::GenerateMesh(MESH_PLANE, MeshGenerator::DEFAULT_DETAIL, data);
+	m_pRenderDevice->LoadMesh(MESH_PLANE, data);
+
+	double emptyMilliseconds = TimeFrames(&QualityTuner::DrawEmpty);
+	double drawMilliseconds = TimeFrames(&QualityTuner::DrawSmallMeshes);
+	double denseMilliseconds = TimeFrames(&QualityTuner::DrawDenseMeshes);
+	double layerMilliseconds = TimeFrames(&QualityTuner::DrawScreenLayers);
+
+	m_results.emptyMilliseconds = emptyMilliseconds;
+	m_results.drawMicroseconds = std::max(0.0, drawMilliseconds - emptyMilliseconds) * 1000.0 / SMALL_MESH_DRAWS;
+	m_results.triangleNanoseconds = std::max(0.0,
+		denseMilliseconds - emptyMilliseconds - DENSE_MESH_DRAWS * m_results.drawMicroseconds / 1000.0) *
+		1000000.0 / ((double)DENSE_MESH_DRAWS * denseTriangles);
+	m_results.fillMilliseconds = std::max(0.0,
+		layerMilliseconds - emptyMilliseconds - SCREEN_LAYERS * m_results.drawMicroseconds / 1000.0) / SCREEN_LAYERS;
+	TimeUploads();
+	m_bCalibrated = true;
+
+	LOG_INFO("quality calibration", "machine", m_machineKey,
+		"emptyMs", m_results.emptyMilliseconds,
+		"drawUs", m_results.drawMicroseconds,
+		"triangleNs", m_results.triangleNanoseconds,
+		"fillMs", m_results.fillMilliseconds,
+		"uploadMBps", m_results.uploadMegabytesPerSecond,
+		"calibrationMs", std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+}
+
+/***********************************************************
+ *  ChoosePreset()
+ *
+ *  This method is used for estimating the frame time of the
+ *  scene at each preset from the calibration results, and
+ *  choosing the highest preset that fits the target.  The
+ *  draw calls and triangles of a preset are counted by
+ *  drawing the scene once on a null render device with the
+ *  meshes of the preset.
+ ***********************************************************/
+QualityTuner::QUALITY_PRESET QualityTuner::ChoosePreset(int sceneCopies) const
+{
+	if (m_bCalibrated == false)
+	{
+		return(PRESET_ULTRA);
+	}
+
+	NullRenderDevice countingDevice;
+	SceneManager* pScene = new SceneManager(&countingDevice);
+	pScene->SetSceneCopies(sceneCopies);
+
+	QUALITY_PRESET chosen = PRESET_LOW;
+	double chosenMilliseconds = 0.0;
+	for (int i = 0; i < PRESET_COUNT; i++)
+	{
+		for (int mesh = 0; mesh < MESH_COUNT; mesh++)
+		{
+			RenderDevice::MESH_DATA data;
+			MeshGenerator::GenerateMesh((MESH_TYPE)mesh, PRESETS[i].meshDetail, data);
+			countingDevice.LoadMesh((MESH_TYPE)mesh, data);
+		}
+		countingDevice.BeginFrame();
+		pScene->RenderScene();
+		countingDevice.EndFrame();
+		const RenderDevice::RENDER_STATS& stats = countingDevice.GetStats();
+
+		double estimate = m_results.emptyMilliseconds +
+			stats.drawCalls * m_results.drawMicroseconds / 1000.0 +
+			stats.triangles * m_results.triangleNanoseconds / 1000000.0 +
+			SCENE_SCREEN_COVERAGE * m_results.fillMilliseconds * GetShadingScale(PRESETS[i]);
+		LOG_DEBUG("quality preset estimate", "preset", PRESETS[i].name, "draws", stats.drawCalls,
+			"triangles", stats.triangles, "estimateMs", estimate);
+
+		if ((i == PRESET_LOW) || (estimate <= m_targetMilliseconds * TARGET_HEADROOM))
+		{
+			chosen = (QUALITY_PRESET)i;
+			chosenMilliseconds = estimate;
+		}
+	}
+	delete pScene;
+
+	LOG_INFO("quality preset chosen", "preset", PRESETS[chosen].name, "estimateMs", chosenMilliseconds,
+		"targetMs", m_targetMilliseconds);
+	return(chosen);
+}
+
+/***********************************************************
+ *  TimeFrames()
+ *
+ *  This method is used for drawing the load of a test for
+ *  a number of frames and getting the time of a frame.  The
+ *  CPU and GPU work of the frames overlap, so the slower of
+ *  the two is the frame time.  The GPU times are read with a
+ *  delay, so the frames before the timed ones are not
+ *  counted.
+ ***********************************************************/
+double QualityTuner::TimeFrames(void (QualityTuner::*pDraw)())
+{
+	std::vector<double> cpuTimes;
+	std::vector<double> gpuTimes;
+
+	for (int frame = 0; frame < WARMUP_FRAMES + TIMED_FRAMES; frame++)
+	{
+		Clock::time_point frameStart = Clock::now();
+		m_pRenderDevice->BeginFrame();
+		SetCalibrationBlocks();
+		(this->*pDraw)();
+		m_pRenderDevice->EndFrame();
+		double cpuMilliseconds = std::chrono::duration<double, std::milli>(Clock::now() - frameStart).count();
+
+		double gpuMilliseconds = 0.0;
+		bool bGpuTime = m_pRenderDevice->GetGpuFrameTime(gpuMilliseconds);
+		if (frame >= WARMUP_FRAMES)
+		{
+			cpuTimes.push_back(cpuMilliseconds);
+			if (bGpuTime)
+			{
+				gpuTimes.push_back(gpuMilliseconds);
+			}
+		}
+	}
+
+	return(std::max(GetMedian(cpuTimes), GetMedian(gpuTimes)));
+}
+
+/***********************************************************
+ *  DrawEmpty()
+ *  DrawSmallMeshes()
+ *  DrawDenseMeshes()
+ *  DrawScreenLayers()
+ *
+ *  These methods are used for drawing the load of each of
+ *  the calibration tests.  The small and dense meshes are
+ *  shrunk so that they cover few pixels, and the screen
+ *  layers are drawn from the back so each is shaded fully.
+ ***********************************************************/
+void QualityTuner::DrawEmpty()
+{
+}
+
+void QualityTuner::DrawSmallMeshes()
+{
+	for (int i = 0; i < SMALL_MESH_DRAWS; i++)
+	{
+		float x = -0.9f + 1.8f * (i % 40) / 39.0f;
+		float y = -0.9f + 1.8f * (i / 40) / 24.0f;
+		DrawCalibrationMesh(MESH_SPHERE, glm::translate(glm::vec3(x, y, 0.5f)) * glm::scale(glm::vec3(0.005f)));
+	}
+}
+
+void QualityTuner::DrawDenseMeshes()
+{
+	for (int i = 0; i < DENSE_MESH_DRAWS; i++)
+	{
+		float x = -0.7f + 1.4f * i / (DENSE_MESH_DRAWS - 1);
+		DrawCalibrationMesh(MESH_TORUS, glm::translate(glm::vec3(x, 0.0f, 0.5f)) * glm::scale(glm::vec3(0.05f)));
+	}
+}
+
+void QualityTuner::DrawScreenLayers()
+{
+	for (int i = 0; i < SCREEN_LAYERS; i++)
+	{
+		// the plane faces up, so it is turned to face the view,
+		// and each layer is nearer than the one before
+		float depth = 0.9f - 0.8f * i / (SCREEN_LAYERS - 1);
+		DrawCalibrationMesh(MESH_PLANE,
+			glm::translate(glm::vec3(0.0f, 0.0f, depth)) * glm::rotate(glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)));
+	}
+}
+
+/***********************************************************
+ *  TimeUploads()
+ *
+ *  This method is used for timing the creation of a few
+ *  large textures, which is how the scene textures are
+ *  uploaded.  The time is measured on the CPU, so it covers
+ *  the copy into the driver and any mipmap generation the
+ *  device does when the texture is created.
+ ***********************************************************/
+void QualityTuner::TimeUploads()
+{
+	size_t textureBytes = (size_t)UPLOAD_TEXTURE_SIZE * UPLOAD_TEXTURE_SIZE * 4;
+	std::vector<unsigned char> pixels(textureBytes);
+	for (size_t i = 0; i < pixels.size(); i++)
+	{
+		pixels[i] = (unsigned char)(i * 7);
+	}
+
+	uint32_t textures[UPLOAD_TEXTURES];
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < UPLOAD_TEXTURES; i++)
+	{
+		textures[i] = m_pRenderDevice->CreateTexture(UPLOAD_TEXTURE_SIZE, UPLOAD_TEXTURE_SIZE, 4, pixels.data());
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	for (int i = 0; i < UPLOAD_TEXTURES; i++)
+	{
+		if (textures[i] != 0)
+		{
+			m_pRenderDevice->DestroyTexture(textures[i]);
+		}
+	}
+
+	double megabytes = (double)textureBytes * UPLOAD_TEXTURES / (1024.0 * 1024.0);
+	m_results.uploadMegabytesPerSecond = (seconds > 0.0) ? (megabytes / seconds) : 0.0;
+}
+
+/***********************************************************
+ *  SetCalibrationBlocks()
+ *
+ *  This method is used for setting the uniform blocks of
+ *  the calibration draws at the start of each frame.  The
+ *  camera passes the positions through in a single view, so
+ *  the meshes are placed in clip space, and all of the
+ *  lights are on so that the full shading is timed.
+ ***********************************************************/
+void QualityTuner::SetCalibrationBlocks()
+{
+	CAMERA_BLOCK cameraData = CAMERA_BLOCK();
+	cameraData.views[0].view = glm::mat4(1.0f);
+	cameraData.views[0].projection = glm::mat4(1.0f);
+	cameraData.views[0].viewPosition = glm::vec3(0.0f, 0.0f, -1.0f);
+	m_pRenderDevice->SetViews(NULL, 0);
+	m_pRenderDevice->UpdateBlock(cameraData);
+
+	LIGHT_BLOCK lightData = LIGHT_BLOCK();
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		lightData.lightSources[i].position = glm::vec3(-1.0f + i * 0.6f, 1.0f, -1.0f);
+		lightData.lightSources[i].diffuseColor = glm::vec3(0.25f);
+		lightData.lightSources[i].specularColor = glm::vec3(0.25f);
+		lightData.lightSources[i].focalStrength = 32.0f;
+		lightData.lightSources[i].specularIntensity = 0.5f;
+	}
+	lightData.globalAmbientColor = glm::vec3(0.1f);
+	m_pRenderDevice->UpdateBlock(lightData);
+
+	MATERIAL_BLOCK materialData = MATERIAL_BLOCK();
+	materialData.diffuseColor = glm::vec3(0.8f);
+	materialData.specularColor = glm::vec3(0.5f);
+	materialData.shininess = 32.0f;
+	m_pRenderDevice->UpdateBlock(materialData);
+}
+
+/***********************************************************
+ *  DrawCalibrationMesh()
+ *
+ *  This method is used for drawing a lit mesh with the
+ *  passed in model transformation.
+ ***********************************************************/
+void QualityTuner::DrawCalibrationMesh(MESH_TYPE mesh, const glm::mat4& model)
+{
+	INSTANCE_BLOCK instanceData = INSTANCE_BLOCK();
+	instanceData.model = model;
+	instanceData.objectColor = glm::vec4(0.6f, 0.6f, 0.6f, 1.0f);
+	instanceData.UVscale = glm::vec2(1.0f, 1.0f);
+	instanceData.bUseTexture = false;
+	instanceData.bUseLighting = true;
+	m_pRenderDevice->UpdateBlock(instanceData);
+	m_pRenderDevice->DrawMesh(mesh);
+}
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// qualitytuner.h
+// ============
+// pick the quality settings that fit the frame time on this machine
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <string>
+
+/***********************************************************
+ *  QualityTuner
+ *
+ *  This class contains the code for choosing the quality
+ *  preset of the scene from a short calibration run.  The
+ *  calibration draws a few frames of each of four synthetic
+ *  loads - an empty frame, many small draw calls, many
+ *  triangles and full screen lit layers - and times a few
+ *  texture uploads, giving the cost of a draw call, of a
+ *  triangle, of shading the screen and the upload
+ *  bandwidth.  The draw calls and triangles of the scene at
+ *  each preset are counted by drawing it once on a null
+ *  render device, and the highest preset whose estimated
+ *  frame time fits the target is chosen.  The calibration
+ *  results are cached per machine, keyed by the graphics
+ *  adapter and driver, so the calibration only runs on the
+ *  first launch.
+ ***********************************************************/
+class QualityTuner
+{
+public:
+	// quality presets from the cheapest to the full quality
+	enum QUALITY_PRESET
+	{
+		PRESET_LOW = 0,
+		PRESET_MEDIUM,
+		PRESET_HIGH,
+		PRESET_ULTRA,
+		PRESET_COUNT
+	};
+
+	// settings of a preset
+	struct QUALITY_SETTINGS
+	{
+		const char* name;
+		// segments around the curved meshes
+		int meshDetail;
+		// light sources evaluated by the fragment shader
+		int lightCount;
+		bool bSpecular;
+	};
+
+	// costs measured by the calibration
+	struct CALIBRATION_RESULTS
+	{
+		// time of a frame that only clears the screen
+		double emptyMilliseconds;
+		// time of each draw call and each triangle
+		double drawMicroseconds;
+		double triangleNanoseconds;
+		// time of shading the whole screen once with all the
+		// lights and the specular term
+		double fillMilliseconds;
+		// texture data that can be uploaded in a second
+		double uploadMegabytesPerSecond;
+	};
+
+	// constructor
+	QualityTuner(RenderDevice* pRenderDevice, double targetMilliseconds);
+	// destructor
+	~QualityTuner();
+
+	// get the settings of a preset
+	static const QUALITY_SETTINGS& GetSettings(QUALITY_PRESET preset);
+	// find a preset by its name, false is returned when there
+	// is none with the name
+	static bool FindPreset(const char* name, QUALITY_PRESET& preset);
+
+	// read the calibration results of this machine from the
+	// cache, false is returned when they are not cached
+	bool LoadCache(const char* filename);
+	// add the calibration results of this machine to the cache
+	bool SaveCache(const char* filename) const;
+	// run the calibration frames, the pipeline that draws the
+	// scene with all the lights must be bound
+	void Calibrate();
+	// choose the highest preset that fits the target frame
+	// time with the passed in number of scene copies
+	QUALITY_PRESET ChoosePreset(int sceneCopies) const;
+
+	// get the measured or cached calibration results
+	const CALIBRATION_RESULTS& GetResults() const { return(m_results); }
+
+private:
+	// pointer to render device object
+	RenderDevice* m_pRenderDevice;
+	// frame time that the chosen preset has to fit in
+	double m_targetMilliseconds;
+	// adapter and driver that the results are cached under
+	std::string m_machineKey;
+	CALIBRATION_RESULTS m_results;
+	bool m_bCalibrated;
+
+	// time the frames drawn by one of the draw methods, the
+	// slower of the CPU and GPU time of a frame is returned
+	double TimeFrames(void (QualityTuner::*pDraw)());
+	// draw the load of one calibration test
+	void DrawEmpty();
+	void DrawSmallMeshes();
+	void DrawDenseMeshes();
+	void DrawScreenLayers();
+	// time the upload of the calibration textures
+	void TimeUploads();
+
+	// set the camera, lights and material of the calibration
+	void SetCalibrationBlocks();
+	// draw one mesh with the passed in model transformation
+	void DrawCalibrationMesh(MESH_TYPE mesh, const glm::mat4& model);
+};
@@ -0,0 +1,251 @@
+///////////////////////////////////////////////////////////////////////////////
+// reflectionprobes.cpp
+// ============
+// capture the scene into cube maps around fixed points for reflections
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ReflectionProbes.h"
+#include "Logger.h"
+
+// GLM Math Header inclusions
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+
+// declaration of global variables
+namespace
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// faces of a cube map, which are the layers of its target,
+	// and the width and height of each face
+	const int CUBE_FACES = 6;
+	const int FACE_SIZE = 128;
+
+	// direction and up vector of each cube map face, in the
+	// +X, -X, +Y, -Y, +Z and -Z order of the OpenGL faces
+	struct CUBE_FACE
+	{
+		glm::vec3 direction;
+		glm::vec3 up;
+	};
+	const CUBE_FACE g_CubeFaces[CUBE_FACES] =
+	{
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f) }
+	};
+
+	// near and far planes of the faces
+	const float NEAR_PLANE = 0.1f;
+	const float FAR_PLANE = 100.0f;
+}
+
+/***********************************************************
+ *  ReflectionProbes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ReflectionProbes::ReflectionProbes(RenderDevice* pRenderDevice, SceneManager* pSceneManager)
+{
+	m_pRenderDevice = pRenderDevice;
+	m_pSceneManager = pSceneManager;
+	m_bUnsupported = false;
+}
+
+/***********************************************************
+ *  ~ReflectionProbes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ReflectionProbes::~ReflectionProbes()
+{
+	for (size_t i = 0; i < m_probes.size(); i++)
+	{
+		if ((NULL != m_pRenderDevice) && (m_probes[i].target != 0))
+		{
+			m_pRenderDevice->DestroyTarget(m_probes[i].target);
+		}
+	}
+	m_probes.clear();
+	m_pRenderDevice = NULL;
+	m_pSceneManager = NULL;
+}
+
+/***********************************************************
+ *  AddProbe()
+ *
+ *  This method is used for adding a probe at a position in
+ *  the scene, which is captured with the next probes.
+ ***********************************************************/
+bool ReflectionProbes::AddProbe(const glm::vec3& position)
+{
+	if ((int)m_probes.size() >= MAX_PROBES)
+	{
+		return(false);
+	}
+
+	PROBE probe;
+	probe.position = position;
+	probe.target = 0;
+	probe.bCaptured = false;
+	m_probes.push_back(probe);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for marking all of the probes for
+ *  capturing again, keeping their cube maps.
+ ***********************************************************/
+void ReflectionProbes::Invalidate()
+{
+	for (size_t i = 0; i < m_probes.size(); i++)
+	{
+		m_probes[i].bCaptured = false;
+	}
+}
+
+/***********************************************************
+ *  NeedsCapture()
+ *
+ *  This method is used for checking whether any of the
+ *  probes needs capturing.
+ ***********************************************************/
+bool ReflectionProbes::NeedsCapture() const
+{
+	if (m_bUnsupported)
+	{
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_probes.size(); i++)
+	{
+		if (m_probes[i].bCaptured == false)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  GetProbeTarget()
+ *
+ *  This method is used for getting the cube map target of
+ *  a probe once it has been captured.
+ ***********************************************************/
+uint32_t ReflectionProbes::GetProbeTarget(int index) const
+{
+	if ((index < 0) || (index >= (int)m_probes.size()) || (m_probes[index].bCaptured == false))
+	{
+		return(0);
+	}
+
+	return(m_probes[index].target);
+}
+
+/***********************************************************
+ *  GetFaceViews()
+ *
+ *  This method is used for getting the view and projection
+ *  of each cube map face seen from a position.  The faces
+ *  have a square field of view of 90 degrees, so that they
+ *  meet at their edges.
+ ***********************************************************/
+void ReflectionProbes::GetFaceViews(const glm::vec3& position, CAMERA_BLOCK& cameraData)
+{
+	glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, NEAR_PLANE, FAR_PLANE);
+
+	for (int i = 0; i < CUBE_FACES; i++)
+	{
+		cameraData.views[i].view = glm::lookAt(position, position + g_CubeFaces[i].direction, g_CubeFaces[i].up);
+		cameraData.views[i].projection = projection;
+		cameraData.views[i].viewPosition = position;
+	}
+}
+
+/***********************************************************
+ *  CaptureProbes()
+ *
+ *  This method is used for drawing the scene into the cube
+ *  map of each probe that needs capturing.  Each probe is
+ *  one pass over the scene with the six faces as the views,
+ *  culled against the face frustums so that the objects
+ *  are only drawn into the faces that they are inside, and
+ *  the mip levels are filtered from the drawn faces.  The
+ *  scene is drawn into the window again afterwards.
+ ***********************************************************/
+void ReflectionProbes::CaptureProbes()
+{
+	if (m_bUnsupported || (NULL == m_pRenderDevice) || (NULL == m_pSceneManager))
+	{
+		return;
+	}
+
+	Clock::time_point start = Clock::now();
+	RenderDevice::VIEWPORT viewports[CUBE_FACES];
+	int captured = 0;
+
+	for (int i = 0; i < CUBE_FACES; i++)
+	{
+		viewports[i].x = 0.0f;
+		viewports[i].y = 0.0f;
+		viewports[i].width = 1.0f;
+		viewports[i].height = 1.0f;
+	}
+
+	for (size_t i = 0; i < m_probes.size(); i++)
+	{
+		PROBE& probe = m_probes[i];
+		if (probe.bCaptured)
+		{
+			continue;
+		}
+
+		if (probe.target == 0)
+		{
+			RenderDevice::TARGET_DESC desc;
+			desc.width = FACE_SIZE;
+			desc.height = FACE_SIZE;
+			desc.layers = CUBE_FACES;
+			desc.bCubeMap = true;
+			probe.target = m_pRenderDevice->CreateTarget(desc);
+			if (probe.target == 0)
+			{
+				LOG_WARNING("the render device cannot draw into cube maps, the reflection probes are not captured",
+					"device", m_pRenderDevice->GetName());
+				m_bUnsupported = true;
+				break;
+			}
+		}
+
+		CAMERA_BLOCK cameraData = CAMERA_BLOCK();
+		GetFaceViews(probe.position, cameraData);
+
+		m_pRenderDevice->BindTarget(probe.target);
+		m_pRenderDevice->SetViews(viewports, CUBE_FACES);
+		m_pRenderDevice->UpdateBlock(cameraData);
+		m_pSceneManager->SetCullingViews(cameraData, CUBE_FACES);
+		m_pSceneManager->RenderScene();
+		m_pRenderDevice->FilterTargetMips(probe.target);
+
+		probe.bCaptured = true;
+		captured++;
+	}
+
+	m_pRenderDevice->BindTarget(0);
+	m_pRenderDevice->SetViews(NULL, 0);
+
+	if (captured > 0)
+	{
+		double milliseconds = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+		LOG_INFO("reflection probes captured", "probes", captured, "faceSize", FACE_SIZE, "cpuMs", milliseconds);
+	}
+}
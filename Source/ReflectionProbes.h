@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// reflectionprobes.h
+// ============
+// capture the scene into cube maps around fixed points for reflections
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "SceneManager.h"
+
+#include <vector>
+
+/***********************************************************
+ *  ReflectionProbes
+ *
+ *  This class contains the code for capturing the scene
+ *  into a cube map at each probe position, which the
+ *  reflective materials can sample instead of drawing the
+ *  scene again every frame.  The six faces of a cube map
+ *  are drawn in one pass over the scene as six views of a
+ *  layered target, and each object is only drawn into the
+ *  faces that it is inside.  The probes are captured once,
+ *  and again when they are marked as out of date, such as
+ *  once the scene has all of its assets.
+ ***********************************************************/
+class ReflectionProbes
+{
+public:
+	// most probes that can be placed in the scene
+	static const int MAX_PROBES = 8;
+
+	// constructor
+	ReflectionProbes(RenderDevice* pRenderDevice, SceneManager* pSceneManager);
+	// destructor
+	~ReflectionProbes();
+
+	// add a probe at a position in the scene, false is returned
+	// when there are already the most probes
+	bool AddProbe(const glm::vec3& position);
+	// mark all of the probes for capturing again
+	void Invalidate();
+	// check whether any of the probes needs capturing
+	bool NeedsCapture() const;
+	// draw the scene into the cube map of each probe that needs
+	// capturing, the views of the frame must be set afterwards
+	void CaptureProbes();
+
+	// get the number of probes and the position of each
+	int GetProbeCount() const { return((int)m_probes.size()); }
+	const glm::vec3& GetProbePosition(int index) const { return(m_probes[index].position); }
+	// get the cube map target of a probe, zero is returned
+	// until the probe has been captured
+	uint32_t GetProbeTarget(int index) const;
+
+	// get the view and projection of each cube map face seen
+	// from a position, in the order of the target layers
+	static void GetFaceViews(const glm::vec3& position, CAMERA_BLOCK& cameraData);
+
+private:
+	// probe position and the cube map target it is captured in
+	struct PROBE
+	{
+		glm::vec3 position;
+		uint32_t target;
+		bool bCaptured;
+	};
+
+	// pointer to render device object
+	RenderDevice* m_pRenderDevice;
+	// pointer to the scene that is captured
+	SceneManager* m_pSceneManager;
+	std::vector<PROBE> m_probes;
+	// the render device cannot create cube map targets, so the
+	// probes are never captured
+	bool m_bUnsupported;
+};
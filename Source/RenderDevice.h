@@ -0,0 +1,332 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderdevice.h
+// ============
+// interface between the scene code and the graphics API
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "UniformBlocks.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// shape meshes that can be loaded and drawn by the render device
+enum MESH_TYPE
+{
+	MESH_PLANE = 0,
+	MESH_TORUS,
+	MESH_CYLINDER,
+	MESH_SPHERE,
+	MESH_COUNT
+};
+
+/***********************************************************
+ *  RenderDevice
+ *
+ *  This class is the interface used by the scene and view
+ *  managers for creating buffers, textures and pipelines,
+ *  and for issuing the draw commands.  The scene code does
+ *  not call the graphics API directly, so that a backend
+ *  which only records the commands can be used to measure
+ *  the CPU cost of the scene without a GPU driver.
+ ***********************************************************/
+class RenderDevice
+{
+public:
+	// description of a shader pipeline
+	struct PIPELINE_DESC
+	{
+		const char* vertexShaderPath;
+		const char* fragmentShaderPath;
+		const char* vertexBinaryPath;
+		const char* fragmentBinaryPath;
+		// SPIR-V binaries compiled for the Vulkan environment
+		const char* vulkanVertexBinaryPath;
+		const char* vulkanFragmentBinaryPath;
+		// values for the shader specialization constants
+		int activeLights;
+		bool bEnableLighting;
+		bool bEnableSpecular;
+	};
+
+	// counters for the commands issued during a frame
+	struct RENDER_STATS
+	{
+		uint32_t drawCalls;
+		uint32_t triangles;
+		uint32_t blockUploads;
+		uint32_t uploadBytes;
+		uint32_t textureBinds;
+		uint32_t pipelineBinds;
+	};
+
+	// rectangle of the window that a view is drawn into, as
+	// fractions of the window size from the bottom left corner
+	struct VIEWPORT
+	{
+		float x;
+		float y;
+		float width;
+		float height;
+	};
+
+	// constructor
+	RenderDevice() { ResetStats(); RenderDevice::SetViews(NULL, 0); m_instanceViewMask = 0; }
+	// destructor
+	virtual ~RenderDevice() {}
+
+	// name of the backend for reporting
+	virtual const char* GetName() const = 0;
+	// name of the graphics adapter and its driver version, which
+	// tells the machines apart
+	virtual std::string GetAdapterName() const { return(GetName()); }
+
+	// prepare the device once the graphics context exists
+	virtual bool Initialize() = 0;
+
+	// create and bind the shader pipeline, zero is returned
+	// when the pipeline could not be created
+	virtual uint32_t CreatePipeline(const PIPELINE_DESC& desc) = 0;
+	virtual void BindPipeline(uint32_t pipeline) = 0;
+	// free a pipeline, another one has to be bound before the
+	// next draw when it was the bound pipeline
+	virtual void DestroyPipeline(uint32_t pipeline) = 0;
+
+	// create texture from decoded image data, zero is returned
+	// when the texture could not be created
+	virtual uint32_t CreateTexture(
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels) = 0;
+	virtual void DestroyTexture(uint32_t texture) = 0;
+	// bind a texture to one of the texture slots
+	virtual void BindTexture(int slot, uint32_t texture) = 0;
+	// select the texture slot sampled by the shader
+	virtual void SetTextureSlot(int slot) = 0;
+
+	// create a texture with room for its mip levels but no
+	// pixels, which are then uploaded one level at a time from
+	// the smallest level up, so that a large texture can be
+	// spread over several frames - zero is returned when the
+	// device cannot upload the levels separately
+	virtual uint32_t CreateStreamedTexture(int width, int height, int colorChannels, int mipLevels) { return(0); }
+	// upload the pixels of one mip level of a streamed texture,
+	// which is then sampled from that level
+	virtual void UploadTextureLevel(
+		uint32_t texture,
+		int level,
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels) {}
+
+	// create a cube map texture from RGB float pixels, which
+	// are the six faces of each mip level in turn from the
+	// full size level down, freed with DestroyTexture - zero
+	// is returned when the device cannot sample cube maps
+	virtual uint32_t CreateCubeTexture(int faceSize, int mipLevels, const float* pixels) { return(0); }
+	// bind the cube map that the environment lighting of the
+	// reflective materials is sampled from
+	virtual void BindEnvironment(uint32_t texture) {}
+	// get the number of floats in the pixels of a cube map
+	static size_t GetCubeTextureFloats(int faceSize, int mipLevels);
+
+	// copy the uniform block structs into the uniform buffers
+	virtual void UpdateBlock(const CAMERA_BLOCK& block) = 0;
+	virtual void UpdateBlock(const LIGHT_BLOCK& block) = 0;
+	virtual void UpdateBlock(const MATERIAL_BLOCK& block) = 0;
+	virtual void UpdateBlock(const INSTANCE_BLOCK& block) = 0;
+
+	// interleaved vertex layout of the shape meshes
+	struct MESH_VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 textureCoordinate;
+	};
+
+	// shape mesh triangle list generated on the CPU
+	struct MESH_DATA
+	{
+		std::vector<MESH_VERTEX> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	// create the vertex buffers for one of the shape meshes
+	virtual void LoadMesh(MESH_TYPE mesh) = 0;
+	// create the vertex buffers for a shape mesh from data that
+	// was generated ahead of time, such as on a loading thread -
+	// a mesh that is already loaded is replaced, so a coarse
+	// placeholder can be swapped for the full detail mesh
+	virtual void LoadMesh(MESH_TYPE mesh, const MESH_DATA& data) = 0;
+	// draw one of the loaded shape meshes, once in each view
+	// that is set in the view mask of the instance block
+	virtual void DrawMesh(MESH_TYPE mesh) = 0;
+
+	// set the views that each draw is repeated in, the draw of
+	// each view reads its matrices from the same element of the
+	// views in the camera block - without viewports the whole
+	// window is drawn as one view
+	virtual void SetViews(const VIEWPORT* viewports, uint32_t viewCount);
+	// get the number of views that each draw is repeated in
+	uint32_t GetViewCount() const { return(m_viewCount); }
+
+	// size of an offscreen target that the views are drawn
+	// into, with a layer for each view - the six layers of a
+	// cube map target are its faces, in the +X, -X, +Y, -Y, +Z
+	// and -Z order, and it has a chain of mip levels
+	struct TARGET_DESC
+	{
+		int width;
+		int height;
+		uint32_t layers;
+		bool bCubeMap;
+	};
+
+	// create a layered target, zero is returned when the device
+	// cannot select the layer of each view in the vertex shader
+	virtual uint32_t CreateTarget(const TARGET_DESC& desc) { return(0); }
+	virtual void DestroyTarget(uint32_t target) {}
+	// draw the views into the layers of a target, which is
+	// cleared, or into the window when zero is passed - the
+	// viewports are fractions of the bound target
+	virtual void BindTarget(uint32_t target) {}
+	// copy the layers of a target side by side into the window
+	// and draw into the window again
+	virtual void ShowTarget(uint32_t target) {}
+	// filter the mip levels of a cube map target down from its
+	// drawn faces
+	virtual void FilterTargetMips(uint32_t target) {}
+	// read the first mip level of the layers of a target back
+	// as RGB floats, layer after layer with the rows from the
+	// bottom - this waits for the GPU to finish the target,
+	// and false is returned when the device cannot read it
+	virtual bool ReadTarget(uint32_t target, std::vector<float>& pixels) { return(false); }
+
+	// vertex of the 2D overlay drawn over the scene, positioned
+	// in window pixels from the top left corner, with the color
+	// packed as RGBA bytes
+	struct OVERLAY_VERTEX
+	{
+		float x;
+		float y;
+		float u;
+		float v;
+		uint32_t color;
+	};
+
+	// draw a triangle list over the scene without depth testing,
+	// sampling the passed in texture - the overlay is not counted
+	// in the frame counters
+	virtual void DrawOverlay(
+		const OVERLAY_VERTEX* vertices,
+		uint32_t vertexCount,
+		uint32_t texture) = 0;
+
+	// start and finish the commands for a frame
+	virtual void BeginFrame() = 0;
+	virtual void EndFrame() = 0;
+
+	// get the GPU time of the most recent frame that the GPU
+	// has finished, false is returned when it is not measured
+	virtual bool GetGpuFrameTime(double& milliseconds) { return(false); }
+	// get and clear the first graphics API error raised since
+	// the last call, zero is returned when there was none
+	virtual uint32_t GetError() { return(0); }
+
+	// get the counters for the commands issued in this frame
+	const RENDER_STATS& GetStats() const { return m_stats; }
+
+protected:
+	// counters for the current frame
+	RENDER_STATS m_stats;
+	// viewports of the views that each draw is repeated in
+	VIEWPORT m_viewports[MAX_VIEWS];
+	uint32_t m_viewCount;
+	// view mask of the last instance block, which the next
+	// draws are repeated in
+	uint32_t m_instanceViewMask;
+
+	// clear the counters at the start of a frame
+	void ResetStats() { m_stats = RENDER_STATS(); }
+	// get the views that the next draw is repeated in as one
+	// bit for each view, and the number of them
+	uint32_t GetDrawViewMask() const;
+	static uint32_t CountViews(uint32_t viewMask);
+};
+
+/***********************************************************
+ *  SetViews()
+ *
+ *  This method is used for keeping the viewports of the
+ *  views, the backends apply them to the graphics API.
+ ***********************************************************/
+inline void RenderDevice::SetViews(const VIEWPORT* viewports, uint32_t viewCount)
+{
+	if ((NULL == viewports) || (viewCount == 0))
+	{
+		m_viewports[0].x = 0.0f;
+		m_viewports[0].y = 0.0f;
+		m_viewports[0].width = 1.0f;
+		m_viewports[0].height = 1.0f;
+		m_viewCount = 1;
+		return;
+	}
+
+	m_viewCount = (viewCount < (uint32_t)MAX_VIEWS) ? viewCount : (uint32_t)MAX_VIEWS;
+	for (uint32_t i = 0; i < m_viewCount; i++)
+	{
+		m_viewports[i] = viewports[i];
+	}
+}
+
+/***********************************************************
+ *  GetDrawViewMask()
+ *  CountViews()
+ *
+ *  These methods are used for getting the views that the
+ *  next draw is repeated in, from the view mask of the last
+ *  instance block, where zero is all of the views.  The
+ *  draw is instanced once for each of them, and the shader
+ *  finds the view of each instance from the same mask.
+ ***********************************************************/
+inline uint32_t RenderDevice::GetDrawViewMask() const
+{
+	uint32_t allViews = (1u << m_viewCount) - 1u;
+
+	return((m_instanceViewMask != 0) ? (m_instanceViewMask & allViews) : allViews);
+}
+
+inline uint32_t RenderDevice::CountViews(uint32_t viewMask)
+{
+	uint32_t count = 0;
+
+	for (; viewMask != 0; viewMask &= viewMask - 1u)
+	{
+		count++;
+	}
+	return(count);
+}
+
+/***********************************************************
+ *  GetCubeTextureFloats()
+ *
+ *  This method is used for getting the number of floats in
+ *  the RGB pixels of the six faces of each mip level of a
+ *  cube map.
+ ***********************************************************/
+inline size_t RenderDevice::GetCubeTextureFloats(int faceSize, int mipLevels)
+{
+	size_t count = 0;
+
+	for (int level = 0; level < mipLevels; level++)
+	{
+		size_t size = (size_t)std::max(faceSize >> level, 1);
+		count += 6 * size * size * 3;
+	}
+	return(count);
+}
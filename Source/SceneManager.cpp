@@ -8,6 +8,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "MeshGenerator.h"
+#include "Logger.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,14 +18,76 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
 // declaration of global variables
 namespace
 {
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
+	// image file and tag of each texture used by the scene
+	struct SCENE_TEXTURE
+	{
+		const char* filename;
+		const char* tag;
+	};
+	const SCENE_TEXTURE g_SceneTextures[] =
+	{
+		{ "textures/blackmetal.jpg", "blackmetal" },
+		{ "textures/carbonfiber.png", "carbonfiber" },
+		{ "textures/metal.jpg", "metal" },
+		{ "textures/greyplastic.jpg", "greyplastic" }
+	};
+	const int g_SceneTextureCount = (int)(sizeof(g_SceneTextures) / sizeof(g_SceneTextures[0]));
+
+	/***********************************************************
+	 *  FindSceneTexture()
+	 *
+	 *  This function is used for getting the index of the
+	 *  scene texture with the passed in tag, or -1.
+	 ***********************************************************/
+	int FindSceneTexture(const std::string& tag)
+	{
+		for (int i = 0; i < g_SceneTextureCount; i++)
+		{
+			if (tag.compare(g_SceneTextures[i].tag) == 0)
+			{
+				return(i);
+			}
+		}
+
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  GetMipLevelBytes()
+	 *
+	 *  This function is used for getting the bytes of the
+	 *  pixels of one mip level of a decoded image.
+	 ***********************************************************/
+	size_t GetMipLevelBytes(const AssetLoader::DECODED_IMAGE& image, int level)
+	{
+		return((size_t)std::max(image.width >> level, 1) * std::max(image.height >> level, 1) * image.colorChannels);
+	}
+
+	// default time and bytes that the streamed uploads of one
+	// frame can take
+	const double DEFAULT_UPLOAD_MILLISECONDS = 2.0;
+	const size_t DEFAULT_UPLOAD_BYTES = 4 * 1024 * 1024;
+
+	// radius of a sphere around the origin that bounds all of
+	// the unscaled shape meshes, the corners of the plane and
+	// the rims of the cylinder are the farthest points
+	const float MESH_BOUNDING_RADIUS = 1.4143f;
+
+	// box over the desk and in front of the backdrop that the
+	// light probes are spread over, and the number of probes
+	// along each of its axes
+	const glm::vec3 PROBE_GRID_MINIMUM = glm::vec3(-18.0f, 0.5f, -9.5f);
+	const glm::vec3 PROBE_GRID_MAXIMUM = glm::vec3(18.0f, 12.0f, 9.5f);
+	const int PROBE_GRID_COUNT_X = 9;
+	const int PROBE_GRID_COUNT_Y = 4;
+	const int PROBE_GRID_COUNT_Z = 5;
 }
 
 /***********************************************************
@@ -31,10 +95,51 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(RenderDevice *pRenderDevice)
 {
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_pRenderDevice = pRenderDevice;
+	m_loadedTextures = 0;
+	m_textureBytes = 0;
+
+	// default values for the instance uniform block
+	m_instanceData = INSTANCE_BLOCK();
+	m_lightData = LIGHT_BLOCK();
+	m_instanceData.model = glm::mat4(1.0f);
+	m_instanceData.objectColor = glm::vec4(1.0f);
+	m_instanceData.UVscale = glm::vec2(1.0f, 1.0f);
+	m_instanceData.bUseTexture = false;
+	m_instanceData.bUseLighting = false;
+
+	m_sceneCopies = 1;
+	m_sceneOffset = glm::vec3(0.0f);
+	m_meshDetail = MeshGenerator::DEFAULT_DETAIL;
+	m_pStartupProfiler = NULL;
+	m_pAssetLoader = NULL;
+	m_bProgressiveLoading = false;
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		m_bPendingMeshes[i] = false;
+		m_meshUses[i] = 0;
+	}
+	for (int i = 0; i < 16; i++)
+	{
+		m_textureUses[i] = 0;
+	}
+	m_pendingTextureUses.assign(g_SceneTextureCount, 0);
+	m_uploadBudgetMilliseconds = DEFAULT_UPLOAD_MILLISECONDS;
+	m_uploadBudgetBytes = DEFAULT_UPLOAD_BYTES;
+	m_uploadStats = UPLOAD_STATS();
+	m_uploadFrames = 0;
+	m_maxQueuedAssets = 0;
+	m_maxDeferredBytes = 0;
+	m_cullViewCount = 0;
+	m_bObjectCulled = false;
+	m_culledObjects = 0;
+	m_pLightProbes = NULL;
+	m_nextProbeSample = 0;
+	m_probeUpdates = 0;
+	m_pRecordedOccluders = NULL;
+	m_recordedAlbedo = glm::vec3(0.0f);
 }
 
 /***********************************************************
@@ -44,9 +149,8 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
+	DestroyGLTextures();
+	m_pRenderDevice = NULL;
 }
 
 /***********************************************************
@@ -62,67 +166,189 @@ bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 	int width = 0;
 	int height = 0;
 	int colorChannels = 0;
-	GLuint textureID = 0;
+	uint32_t textureID = 0;
 
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
+	unsigned char* image = NULL;
 
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
+	BeginStartupPhase(std::string("CreateGLTexture ") + filename);
+
+	// take the image if it was decoded by the asset loader
+	AssetLoader::DECODED_IMAGE decoded;
+	if (NULL != m_pAssetLoader)
+	{
+		BeginStartupPhase("wait for decode");
+		if (m_pAssetLoader->TakeImage(filename, decoded))
+		{
+			image = decoded.pixels;
+			width = decoded.width;
+			height = decoded.height;
+			colorChannels = decoded.colorChannels;
+		}
+		EndStartupPhase();
+	}
+
+	if (NULL == image)
+	{
+		// indicate to always flip images vertically when loaded
+		stbi_set_flip_vertically_on_load(true);
+
+		// try to parse the image data from the specified image file
+		BeginStartupPhase("decode");
+		image = stbi_load(
+			filename,
+			&width,
+			&height,
+			&colorChannels,
+			0);
+		EndStartupPhase();
+	}
 
 	// if the image was successfully read from the image file
 	if (image)
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
+		LOG_INFO("loaded image", "file", filename, "width", width, "height", height, "channels", colorChannels);
 
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
+		// create the texture from the decoded image data
+		BeginStartupPhase("upload");
+		textureID = m_pRenderDevice->CreateTexture(
+			width,
+			height,
+			colorChannels,
+			image);
+		EndStartupPhase();
 
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		// free the image data from local memory
+		stbi_image_free(image);
+		EndStartupPhase();
 
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
+		if (textureID == 0)
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
 			return false;
 		}
 
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
 		// register the loaded texture and associate it with the special tag string
 		m_textureIDs[m_loadedTextures].ID = textureID;
 		m_textureIDs[m_loadedTextures].tag = tag;
 		m_loadedTextures++;
+		m_textureBytes += (size_t)width * height * colorChannels;
 
 		return true;
 	}
+	EndStartupPhase();
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	LOG_ERROR("could not load image", "file", filename);
 
 	// Error loading the image
 	return false;
 }
 
+/***********************************************************
+ *  StartStreamedTexture()
+ *
+ *  This method is used for creating a texture from an image
+ *  that the loader decoded along with its mip levels.  The
+ *  smallest levels are uploaded at once, so that the texture
+ *  is drawn from this frame on, and the larger levels are
+ *  left for the next frames.  The texture is uploaded whole
+ *  when the device cannot upload the levels separately.
+ ***********************************************************/
+bool SceneManager::StartStreamedTexture(const char* filename, std::string tag, size_t budgetBytes, size_t& uploadedBytes)
+{
+	STREAMED_TEXTURE streamed;
+	uint32_t textureID = 0;
+
+	uploadedBytes = 0;
+
+	// an image that the loader could not decode is loaded by
+	// the usual path, which logs the error
+	if ((NULL == m_pAssetLoader) || (m_pAssetLoader->TakeImage(filename, streamed.image) == false))
+	{
+		size_t textureBytes = m_textureBytes;
+		bool bLoaded = CreateGLTexture(filename, tag);
+		uploadedBytes = m_textureBytes - textureBytes;
+		return(bLoaded);
+	}
+
+	const AssetLoader::DECODED_IMAGE& image = streamed.image;
+	int mipLevels = (int)image.mipLevels.size() + 1;
+	if (mipLevels > 1)
+	{
+		textureID = m_pRenderDevice->CreateStreamedTexture(image.width, image.height, image.colorChannels, mipLevels);
+	}
+	if (textureID == 0)
+	{
+		textureID = m_pRenderDevice->CreateTexture(image.width, image.height, image.colorChannels, image.pixels);
+		uploadedBytes = GetMipLevelBytes(image, 0);
+		stbi_image_free(streamed.image.pixels);
+		streamed.image.pixels = NULL;
+		if (textureID == 0)
+		{
+			return(false);
+		}
+	}
+
+	LOG_INFO("streaming image", "file", filename, "width", image.width, "height", image.height,
+		"channels", image.colorChannels, "levels", (NULL != image.pixels) ? mipLevels : 1);
+
+	// register the texture and associate it with the tag string
+	m_textureIDs[m_loadedTextures].ID = textureID;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_loadedTextures++;
+	m_textureBytes += GetMipLevelBytes(image, 0);
+
+	if (NULL == image.pixels)
+	{
+		return(true);
+	}
+
+	streamed.texture = m_loadedTextures - 1;
+	streamed.nextLevel = mipLevels - 1;
+	while ((UploadNextTextureLevel(streamed, uploadedBytes) == false) &&
+		(uploadedBytes + GetMipLevelBytes(streamed.image, streamed.nextLevel) <= budgetBytes))
+	{
+	}
+
+	if (streamed.nextLevel >= 0)
+	{
+		m_streamedTextures.push_back(std::move(streamed));
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  UploadNextTextureLevel()
+ *
+ *  This method is used for uploading the next mip level of
+ *  a streamed texture, and freeing its pixels once they are
+ *  no longer needed.
+ ***********************************************************/
+bool SceneManager::UploadNextTextureLevel(STREAMED_TEXTURE& streamed, size_t& uploadedBytes)
+{
+	AssetLoader::DECODED_IMAGE& image = streamed.image;
+	int level = streamed.nextLevel;
+	const unsigned char* pixels = (level == 0) ? image.pixels : image.mipLevels[level - 1].data();
+
+	m_pRenderDevice->UploadTextureLevel(
+		m_textureIDs[streamed.texture].ID,
+		level,
+		std::max(image.width >> level, 1),
+		std::max(image.height >> level, 1),
+		image.colorChannels,
+		pixels);
+	uploadedBytes += GetMipLevelBytes(image, level);
+	streamed.nextLevel--;
+
+	if (level > 0)
+	{
+		std::vector<unsigned char>().swap(image.mipLevels[level - 1]);
+		return(false);
+	}
+
+	stbi_image_free(image.pixels);
+	image.pixels = NULL;
+	return(true);
+}
+
 /***********************************************************
  *  BindGLTextures()
  *
@@ -134,8 +360,7 @@ void SceneManager::BindGLTextures()
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
 		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		m_pRenderDevice->BindTexture(i, m_textureIDs[i].ID);
 	}
 }
 
@@ -147,10 +372,19 @@ void SceneManager::BindGLTextures()
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
+	// free the images of the textures that were still streaming
+	for (size_t i = 0; i < m_streamedTextures.size(); i++)
+	{
+		stbi_image_free(m_streamedTextures[i].image.pixels);
+	}
+	m_streamedTextures.clear();
+
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		m_pRenderDevice->DestroyTexture(m_textureIDs[i].ID);
 	}
+	m_loadedTextures = 0;
+	m_textureBytes = 0;
 }
 
 /***********************************************************
@@ -230,6 +464,8 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 			material.diffuseColor = m_objectMaterials[index].diffuseColor;
 			material.specularColor = m_objectMaterials[index].specularColor;
 			material.shininess = m_objectMaterials[index].shininess;
+			material.reflectivity = m_objectMaterials[index].reflectivity;
+			material.roughness = m_objectMaterials[index].roughness;
 		}
 		else
 		{
@@ -268,13 +504,30 @@ void SceneManager::SetTransformations(
 	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
 	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
 	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
+	translation = glm::translate(positionXYZ + m_sceneOffset);
 
 	modelView = translation * rotationZ * rotationY * rotationX * scale;
 
-	if (NULL != m_pShaderManager)
+	m_instanceData.model = modelView;
+
+	// the recorded objects are only kept as boxes, not drawn
+	if (NULL != m_pRecordedOccluders)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		m_bObjectCulled = true;
+		return;
+	}
+
+	m_instanceData.viewMask = FindInsideViews(modelView);
+	m_bObjectCulled = (m_instanceData.viewMask == 0);
+
+	// the probes are baked for the first copy of the scene
+	if (NULL != m_pLightProbes)
+	{
+		int sample = m_nextProbeSample++;
+		if (m_bObjectCulled == false)
+		{
+			UpdateProbeLighting(sample, glm::vec3(modelView[3]) - m_sceneOffset);
+		}
 	}
 }
 
@@ -298,11 +551,8 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	m_instanceData.bUseTexture = false;
+	m_instanceData.objectColor = currentColor;
 }
 
 /***********************************************************
@@ -314,13 +564,40 @@ void SceneManager::SetShaderColor(
 void SceneManager::SetShaderTexture(
 	std::string textureTag)
 {
-	if (NULL != m_pShaderManager)
+	if (m_bObjectCulled)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		return;
+	}
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+	// the uses are counted by slot, and only the textures that
+	// are still loading are looked up by their tag
+	int textureID = -1;
+	textureID = FindTextureSlot(textureTag);
+	if (textureID >= 0)
+	{
+		m_textureUses[textureID]++;
+	}
+	else
+	{
+		int sceneTexture = FindSceneTexture(textureTag);
+		if (sceneTexture >= 0)
+		{
+			m_pendingTextureUses[sceneTexture]++;
+		}
+	}
+
+	if (NULL != m_pRenderDevice)
+	{
+		// until the texture is loaded the object is drawn with
+		// the flat color that was set before the texture
+		if (textureID < 0)
+		{
+			m_instanceData.bUseTexture = false;
+			return;
+		}
+
+		m_instanceData.bUseTexture = true;
+		m_pRenderDevice->SetTextureSlot(textureID);
 	}
 }
 
@@ -332,10 +609,7 @@ void SceneManager::SetShaderTexture(
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	m_instanceData.UVscale = glm::vec2(u, v);
 }
 
 /***********************************************************
@@ -347,23 +621,249 @@ void SceneManager::SetTextureUVScale(float u, float v)
 void SceneManager::SetShaderMaterial(
 	std::string materialTag)
 {
+	if (NULL != m_pRecordedOccluders)
+	{
+		OBJECT_MATERIAL material;
+		m_recordedAlbedo = FindMaterial(materialTag, material) ? material.diffuseColor : glm::vec3(0.0f);
+		return;
+	}
+
+	if (m_bObjectCulled)
+	{
+		return;
+	}
+
 	if (m_objectMaterials.size() > 0)
 	{
 		OBJECT_MATERIAL material;
 		bool bReturn = false;
 
 		bReturn = FindMaterial(materialTag, material);
+		// the shader material block has no ambient members, the
+		// ambient term comes from the global ambient color
 		if (bReturn == true)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			MATERIAL_BLOCK materialData = MATERIAL_BLOCK();
+			materialData.diffuseColor = material.diffuseColor;
+			materialData.specularColor = material.specularColor;
+			materialData.shininess = material.shininess;
+			materialData.reflectivity = material.reflectivity;
+			materialData.roughness = material.roughness;
+			m_pRenderDevice->UpdateBlock(materialData);
 		}
 	}
 }
 
+/***********************************************************
+ *  DrawSceneMesh()
+ *
+ *  This method is used for drawing one of the loaded shape
+ *  meshes, counting the draw as a use of the mesh.
+ ***********************************************************/
+void SceneManager::DrawSceneMesh(MESH_TYPE mesh)
+{
+	if (NULL != m_pRecordedOccluders)
+	{
+		glm::vec3 minimum;
+		glm::vec3 maximum;
+		MeshGenerator::GetMeshBounds(mesh, minimum, maximum);
+		m_pRecordedOccluders->push_back(LightProbeGrid::MakeOccluder(m_instanceData.model, minimum, maximum, m_recordedAlbedo));
+		return;
+	}
+
+	if (m_bObjectCulled)
+	{
+		m_culledObjects++;
+		return;
+	}
+
+	if ((mesh >= 0) && (mesh < MESH_COUNT))
+	{
+		m_meshUses[mesh]++;
+	}
+	m_pRenderDevice->DrawMesh(mesh);
+}
+
+/***********************************************************
+ *  SetEnvironmentLighting()
+ *
+ *  This method is used for lighting the reflective materials
+ *  with a built environment, by setting its diffuse light
+ *  into the light block and binding its cube map.
+ ***********************************************************/
+void SceneManager::SetEnvironmentLighting(const EnvironmentLighting* pEnvironment)
+{
+	if (NULL == pEnvironment)
+	{
+		return;
+	}
+
+	pEnvironment->ApplyToLights(m_lightData);
+	m_pRenderDevice->UpdateBlock(m_lightData);
+	m_pRenderDevice->BindEnvironment(pEnvironment->GetTexture());
+}
+
+/***********************************************************
+ *  BakeLightProbes()
+ *
+ *  This method is used for baking the light probes.  The
+ *  objects of the scene are recorded as boxes instead of
+ *  being drawn, the probes are baked from the boxes and the
+ *  lights of the scene, and from then on the drawn objects
+ *  are lit with the probes around them.
+ ***********************************************************/
+void SceneManager::BakeLightProbes(LightProbeGrid* pLightProbes)
+{
+	if (NULL == pLightProbes)
+	{
+		return;
+	}
+
+	std::vector<LightProbeGrid::PROBE_OCCLUDER> occluders;
+	m_pRecordedOccluders = &occluders;
+	m_sceneOffset = glm::vec3(0.0f);
+	RenderSceneObjects();
+	m_pRecordedOccluders = NULL;
+	m_bObjectCulled = false;
+
+	pLightProbes->SetBounds(
+		PROBE_GRID_MINIMUM,
+		PROBE_GRID_MAXIMUM,
+		PROBE_GRID_COUNT_X,
+		PROBE_GRID_COUNT_Y,
+		PROBE_GRID_COUNT_Z);
+	pLightProbes->Bake(m_lightData, occluders);
+
+	m_pLightProbes = pLightProbes;
+	m_probeSamples.clear();
+}
+
+/***********************************************************
+ *  SetCullingViews()
+ *
+ *  This method is used for getting the planes of the view
+ *  frustums from the view and projection of each view.  The
+ *  planes point into the frustum, and are normalized so that
+ *  the distances to them can be compared with a radius.
+ ***********************************************************/
+void SceneManager::SetCullingViews(const CAMERA_BLOCK& cameraData, int viewCount)
+{
+	m_cullViewCount = std::max(0, std::min(viewCount, MAX_VIEWS));
+
+	for (int i = 0; i < m_cullViewCount; i++)
+	{
+		glm::mat4 viewProjection = cameraData.views[i].projection * cameraData.views[i].view;
+		glm::vec4 rows[4];
+
+		for (int row = 0; row < 4; row++)
+		{
+			rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row],
+				viewProjection[2][row], viewProjection[3][row]);
+		}
+
+		// left, right, bottom, top, near and far
+		for (int axis = 0; axis < 3; axis++)
+		{
+			m_cullPlanes[i][axis * 2] = rows[3] + rows[axis];
+			m_cullPlanes[i][(axis * 2) + 1] = rows[3] - rows[axis];
+		}
+		for (int plane = 0; plane < 6; plane++)
+		{
+			float length = glm::length(glm::vec3(m_cullPlanes[i][plane]));
+			if (length > 0.0f)
+			{
+				m_cullPlanes[i][plane] /= length;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  FindInsideViews()
+ *
+ *  This method is used for checking the bounding sphere of
+ *  a shape mesh against each of the culling views, so that
+ *  the object is only drawn in the views that it is in,
+ *  such as the faces of a cube map that it crosses.  The
+ *  views are returned as one bit for each view, and without
+ *  culling views every object is in all of them.
+ ***********************************************************/
+uint32_t SceneManager::FindInsideViews(const glm::mat4& model) const
+{
+	if (m_cullViewCount == 0)
+	{
+		return((1u << MAX_VIEWS) - 1u);
+	}
+
+	glm::vec3 center = glm::vec3(model[3]);
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	float radius = MESH_BOUNDING_RADIUS * scale;
+
+	uint32_t viewMask = 0;
+	for (int i = 0; i < m_cullViewCount; i++)
+	{
+		bool bInside = true;
+		for (int plane = 0; (plane < 6) && bInside; plane++)
+		{
+			bInside = (glm::dot(glm::vec3(m_cullPlanes[i][plane]), center) + m_cullPlanes[i][plane].w >= -radius);
+		}
+		if (bInside)
+		{
+			viewMask |= (1u << i);
+		}
+	}
+
+	return(viewMask);
+}
+
+/***********************************************************
+ *  UpdateProbeLighting()
+ *
+ *  This method is used for setting the diffuse light of
+ *  the light probes around the next drawn object into the
+ *  shader.  The blended probes of each object are kept from
+ *  frame to frame, and are only blended again when the
+ *  object is drawn at a different position.
+ ***********************************************************/
+void SceneManager::UpdateProbeLighting(int sample, const glm::vec3& position)
+{
+	if (sample >= (int)m_probeSamples.size())
+	{
+		m_probeSamples.resize(sample + 1, PROBE_SAMPLE());
+	}
+
+	PROBE_SAMPLE& probeSample = m_probeSamples[sample];
+	if ((probeSample.bValid == false) || (probeSample.position != position))
+	{
+		SphericalHarmonics::SH_COLOR sh;
+		m_pLightProbes->Sample(position, sh);
+		SphericalHarmonics::PackForInstance(sh, probeSample.lightProbe);
+		probeSample.position = position;
+		probeSample.bValid = true;
+		m_probeUpdates++;
+	}
+
+	for (int i = 0; i < SH_INSTANCE_VECTORS; i++)
+	{
+		m_instanceData.lightProbe[i] = probeSample.lightProbe[i];
+	}
+}
+
+/***********************************************************
+ *  UpdateInstanceBlock()
+ *
+ *  This method is used for copying the transformation and
+ *  color values of the next drawn object into the shader.
+ ***********************************************************/
+void SceneManager::UpdateInstanceBlock()
+{
+	if ((NULL != m_pRenderDevice) && (m_bObjectCulled == false))
+	{
+		m_pRenderDevice->UpdateBlock(m_instanceData);
+	}
+}
+
 /**************************************************************/
 /*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
 /*** preparing and rendering their own 3D replicated scenes.***/
@@ -389,6 +889,8 @@ void SceneManager::DefineObjectMaterials()
 	blackmetalMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
 	blackmetalMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
 	blackmetalMaterial.shininess = 128.0;
+	blackmetalMaterial.reflectivity = 0.3f;
+	blackmetalMaterial.roughness = 0.4f;
 	blackmetalMaterial.tag = "blackmetal";
 
 	m_objectMaterials.push_back(blackmetalMaterial);
@@ -399,6 +901,8 @@ void SceneManager::DefineObjectMaterials()
 	carbonfiberMaterial.diffuseColor = glm::vec3(0.4f, 0.4f, 0.4f);
 	carbonfiberMaterial.specularColor = glm::vec3(0.8f, 0.8f, 0.8f);
 	carbonfiberMaterial.shininess = 0.5;
+	carbonfiberMaterial.reflectivity = 0.0f;
+	carbonfiberMaterial.roughness = 1.0f;
 	carbonfiberMaterial.tag = "carbonfiber";
 
 	m_objectMaterials.push_back(carbonfiberMaterial);
@@ -409,6 +913,8 @@ void SceneManager::DefineObjectMaterials()
 	metalMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
 	metalMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f);
 	metalMaterial.shininess = 100.0;
+	metalMaterial.reflectivity = 0.6f;
+	metalMaterial.roughness = 0.2f;
 	metalMaterial.tag = "metal";
 
 	m_objectMaterials.push_back(metalMaterial);
@@ -419,6 +925,8 @@ void SceneManager::DefineObjectMaterials()
 	greyplasticMaterial.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
 	greyplasticMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f);
 	greyplasticMaterial.shininess = 65.0;
+	greyplasticMaterial.reflectivity = 0.0f;
+	greyplasticMaterial.roughness = 1.0f;
 	greyplasticMaterial.tag = "greyplastic";
 
 	m_objectMaterials.push_back(greyplasticMaterial);
@@ -429,6 +937,8 @@ void SceneManager::DefineObjectMaterials()
 	clayMaterial.diffuseColor = glm::vec3(0.4f, 0.4f, 0.5f);
 	clayMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.4f);
 	clayMaterial.shininess = 0.5;
+	clayMaterial.reflectivity = 0.0f;
+	clayMaterial.roughness = 1.0f;
 	clayMaterial.tag = "clay";
 	m_objectMaterials.push_back(clayMaterial);
 
@@ -446,41 +956,42 @@ void SceneManager::SetupSceneLights()
 	// the 3D scene with custom lighting, if no light sources have
 	// been added then the display window will be black - to use the 
 	// default OpenGL lighting then comment out the following line
-	//m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	//m_instanceData.bUseLighting = true;
 
 	/*** STUDENTS - add the code BELOW for setting up light sources ***/
 	/*** Up to four light sources can be defined. Refer to the code ***/
 	/*** in the OpenGL Sample for help                              ***/
 
-	m_pShaderManager->setVec3Value("lightSources[0].position", 5.0f, 5.0f, 5.0f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.01f, 0.01f, 0.01f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 1.0f, 0.4f, 0.4f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 0.01f);
+	LIGHT_BLOCK lightData = LIGHT_BLOCK();
 
-	m_pShaderManager->setVec3Value("lightSources[1].position", -3.0f, 5.0f, 5.0f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 1.0f, 0.01f, 0.01f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.4f, 0.4f, 0.4f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 32.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 0.01f);
+	lightData.lightSources[0].position = glm::vec3(5.0f, 5.0f, 5.0f);
+	lightData.lightSources[0].diffuseColor = glm::vec3(1.0f, 0.4f, 0.4f);
+	lightData.lightSources[0].specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	lightData.lightSources[0].focalStrength = 32.0f;
+	lightData.lightSources[0].specularIntensity = 0.01f;
 
-	m_pShaderManager->setVec3Value("lightSources[2].position", 1.6f, 5.0f, 1.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.01f, 0.01f, 0.01f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.1f);
+	lightData.lightSources[1].position = glm::vec3(-3.0f, 5.0f, 5.0f);
+	lightData.lightSources[1].diffuseColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	lightData.lightSources[1].specularColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	lightData.lightSources[1].focalStrength = 32.0f;
+	lightData.lightSources[1].specularIntensity = 0.01f;
 
-	m_pShaderManager->setVec3Value("lightSources[3].position", 4.0f, 5.0f, -5.0f);
-	m_pShaderManager->setVec3Value("lightSources[3].ambientColor", 0.01f, 0.01f, 0.01f);
-	m_pShaderManager->setVec3Value("lightSources[3].diffuseColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setVec3Value("lightSources[3].specularColor", 0.3f, 0.3f, 0.3f);
-	m_pShaderManager->setFloatValue("lightSources[3].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[3].specularIntensity", 0.1f);
+	lightData.lightSources[2].position = glm::vec3(1.6f, 5.0f, 1.0f);
+	lightData.lightSources[2].diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	lightData.lightSources[2].specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	lightData.lightSources[2].focalStrength = 12.0f;
+	lightData.lightSources[2].specularIntensity = 0.1f;
 
-	m_pShaderManager->setBoolValue("bUseLighting", true);
+	lightData.lightSources[3].position = glm::vec3(4.0f, 5.0f, -5.0f);
+	lightData.lightSources[3].diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	lightData.lightSources[3].specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	lightData.lightSources[3].focalStrength = 12.0f;
+	lightData.lightSources[3].specularIntensity = 0.1f;
+
+	m_lightData = lightData;
+	m_pRenderDevice->UpdateBlock(m_lightData);
+
+	m_instanceData.bUseLighting = true;
 
 }
 
@@ -493,24 +1004,16 @@ void SceneManager::SetupSceneLights()
 ***********************************************************/
 void SceneManager::LoadSceneTextures()
 {
-	/*** STUDENTS - add the code BELOW for loading the textures that ***/
-	/*** will be used for mapping to objects in the 3D scene. Up to  ***/
-	/*** 16 textures can be loaded per scene. Refer to the code in   ***/
-	/*** the OpenGL Sample for help.                                 ***/
-
-	bool bReturn = false;
-	bReturn = CreateGLTexture(
-		"textures/blackmetal.jpg",
-		"blackmetal");
-	bReturn = CreateGLTexture(
-		"textures/carbonfiber.png",
-		"carbonfiber");
-	bReturn = CreateGLTexture(
-		"textures/metal.jpg",
-		"metal");
-	bReturn = CreateGLTexture(
-		"textures/greyplastic.jpg",
-		"greyplastic");
+	/*** STUDENTS - add the textures that will be used for mapping ***/
+	/*** to objects in the 3D scene to the g_SceneTextures table.  ***/
+	/*** Up to 16 textures can be loaded per scene.                ***/
+
+	for (int i = 0; i < g_SceneTextureCount; i++)
+	{
+		CreateGLTexture(
+			g_SceneTextures[i].filename,
+			g_SceneTextures[i].tag);
+	}
 
 	// after the texture image data is loaded into memory, the
 	// loaded textures need to be bound to texture slots - there
@@ -518,6 +1021,25 @@ void SceneManager::LoadSceneTextures()
 	BindGLTextures();
 }
 
+/***********************************************************
+ *  GetTextureFiles()
+ *
+ *  This method is used for getting the image files of the
+ *  scene textures, so that they can be decoded before the
+ *  scene is prepared.
+ ***********************************************************/
+std::vector<std::string> SceneManager::GetTextureFiles()
+{
+	std::vector<std::string> files;
+
+	for (int i = 0; i < g_SceneTextureCount; i++)
+	{
+		files.push_back(g_SceneTextures[i].filename);
+	}
+
+	return(files);
+}
+
 /***********************************************************
  *  PrepareScene()
  *
@@ -528,29 +1050,362 @@ void SceneManager::LoadSceneTextures()
 void SceneManager::PrepareScene()
 {
 	// define the materials for objects in the scene
+	BeginStartupPhase("DefineObjectMaterials");
 	DefineObjectMaterials();
+	EndStartupPhase();
 	// add and define the light sources for the scene
+	BeginStartupPhase("SetupSceneLights");
 	SetupSceneLights();
+	EndStartupPhase();
+
+	// draw the first frames with coarse meshes and flat colors,
+	// the textures and the full meshes are uploaded as they
+	// arrive from the loader
+	if ((NULL != m_pAssetLoader) && m_bProgressiveLoading)
+	{
+		LoadPlaceholderMeshes();
+		for (int i = 0; i < g_SceneTextureCount; i++)
+		{
+			m_pendingTextures.push_back(i);
+		}
+		return;
+	}
 
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
 	// in the rendered 3D scene
+	BeginStartupPhase("LoadSceneTextures");
 	LoadSceneTextures();
+	EndStartupPhase();
+
+	LoadSceneMesh(MESH_PLANE);
+	LoadSceneMesh(MESH_TORUS);
+	LoadSceneMesh(MESH_CYLINDER);
+	LoadSceneMesh(MESH_SPHERE);
+}
+
+/***********************************************************
+ *  LoadSceneMesh()
+ *
+ *  This method is used for loading one of the shape meshes,
+ *  timed under the name of the shape mesh load method.
+ ***********************************************************/
+void SceneManager::LoadSceneMesh(MESH_TYPE mesh)
+{
+	static const char* const meshPhases[MESH_COUNT] =
+	{
+		"LoadPlaneMesh",
+		"LoadTorusMesh",
+		"LoadCylinderMesh",
+		"LoadSphereMesh"
+	};
+
+	if ((mesh < 0) || (mesh >= MESH_COUNT))
+	{
+		return;
+	}
+
+	BeginStartupPhase(meshPhases[mesh]);
+	RenderDevice::MESH_DATA data;
+	if ((NULL != m_pAssetLoader) && m_pAssetLoader->TakeMesh(mesh, data))
+	{
+		m_pRenderDevice->LoadMesh(mesh, data);
+	}
+	else if (m_meshDetail != MeshGenerator::DEFAULT_DETAIL)
+	{
+		MeshGenerator::GenerateMesh(mesh, m_meshDetail, data);
+		m_pRenderDevice->LoadMesh(mesh, data);
+	}
+	else
+	{
+		m_pRenderDevice->LoadMesh(mesh);
+	}
+	EndStartupPhase();
+}
+
+/***********************************************************
+ *  LoadPlaceholderMeshes()
+ *
+ *  This method is used for loading coarse versions of the
+ *  shape meshes, which are cheap enough to generate on the
+ *  main thread, so that the scene can be drawn before the
+ *  loader has generated the full meshes.
+ ***********************************************************/
+void SceneManager::LoadPlaceholderMeshes()
+{
+	BeginStartupPhase("LoadPlaceholderMeshes");
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		RenderDevice::MESH_DATA data;
+		MeshGenerator::GenerateMesh((MESH_TYPE)i, MeshGenerator::PLACEHOLDER_DETAIL, data);
+		m_pRenderDevice->LoadMesh((MESH_TYPE)i, data);
+		m_bPendingMeshes[i] = true;
+	}
+	EndStartupPhase();
+}
+
+/***********************************************************
+ *  LoadArrivedAssets()
+ *
+ *  This method is used for uploading the textures and the
+ *  full meshes that the loader has finished, in place of
+ *  the placeholders.  Only the assets that are done are
+ *  taken, so the frame is never stalled waiting for one.
+ *  The textures are uploaded a mip level at a time, from
+ *  the smallest level up, so that one large texture is
+ *  spread over several frames.  The uploads are ordered by
+ *  the number of objects that used the asset in the last
+ *  frame, and stop once the frame's upload time or bytes
+ *  are spent, leaving the rest queued for the next frames.
+ *  Without a loader the remaining assets are loaded here.
+ ***********************************************************/
+bool SceneManager::LoadArrivedAssets()
+{
+	// asset that is ready to upload
+	struct UPLOAD_ITEM
+	{
+		// index in the scene textures, or -1 for a mesh or the
+		// next level of a streamed texture
+		int texture;
+		MESH_TYPE mesh;
+		// index in the streamed textures, or -1
+		int streamed;
+		size_t bytes;
+		int uses;
+	};
+	std::vector<UPLOAD_ITEM> ready;
+
+	m_uploadStats = UPLOAD_STATS();
+
+	for (size_t i = 0; i < m_streamedTextures.size(); i++)
+	{
+		const STREAMED_TEXTURE& streamed = m_streamedTextures[i];
+		UPLOAD_ITEM item;
+		item.texture = -1;
+		item.mesh = MESH_COUNT;
+		item.streamed = (int)i;
+		item.bytes = GetMipLevelBytes(streamed.image, streamed.nextLevel);
+		item.uses = m_textureUses[streamed.texture];
+		ready.push_back(item);
+	}
+	for (size_t i = 0; i < m_pendingTextures.size(); i++)
+	{
+		const SCENE_TEXTURE& texture = g_SceneTextures[m_pendingTextures[i]];
+		UPLOAD_ITEM item;
+		item.bytes = 0;
+		if ((NULL != m_pAssetLoader) && (m_pAssetLoader->IsImageReady(texture.filename, item.bytes) == false))
+		{
+			m_uploadStats.loadingAssets++;
+			continue;
+		}
+
+		item.texture = m_pendingTextures[i];
+		item.mesh = MESH_COUNT;
+		item.streamed = -1;
+		item.uses = m_pendingTextureUses[m_pendingTextures[i]];
+		ready.push_back(item);
+	}
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		if (m_bPendingMeshes[i] == false)
+		{
+			continue;
+		}
 
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadTorusMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadSphereMesh();
+		UPLOAD_ITEM item;
+		item.bytes = 0;
+		if ((NULL != m_pAssetLoader) && (m_pAssetLoader->IsMeshReady((MESH_TYPE)i, item.bytes) == false))
+		{
+			m_uploadStats.loadingAssets++;
+			continue;
+		}
+
+		item.texture = -1;
+		item.mesh = (MESH_TYPE)i;
+		item.streamed = -1;
+		item.uses = m_meshUses[i];
+		ready.push_back(item);
+	}
+
+	std::stable_sort(ready.begin(), ready.end(),
+		[](const UPLOAD_ITEM& a, const UPLOAD_ITEM& b) { return(a.uses > b.uses); });
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < ready.size(); i++)
+	{
+		const UPLOAD_ITEM& item = ready[i];
+
+		// the first asset is always uploaded, so that the queue
+		// drains even when one asset is over the budget
+		if (m_uploadStats.uploadedAssets > 0)
+		{
+			m_uploadStats.uploadMilliseconds = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - start).count();
+			if ((m_uploadStats.uploadMilliseconds >= m_uploadBudgetMilliseconds) ||
+				(m_uploadStats.uploadedBytes + item.bytes > m_uploadBudgetBytes))
+			{
+				m_uploadStats.queuedAssets++;
+				m_uploadStats.deferredBytes += item.bytes;
+				continue;
+			}
+		}
+
+		size_t bytes = item.bytes;
+		if (item.streamed >= 0)
+		{
+			bytes = 0;
+			UploadNextTextureLevel(m_streamedTextures[item.streamed], bytes);
+		}
+		else if (item.texture >= 0)
+		{
+			// a texture that could not be loaded keeps its flat color
+			const SCENE_TEXTURE& texture = g_SceneTextures[item.texture];
+			size_t budgetBytes = (m_uploadBudgetBytes > m_uploadStats.uploadedBytes) ?
+				(m_uploadBudgetBytes - m_uploadStats.uploadedBytes) : 0;
+			if (StartStreamedTexture(texture.filename, texture.tag, budgetBytes, bytes))
+			{
+				m_pRenderDevice->BindTexture(m_loadedTextures - 1, m_textureIDs[m_loadedTextures - 1].ID);
+			}
+			m_pendingTextures.erase(std::find(m_pendingTextures.begin(), m_pendingTextures.end(), item.texture));
+		}
+		else
+		{
+			LoadSceneMesh(item.mesh);
+			m_bPendingMeshes[item.mesh] = false;
+		}
+		m_uploadStats.uploadedAssets++;
+		m_uploadStats.uploadedBytes += bytes;
+	}
+	m_streamedTextures.erase(
+		std::remove_if(m_streamedTextures.begin(), m_streamedTextures.end(),
+			[](const STREAMED_TEXTURE& streamed) { return(streamed.nextLevel < 0); }),
+		m_streamedTextures.end());
+	m_uploadStats.uploadMilliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - start).count();
+
+	m_uploadFrames++;
+	m_maxQueuedAssets = std::max(m_maxQueuedAssets, m_uploadStats.queuedAssets);
+	m_maxDeferredBytes = std::max(m_maxDeferredBytes, m_uploadStats.deferredBytes);
+
+	if ((m_uploadStats.loadingAssets > 0) || (m_uploadStats.queuedAssets > 0) ||
+		(false == m_streamedTextures.empty()))
+	{
+		return(false);
+	}
+
+	if (m_bProgressiveLoading)
+	{
+		LOG_INFO("assets streamed", "frames", m_uploadFrames, "maxQueued", m_maxQueuedAssets,
+			"maxDeferredKB", m_maxDeferredBytes / 1024.0);
+	}
+	return(true);
 }
 
+/***********************************************************
+ *  SetUploadBudget()
+ *
+ *  This method is used for setting the time and the bytes
+ *  that the streamed uploads of one frame can take.
+ ***********************************************************/
+void SceneManager::SetUploadBudget(double milliseconds, size_t bytes)
+{
+	m_uploadBudgetMilliseconds = milliseconds;
+	m_uploadBudgetBytes = bytes;
+}
+
+/***********************************************************
+ *  BeginStartupPhase()
+ *  EndStartupPhase()
+ *
+ *  These methods are used for timing a phase of the scene
+ *  preparation when a startup profiler is set.
+ ***********************************************************/
+void SceneManager::BeginStartupPhase(const std::string& name)
+{
+	if (NULL != m_pStartupProfiler)
+	{
+		m_pStartupProfiler->BeginPhase(name);
+	}
+}
+
+void SceneManager::EndStartupPhase()
+{
+	if (NULL != m_pStartupProfiler)
+	{
+		m_pStartupProfiler->EndPhase();
+	}
+}
+
+
+/***********************************************************
+ *  SetSceneCopies()
+ *
+ *  This method is used for setting the number of copies of
+ *  the scene that are drawn each frame.
+ ***********************************************************/
+void SceneManager::SetSceneCopies(int copies)
+{
+	m_sceneCopies = (copies > 1) ? copies : 1;
+}
 
 /***********************************************************
  *  RenderScene()
  *
+ *  This method is used for rendering the copies of the 3D
+ *  scene, laid out in a grid that extends away from the
+ *  camera.
+ ***********************************************************/
+void SceneManager::RenderScene()
+{
+	// spacing between the copies, wider than the desk plane
+	const float copySpacing = 24.0f;
+	int columns = 1;
+
+	while (columns * columns < m_sceneCopies)
+	{
+		columns++;
+	}
+
+	// count the uses of the textures and meshes in this frame
+	for (int i = 0; i < 16; i++)
+	{
+		m_textureUses[i] = 0;
+	}
+	for (size_t i = 0; i < m_pendingTextureUses.size(); i++)
+	{
+		m_pendingTextureUses[i] = 0;
+	}
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		m_meshUses[i] = 0;
+	}
+	m_culledObjects = 0;
+	m_nextProbeSample = 0;
+	m_probeUpdates = 0;
+
+	for (int i = 0; i < m_sceneCopies; i++)
+	{
+		int column = i % columns;
+		int row = i / columns;
+
+		m_sceneOffset = glm::vec3(
+			(column - ((columns - 1) * 0.5f)) * copySpacing,
+			0.0f,
+			-row * copySpacing);
+		RenderSceneObjects();
+	}
+
+	m_sceneOffset = glm::vec3(0.0f);
+	m_bObjectCulled = false;
+}
+
+/***********************************************************
+ *  RenderSceneObjects()
+ *
  *  This method is used for rendering the 3D scene by 
  *  transforming and drawing the basic 3D shapes
  ***********************************************************/
-void SceneManager::RenderScene()
+void SceneManager::RenderSceneObjects()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -587,8 +1442,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("greyplastic");
 	SetShaderMaterial("clay");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	DrawSceneMesh(MESH_PLANE);
 	/****************************************************************/
 
 	//Backdrop
@@ -616,8 +1473,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("greyplastic");
 	SetShaderMaterial("clay");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	DrawSceneMesh(MESH_PLANE);
 	/****************************************************************/
 
 	// Base Cylinder
@@ -645,8 +1504,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("carbonfiber");
 	SetShaderMaterial("carbonfiber");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 
 	// Cylinder Extension
@@ -674,8 +1535,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("blackmetal");
 	SetShaderMaterial("blackmetal");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 
 	// Cylinder Lock
@@ -703,8 +1566,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("carbonfiber");
 	SetShaderMaterial("carbonfiber");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 
 	// Cylinder Lock
@@ -732,8 +1597,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("carbonfiber");
 	SetShaderMaterial("carbonfiber");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 
 	// Cylinder Joint
@@ -761,8 +1628,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("carbonfiber");
 	SetShaderMaterial("carbonfiber");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 
 	// Sphere Joint
@@ -790,8 +1659,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("metal");
 	SetShaderMaterial("metal");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+	DrawSceneMesh(MESH_SPHERE);
 	/****************************************************************/
 
 	// Cylinder off Ball Joint
@@ -819,8 +1690,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("metal");
 	SetShaderMaterial("metal");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 	
 	// Cylinder off Torus
@@ -848,8 +1721,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("carbonfiber");
 	SetShaderMaterial("carbonfiber");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(MESH_CYLINDER);
 	/****************************************************************/
 
 	// Torus Light
@@ -877,8 +1752,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("greyplastic");
 	SetShaderMaterial("greyplastic");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	DrawSceneMesh(MESH_TORUS);
 	/****************************************************************/
 
 	// Torus Light Back
@@ -906,8 +1783,10 @@ void SceneManager::RenderScene()
 	SetShaderTexture("blackmetal");
 	SetShaderMaterial("blackmetal");
 
+	UpdateInstanceBlock();
+
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	DrawSceneMesh(MESH_TORUS);
 	/****************************************************************/
 
 }
@@ -9,8 +9,11 @@
 
 #pragma once
 
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
+#include "RenderDevice.h"
+#include "StartupProfiler.h"
+#include "AssetLoader.h"
+#include "EnvironmentLighting.h"
+#include "LightProbeGrid.h"
 
 #include <string>
 #include <vector>
@@ -23,9 +26,12 @@
  ***********************************************************/
 class SceneManager
 {
+	// the microbenchmarks time the private helper methods
+	friend class MicroBenchmarks;
+
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(RenderDevice *pRenderDevice);
 	// destructor
 	~SceneManager();
 
@@ -42,23 +48,126 @@ public:
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
+		// share of the environment that the surface reflects,
+		// and how blurred the reflection is, from zero to one
+		float reflectivity;
+		float roughness;
 		std::string tag;
 	};
 
+	// counters of the streamed asset uploads for one frame
+	struct UPLOAD_STATS
+	{
+		// assets uploaded in the frame
+		int uploadedAssets;
+		size_t uploadedBytes;
+		double uploadMilliseconds;
+		// assets that were loaded but left for a later frame
+		int queuedAssets;
+		size_t deferredBytes;
+		// assets that the loader has not finished
+		int loadingAssets;
+	};
+
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
+	// pointer to render device object
+	RenderDevice* m_pRenderDevice;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
+	// bytes of the image data of the loaded textures
+	size_t m_textureBytes;
+	// segments around the curved surfaces of the full meshes
+	int m_meshDetail;
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// values for the instance uniform block of the next drawn object
+	INSTANCE_BLOCK m_instanceData;
+	// light sources of the scene, with the environment lighting
+	LIGHT_BLOCK m_lightData;
+	// number of copies of the scene that are drawn, and the
+	// offset of the copy being drawn
+	int m_sceneCopies;
+	glm::vec3 m_sceneOffset;
+	// profiler that times the scene preparation, if any
+	StartupProfiler* m_pStartupProfiler;
+	// loader with the assets decoded ahead of time, if any
+	AssetLoader* m_pAssetLoader;
+	// draw placeholders until the loaded assets arrive
+	bool m_bProgressiveLoading;
+	// indices of the scene textures that have not arrived, and
+	// the meshes that are still drawn as coarse placeholders
+	std::vector<int> m_pendingTextures;
+	bool m_bPendingMeshes[MESH_COUNT];
+	// time and bytes that the uploads of one frame can take
+	double m_uploadBudgetMilliseconds;
+	size_t m_uploadBudgetBytes;
+	UPLOAD_STATS m_uploadStats;
+	// frames that streamed assets, and the deepest queue
+	int m_uploadFrames;
+	int m_maxQueuedAssets;
+	size_t m_maxDeferredBytes;
+	// textures whose mip levels are uploaded over several
+	// frames from the smallest level up, with the index of the
+	// loaded texture, its decoded image and the next level
+	struct STREAMED_TEXTURE
+	{
+		int texture;
+		AssetLoader::DECODED_IMAGE image;
+		int nextLevel;
+	};
+	std::vector<STREAMED_TEXTURE> m_streamedTextures;
+	// number of objects that used each texture slot and mesh
+	// in the last drawn frame, which orders the queued uploads,
+	// and the uses of the scene textures that are not loaded
+	// into a slot yet
+	int m_textureUses[16];
+	std::vector<int> m_pendingTextureUses;
+	int m_meshUses[MESH_COUNT];
+	// planes of the frustum of each view, the objects are
+	// culled once against all of the views and drawn in the
+	// views that they are inside
+	glm::vec4 m_cullPlanes[MAX_VIEWS][6];
+	int m_cullViewCount;
+	// the object being set up is outside the views, so its
+	// uniform updates and its draw are skipped
+	bool m_bObjectCulled;
+	// objects that were skipped in the last drawn frame
+	int m_culledObjects;
+	// light probes that the diffuse light of the drawn objects
+	// is blended from, if any
+	const LightProbeGrid* m_pLightProbes;
+	// blended light probes of each object that is drawn, in
+	// the order of the draws, which are only blended again
+	// when the object has moved
+	struct PROBE_SAMPLE
+	{
+		glm::vec3 position;
+		glm::vec4 lightProbe[SH_INSTANCE_VECTORS];
+		bool bValid;
+	};
+	std::vector<PROBE_SAMPLE> m_probeSamples;
+	int m_nextProbeSample;
+	// objects that the probes were blended for in the last
+	// drawn frame
+	int m_probeUpdates;
+	// boxes around the objects while the scene is recorded for
+	// baking the light probes, and the diffuse color of the
+	// material of the next recorded object
+	std::vector<LightProbeGrid::PROBE_OCCLUDER>* m_pRecordedOccluders;
+	glm::vec3 m_recordedAlbedo;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
+	// create a texture from an image decoded by the loader and
+	// upload its smaller mip levels within the passed in bytes,
+	// leaving the larger levels for the next frames, and get
+	// the bytes that were uploaded
+	bool StartStreamedTexture(const char* filename, std::string tag, size_t budgetBytes, size_t& uploadedBytes);
+	// upload the next mip level of a streamed texture, true is
+	// returned once all of its levels have been uploaded
+	bool UploadNextTextureLevel(STREAMED_TEXTURE& streamed, size_t& uploadedBytes);
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
@@ -97,6 +206,27 @@ private:
 	void SetShaderMaterial(
 		std::string materialTag);
 
+	// copy the instance values into the shader before drawing
+	void UpdateInstanceBlock();
+
+	// draw a mesh, counting it as a use of the mesh
+	void DrawSceneMesh(MESH_TYPE mesh);
+	// find the culling views that a shape mesh with the passed
+	// in model transformation is inside, as one bit for each
+	uint32_t FindInsideViews(const glm::mat4& model) const;
+	// set the blended light probes of the next drawn object
+	// into the shader, blending them again if it has moved
+	void UpdateProbeLighting(int sample, const glm::vec3& position);
+
+	// time a phase of the scene preparation
+	void BeginStartupPhase(const std::string& name);
+	void EndStartupPhase();
+	// load a mesh, timing it as a phase of the preparation
+	void LoadSceneMesh(MESH_TYPE mesh);
+	// load coarse meshes that are drawn until the loader has
+	// generated the full meshes
+	void LoadPlaceholderMeshes();
+
 	void DefineObjectMaterials();
 
 	void SetupSceneLights();
@@ -109,5 +239,54 @@ public:
 	// customize for their own 3D scene
 	void PrepareScene();
 	void RenderScene();
+	void RenderSceneObjects();
+
+	// draw a grid of copies of the scene, for stress testing
+	// the render devices with more draw calls
+	void SetSceneCopies(int copies);
+
+	// set the profiler that times the phases of PrepareScene
+	void SetStartupProfiler(StartupProfiler* pStartupProfiler) { m_pStartupProfiler = pStartupProfiler; }
+	// set the loader that PrepareScene takes decoded assets from
+	void SetAssetLoader(AssetLoader* pAssetLoader) { m_pAssetLoader = pAssetLoader; }
+	// when enabled with an asset loader, PrepareScene returns
+	// without waiting for the assets, and the scene is drawn
+	// with coarse meshes and flat colors until they arrive
+	void SetProgressiveLoading(bool bProgressive) { m_bProgressiveLoading = bProgressive; }
+	// upload the assets that the loader has finished since the
+	// last frame, within the upload budget - true is returned
+	// once none are left
+	bool LoadArrivedAssets();
+	// set the time and bytes that the uploads of one frame can
+	// take, the first queued asset is always uploaded
+	void SetUploadBudget(double milliseconds, size_t bytes);
+	// get the upload counters of the last LoadArrivedAssets()
+	const UPLOAD_STATS& GetUploadStats() const { return(m_uploadStats); }
+	// get the bytes of the image data of the loaded textures
+	size_t GetTextureBytes() const { return(m_textureBytes); }
+	// set the segments around the curved surfaces of the full
+	// meshes, before the scene is prepared
+	void SetMeshDetail(int detail) { m_meshDetail = detail; }
+	// get the time that the streamed uploads of a frame can take
+	double GetUploadBudgetMilliseconds() const { return(m_uploadBudgetMilliseconds); }
+	// set the views that the objects are culled against before
+	// the scene is drawn, the first passed in views are used
+	void SetCullingViews(const CAMERA_BLOCK& cameraData, int viewCount);
+	// get the number of objects outside all of the views in
+	// the last drawn frame
+	int GetCulledObjects() const { return(m_culledObjects); }
+	// get the light sources that were set up for the scene
+	const LIGHT_BLOCK& GetLightData() const { return(m_lightData); }
+	// light the reflective materials with a built environment
+	void SetEnvironmentLighting(const EnvironmentLighting* pEnvironment);
+	// bake the light probes around the objects of the scene
+	// and light the drawn objects with them
+	void BakeLightProbes(LightProbeGrid* pLightProbes);
+	// get the number of objects that the light probes were
+	// blended for in the last drawn frame
+	int GetProbeUpdates() const { return(m_probeUpdates); }
+
+	// get the image files of the textures loaded by the scene
+	static std::vector<std::string> GetTextureFiles();
 
 };
\ No newline at end of file
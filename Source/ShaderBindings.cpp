@@ -0,0 +1,442 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderbindings.cpp
+// ============
+// reflect the linked shader program and bind uniform values by location
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderBindings.h"
+#include "Logger.h"
+
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// table of the application uniforms, in UNIFORM_ID order - the
+	// locations must match the layout qualifiers in the shaders
+	const ShaderBindings::UNIFORM_BINDING g_UniformBindings[ShaderBindings::UNIFORM_COUNT] =
+	{
+		{ "objectTexture", GL_SAMPLER_2D, 0 },
+		{ "environmentMap", GL_SAMPLER_CUBE, 1 }
+	};
+}
+
+/***********************************************************
+ *  ShaderBindings()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderBindings::ShaderBindings()
+{
+	m_programID = 0;
+	for (int i = 0; i < UNIFORM_COUNT; i++)
+	{
+		m_locations[i] = -1;
+	}
+}
+
+/***********************************************************
+ *  ~ShaderBindings()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderBindings::~ShaderBindings()
+{
+	m_uniforms.clear();
+	m_blocks.clear();
+	m_blockDescriptions.clear();
+}
+
+/***********************************************************
+ *  ReflectProgram()
+ *
+ *  This method is used for querying the active uniforms and
+ *  uniform blocks from the linked shader program.
+ ***********************************************************/
+void ShaderBindings::ReflectProgram(GLuint programID)
+{
+	GLint numUniforms = 0;
+	GLint numBlocks = 0;
+	char name[256];
+
+	m_uniforms.clear();
+	m_blocks.clear();
+
+	glGetProgramInterfaceiv(programID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &numUniforms);
+	for (int i = 0; i < numUniforms; i++)
+	{
+		const GLenum properties[5] = {
+			GL_TYPE, GL_LOCATION, GL_ARRAY_SIZE, GL_BLOCK_INDEX, GL_OFFSET };
+		GLint values[5] = { 0, -1, 0, -1, -1 };
+		GLsizei nameLength = 0;
+
+		glGetProgramResourceiv(programID, GL_UNIFORM, i, 5, properties, 5, NULL, values);
+		// names are optional when the program was loaded from SPIR-V
+		glGetProgramResourceName(programID, GL_UNIFORM, i, sizeof(name), &nameLength, name);
+
+		REFLECTED_UNIFORM uniform;
+		uniform.name.assign(name, nameLength);
+		uniform.type = (GLenum)values[0];
+		uniform.location = values[1];
+		uniform.arraySize = values[2];
+		uniform.blockIndex = values[3];
+		uniform.offset = values[4];
+		m_uniforms.push_back(uniform);
+	}
+
+	glGetProgramInterfaceiv(programID, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &numBlocks);
+	for (int i = 0; i < numBlocks; i++)
+	{
+		const GLenum properties[2] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+		GLint values[2] = { -1, 0 };
+		GLsizei nameLength = 0;
+
+		glGetProgramResourceiv(programID, GL_UNIFORM_BLOCK, i, 2, properties, 2, NULL, values);
+		glGetProgramResourceName(programID, GL_UNIFORM_BLOCK, i, sizeof(name), &nameLength, name);
+
+		REFLECTED_BLOCK block;
+		block.name.assign(name, nameLength);
+		block.binding = values[0];
+		block.dataSize = values[1];
+		m_blocks.push_back(block);
+	}
+}
+
+/***********************************************************
+ *  FindUniformByLocation()
+ *
+ *  This method is used for finding the reflected uniform
+ *  that is assigned to the passed in location.
+ ***********************************************************/
+const ShaderBindings::REFLECTED_UNIFORM* ShaderBindings::FindUniformByLocation(GLint location) const
+{
+	for (size_t i = 0; i < m_uniforms.size(); i++)
+	{
+		if (m_uniforms[i].location == location)
+		{
+			return(&m_uniforms[i]);
+		}
+	}
+
+	return(NULL);
+}
+
+/***********************************************************
+ *  FindUniformByName()
+ *
+ *  This method is used for finding the reflected uniform
+ *  with the passed in name.  Array uniforms are reported
+ *  with a "[0]" suffix which is ignored here.
+ ***********************************************************/
+const ShaderBindings::REFLECTED_UNIFORM* ShaderBindings::FindUniformByName(const char* name) const
+{
+	std::string arrayName = std::string(name) + "[0]";
+
+	for (size_t i = 0; i < m_uniforms.size(); i++)
+	{
+		if ((m_uniforms[i].name.compare(name) == 0) ||
+			(m_uniforms[i].name.compare(arrayName) == 0))
+		{
+			return(&m_uniforms[i]);
+		}
+	}
+
+	return(NULL);
+}
+
+/***********************************************************
+ *  ValidateBindings()
+ *
+ *  This method is used for checking every entry of the
+ *  binding table against the reflected shader program, and
+ *  resolving the location that is used for writing it.
+ ***********************************************************/
+bool ShaderBindings::ValidateBindings()
+{
+	bool bValid = true;
+
+	for (int i = 0; i < UNIFORM_COUNT; i++)
+	{
+		const UNIFORM_BINDING& binding = g_UniformBindings[i];
+		const REFLECTED_UNIFORM* pUniform = FindUniformByLocation(binding.location);
+
+		m_locations[i] = -1;
+
+		// a uniform that exists under the expected name at a
+		// different location means the table is out of date
+		const REFLECTED_UNIFORM* pNamed = FindUniformByName(binding.name);
+		if ((NULL != pNamed) && (pNamed != pUniform))
+		{
+			LOG_ERROR("uniform is at an unexpected location", "uniform", binding.name,
+				"location", pNamed->location, "expected", binding.location);
+			bValid = false;
+			continue;
+		}
+
+		// the uniform is not active in the shader program, so
+		// writes to it are skipped instead of reaching the driver
+		if (NULL == pUniform)
+		{
+			LOG_WARNING("uniform is not active in the shader program", "uniform", binding.name);
+			continue;
+		}
+
+		if ((false == pUniform->name.empty()) && (NULL == pNamed))
+		{
+			LOG_ERROR("location has an unexpected uniform", "location", binding.location,
+				"uniform", pUniform->name, "expected", binding.name);
+			bValid = false;
+			continue;
+		}
+
+		if (pUniform->type != binding.type)
+		{
+			char type[16];
+			char expected[16];
+			snprintf(type, sizeof(type), "0x%x", pUniform->type);
+			snprintf(expected, sizeof(expected), "0x%x", binding.type);
+			LOG_ERROR("uniform has an unexpected type", "uniform", binding.name, "type", type, "expected", expected);
+			bValid = false;
+			continue;
+		}
+
+		m_locations[i] = binding.location;
+	}
+
+	// report the active uniforms that the application never writes
+	for (size_t i = 0; i < m_uniforms.size(); i++)
+	{
+		bool bBound = (m_uniforms[i].location < 0);
+		for (int j = 0; (j < UNIFORM_COUNT) && (bBound == false); j++)
+		{
+			bBound = (g_UniformBindings[j].location == m_uniforms[i].location);
+		}
+		if (bBound == false)
+		{
+			LOG_WARNING("active uniform has no binding", "uniform", m_uniforms[i].name,
+				"location", m_uniforms[i].location);
+		}
+	}
+
+	return(bValid);
+}
+
+/***********************************************************
+ *  DescribeBlocks()
+ *
+ *  This method is used for describing the member offsets of
+ *  the uniform block structs, using the names that OpenGL
+ *  reports for the members of each block.
+ ***********************************************************/
+void ShaderBindings::DescribeBlocks()
+{
+	BLOCK_DESCRIPTION description;
+
+	m_blockDescriptions.clear();
+
+	description.name = "CameraBlock";
+	description.binding = CAMERA_BLOCK_BINDING;
+	description.dataSize = sizeof(CAMERA_BLOCK);
+	description.members.clear();
+	for (int i = 0; i < MAX_VIEWS; i++)
+	{
+		std::ostringstream prefix;
+		GLint viewOffset = (GLint)(offsetof(CAMERA_BLOCK, views) + (i * sizeof(CAMERA_VIEW)));
+
+		prefix << "CameraBlock.views[" << i << "].";
+		description.members.push_back({ prefix.str() + "view", viewOffset + (GLint)offsetof(CAMERA_VIEW, view) });
+		description.members.push_back({ prefix.str() + "projection", viewOffset + (GLint)offsetof(CAMERA_VIEW, projection) });
+		description.members.push_back({ prefix.str() + "viewPosition", viewOffset + (GLint)offsetof(CAMERA_VIEW, viewPosition) });
+	}
+	m_blockDescriptions.push_back(description);
+
+	description.name = "LightBlock";
+	description.binding = LIGHT_BLOCK_BINDING;
+	description.dataSize = sizeof(LIGHT_BLOCK);
+	description.members.clear();
+	for (int i = 0; i < TOTAL_LIGHTS; i++)
+	{
+		std::ostringstream prefix;
+		GLint lightOffset = (GLint)(offsetof(LIGHT_BLOCK, lightSources) + (i * sizeof(LIGHT_SOURCE)));
+
+		prefix << "LightBlock.lightSources[" << i << "].";
+		description.members.push_back({ prefix.str() + "position", lightOffset + (GLint)offsetof(LIGHT_SOURCE, position) });
+		description.members.push_back({ prefix.str() + "diffuseColor", lightOffset + (GLint)offsetof(LIGHT_SOURCE, diffuseColor) });
+		description.members.push_back({ prefix.str() + "specularColor", lightOffset + (GLint)offsetof(LIGHT_SOURCE, specularColor) });
+		description.members.push_back({ prefix.str() + "focalStrength", lightOffset + (GLint)offsetof(LIGHT_SOURCE, focalStrength) });
+		description.members.push_back({ prefix.str() + "specularIntensity", lightOffset + (GLint)offsetof(LIGHT_SOURCE, specularIntensity) });
+	}
+	description.members.push_back({ "LightBlock.globalAmbientColor", (GLint)offsetof(LIGHT_BLOCK, globalAmbientColor) });
+	description.members.push_back({ "LightBlock.irradiance[0]", (GLint)offsetof(LIGHT_BLOCK, irradiance) });
+	description.members.push_back({ "LightBlock.environmentLevels", (GLint)offsetof(LIGHT_BLOCK, environmentLevels) });
+	m_blockDescriptions.push_back(description);
+
+	description.name = "MaterialBlock";
+	description.binding = MATERIAL_BLOCK_BINDING;
+	description.dataSize = sizeof(MATERIAL_BLOCK);
+	description.members.clear();
+	description.members.push_back({ "MaterialBlock.diffuseColor", (GLint)offsetof(MATERIAL_BLOCK, diffuseColor) });
+	description.members.push_back({ "MaterialBlock.specularColor", (GLint)offsetof(MATERIAL_BLOCK, specularColor) });
+	description.members.push_back({ "MaterialBlock.shininess", (GLint)offsetof(MATERIAL_BLOCK, shininess) });
+	description.members.push_back({ "MaterialBlock.reflectivity", (GLint)offsetof(MATERIAL_BLOCK, reflectivity) });
+	description.members.push_back({ "MaterialBlock.roughness", (GLint)offsetof(MATERIAL_BLOCK, roughness) });
+	m_blockDescriptions.push_back(description);
+
+	description.name = "InstanceBlock";
+	description.binding = INSTANCE_BLOCK_BINDING;
+	description.dataSize = sizeof(INSTANCE_BLOCK);
+	description.members.clear();
+	description.members.push_back({ "InstanceBlock.model", (GLint)offsetof(INSTANCE_BLOCK, model) });
+	description.members.push_back({ "InstanceBlock.objectColor", (GLint)offsetof(INSTANCE_BLOCK, objectColor) });
+	description.members.push_back({ "InstanceBlock.UVscale", (GLint)offsetof(INSTANCE_BLOCK, UVscale) });
+	description.members.push_back({ "InstanceBlock.bUseTexture", (GLint)offsetof(INSTANCE_BLOCK, bUseTexture) });
+	description.members.push_back({ "InstanceBlock.bUseLighting", (GLint)offsetof(INSTANCE_BLOCK, bUseLighting) });
+	description.members.push_back({ "InstanceBlock.viewMask", (GLint)offsetof(INSTANCE_BLOCK, viewMask) });
+	description.members.push_back({ "InstanceBlock.lightProbe[0]", (GLint)offsetof(INSTANCE_BLOCK, lightProbe) });
+	m_blockDescriptions.push_back(description);
+}
+
+/***********************************************************
+ *  ValidateBlocks()
+ *
+ *  This method is used for checking the size and member
+ *  offsets of the uniform block structs against the block
+ *  layouts reported by the shader program.  Blocks are
+ *  matched by binding point, and members are matched by
+ *  name, or only by offset when the program was loaded from
+ *  SPIR-V without names.
+ ***********************************************************/
+bool ShaderBindings::ValidateBlocks()
+{
+	bool bValid = true;
+
+	for (size_t i = 0; i < m_blockDescriptions.size(); i++)
+	{
+		const BLOCK_DESCRIPTION& description = m_blockDescriptions[i];
+		int blockIndex = -1;
+
+		for (size_t j = 0; j < m_blocks.size(); j++)
+		{
+			if (m_blocks[j].binding == description.binding)
+			{
+				blockIndex = (int)j;
+			}
+		}
+
+		if (blockIndex < 0)
+		{
+			LOG_WARNING("uniform block is not active in the shader program", "block", description.name);
+			continue;
+		}
+
+		const REFLECTED_BLOCK& block = m_blocks[blockIndex];
+		if ((false == block.name.empty()) && (block.name.compare(description.name) != 0))
+		{
+			LOG_ERROR("binding has an unexpected uniform block", "binding", description.binding,
+				"block", block.name, "expected", description.name);
+			bValid = false;
+			continue;
+		}
+
+		if (block.dataSize != description.dataSize)
+		{
+			LOG_ERROR("uniform block size does not match the C++ struct", "block", description.name,
+				"bytes", block.dataSize, "structBytes", description.dataSize);
+			bValid = false;
+		}
+
+		for (size_t j = 0; j < m_uniforms.size(); j++)
+		{
+			const REFLECTED_UNIFORM& uniform = m_uniforms[j];
+			const BLOCK_MEMBER* pMember = NULL;
+
+			if (uniform.blockIndex != blockIndex)
+			{
+				continue;
+			}
+
+			for (size_t k = 0; (k < description.members.size()) && (NULL == pMember); k++)
+			{
+				if (uniform.name.empty())
+				{
+					if (description.members[k].offset == uniform.offset)
+					{
+						pMember = &description.members[k];
+					}
+				}
+				else if (description.members[k].name.compare(uniform.name) == 0)
+				{
+					pMember = &description.members[k];
+				}
+			}
+
+			if (NULL == pMember)
+			{
+				LOG_ERROR("uniform block member is not in the C++ struct", "member", uniform.name,
+					"offset", uniform.offset, "block", description.name);
+				bValid = false;
+			}
+			else if (pMember->offset != uniform.offset)
+			{
+				LOG_ERROR("uniform block member offset does not match the C++ struct", "member", uniform.name,
+					"offset", uniform.offset, "structOffset", pMember->offset);
+				bValid = false;
+			}
+		}
+	}
+
+	return(bValid);
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for reflecting the passed in shader
+ *  program and validating the uniform binding table.  False
+ *  is returned if the table does not match the shaders.
+ ***********************************************************/
+bool ShaderBindings::Initialize(GLuint programID)
+{
+	bool bValid = true;
+
+	m_programID = programID;
+
+	ReflectProgram(programID);
+	DescribeBlocks();
+
+	LOG_INFO("shader program reflected", "uniforms", m_uniforms.size(), "blocks", m_blocks.size());
+
+	// check every table so that all of the mismatches are reported
+	bValid = ValidateBindings();
+	bValid = ValidateBlocks() && bValid;
+
+	return(bValid);
+}
+
+/***********************************************************
+ *  SetSampler2D()
+ *
+ *  This method is used for setting the texture slot used by
+ *  a sampler uniform.
+ ***********************************************************/
+void ShaderBindings::SetSampler2D(UNIFORM_ID uniform, int textureSlot)
+{
+	if (m_locations[uniform] >= 0)
+	{
+		glUniform1i(m_locations[uniform], textureSlot);
+	}
+}
+
+/***********************************************************
+ *  SetSamplerCube()
+ *
+ *  This method is used for setting the texture slot used by
+ *  a cube map sampler uniform.
+ ***********************************************************/
+void ShaderBindings::SetSamplerCube(UNIFORM_ID uniform, int textureSlot)
+{
+	if (m_locations[uniform] >= 0)
+	{
+		glUniform1i(m_locations[uniform], textureSlot);
+	}
+}
@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// shaderbindings.h
+// ============
+// reflect the linked shader program and bind uniform values by location
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include "UniformBlocks.h"
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ShaderBindings
+ *
+ *  This class contains the table of every uniform and
+ *  uniform block that the application writes into the
+ *  shaders.  The tables are validated against the reflected
+ *  shader program once after linking, and the samplers are
+ *  then set with the resolved locations instead of uniform
+ *  name strings, while the block data is streamed into the
+ *  uniform buffer ranges of a GLUniformRing.
+ ***********************************************************/
+class ShaderBindings
+{
+public:
+	// constructor
+	ShaderBindings();
+	// destructor
+	~ShaderBindings();
+
+	// every uniform written by the application outside of the
+	// uniform blocks
+	enum UNIFORM_ID
+	{
+		UNIFORM_OBJECT_TEXTURE = 0,
+		UNIFORM_ENVIRONMENT_MAP,
+		UNIFORM_COUNT
+	};
+
+	// entry in the table of application uniforms
+	struct UNIFORM_BINDING
+	{
+		const char* name;
+		GLenum type;
+		GLint location;
+	};
+
+	// active uniform reported by the linked shader program
+	struct REFLECTED_UNIFORM
+	{
+		std::string name;
+		GLenum type;
+		GLint location;
+		GLint arraySize;
+		GLint blockIndex;
+		GLint offset;
+	};
+
+	// active uniform block reported by the linked shader program
+	struct REFLECTED_BLOCK
+	{
+		std::string name;
+		GLint binding;
+		GLint dataSize;
+	};
+
+	// member of a uniform block struct and its std140 offset
+	struct BLOCK_MEMBER
+	{
+		std::string name;
+		GLint offset;
+	};
+
+	// entry in the table of application uniform blocks
+	struct BLOCK_DESCRIPTION
+	{
+		std::string name;
+		GLint binding;
+		GLint dataSize;
+		std::vector<BLOCK_MEMBER> members;
+	};
+
+	// reflect the shader program and validate the binding table
+	bool Initialize(GLuint programID);
+
+	// get the reflected uniforms and uniform blocks
+	const std::vector<REFLECTED_UNIFORM>& GetUniforms() const { return m_uniforms; }
+	const std::vector<REFLECTED_BLOCK>& GetBlocks() const { return m_blocks; }
+
+	// set the texture slots of the sampler uniforms
+	void SetSampler2D(UNIFORM_ID uniform, int textureSlot);
+	void SetSamplerCube(UNIFORM_ID uniform, int textureSlot);
+
+private:
+	// linked shader program that was reflected
+	GLuint m_programID;
+	// resolved uniform locations, -1 when not active
+	GLint m_locations[UNIFORM_COUNT];
+	// C++ layout of each of the uniform blocks
+	std::vector<BLOCK_DESCRIPTION> m_blockDescriptions;
+	// reflected shader program interface
+	std::vector<REFLECTED_UNIFORM> m_uniforms;
+	std::vector<REFLECTED_BLOCK> m_blocks;
+
+	// query the active uniforms and uniform blocks
+	void ReflectProgram(GLuint programID);
+	// find a reflected uniform by location or by name
+	const REFLECTED_UNIFORM* FindUniformByLocation(GLint location) const;
+	const REFLECTED_UNIFORM* FindUniformByName(const char* name) const;
+	// check the binding table against the reflected uniforms
+	bool ValidateBindings();
+	// describe the member offsets of the uniform block structs
+	void DescribeBlocks();
+	// check the block structs against the reflected block layouts
+	bool ValidateBlocks();
+};
@@ -0,0 +1,180 @@
+///////////////////////////////////////////////////////////////////////////////
+// sphericalharmonics.cpp
+// ============
+// project lighting onto the first three bands of the spherical harmonics
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SphericalHarmonics.h"
+
+// declaration of global variables
+namespace
+{
+	// constant factors of the basis functions of each band
+	const float BAND0_FACTOR = 0.282095f;
+	const float BAND1_FACTOR = 0.488603f;
+	const float BAND2_FACTOR = 1.092548f;
+	const float BAND2_ZONAL_FACTOR = 0.315392f;
+	const float BAND2_SECTORAL_FACTOR = 0.546274f;
+
+	// scale of each band after the convolution with a cosine
+	// lobe, divided by pi
+	const float BAND0_DIFFUSE = 1.0f;
+	const float BAND1_DIFFUSE = 2.0f / 3.0f;
+	const float BAND2_DIFFUSE = 0.25f;
+}
+
+/***********************************************************
+ *  EvaluateBasis()
+ *
+ *  This method is used for getting the nine basis functions
+ *  in a unit direction.
+ ***********************************************************/
+void SphericalHarmonics::EvaluateBasis(const glm::vec3& direction, float basis[SH_COEFFICIENTS])
+{
+	float x = direction.x;
+	float y = direction.y;
+	float z = direction.z;
+
+	basis[0] = BAND0_FACTOR;
+	basis[1] = BAND1_FACTOR * y;
+	basis[2] = BAND1_FACTOR * z;
+	basis[3] = BAND1_FACTOR * x;
+	basis[4] = BAND2_FACTOR * x * y;
+	basis[5] = BAND2_FACTOR * y * z;
+	basis[6] = BAND2_ZONAL_FACTOR * ((3.0f * z * z) - 1.0f);
+	basis[7] = BAND2_FACTOR * x * z;
+	basis[8] = BAND2_SECTORAL_FACTOR * ((x * x) - (y * y));
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding the light arriving from
+ *  a unit direction over the passed in solid angle.
+ ***********************************************************/
+void SphericalHarmonics::AddLight(SH_COLOR& sh, const glm::vec3& direction, const glm::vec3& color, float solidAngle)
+{
+	float basis[SH_COEFFICIENTS];
+	EvaluateBasis(direction, basis);
+
+	for (int i = 0; i < SH_COEFFICIENTS; i++)
+	{
+		sh.coefficients[i] += color * (basis[i] * solidAngle);
+	}
+}
+
+/***********************************************************
+ *  AddScaled()
+ *
+ *  This method is used for adding the coefficients of
+ *  another projection, scaled, such as when blending the
+ *  projections of nearby points.
+ ***********************************************************/
+void SphericalHarmonics::AddScaled(SH_COLOR& sh, const SH_COLOR& other, float scale)
+{
+	for (int i = 0; i < SH_COEFFICIENTS; i++)
+	{
+		sh.coefficients[i] += other.coefficients[i] * scale;
+	}
+}
+
+/***********************************************************
+ *  ConvolveDiffuse()
+ *
+ *  This method is used for convolving the projected light
+ *  with a cosine lobe.  The convolution only scales each
+ *  band, and the scales are divided by pi so that the
+ *  result is the light reflected by a white surface.
+ ***********************************************************/
+void SphericalHarmonics::ConvolveDiffuse(SH_COLOR& sh)
+{
+	sh.coefficients[0] *= BAND0_DIFFUSE;
+	for (int i = 1; i < 4; i++)
+	{
+		sh.coefficients[i] *= BAND1_DIFFUSE;
+	}
+	for (int i = 4; i < SH_COEFFICIENTS; i++)
+	{
+		sh.coefficients[i] *= BAND2_DIFFUSE;
+	}
+}
+
+/***********************************************************
+ *  Evaluate()
+ *
+ *  This method is used for getting the value of the
+ *  coefficients in a unit direction.
+ ***********************************************************/
+glm::vec3 SphericalHarmonics::Evaluate(const SH_COLOR& sh, const glm::vec3& direction)
+{
+	float basis[SH_COEFFICIENTS];
+	EvaluateBasis(direction, basis);
+
+	glm::vec3 color = glm::vec3(0.0f);
+	for (int i = 0; i < SH_COEFFICIENTS; i++)
+	{
+		color += sh.coefficients[i] * basis[i];
+	}
+
+	return(color);
+}
+
+/***********************************************************
+ *  PackForShader()
+ *
+ *  This method is used for folding the constant factors of
+ *  the basis functions into the coefficients, so that the
+ *  shaders evaluate them with a few multiply-adds.
+ ***********************************************************/
+void SphericalHarmonics::PackForShader(const SH_COLOR& sh, glm::vec4 packed[SH_COEFFICIENTS])
+{
+	const float factors[SH_COEFFICIENTS] =
+	{
+		BAND0_FACTOR,
+		BAND1_FACTOR, BAND1_FACTOR, BAND1_FACTOR,
+		BAND2_FACTOR, BAND2_FACTOR, BAND2_ZONAL_FACTOR, BAND2_FACTOR, BAND2_SECTORAL_FACTOR
+	};
+
+	for (int i = 0; i < SH_COEFFICIENTS; i++)
+	{
+		packed[i] = glm::vec4(sh.coefficients[i] * factors[i], 0.0f);
+	}
+}
+
+/***********************************************************
+ *  PackForInstance()
+ *
+ *  This method is used for folding the constant factors of
+ *  the basis functions into seven vectors, so that the
+ *  shaders evaluate the coefficients of a drawn object with
+ *  two dot products for each color channel and one more
+ *  multiply-add.  The constant part of the zonal function
+ *  of the quadratic band is moved into the constant band.
+ ***********************************************************/
+void SphericalHarmonics::PackForInstance(const SH_COLOR& sh, glm::vec4 packed[SH_INSTANCE_VECTORS])
+{
+	glm::vec3 constant = sh.coefficients[0] * BAND0_FACTOR;
+	glm::vec3 linearX = sh.coefficients[3] * BAND1_FACTOR;
+	glm::vec3 linearY = sh.coefficients[1] * BAND1_FACTOR;
+	glm::vec3 linearZ = sh.coefficients[2] * BAND1_FACTOR;
+	glm::vec3 quadraticXY = sh.coefficients[4] * BAND2_FACTOR;
+	glm::vec3 quadraticYZ = sh.coefficients[5] * BAND2_FACTOR;
+	glm::vec3 quadraticZZ = sh.coefficients[6] * BAND2_ZONAL_FACTOR;
+	glm::vec3 quadraticXZ = sh.coefficients[7] * BAND2_FACTOR;
+	glm::vec3 sectoral = sh.coefficients[8] * BAND2_SECTORAL_FACTOR;
+
+	for (int channel = 0; channel < 3; channel++)
+	{
+		packed[channel] = glm::vec4(
+			linearX[channel],
+			linearY[channel],
+			linearZ[channel],
+			constant[channel] - quadraticZZ[channel]);
+		packed[3 + channel] = glm::vec4(
+			quadraticXY[channel],
+			quadraticYZ[channel],
+			3.0f * quadraticZZ[channel],
+			quadraticXZ[channel]);
+	}
+	packed[6] = glm::vec4(sectoral, 0.0f);
+}
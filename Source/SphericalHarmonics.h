@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+// sphericalharmonics.h
+// ============
+// project lighting onto the first three bands of the spherical harmonics
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "UniformBlocks.h"
+
+/***********************************************************
+ *  SphericalHarmonics
+ *
+ *  This class contains the code for storing the light
+ *  arriving from every direction as the RGB coefficients
+ *  of the first three bands of the real spherical
+ *  harmonics.  Light is added one direction at a time,
+ *  weighted by its solid angle, and the projected light can
+ *  be convolved with a cosine lobe to get the diffuse light
+ *  of a surface facing any direction.  Nine coefficients
+ *  are enough for diffuse light, since the cosine lobe
+ *  filters out the higher bands.
+ ***********************************************************/
+class SphericalHarmonics
+{
+public:
+	// RGB coefficients of the nine basis functions, in the
+	// order of the bands
+	struct SH_COLOR
+	{
+		glm::vec3 coefficients[SH_COEFFICIENTS];
+	};
+
+	// get the nine basis functions in a unit direction
+	static void EvaluateBasis(const glm::vec3& direction, float basis[SH_COEFFICIENTS]);
+	// add the light arriving from a unit direction over the
+	// passed in solid angle
+	static void AddLight(SH_COLOR& sh, const glm::vec3& direction, const glm::vec3& color, float solidAngle);
+	// add the coefficients of another projection, scaled
+	static void AddScaled(SH_COLOR& sh, const SH_COLOR& other, float scale);
+	// convolve the projected light with a cosine lobe, divided
+	// by pi, so that evaluating it gives the light reflected
+	// by a white diffuse surface facing the direction
+	static void ConvolveDiffuse(SH_COLOR& sh);
+	// get the value of the coefficients in a unit direction
+	static glm::vec3 Evaluate(const SH_COLOR& sh, const glm::vec3& direction);
+	// fold the constant factors of the basis functions into
+	// the coefficients, which the shaders evaluate as
+	// c0 + c1 y + c2 z + c3 x + c4 xy + c5 yz + c6 (3zz - 1)
+	// + c7 xz + c8 (xx - yy)
+	static void PackForShader(const SH_COLOR& sh, glm::vec4 packed[SH_COEFFICIENTS]);
+	// fold the constant factors into seven vectors for each
+	// drawn object, which the shaders evaluate for each color
+	// channel as dot(A, (x, y, z, 1)) + dot(B, (xy, yz, zz, xz))
+	// with the last vector times (xx - yy) added to the color
+	static void PackForInstance(const SH_COLOR& sh, glm::vec4 packed[SH_INSTANCE_VECTORS]);
+};
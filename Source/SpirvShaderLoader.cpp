@@ -0,0 +1,232 @@
+///////////////////////////////////////////////////////////////////////////////
+// spirvshaderloader.cpp
+// ============
+// load offline compiled SPIR-V shader binaries and specialize them
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SpirvShaderLoader.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <fstream>
+
+// declaration of global variables
+namespace
+{
+	// shader entry point name used when specializing
+	const char* g_EntryPointName = "main";
+
+	// constant_id values declared in the fragment shader
+	enum SPECIALIZATION_CONSTANT_ID
+	{
+		CONSTANT_ACTIVE_LIGHTS = 0,
+		CONSTANT_ENABLE_LIGHTING = 1,
+		CONSTANT_ENABLE_SPECULAR = 2,
+		CONSTANT_COUNT = 3
+	};
+}
+
+/***********************************************************
+ *  SpirvShaderLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SpirvShaderLoader::SpirvShaderLoader()
+{
+}
+
+/***********************************************************
+ *  ~SpirvShaderLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SpirvShaderLoader::~SpirvShaderLoader()
+{
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the active
+ *  OpenGL context can consume SPIR-V shader binaries.
+ ***********************************************************/
+bool SpirvShaderLoader::IsSupported()
+{
+	// glSpecializeShader is core in OpenGL 4.6
+	if (!GLEW_VERSION_4_6)
+	{
+		return(false);
+	}
+
+	GLint numFormats = 0;
+	glGetIntegerv(GL_NUM_SHADER_BINARY_FORMATS, &numFormats);
+	if (numFormats <= 0)
+	{
+		return(false);
+	}
+
+	std::vector<GLint> formats(numFormats);
+	glGetIntegerv(GL_SHADER_BINARY_FORMATS, formats.data());
+	for (int i = 0; i < numFormats; i++)
+	{
+		if (formats[i] == GL_SHADER_BINARY_FORMAT_SPIR_V)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  ReadBinaryFile()
+ *
+ *  This method is used for reading the contents of the
+ *  passed in binary file into memory.
+ ***********************************************************/
+bool SpirvShaderLoader::ReadBinaryFile(const char* filename, std::vector<char>& data)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		return(false);
+	}
+
+	std::streamsize size = file.tellg();
+	// SPIR-V modules are a stream of 32-bit words
+	if ((size <= 0) || ((size % 4) != 0))
+	{
+		LOG_ERROR("invalid SPIR-V binary", "file", filename);
+		return(false);
+	}
+
+	data.resize((size_t)size);
+	file.seekg(0, std::ios::beg);
+	file.read(data.data(), size);
+
+	return(file.good());
+}
+
+/***********************************************************
+ *  CreateSpecializedShader()
+ *
+ *  This method is used for creating a shader object from
+ *  the passed in SPIR-V binary and specializing it with the
+ *  passed in constant values.
+ ***********************************************************/
+GLuint SpirvShaderLoader::CreateSpecializedShader(
+	GLenum shaderType,
+	const char* filename,
+	const SPECIALIZATION_CONSTANTS& constants,
+	GLuint constantCount)
+{
+	std::vector<char> binary;
+
+	if (ReadBinaryFile(filename, binary) == false)
+	{
+		return(0);
+	}
+
+	GLuint shaderID = glCreateShader(shaderType);
+	glShaderBinary(
+		1,
+		&shaderID,
+		GL_SHADER_BINARY_FORMAT_SPIR_V,
+		binary.data(),
+		(GLsizei)binary.size());
+
+	// the driver fails the specialization for a constant that
+	// the stage does not declare, so only the first ones that
+	// the stage declares are passed
+	GLuint constantIndex[CONSTANT_COUNT];
+	GLuint constantValue[CONSTANT_COUNT];
+	constantIndex[0] = CONSTANT_ACTIVE_LIGHTS;
+	constantValue[0] = (GLuint)constants.activeLights;
+	constantIndex[1] = CONSTANT_ENABLE_LIGHTING;
+	constantValue[1] = constants.bEnableLighting ? 1 : 0;
+	constantIndex[2] = CONSTANT_ENABLE_SPECULAR;
+	constantValue[2] = constants.bEnableSpecular ? 1 : 0;
+
+	glSpecializeShader(
+		shaderID,
+		g_EntryPointName,
+		std::min(constantCount, (GLuint)CONSTANT_COUNT),
+		constantIndex,
+		constantValue);
+
+	GLint bSuccess = GL_FALSE;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &bSuccess);
+	if (bSuccess == GL_FALSE)
+	{
+		char infoLog[512];
+		glGetShaderInfoLog(shaderID, sizeof(infoLog), NULL, infoLog);
+		LOG_ERROR("failed to specialize the SPIR-V shader", "file", filename, "log", (const char*)infoLog);
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  LoadShaders()
+ *
+ *  This method is used for loading the SPIR-V vertex and
+ *  fragment shader binaries and linking them into a shader
+ *  program.  Zero is returned if the program could not be
+ *  created, so that the GLSL source can be used instead.
+ ***********************************************************/
+GLuint SpirvShaderLoader::LoadShaders(
+	const char* vertexShaderPath,
+	const char* fragmentShaderPath,
+	const SPECIALIZATION_CONSTANTS& constants)
+{
+	if (IsSupported() == false)
+	{
+		LOG_INFO("SPIR-V shader binaries are not supported by this OpenGL context, compiling the GLSL shaders");
+		return(0);
+	}
+
+	// the vertex shader declares no specialization constants,
+	// the fragment shader declares all of them
+	GLuint vertexShaderID = CreateSpecializedShader(
+		GL_VERTEX_SHADER, vertexShaderPath, constants, 0);
+	if (vertexShaderID == 0)
+	{
+		return(0);
+	}
+
+	GLuint fragmentShaderID = CreateSpecializedShader(
+		GL_FRAGMENT_SHADER, fragmentShaderPath, constants, CONSTANT_COUNT);
+	if (fragmentShaderID == 0)
+	{
+		glDeleteShader(vertexShaderID);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, vertexShaderID);
+	glAttachShader(programID, fragmentShaderID);
+	glLinkProgram(programID);
+
+	// the shader objects are no longer needed once linked
+	glDetachShader(programID, vertexShaderID);
+	glDetachShader(programID, fragmentShaderID);
+	glDeleteShader(vertexShaderID);
+	glDeleteShader(fragmentShaderID);
+
+	GLint bSuccess = GL_FALSE;
+	glGetProgramiv(programID, GL_LINK_STATUS, &bSuccess);
+	if (bSuccess == GL_FALSE)
+	{
+		char infoLog[512];
+		glGetProgramInfoLog(programID, sizeof(infoLog), NULL, infoLog);
+		LOG_ERROR("failed to link the SPIR-V shader program", "log", (const char*)infoLog);
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	LOG_INFO("loaded SPIR-V shaders", "vertex", vertexShaderPath, "fragment", fragmentShaderPath);
+
+	return(programID);
+}
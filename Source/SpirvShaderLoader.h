@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// spirvshaderloader.h
+// ============
+// load offline compiled SPIR-V shader binaries and specialize them
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>        // GLEW library
+
+#include <vector>
+
+/***********************************************************
+ *  SpirvShaderLoader
+ *
+ *  This class contains the code for loading the SPIR-V
+ *  binaries that are compiled from the GLSL shader files
+ *  during the build, and linking them into a shader program.
+ ***********************************************************/
+class SpirvShaderLoader
+{
+public:
+	// constructor
+	SpirvShaderLoader();
+	// destructor
+	~SpirvShaderLoader();
+
+	// values for the specialization constants declared
+	// in the fragment shader
+	struct SPECIALIZATION_CONSTANTS
+	{
+		int activeLights;
+		bool bEnableLighting;
+		bool bEnableSpecular;
+	};
+
+	// check whether the active OpenGL context accepts SPIR-V
+	bool IsSupported();
+
+	// load, specialize and link the SPIR-V shader binaries
+	GLuint LoadShaders(
+		const char* vertexShaderPath,
+		const char* fragmentShaderPath,
+		const SPECIALIZATION_CONSTANTS& constants);
+
+private:
+	// read the contents of a binary file into memory
+	bool ReadBinaryFile(const char* filename, std::vector<char>& data);
+
+	// create a shader object from a SPIR-V binary, setting
+	// the passed in number of constants, which has to match
+	// the constants that the stage declares
+	GLuint CreateSpecializedShader(
+		GLenum shaderType,
+		const char* filename,
+		const SPECIALIZATION_CONSTANTS& constants,
+		GLuint constantCount);
+};
@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupprofiler.cpp
+// ============
+// time the startup phases and the time to the first presented frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StartupProfiler.h"
+#include "JsonUtils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// version of the JSON report layout
+	const int STARTUP_REPORT_VERSION = 2;
+}
+
+/***********************************************************
+ *  StartupProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StartupProfiler::StartupProfiler()
+{
+	m_start = Clock::now();
+	m_firstFrameMilliseconds = 0.0;
+	m_bFirstFrame = false;
+	m_sceneCompleteMilliseconds = 0.0;
+	m_bSceneComplete = false;
+	m_phases.reserve(64);
+}
+
+/***********************************************************
+ *  ~StartupProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StartupProfiler::~StartupProfiler()
+{
+}
+
+/***********************************************************
+ *  GetElapsedMilliseconds()
+ *
+ *  This method is used for getting the time since the
+ *  profiler was created.
+ ***********************************************************/
+double StartupProfiler::GetElapsedMilliseconds() const
+{
+	return(std::chrono::duration<double, std::milli>(Clock::now() - m_start).count());
+}
+
+/***********************************************************
+ *  BeginPhase()
+ *
+ *  This method is used for starting the timing of a phase.
+ ***********************************************************/
+void StartupProfiler::BeginPhase(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	STARTUP_PHASE phase;
+	phase.name = name;
+	phase.depth = (int)m_openPhases.size();
+	phase.bWorker = false;
+	phase.durationMilliseconds = 0.0;
+	phase.startMilliseconds = GetElapsedMilliseconds();
+
+	m_openPhases.push_back(m_phases.size());
+	m_phases.push_back(phase);
+}
+
+/***********************************************************
+ *  EndPhase()
+ *
+ *  This method is used for ending the timing of the most
+ *  recently started phase.
+ ***********************************************************/
+void StartupProfiler::EndPhase()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_openPhases.empty())
+	{
+		return;
+	}
+
+	STARTUP_PHASE& phase = m_phases[m_openPhases.back()];
+	phase.durationMilliseconds = GetElapsedMilliseconds() - phase.startMilliseconds;
+	m_openPhases.pop_back();
+}
+
+/***********************************************************
+ *  AddWorkerPhase()
+ *
+ *  This method is used for recording a phase that was timed
+ *  on a worker thread.
+ ***********************************************************/
+void StartupProfiler::AddWorkerPhase(const std::string& name, double startMilliseconds, double durationMilliseconds)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	STARTUP_PHASE phase;
+	phase.name = name;
+	phase.depth = 0;
+	phase.bWorker = true;
+	phase.startMilliseconds = startMilliseconds;
+	phase.durationMilliseconds = durationMilliseconds;
+	m_phases.push_back(phase);
+}
+
+/***********************************************************
+ *  GetSortedPhases()
+ *
+ *  This method is used for getting the phases of the main
+ *  thread in the order that they started, followed by the
+ *  worker phases in the order that they started, so that
+ *  the nested phases stay under the phase they are in.
+ ***********************************************************/
+std::vector<StartupProfiler::STARTUP_PHASE> StartupProfiler::GetSortedPhases() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	std::vector<STARTUP_PHASE> phases = m_phases;
+
+	std::vector<STARTUP_PHASE>::iterator workers = std::stable_partition(phases.begin(), phases.end(),
+		[](const STARTUP_PHASE& phase) { return(phase.bWorker == false); });
+	std::stable_sort(workers, phases.end(),
+		[](const STARTUP_PHASE& a, const STARTUP_PHASE& b) { return(a.startMilliseconds < b.startMilliseconds); });
+
+	return(phases);
+}
+
+/***********************************************************
+ *  MarkFirstFrame()
+ *
+ *  This method is used for recording the time to the first
+ *  presented frame.  Only the first call is recorded.
+ ***********************************************************/
+void StartupProfiler::MarkFirstFrame()
+{
+	if (m_bFirstFrame)
+	{
+		return;
+	}
+
+	m_firstFrameMilliseconds = GetElapsedMilliseconds();
+	m_bFirstFrame = true;
+}
+
+/***********************************************************
+ *  MarkSceneComplete()
+ *
+ *  This method is used for recording the time at which the
+ *  last asset of the scene was loaded.  When the first
+ *  frame is drawn with placeholders, this is later than the
+ *  first frame.  Only the first call is recorded.
+ ***********************************************************/
+void StartupProfiler::MarkSceneComplete()
+{
+	if (m_bSceneComplete)
+	{
+		return;
+	}
+
+	m_sceneCompleteMilliseconds = GetElapsedMilliseconds();
+	m_bSceneComplete = true;
+}
+
+/***********************************************************
+ *  Report()
+ *
+ *  This method is used for printing the duration of each
+ *  phase, indented under the phase it is nested in, along
+ *  with the time to the first frame.
+ ***********************************************************/
+void StartupProfiler::Report(const char* deviceName) const
+{
+	char line[160];
+	std::vector<STARTUP_PHASE> phases = GetSortedPhases();
+
+	std::cout << "STARTUP: device " << deviceName << std::endl;
+	snprintf(line, sizeof(line), "STARTUP: %-44s %10s %10s", "phase", "start ms", "ms");
+	std::cout << line << std::endl;
+
+	for (size_t i = 0; i < phases.size(); i++)
+	{
+		const STARTUP_PHASE& phase = phases[i];
+		std::string name = std::string(phase.depth * 2, ' ') + phase.name;
+		if (phase.bWorker)
+		{
+			name = "[worker] " + phase.name;
+		}
+
+		snprintf(line, sizeof(line), "STARTUP: %-44s %10.2f %10.2f",
+			name.c_str(), phase.startMilliseconds, phase.durationMilliseconds);
+		std::cout << line << std::endl;
+	}
+
+	if (m_bFirstFrame)
+	{
+		snprintf(line, sizeof(line), "STARTUP: time to first frame %.2f ms", m_firstFrameMilliseconds);
+		std::cout << line << std::endl;
+	}
+	if (m_bSceneComplete)
+	{
+		snprintf(line, sizeof(line), "STARTUP: time to complete scene %.2f ms", m_sceneCompleteMilliseconds);
+		std::cout << line << std::endl;
+	}
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the phases and the time
+ *  to the first frame to a JSON file.
+ ***********************************************************/
+bool StartupProfiler::WriteReport(const char* filename, const char* deviceName) const
+{
+	std::vector<STARTUP_PHASE> phases = GetSortedPhases();
+	std::ofstream file(filename);
+	if (!file)
+	{
+		std::cout << "ERROR: could not write the startup report " << filename << std::endl;
+		return(false);
+	}
+
+	file << "{\n";
+	file << "  \"version\": " << STARTUP_REPORT_VERSION << ",\n";
+	file << "  \"device\": ";
+	JsonUtils::WriteString(file, deviceName);
+	file << ",\n";
+	file << "  \"timeToFirstFrameMs\": ";
+	if (m_bFirstFrame)
+	{
+		file << m_firstFrameMilliseconds;
+	}
+	else
+	{
+		file << "null";
+	}
+	file << ",\n";
+	file << "  \"timeToCompleteSceneMs\": ";
+	if (m_bSceneComplete)
+	{
+		file << m_sceneCompleteMilliseconds;
+	}
+	else
+	{
+		file << "null";
+	}
+	file << ",\n";
+	file << "  \"phases\": [";
+	for (size_t i = 0; i < phases.size(); i++)
+	{
+		const STARTUP_PHASE& phase = phases[i];
+
+		file << ((i == 0) ? "\n" : ",\n");
+		file << "    { \"name\": ";
+		JsonUtils::WriteString(file, phase.name);
+		file << ", \"depth\": " << phase.depth;
+		file << ", \"worker\": " << (phase.bWorker ? "true" : "false");
+		file << ", \"startMs\": " << phase.startMilliseconds;
+		file << ", \"durationMs\": " << phase.durationMilliseconds << " }";
+	}
+	file << "\n  ]\n";
+	file << "}\n";
+
+	if (!file)
+	{
+		std::cout << "ERROR: could not write the startup report " << filename << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: startup report written to " << filename << std::endl;
+	return(true);
+}
@@ -0,0 +1,92 @@
+///////////////////////////////////////////////////////////////////////////////
+// startupprofiler.h
+// ============
+// time the startup phases and the time to the first presented frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  StartupProfiler
+ *
+ *  This class contains the code for timing the phases of
+ *  the application startup, from the start of main() to
+ *  the first presented frame, and to the frame from which
+ *  the scene is drawn with all of its assets.  Phases can be nested, so a
+ *  phase such as preparing the scene is reported along
+ *  with the texture and mesh loads that it is made of.
+ *  Work done on loading threads is recorded as separate
+ *  worker phases, so the report shows how it overlaps the
+ *  phases of the main thread.  The report is printed as a
+ *  table, and can be written as JSON so that startup times
+ *  can be compared between runs.
+ ***********************************************************/
+class StartupProfiler
+{
+public:
+	// constructor - the startup time is measured from here
+	StartupProfiler();
+	// destructor
+	~StartupProfiler();
+
+	// start a phase, nested in the phase that is running
+	void BeginPhase(const std::string& name);
+	// end the most recently started phase
+	void EndPhase();
+	// record a phase that ran on a worker thread, which can
+	// be called from any thread
+	void AddWorkerPhase(const std::string& name, double startMilliseconds, double durationMilliseconds);
+
+	// get the milliseconds since the start
+	double GetElapsedMilliseconds() const;
+
+	// mark that the first frame has been presented
+	void MarkFirstFrame();
+	bool HasFirstFrame() const { return(m_bFirstFrame); }
+	double GetFirstFrameMilliseconds() const { return(m_firstFrameMilliseconds); }
+	// mark that the last asset of the scene has been loaded
+	void MarkSceneComplete();
+	bool HasSceneComplete() const { return(m_bSceneComplete); }
+
+	// print the phases and the time to the first frame
+	void Report(const char* deviceName) const;
+	// write the report to a JSON file
+	bool WriteReport(const char* filename, const char* deviceName) const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	// timing of one startup phase
+	struct STARTUP_PHASE
+	{
+		std::string name;
+		// number of phases that this phase is nested in
+		int depth;
+		// true for the phases that ran on worker threads
+		bool bWorker;
+		double startMilliseconds;
+		double durationMilliseconds;
+	};
+
+	Clock::time_point m_start;
+	// guards the phases, which worker threads add to
+	mutable std::mutex m_mutex;
+	// phases in the order that they were recorded
+	std::vector<STARTUP_PHASE> m_phases;
+	// indices of the phases that have not ended
+	std::vector<size_t> m_openPhases;
+	// time from the start to the first presented frame
+	double m_firstFrameMilliseconds;
+	bool m_bFirstFrame;
+	// time from the start until all the assets were loaded
+	double m_sceneCompleteMilliseconds;
+	bool m_bSceneComplete;
+
+	// get a copy of the phases sorted by their start time
+	std::vector<STARTUP_PHASE> GetSortedPhases() const;
+};
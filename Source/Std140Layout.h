@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// std140layout.h
+// ============
+// compile-time description of the std140 uniform block layout rules
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLM Math Header inclusions
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  Std140
+ *
+ *  These templates describe the base alignment and size
+ *  that the std140 rules assign to each GLSL type, so that
+ *  the C++ structs uploaded into uniform blocks can have
+ *  their member offsets checked while compiling.
+ ***********************************************************/
+namespace Std140
+{
+	// round the passed in offset up to the passed in alignment
+	constexpr size_t AlignUp(size_t offset, size_t alignment)
+	{
+		return(((offset + alignment - 1) / alignment) * alignment);
+	}
+
+	// base alignment and size of a type in a std140 block
+	template<typename T>
+	struct Traits;
+
+	// bool members are 32-bit values in a uniform block
+	template<> struct Traits<float> { static const size_t alignment = 4; static const size_t size = 4; };
+	template<> struct Traits<int32_t> { static const size_t alignment = 4; static const size_t size = 4; };
+	template<> struct Traits<uint32_t> { static const size_t alignment = 4; static const size_t size = 4; };
+	template<> struct Traits<glm::vec2> { static const size_t alignment = 8; static const size_t size = 8; };
+	template<> struct Traits<glm::vec3> { static const size_t alignment = 16; static const size_t size = 12; };
+	template<> struct Traits<glm::vec4> { static const size_t alignment = 16; static const size_t size = 16; };
+	template<> struct Traits<glm::mat4> { static const size_t alignment = 16; static const size_t size = 64; };
+
+	// array elements are aligned and strided to a vec4
+	template<typename T, size_t N>
+	struct Traits<T[N]>
+	{
+		static const size_t alignment = AlignUp(Traits<T>::alignment, 16);
+		static const size_t stride = AlignUp(Traits<T>::size, alignment);
+		static const size_t size = stride * N;
+	};
+
+	// offset of a member that follows the passed in member
+	template<typename T>
+	constexpr size_t NextOffset(size_t previousOffset, size_t previousSize)
+	{
+		return(AlignUp(previousOffset + previousSize, Traits<T>::alignment));
+	}
+
+	// size of a block or struct that ends with the passed in member
+	constexpr size_t BlockSize(size_t lastOffset, size_t lastSize)
+	{
+		return(AlignUp(lastOffset + lastSize, 16));
+	}
+}
+
+// declare that a struct is used as a std140 struct member, which
+// is aligned to a vec4 and padded to a multiple of a vec4
+#define STD140_STRUCT(Type) \
+	namespace Std140 { \
+		template<> struct Traits<Type> { \
+			static const size_t alignment = 16; \
+			static const size_t size = sizeof(Type); \
+		}; \
+	} \
+	static_assert((sizeof(Type) % 16) == 0, #Type " must be padded to a multiple of 16 bytes")
+
+// check the offset of the first member of a std140 block
+#define STD140_FIRST_MEMBER(Block, member) \
+	static_assert(offsetof(Block, member) == 0, \
+		#Block "::" #member " must be at offset 0")
+
+// check the offset of a member against the member before it
+#define STD140_NEXT_MEMBER(Block, previous, member) \
+	static_assert(offsetof(Block, member) == Std140::NextOffset<decltype(Block::member)>( \
+		offsetof(Block, previous), Std140::Traits<decltype(Block::previous)>::size), \
+		#Block "::" #member " does not match the std140 offset")
+
+// check the total size of a block against its last member
+#define STD140_BLOCK_SIZE(Block, last) \
+	static_assert(sizeof(Block) == Std140::BlockSize( \
+		offsetof(Block, last), Std140::Traits<decltype(Block::last)>::size), \
+		#Block " does not match the std140 block size")
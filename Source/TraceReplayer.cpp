@@ -0,0 +1,665 @@
+///////////////////////////////////////////////////////////////////////////////
+// tracereplayer.cpp
+// ============
+// re-execute a captured command trace on a render device
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TraceReplayer.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// declaration of global variables
+namespace
+{
+	// read position within the trace data
+	struct TRACE_CURSOR
+	{
+		const unsigned char* data;
+		size_t size;
+		size_t offset;
+	};
+
+	// location of a payload within the decoded payload bytes
+	struct PAYLOAD_REFERENCE
+	{
+		uint32_t offset;
+		uint32_t size;
+	};
+
+	// read a fixed size value from the trace data
+	template <typename T>
+	bool ReadValue(TRACE_CURSOR& cursor, T& value)
+	{
+		if (cursor.offset + sizeof(T) > cursor.size)
+		{
+			return(false);
+		}
+		memcpy(&value, cursor.data + cursor.offset, sizeof(T));
+		cursor.offset += sizeof(T);
+		return(true);
+	}
+
+	// read a length prefixed string from the trace data
+	bool ReadString(TRACE_CURSOR& cursor, std::string& text, bool& bHasText)
+	{
+		uint16_t length = 0;
+
+		if (ReadValue(cursor, length) == false)
+		{
+			return(false);
+		}
+
+		bHasText = (length != TRACE_NULL_STRING);
+		text.clear();
+		if (bHasText == false)
+		{
+			return(true);
+		}
+
+		if (cursor.offset + length > cursor.size)
+		{
+			return(false);
+		}
+		text.assign((const char*)cursor.data + cursor.offset, length);
+		cursor.offset += length;
+		return(true);
+	}
+
+	// size of the uniform block struct for a binding point
+	uint32_t BlockSize(int32_t binding)
+	{
+		switch (binding)
+		{
+		case CAMERA_BLOCK_BINDING:
+			return(sizeof(CAMERA_BLOCK));
+		case LIGHT_BLOCK_BINDING:
+			return(sizeof(LIGHT_BLOCK));
+		case MATERIAL_BLOCK_BINDING:
+			return(sizeof(MATERIAL_BLOCK));
+		case INSTANCE_BLOCK_BINDING:
+			return(sizeof(INSTANCE_BLOCK));
+		default:
+			return(0);
+		}
+	}
+}
+
+/***********************************************************
+ *  TraceReplayer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TraceReplayer::TraceReplayer()
+{
+	m_setupEnd = 0;
+	m_nextFrame = 0;
+	m_bFirstPass = true;
+}
+
+/***********************************************************
+ *  ~TraceReplayer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TraceReplayer::~TraceReplayer()
+{
+	m_records.clear();
+	m_payloads.clear();
+	m_pipelines.clear();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the passed in trace file
+ *  and decoding it into the list of records.
+ ***********************************************************/
+bool TraceReplayer::Load(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		LOG_ERROR("could not open the trace file", "file", filename);
+		return(false);
+	}
+
+	std::vector<unsigned char> data(
+		(std::istreambuf_iterator<char>(file)),
+		std::istreambuf_iterator<char>());
+
+	if (DecodeTrace(data) == false)
+	{
+		LOG_ERROR("the trace file is not valid", "file", filename);
+		return(false);
+	}
+
+	LOG_INFO("loaded trace", "file", filename, "frames", GetFrameCount(), "commands", m_records.size());
+
+	return(true);
+}
+
+/***********************************************************
+ *  DecodeTrace()
+ *
+ *  This method is used for checking the trace header and
+ *  decoding the records, resolving the payload references
+ *  to offsets in the payload bytes.
+ ***********************************************************/
+bool TraceReplayer::DecodeTrace(const std::vector<unsigned char>& data)
+{
+	TRACE_CURSOR cursor = { data.empty() ? NULL : &data[0], data.size(), 0 };
+	TRACE_HEADER header;
+	std::unordered_map<uint64_t, PAYLOAD_REFERENCE> payloads;
+	bool bEnded = false;
+	bool bInFrame = false;
+
+	if ((ReadValue(cursor, header) == false) ||
+		(memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0))
+	{
+		return(false);
+	}
+	if (header.version != TRACE_VERSION)
+	{
+		LOG_ERROR("the trace version is not supported", "version", header.version, "expected", TRACE_VERSION);
+		return(false);
+	}
+
+	m_records.clear();
+	m_payloads.clear();
+	m_pipelines.clear();
+	m_frameStarts.clear();
+	m_frameEnds.clear();
+	m_setupEnd = 0;
+
+	while (bEnded == false)
+	{
+		uint8_t command = 0;
+		uint64_t hash = 0;
+		TRACE_RECORD record;
+		bool bValid = true;
+
+		if (ReadValue(cursor, command) == false)
+		{
+			return(false);
+		}
+
+		memset(&record, 0, sizeof(record));
+		record.command = (TRACE_COMMAND)command;
+
+		switch (command)
+		{
+		case TRACE_PAYLOAD:
+		{
+			PAYLOAD_REFERENCE reference;
+			bValid = ReadValue(cursor, hash) && ReadValue(cursor, reference.size) &&
+				(cursor.offset + reference.size <= cursor.size);
+			if (bValid == false)
+			{
+				return(false);
+			}
+			reference.offset = (uint32_t)m_payloads.size();
+			m_payloads.insert(m_payloads.end(),
+				cursor.data + cursor.offset,
+				cursor.data + cursor.offset + reference.size);
+			cursor.offset += reference.size;
+			payloads[hash] = reference;
+			// payloads are not replayed as commands
+			continue;
+		}
+		case TRACE_CREATE_PIPELINE:
+		{
+			TRACE_PIPELINE pipeline;
+			uint8_t bLighting = 0;
+			uint8_t bSpecular = 0;
+			bValid = ReadValue(cursor, record.arguments[0]);
+			for (int i = 0; bValid && (i < 6); i++)
+			{
+				bValid = ReadString(cursor, pipeline.paths[i], pipeline.bHasPath[i]);
+			}
+			bValid = bValid && ReadValue(cursor, pipeline.activeLights) &&
+				ReadValue(cursor, bLighting) && ReadValue(cursor, bSpecular);
+			pipeline.bEnableLighting = (bLighting != 0);
+			pipeline.bEnableSpecular = (bSpecular != 0);
+			record.payload = (uint32_t)m_pipelines.size();
+			m_pipelines.push_back(pipeline);
+			break;
+		}
+		case TRACE_BIND_PIPELINE:
+		case TRACE_DESTROY_PIPELINE:
+		case TRACE_DESTROY_TEXTURE:
+		case TRACE_SET_TEXTURE_SLOT:
+		case TRACE_BIND_ENVIRONMENT:
+		case TRACE_DESTROY_TARGET:
+		case TRACE_BIND_TARGET:
+		case TRACE_SHOW_TARGET:
+		case TRACE_FILTER_TARGET:
+			bValid = ReadValue(cursor, record.arguments[0]);
+			break;
+		case TRACE_CREATE_TEXTURE:
+		{
+			bValid = ReadValue(cursor, record.arguments[0]) &&
+				ReadValue(cursor, record.arguments[1]) &&
+				ReadValue(cursor, record.arguments[2]) &&
+				ReadValue(cursor, record.arguments[3]) &&
+				ReadValue(cursor, hash) &&
+				(payloads.count(hash) != 0);
+			if (bValid)
+			{
+				PAYLOAD_REFERENCE reference = payloads[hash];
+				record.payload = reference.offset;
+				bValid = (reference.size ==
+					(uint32_t)(record.arguments[1] * record.arguments[2] * record.arguments[3]));
+			}
+			break;
+		}
+		case TRACE_CREATE_CUBE_TEXTURE:
+		{
+			bValid = ReadValue(cursor, record.arguments[0]) &&
+				ReadValue(cursor, record.arguments[1]) &&
+				ReadValue(cursor, record.arguments[2]) &&
+				ReadValue(cursor, hash) &&
+				(record.arguments[1] > 0) && (record.arguments[2] > 0) && (record.arguments[2] <= 16) &&
+				(payloads.count(hash) != 0);
+			if (bValid)
+			{
+				PAYLOAD_REFERENCE reference = payloads[hash];
+				record.payload = reference.offset;
+				bValid = (reference.size ==
+					(uint32_t)(RenderDevice::GetCubeTextureFloats(record.arguments[1], record.arguments[2]) * sizeof(float)));
+			}
+			break;
+		}
+		case TRACE_BIND_TEXTURE:
+			bValid = ReadValue(cursor, record.arguments[0]) &&
+				ReadValue(cursor, record.arguments[1]);
+			break;
+		case TRACE_UPDATE_BLOCK:
+		{
+			uint8_t binding = 0;
+			bValid = ReadValue(cursor, binding) && ReadValue(cursor, hash) &&
+				(payloads.count(hash) != 0);
+			if (bValid)
+			{
+				PAYLOAD_REFERENCE reference = payloads[hash];
+				record.arguments[0] = binding;
+				record.payload = reference.offset;
+				bValid = (reference.size == BlockSize(binding)) && (reference.size != 0);
+			}
+			break;
+		}
+		case TRACE_LOAD_MESH:
+		case TRACE_DRAW_MESH:
+		{
+			uint8_t mesh = 0;
+			bValid = ReadValue(cursor, mesh) && (mesh < MESH_COUNT);
+			record.arguments[0] = mesh;
+			break;
+		}
+		case TRACE_LOAD_MESH_DATA:
+		{
+			// the offset of the indices is kept in the last
+			// argument, as the record has a single payload
+			uint8_t mesh = 0;
+			uint32_t vertexCount = 0;
+			uint32_t indexCount = 0;
+			uint64_t indicesHash = 0;
+			bValid = ReadValue(cursor, mesh) && (mesh < MESH_COUNT) &&
+				ReadValue(cursor, vertexCount) && ReadValue(cursor, indexCount) &&
+				ReadValue(cursor, hash) && ReadValue(cursor, indicesHash) &&
+				(payloads.count(hash) != 0) && (payloads.count(indicesHash) != 0);
+			if (bValid)
+			{
+				PAYLOAD_REFERENCE vertices = payloads[hash];
+				PAYLOAD_REFERENCE indices = payloads[indicesHash];
+				record.arguments[0] = mesh;
+				record.arguments[1] = (int32_t)vertexCount;
+				record.arguments[2] = (int32_t)indexCount;
+				record.arguments[3] = (int32_t)indices.offset;
+				record.payload = vertices.offset;
+				bValid = (vertices.size == vertexCount * sizeof(RenderDevice::MESH_VERTEX)) &&
+					(indices.size == indexCount * sizeof(uint32_t));
+			}
+			break;
+		}
+		case TRACE_SET_VIEWS:
+		{
+			uint8_t viewCount = 0;
+			bValid = ReadValue(cursor, viewCount) && ReadValue(cursor, hash) &&
+				(viewCount > 0) && (viewCount <= MAX_VIEWS) && (payloads.count(hash) != 0);
+			if (bValid)
+			{
+				PAYLOAD_REFERENCE reference = payloads[hash];
+				record.arguments[0] = viewCount;
+				record.payload = reference.offset;
+				bValid = (reference.size == viewCount * sizeof(RenderDevice::VIEWPORT));
+			}
+			break;
+		}
+		case TRACE_CREATE_TARGET:
+		{
+			uint8_t layers = 0;
+			uint8_t bCubeMap = 0;
+			bValid = ReadValue(cursor, record.arguments[0]) &&
+				ReadValue(cursor, record.arguments[1]) &&
+				ReadValue(cursor, record.arguments[2]) &&
+				ReadValue(cursor, layers) && ReadValue(cursor, bCubeMap) &&
+				(layers > 0) && (layers <= MAX_VIEWS);
+			// the cube map flag is kept in the layer argument
+			record.arguments[3] = layers | (bCubeMap != 0 ? 0x100 : 0);
+			break;
+		}
+		case TRACE_BEGIN_FRAME:
+			if (m_frameStarts.size() == m_frameEnds.size())
+			{
+				// the commands between two frames are replayed
+				// at the start of the next frame
+				if (m_frameEnds.empty())
+				{
+					m_setupEnd = m_records.size();
+				}
+				m_frameStarts.push_back(m_frameEnds.empty() ? m_records.size() : m_frameEnds.back() + 1);
+			}
+			bInFrame = true;
+			break;
+		case TRACE_END_FRAME:
+			bValid = bInFrame;
+			m_frameEnds.push_back(m_records.size());
+			bInFrame = false;
+			break;
+		case TRACE_END:
+			bEnded = true;
+			continue;
+		default:
+			bValid = false;
+			break;
+		}
+
+		if (bValid == false)
+		{
+			return(false);
+		}
+		m_records.push_back(record);
+	}
+
+	// drop a frame that was not ended before the capture stopped
+	if (m_frameStarts.size() > m_frameEnds.size())
+	{
+		m_frameStarts.pop_back();
+	}
+	if (m_frameEnds.empty())
+	{
+		m_setupEnd = m_records.size();
+	}
+
+	return(m_frameEnds.size() == header.frameCount);
+}
+
+/***********************************************************
+ *  IsResourceCommand()
+ *
+ *  This method is used for checking whether the passed in
+ *  command creates or frees a resource.
+ ***********************************************************/
+bool TraceReplayer::IsResourceCommand(TRACE_COMMAND command)
+{
+	return((command == TRACE_CREATE_PIPELINE) ||
+		(command == TRACE_DESTROY_PIPELINE) ||
+		(command == TRACE_CREATE_TEXTURE) ||
+		(command == TRACE_CREATE_CUBE_TEXTURE) ||
+		(command == TRACE_DESTROY_TEXTURE) ||
+		(command == TRACE_CREATE_TARGET) ||
+		(command == TRACE_DESTROY_TARGET) ||
+		(command == TRACE_LOAD_MESH) ||
+		(command == TRACE_LOAD_MESH_DATA));
+}
+
+/***********************************************************
+ *  ExecuteRecord()
+ *
+ *  This method is used for issuing one decoded command to
+ *  the passed in render device.
+ ***********************************************************/
+void TraceReplayer::ExecuteRecord(RenderDevice* pDevice, const TRACE_RECORD& record)
+{
+	switch (record.command)
+	{
+	case TRACE_CREATE_PIPELINE:
+	{
+		const TRACE_PIPELINE& pipeline = m_pipelines[record.payload];
+		const char* paths[6];
+		for (int i = 0; i < 6; i++)
+		{
+			paths[i] = pipeline.bHasPath[i] ? pipeline.paths[i].c_str() : NULL;
+		}
+
+		RenderDevice::PIPELINE_DESC desc;
+		desc.vertexShaderPath = paths[0];
+		desc.fragmentShaderPath = paths[1];
+		desc.vertexBinaryPath = paths[2];
+		desc.fragmentBinaryPath = paths[3];
+		desc.vulkanVertexBinaryPath = paths[4];
+		desc.vulkanFragmentBinaryPath = paths[5];
+		desc.activeLights = pipeline.activeLights;
+		desc.bEnableLighting = pipeline.bEnableLighting;
+		desc.bEnableSpecular = pipeline.bEnableSpecular;
+
+		m_pipelineHandles[(uint32_t)record.arguments[0]] = pDevice->CreatePipeline(desc);
+		break;
+	}
+	case TRACE_BIND_PIPELINE:
+		pDevice->BindPipeline(m_pipelineHandles[(uint32_t)record.arguments[0]]);
+		break;
+	case TRACE_DESTROY_PIPELINE:
+		pDevice->DestroyPipeline(m_pipelineHandles[(uint32_t)record.arguments[0]]);
+		m_pipelineHandles.erase((uint32_t)record.arguments[0]);
+		break;
+	case TRACE_CREATE_TEXTURE:
+		m_textureHandles[(uint32_t)record.arguments[0]] = pDevice->CreateTexture(
+			record.arguments[1],
+			record.arguments[2],
+			record.arguments[3],
+			&m_payloads[record.payload]);
+		break;
+	case TRACE_DESTROY_TEXTURE:
+		pDevice->DestroyTexture(m_textureHandles[(uint32_t)record.arguments[0]]);
+		m_textureHandles.erase((uint32_t)record.arguments[0]);
+		break;
+	case TRACE_BIND_TEXTURE:
+		pDevice->BindTexture(record.arguments[0], m_textureHandles[(uint32_t)record.arguments[1]]);
+		break;
+	case TRACE_SET_TEXTURE_SLOT:
+		pDevice->SetTextureSlot(record.arguments[0]);
+		break;
+	case TRACE_CREATE_CUBE_TEXTURE:
+	{
+		// copied out of the payload bytes, which are not aligned
+		// for the floats
+		std::vector<float> pixels(RenderDevice::GetCubeTextureFloats(record.arguments[1], record.arguments[2]));
+		memcpy(pixels.data(), &m_payloads[record.payload], pixels.size() * sizeof(float));
+		m_textureHandles[(uint32_t)record.arguments[0]] = pDevice->CreateCubeTexture(
+			record.arguments[1],
+			record.arguments[2],
+			pixels.data());
+		break;
+	}
+	case TRACE_BIND_ENVIRONMENT:
+		pDevice->BindEnvironment(m_textureHandles[(uint32_t)record.arguments[0]]);
+		break;
+	case TRACE_UPDATE_BLOCK:
+		// the block data is copied out of the payload bytes, which
+		// are not aligned for the vector and matrix members
+		switch (record.arguments[0])
+		{
+		case CAMERA_BLOCK_BINDING:
+		{
+			CAMERA_BLOCK block;
+			memcpy(&block, &m_payloads[record.payload], sizeof(block));
+			pDevice->UpdateBlock(block);
+			break;
+		}
+		case LIGHT_BLOCK_BINDING:
+		{
+			LIGHT_BLOCK block;
+			memcpy(&block, &m_payloads[record.payload], sizeof(block));
+			pDevice->UpdateBlock(block);
+			break;
+		}
+		case MATERIAL_BLOCK_BINDING:
+		{
+			MATERIAL_BLOCK block;
+			memcpy(&block, &m_payloads[record.payload], sizeof(block));
+			pDevice->UpdateBlock(block);
+			break;
+		}
+		case INSTANCE_BLOCK_BINDING:
+		{
+			INSTANCE_BLOCK block;
+			memcpy(&block, &m_payloads[record.payload], sizeof(block));
+			pDevice->UpdateBlock(block);
+			break;
+		}
+		default:
+			break;
+		}
+		break;
+	case TRACE_LOAD_MESH:
+		pDevice->LoadMesh((MESH_TYPE)record.arguments[0]);
+		break;
+	case TRACE_LOAD_MESH_DATA:
+	{
+		// copied out of the payload bytes like the block data
+		RenderDevice::MESH_DATA data;
+		data.vertices.resize(record.arguments[1]);
+		data.indices.resize(record.arguments[2]);
+		if (data.vertices.empty() == false)
+		{
+			memcpy(data.vertices.data(), &m_payloads[record.payload],
+				data.vertices.size() * sizeof(RenderDevice::MESH_VERTEX));
+		}
+		if (data.indices.empty() == false)
+		{
+			memcpy(data.indices.data(), &m_payloads[record.arguments[3]],
+				data.indices.size() * sizeof(uint32_t));
+		}
+		pDevice->LoadMesh((MESH_TYPE)record.arguments[0], data);
+		break;
+	}
+	case TRACE_DRAW_MESH:
+		pDevice->DrawMesh((MESH_TYPE)record.arguments[0]);
+		break;
+	case TRACE_SET_VIEWS:
+	{
+		// copied out of the payload bytes like the block data
+		RenderDevice::VIEWPORT viewports[MAX_VIEWS];
+		memcpy(viewports, &m_payloads[record.payload], record.arguments[0] * sizeof(RenderDevice::VIEWPORT));
+		pDevice->SetViews(viewports, record.arguments[0]);
+		break;
+	}
+	case TRACE_CREATE_TARGET:
+	{
+		RenderDevice::TARGET_DESC desc;
+		desc.width = record.arguments[1];
+		desc.height = record.arguments[2];
+		desc.layers = (uint32_t)(record.arguments[3] & 0xFF);
+		desc.bCubeMap = ((record.arguments[3] & 0x100) != 0);
+		// a device without layered targets draws into the window
+		m_targetHandles[(uint32_t)record.arguments[0]] = pDevice->CreateTarget(desc);
+		break;
+	}
+	case TRACE_DESTROY_TARGET:
+		pDevice->DestroyTarget(m_targetHandles[(uint32_t)record.arguments[0]]);
+		m_targetHandles.erase((uint32_t)record.arguments[0]);
+		break;
+	case TRACE_BIND_TARGET:
+		pDevice->BindTarget(m_targetHandles[(uint32_t)record.arguments[0]]);
+		break;
+	case TRACE_SHOW_TARGET:
+		pDevice->ShowTarget(m_targetHandles[(uint32_t)record.arguments[0]]);
+		break;
+	case TRACE_FILTER_TARGET:
+		pDevice->FilterTargetMips(m_targetHandles[(uint32_t)record.arguments[0]]);
+		break;
+	case TRACE_BEGIN_FRAME:
+		pDevice->BeginFrame();
+		break;
+	case TRACE_END_FRAME:
+		pDevice->EndFrame();
+		break;
+	default:
+		break;
+	}
+}
+
+/***********************************************************
+ *  ReplaySetup()
+ *
+ *  This method is used for issuing the commands that were
+ *  captured before the first frame.
+ ***********************************************************/
+bool TraceReplayer::ReplaySetup(RenderDevice* pDevice)
+{
+	if (m_frameEnds.empty())
+	{
+		LOG_ERROR("the trace does not contain any frames");
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_setupEnd; i++)
+	{
+		ExecuteRecord(pDevice, m_records[i]);
+	}
+
+	// the handles must have been created for the frames to draw
+	for (std::unordered_map<uint32_t, uint32_t>::const_iterator it = m_pipelineHandles.begin();
+		it != m_pipelineHandles.end(); ++it)
+	{
+		if (it->second == 0)
+		{
+			LOG_ERROR("a captured pipeline could not be created");
+			return(false);
+		}
+	}
+
+	m_nextFrame = 0;
+	m_bFirstPass = true;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReplayFrame()
+ *
+ *  This method is used for issuing the commands of the next
+ *  captured frame, starting over at the first frame after
+ *  the last one.
+ ***********************************************************/
+void TraceReplayer::ReplayFrame(RenderDevice* pDevice)
+{
+	if (m_frameEnds.empty())
+	{
+		return;
+	}
+
+	size_t start = m_frameStarts[m_nextFrame];
+	size_t end = m_frameEnds[m_nextFrame];
+
+	for (size_t i = start; i < end; i++)
+	{
+		// resources are only created once, on the first pass
+		if ((m_bFirstPass == false) && IsResourceCommand(m_records[i].command))
+		{
+			continue;
+		}
+		ExecuteRecord(pDevice, m_records[i]);
+	}
+
+	m_nextFrame++;
+	if (m_nextFrame >= (int)m_frameEnds.size())
+	{
+		m_nextFrame = 0;
+		m_bFirstPass = false;
+	}
+}
@@ -0,0 +1,96 @@
+///////////////////////////////////////////////////////////////////////////////
+// tracereplayer.h
+// ============
+// re-execute a captured command trace on a render device
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "CommandTrace.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  TraceReplayer
+ *
+ *  This class contains the code for loading a trace that
+ *  was written by the CaptureRenderDevice, and issuing its
+ *  commands to a render device without the scene code.  The
+ *  whole trace is decoded into a list of records when it is
+ *  loaded, so that replaying a frame only walks the list.
+ *  The captured frames are replayed in a loop, and the
+ *  commands that create resources only run on the first
+ *  pass through the frames.
+ ***********************************************************/
+class TraceReplayer
+{
+public:
+	// constructor
+	TraceReplayer();
+	// destructor
+	~TraceReplayer();
+
+	// load and decode a trace file
+	bool Load(const char* filename);
+
+	// get the number of frames in the loaded trace
+	int GetFrameCount() const { return((int)m_frameEnds.size()); }
+
+	// issue the commands that come before the first frame,
+	// which create the pipelines, textures and meshes
+	bool ReplaySetup(RenderDevice* pDevice);
+	// issue the commands of the next frame, up to but not
+	// including the end of the frame, which is left to the
+	// caller so that it can be timed separately
+	void ReplayFrame(RenderDevice* pDevice);
+
+private:
+	// decoded command, the meaning of the arguments depends
+	// on the command as described in the trace format
+	struct TRACE_RECORD
+	{
+		TRACE_COMMAND command;
+		int32_t arguments[4];
+		// offset of the payload bytes, or pipeline index
+		uint32_t payload;
+	};
+
+	// decoded pipeline description
+	struct TRACE_PIPELINE
+	{
+		std::string paths[6];
+		bool bHasPath[6];
+		int activeLights;
+		bool bEnableLighting;
+		bool bEnableSpecular;
+	};
+
+	// decoded trace
+	std::vector<TRACE_RECORD> m_records;
+	std::vector<unsigned char> m_payloads;
+	std::vector<TRACE_PIPELINE> m_pipelines;
+	// index of the first record of each frame, and of the
+	// record that ends it
+	std::vector<size_t> m_frameStarts;
+	std::vector<size_t> m_frameEnds;
+	size_t m_setupEnd;
+
+	// replay position
+	int m_nextFrame;
+	bool m_bFirstPass;
+
+	// handles created during the replay for the captured handles
+	std::unordered_map<uint32_t, uint32_t> m_pipelineHandles;
+	std::unordered_map<uint32_t, uint32_t> m_textureHandles;
+	std::unordered_map<uint32_t, uint32_t> m_targetHandles;
+
+	// decode the trace data into records
+	bool DecodeTrace(const std::vector<unsigned char>& data);
+	// issue one decoded command to the device
+	void ExecuteRecord(RenderDevice* pDevice, const TRACE_RECORD& record);
+	// check whether a command creates or frees resources
+	static bool IsResourceCommand(TRACE_COMMAND command);
+};
@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+// uniformblocks.h
+// ============
+// C++ mirrors of the std140 uniform blocks declared in the shaders
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "Std140Layout.h"
+
+/***********************************************************
+ *  Uniform blocks
+ *
+ *  Each struct matches the std140 layout of the uniform
+ *  block with the same name in the shaders, so that it can
+ *  be uploaded into its uniform buffer with one copy.  The
+ *  explicit padding members are never read by the shaders.
+ ***********************************************************/
+
+// uniform block binding points declared in the shaders
+enum UNIFORM_BLOCK_BINDING
+{
+	CAMERA_BLOCK_BINDING = 0,
+	LIGHT_BLOCK_BINDING = 1,
+	MATERIAL_BLOCK_BINDING = 2,
+	INSTANCE_BLOCK_BINDING = 3,
+	UNIFORM_BLOCK_COUNT = 4
+};
+
+// number of light sources declared in the fragment shader
+const int TOTAL_LIGHTS = 4;
+
+// number of views declared in the shaders, which is the most
+// views that each draw can be repeated in - the six faces of
+// a cube map are drawn as six views
+const int MAX_VIEWS = 6;
+
+// CameraView struct used within the CameraBlock
+struct CAMERA_VIEW
+{
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	float padding0;
+};
+
+STD140_FIRST_MEMBER(CAMERA_VIEW, view);
+STD140_NEXT_MEMBER(CAMERA_VIEW, view, projection);
+STD140_NEXT_MEMBER(CAMERA_VIEW, projection, viewPosition);
+STD140_BLOCK_SIZE(CAMERA_VIEW, viewPosition);
+STD140_STRUCT(CAMERA_VIEW);
+
+// CameraBlock - per-frame view and projection of each view,
+// the shaders select the view by the instance of the draw
+struct CAMERA_BLOCK
+{
+	CAMERA_VIEW views[MAX_VIEWS];
+};
+
+STD140_FIRST_MEMBER(CAMERA_BLOCK, views);
+STD140_BLOCK_SIZE(CAMERA_BLOCK, views);
+
+// LightSource struct used within the LightBlock
+struct LIGHT_SOURCE
+{
+	glm::vec3 position;
+	float padding0;
+	glm::vec3 diffuseColor;
+	float padding1;
+	glm::vec3 specularColor;
+	float focalStrength;
+	float specularIntensity;
+	float padding2[3];
+};
+
+STD140_FIRST_MEMBER(LIGHT_SOURCE, position);
+STD140_NEXT_MEMBER(LIGHT_SOURCE, position, diffuseColor);
+STD140_NEXT_MEMBER(LIGHT_SOURCE, diffuseColor, specularColor);
+STD140_NEXT_MEMBER(LIGHT_SOURCE, specularColor, focalStrength);
+STD140_NEXT_MEMBER(LIGHT_SOURCE, focalStrength, specularIntensity);
+STD140_BLOCK_SIZE(LIGHT_SOURCE, specularIntensity);
+STD140_STRUCT(LIGHT_SOURCE);
+
+// number of spherical harmonic coefficients of the diffuse
+// environment lighting, the first three bands
+const int SH_COEFFICIENTS = 9;
+
+// LightBlock - light sources set up once for the scene, and
+// the environment lighting of the reflective materials as the
+// spherical harmonic coefficients of its diffuse light and
+// the mip levels of its prefiltered cube map, where zero
+// levels means that there is no cube map
+struct LIGHT_BLOCK
+{
+	LIGHT_SOURCE lightSources[TOTAL_LIGHTS];
+	glm::vec3 globalAmbientColor;
+	float padding0;
+	glm::vec4 irradiance[SH_COEFFICIENTS];
+	float environmentLevels;
+	float padding1[3];
+};
+
+STD140_FIRST_MEMBER(LIGHT_BLOCK, lightSources);
+STD140_NEXT_MEMBER(LIGHT_BLOCK, lightSources, globalAmbientColor);
+STD140_NEXT_MEMBER(LIGHT_BLOCK, globalAmbientColor, irradiance);
+STD140_NEXT_MEMBER(LIGHT_BLOCK, irradiance, environmentLevels);
+STD140_BLOCK_SIZE(LIGHT_BLOCK, environmentLevels);
+
+// MaterialBlock - surface material of the drawn object, the
+// reflectivity scales the environment lighting and the
+// roughness selects the blur of its reflections
+struct MATERIAL_BLOCK
+{
+	glm::vec3 diffuseColor;
+	float padding0;
+	glm::vec3 specularColor;
+	float shininess;
+	float reflectivity;
+	float roughness;
+	float padding1[2];
+};
+
+STD140_FIRST_MEMBER(MATERIAL_BLOCK, diffuseColor);
+STD140_NEXT_MEMBER(MATERIAL_BLOCK, diffuseColor, specularColor);
+STD140_NEXT_MEMBER(MATERIAL_BLOCK, specularColor, shininess);
+STD140_NEXT_MEMBER(MATERIAL_BLOCK, shininess, reflectivity);
+STD140_NEXT_MEMBER(MATERIAL_BLOCK, reflectivity, roughness);
+STD140_BLOCK_SIZE(MATERIAL_BLOCK, roughness);
+
+// number of vectors that the diffuse light of the light
+// probes is packed into for each drawn object, three for the
+// constant and linear bands, three for the quadratic band and
+// one for its last coefficient
+const int SH_INSTANCE_VECTORS = 7;
+
+// InstanceBlock - transform and color of the drawn object,
+// the views that it is drawn in as one bit for each view,
+// where zero draws it in all of the views, and the diffuse
+// light of the light probes around it
+struct INSTANCE_BLOCK
+{
+	glm::mat4 model;
+	glm::vec4 objectColor;
+	glm::vec2 UVscale;
+	uint32_t bUseTexture;
+	uint32_t bUseLighting;
+	uint32_t viewMask;
+	uint32_t padding0[3];
+	glm::vec4 lightProbe[SH_INSTANCE_VECTORS];
+};
+
+STD140_FIRST_MEMBER(INSTANCE_BLOCK, model);
+STD140_NEXT_MEMBER(INSTANCE_BLOCK, model, objectColor);
+STD140_NEXT_MEMBER(INSTANCE_BLOCK, objectColor, UVscale);
+STD140_NEXT_MEMBER(INSTANCE_BLOCK, UVscale, bUseTexture);
+STD140_NEXT_MEMBER(INSTANCE_BLOCK, bUseTexture, bUseLighting);
+STD140_NEXT_MEMBER(INSTANCE_BLOCK, bUseLighting, viewMask);
+STD140_NEXT_MEMBER(INSTANCE_BLOCK, viewMask, lightProbe);
+STD140_BLOCK_SIZE(INSTANCE_BLOCK, lightProbe);
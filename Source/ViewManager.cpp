@@ -8,12 +8,17 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "Logger.h"
+
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 glm::mat4 view;
 glm::mat4 perspectiveProjection;
 glm::mat4 orthogonalProjection;
@@ -28,8 +33,6 @@ namespace
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
-	const char* g_ViewName = "view";
-	const char* g_ProjectionName = "projection";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -47,6 +50,37 @@ namespace
 	// the following variable is false when orthographic projection
 	// is off and true when it is on
 	bool bOrthographicProjection = false;
+
+	// fixed orthographic views of the scene drawn beside the
+	// camera view, in the order they are added
+	struct SIDE_VIEW
+	{
+		glm::vec3 position;
+		glm::vec3 target;
+		glm::vec3 up;
+	};
+	const SIDE_VIEW g_SideViews[] =
+	{
+		// top
+		{ glm::vec3(0.0f, 40.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		// front
+		{ glm::vec3(0.0f, 5.0f, 40.0f), glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) }
+	};
+	const int g_SideViewCount = (int)(sizeof(g_SideViews) / sizeof(g_SideViews[0]));
+
+	// part of the window width taken by the camera view when
+	// the side views are drawn
+	const float CAMERA_VIEW_WIDTH = 2.0f / 3.0f;
+	// half of the scene width shown by the side views, which
+	// covers the desk plane
+	const float SIDE_VIEW_HALF_WIDTH = 21.0f;
+
+	// distance in front of the eyes where the left and right
+	// images line up, objects there appear at the screen
+	const float STEREO_CONVERGENCE = 16.0f;
+	// near and far planes of the perspective projections
+	const float NEAR_PLANE = 0.1f;
+	const float FAR_PLANE = 100.0f;
 }
 
 /***********************************************************
@@ -55,11 +89,18 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	RenderDevice *pRenderDevice)
 {
 	// initialize the member variables
-	m_pShaderManager = pShaderManager;
+	m_pRenderDevice = pRenderDevice;
 	m_pWindow = NULL;
+	m_pPerformanceHud = NULL;
+	m_bHudKeyDown = false;
+	m_viewCount = 1;
+	m_cameraData = CAMERA_BLOCK();
+	m_stereoMode = STEREO_OFF;
+	m_eyeSeparation = 0.0f;
+	m_stereoTarget = 0;
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 16.0f);
@@ -77,7 +118,12 @@ ViewManager::ViewManager(
 ViewManager::~ViewManager()
 {
 	// free up allocated memory
-	m_pShaderManager = NULL;
+	if ((NULL != m_pRenderDevice) && (m_stereoTarget != 0))
+	{
+		m_pRenderDevice->DestroyTarget(m_stereoTarget);
+		m_stereoTarget = 0;
+	}
+	m_pRenderDevice = NULL;
 	m_pWindow = NULL;
 	if (NULL != g_pCamera)
 	{
@@ -103,11 +149,16 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 		NULL, NULL);
 	if (window == NULL)
 	{
-		std::cout << "Failed to create GLFW window" << std::endl;
+		LOG_ERROR("failed to create the GLFW window");
 		glfwTerminate();
 		return NULL;
 	}
-	glfwMakeContextCurrent(window);
+
+	// windows for the Vulkan device are created without a context
+	if (glfwGetWindowAttrib(window, GLFW_CLIENT_API) != GLFW_NO_API)
+	{
+		glfwMakeContextCurrent(window);
+	}
 
 	// tell GLFW to capture all mouse events
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -118,10 +169,6 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	// this callback is used to recieve mouse scroll events
 	glfwSetScrollCallback(window, scroll_callback);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
 	m_pWindow = window;
 
 	return(window);
@@ -165,6 +212,12 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
  ***********************************************************/
 void ViewManager::ProcessKeyboardEvents()
 {
+	// there are no keyboard events without a display window
+	if (NULL == m_pWindow)
+	{
+		return;
+	}
+
 	// close the window if the escape key has been pressed
 	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
@@ -212,6 +265,14 @@ void ViewManager::ProcessKeyboardEvents()
 	{
 		perspectiveDisplay = false;
 	}
+
+	// show or hide the performance overlay once per key press
+	bool bHudKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_F1) == GLFW_PRESS);
+	if (bHudKeyDown && (m_bHudKeyDown == false) && (NULL != m_pPerformanceHud))
+	{
+		m_pPerformanceHud->ToggleVisible();
+	}
+	m_bHudKeyDown = bHudKeyDown;
 }
 
 /***********************************************************
@@ -232,31 +293,148 @@ void ViewManager::PrepareSceneView()
 	// event queue
 	ProcessKeyboardEvents();
 
+	RenderDevice::VIEWPORT viewports[MAX_VIEWS];
+	if (m_stereoMode != STEREO_OFF)
+	{
+		PrepareStereoViews(viewports);
+		return;
+	}
+
+	// the camera view takes the whole window, or the left part
+	// of it when the side views are drawn on the right
+	int sideViews = m_viewCount - 1;
+	viewports[0].x = 0.0f;
+	viewports[0].y = 0.0f;
+	viewports[0].width = (sideViews > 0) ? CAMERA_VIEW_WIDTH : 1.0f;
+	viewports[0].height = 1.0f;
+	float aspect = (WINDOW_WIDTH * viewports[0].width) / (WINDOW_HEIGHT * viewports[0].height);
+
 	// get the current view matrix from the camera
 	view = g_pCamera->GetViewMatrix();
 
 	// define the orthogonal projection matrix
-	orthogonalProjection = glm::ortho(-2.1f, 2.1f, -2.0f, 2.0f, 1.0f, 100.0f);
+	orthogonalProjection = glm::ortho(-2.1f * viewports[0].width, 2.1f * viewports[0].width, -2.0f, 2.0f, 1.0f, 100.0f);
 
 	// define the perspective projection matrix
-	perspectiveProjection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	perspectiveProjection = glm::perspective(glm::radians(g_pCamera->Zoom), aspect, NEAR_PLANE, FAR_PLANE);
+
+	// set the view matrix into the shader for proper rendering
+	m_cameraData.views[0].view = view;
+
+	// set the view matrix into the shader for proper rendering
+	// added boolean check based off keybinds for which view is rendered
+	if (perspectiveDisplay) {
+		m_cameraData.views[0].projection = perspectiveProjection;
+	}
+	else {
+		m_cameraData.views[0].projection = orthogonalProjection;
+	}
+	// set the view position of the camera into the shader for proper rendering
+	m_cameraData.views[0].viewPosition = g_pCamera->Position;
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// the side views are stacked from the top right corner
+	for (int i = 0; i < sideViews; i++)
 	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
+		RenderDevice::VIEWPORT& viewport = viewports[i + 1];
+		viewport.x = CAMERA_VIEW_WIDTH;
+		viewport.y = 1.0f - ((i + 1) / (float)sideViews);
+		viewport.width = 1.0f - CAMERA_VIEW_WIDTH;
+		viewport.height = 1.0f / sideViews;
+
+		float halfHeight = SIDE_VIEW_HALF_WIDTH * (WINDOW_HEIGHT * viewport.height) / (WINDOW_WIDTH * viewport.width);
+		CAMERA_VIEW& sideView = m_cameraData.views[i + 1];
+		sideView.view = glm::lookAt(g_SideViews[i].position, g_SideViews[i].target, g_SideViews[i].up);
+		sideView.projection = glm::ortho(-SIDE_VIEW_HALF_WIDTH, SIDE_VIEW_HALF_WIDTH, -halfHeight, halfHeight, 1.0f, 100.0f);
+		sideView.viewPosition = g_SideViews[i].position;
+	}
 
-		// set the view matrix into the shader for proper rendering
-		// added boolean check based off keybinds for which view is rendered
-		if (perspectiveDisplay) {
-			m_pShaderManager->setMat4Value(g_ProjectionName, perspectiveProjection);
+	// if the render device object is valid
+	if (NULL != m_pRenderDevice)
+	{
+		m_pRenderDevice->SetViews(viewports, m_viewCount);
+		m_pRenderDevice->UpdateBlock(m_cameraData);
+	}
+}
+
+/***********************************************************
+ *  PrepareStereoViews()
+ *
+ *  This method is used for setting the views of the left
+ *  and the right eye.  Each eye is moved half of the eye
+ *  separation to its side of the camera, and its frustum
+ *  is shifted back towards the middle so that the two
+ *  frustums meet at the convergence distance, which keeps
+ *  the images of both eyes parallel without any vertical
+ *  parallax.  The layered target is created on the first
+ *  frame, and the eyes are drawn side by side when the
+ *  render device cannot create it.
+ ***********************************************************/
+void ViewManager::PrepareStereoViews(RenderDevice::VIEWPORT* viewports)
+{
+	if ((m_stereoMode == STEREO_LAYERS) && (m_stereoTarget == 0) && (NULL != m_pRenderDevice))
+	{
+		RenderDevice::TARGET_DESC desc;
+		desc.width = WINDOW_WIDTH / 2;
+		desc.height = WINDOW_HEIGHT;
+		desc.layers = 2;
+		desc.bCubeMap = false;
+		m_stereoTarget = m_pRenderDevice->CreateTarget(desc);
+		if (m_stereoTarget == 0)
+		{
+			LOG_WARNING("the render device cannot draw into layers, the eyes are drawn side by side",
+				"device", m_pRenderDevice->GetName());
+			m_stereoMode = STEREO_SIDE_BY_SIDE;
 		}
-		else {
-			m_pShaderManager->setMat4Value(g_ProjectionName, orthogonalProjection);
+	}
+
+	// both eyes see half of the window width
+	float top = NEAR_PLANE * tanf(glm::radians(g_pCamera->Zoom) * 0.5f);
+	float right = top * (WINDOW_WIDTH * 0.5f) / WINDOW_HEIGHT;
+	float shift = 0.5f * m_eyeSeparation * NEAR_PLANE / STEREO_CONVERGENCE;
+
+	view = g_pCamera->GetViewMatrix();
+	for (int eye = 0; eye < 2; eye++)
+	{
+		// the left eye is on the negative side of the camera
+		float side = (eye == 0) ? -1.0f : 1.0f;
+
+		RenderDevice::VIEWPORT& viewport = viewports[eye];
+		viewport.x = (m_stereoMode == STEREO_LAYERS) ? 0.0f : eye * 0.5f;
+		viewport.y = 0.0f;
+		viewport.width = (m_stereoMode == STEREO_LAYERS) ? 1.0f : 0.5f;
+		viewport.height = 1.0f;
+
+		CAMERA_VIEW& eyeView = m_cameraData.views[eye];
+		eyeView.view = glm::translate(glm::vec3(-side * m_eyeSeparation * 0.5f, 0.0f, 0.0f)) * view;
+		eyeView.projection = glm::frustum(-right - side * shift, right - side * shift, -top, top, NEAR_PLANE, FAR_PLANE);
+		eyeView.viewPosition = g_pCamera->Position + (side * m_eyeSeparation * 0.5f) * g_pCamera->Right;
+	}
+
+	// if the render device object is valid
+	if (NULL != m_pRenderDevice)
+	{
+		if (m_stereoMode == STEREO_LAYERS)
+		{
+			m_pRenderDevice->BindTarget(m_stereoTarget);
 		}
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		m_pRenderDevice->SetViews(viewports, m_viewCount);
+		m_pRenderDevice->UpdateBlock(m_cameraData);
+	}
+}
+
+/***********************************************************
+ *  FinishSceneView()
+ *
+ *  This method is used for finishing the frame of the scene
+ *  after it has been drawn.  The eyes drawn into the layers
+ *  are copied side by side into the window, so the output
+ *  handed on can also be seen.
+ ***********************************************************/
+void ViewManager::FinishSceneView()
+{
+	if ((m_stereoMode == STEREO_LAYERS) && (NULL != m_pRenderDevice))
+	{
+		m_pRenderDevice->ShowTarget(m_stereoTarget);
 	}
 }
 
@@ -268,4 +446,55 @@ void ViewManager::PrepareSceneView()
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
 	g_pCamera->ProcessMouseScroll(-yoffset);
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *  GetCameraPose()
+ *
+ *  This method is used for getting the position and the
+ *  view direction of the camera, for reporting.
+ ***********************************************************/
+void ViewManager::GetCameraPose(glm::vec3& position, glm::vec3& front) const
+{
+	position = g_pCamera->Position;
+	front = g_pCamera->Front;
+}
+
+/***********************************************************
+ *  SetViewCount()
+ *
+ *  This method is used for setting the number of views
+ *  drawn each frame.  The views share one pass over the
+ *  scene, each draw is repeated in the views by the render
+ *  device.
+ ***********************************************************/
+void ViewManager::SetViewCount(int viewCount)
+{
+	m_viewCount = std::max(1, std::min(viewCount, GetMaxViewCount()));
+}
+
+/***********************************************************
+ *  SetStereo()
+ *
+ *  This method is used for drawing the scene for both eyes
+ *  in one pass, as two views that each draw is repeated in
+ *  by the render device, so the scene is only walked and
+ *  submitted once.  The side views are not drawn in stereo.
+ ***********************************************************/
+void ViewManager::SetStereo(STEREO_MODE stereoMode, float eyeSeparation)
+{
+	m_stereoMode = stereoMode;
+	m_eyeSeparation = eyeSeparation;
+	m_viewCount = (stereoMode != STEREO_OFF) ? 2 : 1;
+}
+
+/***********************************************************
+ *  GetMaxViewCount()
+ *
+ *  This method is used for getting the most views that can
+ *  be drawn each frame, the camera view and the side views.
+ ***********************************************************/
+int ViewManager::GetMaxViewCount()
+{
+	return(std::min(1 + g_SideViewCount, MAX_VIEWS));
+}
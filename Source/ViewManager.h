@@ -9,7 +9,8 @@
 
 #pragma once
 
-#include "ShaderManager.h"
+#include "RenderDevice.h"
+#include "PerformanceHud.h"
 #include "camera.h"
 
 // GLFW library
@@ -20,21 +21,46 @@ class ViewManager
 public:
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		RenderDevice* pRenderDevice);
 	// destructor
 	~ViewManager();
 
 	// mouse position callback for mouse interaction with the 3D scene
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
 
+	// how the left and right eye views are output
+	enum STEREO_MODE
+	{
+		STEREO_OFF = 0,
+		// both eyes side by side in the window
+		STEREO_SIDE_BY_SIDE,
+		// each eye in its own layer of a two layer target
+		STEREO_LAYERS
+	};
+
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
+	// pointer to render device object
+	RenderDevice* m_pRenderDevice;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// performance overlay toggled from the keyboard
+	PerformanceHud* m_pPerformanceHud;
+	bool m_bHudKeyDown;
+	// number of views drawn each frame, the camera view and
+	// the orthographic side views
+	int m_viewCount;
+	// view and projection of each view in the last frame
+	CAMERA_BLOCK m_cameraData;
+	// stereo output, the distance between the eyes and the
+	// layered target that the eyes are drawn into
+	STEREO_MODE m_stereoMode;
+	float m_eyeSeparation;
+	uint32_t m_stereoTarget;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// set the views of the left and the right eye
+	void PrepareStereoViews(RenderDevice::VIEWPORT* viewports);
 
 public:
 	// create the initial OpenGL display window
@@ -42,4 +68,28 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// set the performance overlay that the F1 key shows and hides
+	void SetPerformanceHud(PerformanceHud* pPerformanceHud) { m_pPerformanceHud = pPerformanceHud; }
+
+	// get the position and the view direction of the camera
+	void GetCameraPose(glm::vec3& position, glm::vec3& front) const;
+
+	// set the number of views drawn each frame, above one the
+	// camera view is drawn beside orthographic side views of
+	// the scene from the top and the front
+	void SetViewCount(int viewCount);
+	int GetViewCount() const { return(m_viewCount); }
+	// get the most views that can be drawn each frame
+	static int GetMaxViewCount();
+	// get the view and projection of each view in the frame
+	const CAMERA_BLOCK& GetCameraData() const { return(m_cameraData); }
+
+	// draw the scene once for both eyes, as two views that are
+	// offset by half the eye separation each way from the camera
+	void SetStereo(STEREO_MODE stereoMode, float eyeSeparation);
+	STEREO_MODE GetStereoMode() const { return(m_stereoMode); }
+	// finish the frame of the scene after it has been drawn,
+	// the layers of a stereo target are shown in the window
+	void FinishSceneView();
 };
\ No newline at end of file
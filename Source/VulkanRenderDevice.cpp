@@ -0,0 +1,2707 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderdevice.cpp
+// ============
+// render device backend that issues the commands to Vulkan
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VulkanRenderDevice.h"
+
+#ifdef ENABLE_VULKAN
+
+#include "Logger.h"
+
+#include "GLFW/glfw3.h"     // GLFW library
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+
+// declaration of global variables
+namespace
+{
+	// size of the per-frame uniform block ring buffer, each draw
+	// uses at most one aligned slot per uniform block
+	const VkDeviceSize UNIFORM_RING_SIZE = 16 * 1024 * 1024;
+
+	// limit on the recording worker threads, and the number of
+	// draws that makes handing a range to another thread worth it
+	const unsigned int MAX_RECORD_WORKERS = 7;
+	const size_t MIN_DRAWS_PER_CHUNK = 256;
+
+	const uint64_t WAIT_FOREVER = ~0ull;
+
+	// values for the fragment shader specialization constants,
+	// matching the constant_id layout in fragmentShader.glsl
+	struct SPECIALIZATION_DATA
+	{
+		int32_t activeLights;
+		VkBool32 bEnableLighting;
+		VkBool32 bEnableSpecular;
+	};
+
+	// push constant block of the fragment shader
+	struct DRAW_CONSTANTS
+	{
+		int32_t textureSlot;
+	};
+
+	// push constant block of the overlay vertex shader
+	struct OVERLAY_CONSTANTS
+	{
+		float screenSize[2];
+	};
+
+	// overlay vertices that can be drawn in one frame
+	const uint32_t OVERLAY_VERTEX_CAPACITY = 16384;
+
+	// SPIR-V binaries of the overlay shaders
+	const char* const OVERLAY_VERTEX_SHADER = "shaders/overlayVertexShader.vk.spv";
+	const char* const OVERLAY_FRAGMENT_SHADER = "shaders/overlayFragmentShader.vk.spv";
+
+	// size of each uniform block for the dynamic uniform buffer bindings
+	const VkDeviceSize BLOCK_SIZES[UNIFORM_BLOCK_COUNT] =
+	{
+		sizeof(CAMERA_BLOCK),
+		sizeof(LIGHT_BLOCK),
+		sizeof(MATERIAL_BLOCK),
+		sizeof(INSTANCE_BLOCK)
+	};
+}
+
+/***********************************************************
+ *  VulkanRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VulkanRenderDevice::VulkanRenderDevice(bool bPreferCpuDevice, bool bDisableVsync)
+{
+	m_bPreferCpuDevice = bPreferCpuDevice;
+	m_bDisableVsync = bDisableVsync;
+	m_pWindow = NULL;
+
+	m_instance = VK_NULL_HANDLE;
+	m_surface = VK_NULL_HANDLE;
+	m_physicalDevice = VK_NULL_HANDLE;
+	m_device = VK_NULL_HANDLE;
+	m_queue = VK_NULL_HANDLE;
+	m_queueFamily = 0;
+	m_memoryProperties = VkPhysicalDeviceMemoryProperties();
+	m_uniformAlignment = 256;
+
+	m_swapchain = VK_NULL_HANDLE;
+	m_swapchainFormat = VK_FORMAT_UNDEFINED;
+	m_swapchainExtent.width = 0;
+	m_swapchainExtent.height = 0;
+	m_depthImage = VK_NULL_HANDLE;
+	m_depthMemory = VK_NULL_HANDLE;
+	m_depthView = VK_NULL_HANDLE;
+	m_renderPass = VK_NULL_HANDLE;
+
+	m_blockSetLayout = VK_NULL_HANDLE;
+	m_textureSetLayout = VK_NULL_HANDLE;
+	m_pipelineLayout = VK_NULL_HANDLE;
+	m_pipelineCache = VK_NULL_HANDLE;
+	m_descriptorPool = VK_NULL_HANDLE;
+	m_sampler = VK_NULL_HANDLE;
+
+	m_overlaySetLayout = VK_NULL_HANDLE;
+	m_overlayPipelineLayout = VK_NULL_HANDLE;
+	m_overlayPipeline = VK_NULL_HANDLE;
+	m_bOverlayFailed = false;
+
+	m_timestampPool = VK_NULL_HANDLE;
+	m_timestampPeriod = 1.0;
+	m_timestampMask = ~0ull;
+	m_gpuMilliseconds = 0.0;
+	m_bGpuTimeValid = false;
+
+	for (int i = 0; i < TEXTURE_SLOTS; i++)
+	{
+		m_slotTextures[i] = 0;
+	}
+	m_defaultTexture = VK_TEXTURE();
+	for (int i = 0; i < MESH_COUNT; i++)
+	{
+		m_meshes[i] = VK_MESH();
+	}
+	m_uploadPool = VK_NULL_HANDLE;
+
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_frames[i].fence = VK_NULL_HANDLE;
+		m_frames[i].imageAvailable = VK_NULL_HANDLE;
+		m_frames[i].commandPool = VK_NULL_HANDLE;
+		m_frames[i].primaryCommands = VK_NULL_HANDLE;
+		m_frames[i].uniformRing = VK_BUFFER();
+		m_frames[i].ringOffset = 0;
+		m_frames[i].blockSet = VK_NULL_HANDLE;
+		m_frames[i].textureSet = VK_NULL_HANDLE;
+		m_frames[i].bTexturesDirty = true;
+		m_frames[i].overlayVertices = VK_BUFFER();
+		m_frames[i].overlayVertexCount = 0;
+		m_frames[i].overlaySet = VK_NULL_HANDLE;
+		m_frames[i].overlayTexture = 0;
+		m_frames[i].overlayCommands = VK_NULL_HANDLE;
+		m_frames[i].bTimestampsWritten = false;
+	}
+	m_frameIndex = 0;
+	m_bFrameStarted = false;
+
+	m_boundPipeline = 0;
+	m_textureSlot = 0;
+	m_cameraBlock = CAMERA_BLOCK();
+	m_lightBlock = LIGHT_BLOCK();
+	m_materialBlock = MATERIAL_BLOCK();
+	m_instanceBlock = INSTANCE_BLOCK();
+	for (int i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		m_blockDirty[i] = true;
+		m_blockOffsets[i] = 0;
+	}
+
+	m_workerGeneration = 0;
+	m_workersPending = 0;
+	m_recordChunks = 0;
+	m_recordImageIndex = 0;
+	m_bWorkersExit = false;
+}
+
+/***********************************************************
+ *  ~VulkanRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VulkanRenderDevice::~VulkanRenderDevice()
+{
+	StopWorkers();
+
+	if (VK_NULL_HANDLE != m_device)
+	{
+		vkDeviceWaitIdle(m_device);
+
+		for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+		{
+			FRAME_RESOURCES& frame = m_frames[i];
+
+			for (size_t j = 0; j < frame.recordPools.size(); j++)
+			{
+				vkDestroyCommandPool(m_device, frame.recordPools[j], NULL);
+			}
+			frame.recordPools.clear();
+			frame.recordCommands.clear();
+			vkDestroyCommandPool(m_device, frame.commandPool, NULL);
+			vkDestroyFence(m_device, frame.fence, NULL);
+			vkDestroySemaphore(m_device, frame.imageAvailable, NULL);
+			DestroyBuffer(frame.uniformRing);
+			DestroyBuffer(frame.overlayVertices);
+		}
+
+		for (int i = 0; i < MESH_COUNT; i++)
+		{
+			DestroyBuffer(m_meshes[i].vertexBuffer);
+			DestroyBuffer(m_meshes[i].indexBuffer);
+		}
+		for (size_t i = 0; i < m_textures.size(); i++)
+		{
+			DestroyDeviceTexture(m_textures[i]);
+		}
+		m_textures.clear();
+		DestroyDeviceTexture(m_defaultTexture);
+
+		for (size_t i = 0; i < m_pipelines.size(); i++)
+		{
+			vkDestroyPipeline(m_device, m_pipelines[i].pipeline, NULL);
+		}
+		m_pipelines.clear();
+
+		vkDestroyPipeline(m_device, m_overlayPipeline, NULL);
+		vkDestroyPipelineLayout(m_device, m_overlayPipelineLayout, NULL);
+		vkDestroyDescriptorSetLayout(m_device, m_overlaySetLayout, NULL);
+		vkDestroyQueryPool(m_device, m_timestampPool, NULL);
+
+		vkDestroySampler(m_device, m_sampler, NULL);
+		vkDestroyDescriptorPool(m_device, m_descriptorPool, NULL);
+		vkDestroyPipelineCache(m_device, m_pipelineCache, NULL);
+		vkDestroyPipelineLayout(m_device, m_pipelineLayout, NULL);
+		vkDestroyDescriptorSetLayout(m_device, m_textureSetLayout, NULL);
+		vkDestroyDescriptorSetLayout(m_device, m_blockSetLayout, NULL);
+
+		DestroySwapchain();
+		vkDestroyRenderPass(m_device, m_renderPass, NULL);
+		vkDestroyCommandPool(m_device, m_uploadPool, NULL);
+		vkDestroyDevice(m_device, NULL);
+		m_device = VK_NULL_HANDLE;
+	}
+
+	if (VK_NULL_HANDLE != m_instance)
+	{
+		vkDestroySurfaceKHR(m_instance, m_surface, NULL);
+		vkDestroyInstance(m_instance, NULL);
+		m_instance = VK_NULL_HANDLE;
+	}
+
+	m_pWindow = NULL;
+}
+
+/***********************************************************
+ *  SetWindow()
+ *
+ *  This method is used for setting the window that the
+ *  swapchain presents to.
+ ***********************************************************/
+void VulkanRenderDevice::SetWindow(GLFWwindow* pWindow)
+{
+	m_pWindow = pWindow;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the Vulkan instance,
+ *  device, swapchain and the objects shared by all of the
+ *  pipelines.
+ ***********************************************************/
+bool VulkanRenderDevice::Initialize()
+{
+	if (NULL == m_pWindow)
+	{
+		LOG_ERROR("the Vulkan device needs a window to present to");
+		return(false);
+	}
+
+	if (glfwVulkanSupported() == GLFW_FALSE)
+	{
+		LOG_ERROR("no Vulkan loader was found");
+		return(false);
+	}
+
+	if (CreateInstance() == false)
+	{
+		return(false);
+	}
+
+	if (glfwCreateWindowSurface(m_instance, m_pWindow, NULL, &m_surface) != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create the Vulkan window surface");
+		return(false);
+	}
+
+	if ((SelectPhysicalDevice() == false) ||
+		(CreateLogicalDevice() == false) ||
+		(CreateRenderPass() == false) ||
+		(CreateSwapchain() == false) ||
+		(CreateDescriptorLayouts() == false))
+	{
+		return(false);
+	}
+
+	// unbound texture slots sample a white texture
+	const unsigned char whitePixel[4] = { 255, 255, 255, 255 };
+	if (CreateDeviceTexture(1, 1, whitePixel, m_defaultTexture) == false)
+	{
+		return(false);
+	}
+
+	if (CreateFrameResources() == false)
+	{
+		return(false);
+	}
+
+	// the GPU frame time is optional, so the device is usable
+	// on queues without timestamp support
+	if (CreateTimestampQueries() == false)
+	{
+		LOG_WARNING("GPU frame times are not available on this Vulkan device");
+	}
+
+	StartWorkers();
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateInstance()
+ *
+ *  This method is used for creating the Vulkan instance with
+ *  the extensions that GLFW needs for the window surface.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateInstance()
+{
+	uint32_t extensionCount = 0;
+	const char** extensions = glfwGetRequiredInstanceExtensions(&extensionCount);
+	std::vector<const char*> layers;
+
+#ifdef _DEBUG
+	// enable the validation layer in debug builds when it is installed
+	uint32_t layerCount = 0;
+	vkEnumerateInstanceLayerProperties(&layerCount, NULL);
+	std::vector<VkLayerProperties> availableLayers(layerCount);
+	vkEnumerateInstanceLayerProperties(&layerCount, availableLayers.data());
+	for (uint32_t i = 0; i < layerCount; i++)
+	{
+		if (strcmp(availableLayers[i].layerName, "VK_LAYER_KHRONOS_validation") == 0)
+		{
+			layers.push_back("VK_LAYER_KHRONOS_validation");
+		}
+	}
+#endif
+
+	VkApplicationInfo appInfo = {};
+	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	appInfo.pApplicationName = "7-1 FinalProject and Milestones";
+	appInfo.applicationVersion = 1;
+	appInfo.apiVersion = VK_API_VERSION_1_1;
+
+	VkInstanceCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	createInfo.pApplicationInfo = &appInfo;
+	createInfo.enabledExtensionCount = extensionCount;
+	createInfo.ppEnabledExtensionNames = extensions;
+	createInfo.enabledLayerCount = (uint32_t)layers.size();
+	createInfo.ppEnabledLayerNames = layers.empty() ? NULL : layers.data();
+
+	if (vkCreateInstance(&createInfo, NULL, &m_instance) != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create the Vulkan instance");
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SelectPhysicalDevice()
+ *
+ *  This method is used for choosing the physical device and
+ *  queue family that can render and present to the window.
+ *  Discrete GPUs are preferred, unless a CPU implementation
+ *  was requested for testing without a GPU.
+ ***********************************************************/
+bool VulkanRenderDevice::SelectPhysicalDevice()
+{
+	uint32_t deviceCount = 0;
+	int bestScore = -1;
+
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, NULL);
+	std::vector<VkPhysicalDevice> devices(deviceCount);
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+
+	for (uint32_t i = 0; i < deviceCount; i++)
+	{
+		VkPhysicalDeviceProperties properties;
+		VkPhysicalDeviceFeatures features;
+		vkGetPhysicalDeviceProperties(devices[i], &properties);
+		vkGetPhysicalDeviceFeatures(devices[i], &features);
+
+		// the texture table is indexed with a push constant
+		if ((properties.apiVersion < VK_API_VERSION_1_1) ||
+			(features.shaderSampledImageArrayDynamicIndexing == VK_FALSE))
+		{
+			continue;
+		}
+
+		// the swapchain extension is required for presenting
+		uint32_t extensionCount = 0;
+		bool bSwapchain = false;
+		vkEnumerateDeviceExtensionProperties(devices[i], NULL, &extensionCount, NULL);
+		std::vector<VkExtensionProperties> extensions(extensionCount);
+		vkEnumerateDeviceExtensionProperties(devices[i], NULL, &extensionCount, extensions.data());
+		for (uint32_t j = 0; j < extensionCount; j++)
+		{
+			if (strcmp(extensions[j].extensionName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
+			{
+				bSwapchain = true;
+			}
+		}
+		if (bSwapchain == false)
+		{
+			continue;
+		}
+
+		// one queue family has to support both graphics and present
+		uint32_t familyCount = 0;
+		int queueFamily = -1;
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount, NULL);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount, families.data());
+		for (uint32_t j = 0; (j < familyCount) && (queueFamily < 0); j++)
+		{
+			VkBool32 bPresent = VK_FALSE;
+			vkGetPhysicalDeviceSurfaceSupportKHR(devices[i], j, m_surface, &bPresent);
+			if ((families[j].queueFlags & VK_QUEUE_GRAPHICS_BIT) && (bPresent == VK_TRUE))
+			{
+				queueFamily = (int)j;
+			}
+		}
+		if (queueFamily < 0)
+		{
+			continue;
+		}
+
+		int score = 0;
+		switch (properties.deviceType)
+		{
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+			score = 3;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+			score = 2;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+			score = 1;
+			break;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU:
+			score = m_bPreferCpuDevice ? 4 : 0;
+			break;
+		default:
+			break;
+		}
+
+		if (score > bestScore)
+		{
+			bestScore = score;
+			m_physicalDevice = devices[i];
+			m_queueFamily = (uint32_t)queueFamily;
+			m_uniformAlignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 16);
+		}
+	}
+
+	if (VK_NULL_HANDLE == m_physicalDevice)
+	{
+		LOG_ERROR("no Vulkan device can render to the window");
+		return(false);
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+	LOG_INFO("Vulkan device", "name", properties.deviceName);
+	m_adapterName = std::string(properties.deviceName) + " driver " + std::to_string(properties.driverVersion);
+
+	// use an 8 bit UNORM format to match the OpenGL default framebuffer
+	uint32_t formatCount = 0;
+	vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &formatCount, NULL);
+	std::vector<VkSurfaceFormatKHR> formats(formatCount);
+	vkGetPhysicalDeviceSurfaceFormatsKHR(m_physicalDevice, m_surface, &formatCount, formats.data());
+	if (formatCount == 0)
+	{
+		LOG_ERROR("the window surface has no formats");
+		return(false);
+	}
+	m_swapchainFormat = formats[0].format;
+	for (uint32_t i = 0; i < formatCount; i++)
+	{
+		if ((formats[i].format == VK_FORMAT_B8G8R8A8_UNORM) ||
+			(formats[i].format == VK_FORMAT_R8G8B8A8_UNORM))
+		{
+			m_swapchainFormat = formats[i].format;
+			break;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateLogicalDevice()
+ *
+ *  This method is used for creating the logical device and
+ *  the command pool used for uploading resources.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateLogicalDevice()
+{
+	float queuePriority = 1.0f;
+	const char* extensions[] = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+
+	VkDeviceQueueCreateInfo queueInfo = {};
+	queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueInfo.queueFamilyIndex = m_queueFamily;
+	queueInfo.queueCount = 1;
+	queueInfo.pQueuePriorities = &queuePriority;
+
+	VkPhysicalDeviceFeatures features = {};
+	features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+	VkDeviceCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.queueCreateInfoCount = 1;
+	createInfo.pQueueCreateInfos = &queueInfo;
+	createInfo.enabledExtensionCount = 1;
+	createInfo.ppEnabledExtensionNames = extensions;
+	createInfo.pEnabledFeatures = &features;
+
+	if (vkCreateDevice(m_physicalDevice, &createInfo, NULL, &m_device) != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create the Vulkan device");
+		return(false);
+	}
+	vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = m_queueFamily;
+	if (vkCreateCommandPool(m_device, &poolInfo, NULL, &m_uploadPool) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateRenderPass()
+ *
+ *  This method is used for creating the render pass that
+ *  clears and draws into the swapchain image and the depth
+ *  buffer.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateRenderPass()
+{
+	VkAttachmentDescription attachments[2] = {};
+
+	attachments[0].format = m_swapchainFormat;
+	attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+	attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[0].finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	attachments[1].format = VK_FORMAT_D32_SFLOAT;
+	attachments[1].samples = VK_SAMPLE_COUNT_1_BIT;
+	attachments[1].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	attachments[1].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	attachments[1].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorReference;
+	subpass.pDepthStencilAttachment = &depthReference;
+
+	// wait for the previous frame's writes to the shared depth
+	// buffer and for the swapchain image to be acquired
+	VkSubpassDependency dependency = {};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	createInfo.attachmentCount = 2;
+	createInfo.pAttachments = attachments;
+	createInfo.subpassCount = 1;
+	createInfo.pSubpasses = &subpass;
+	createInfo.dependencyCount = 1;
+	createInfo.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(m_device, &createInfo, NULL, &m_renderPass) != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create the Vulkan render pass");
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateSwapchain()
+ *
+ *  This method is used for creating the swapchain for the
+ *  current window size, along with the depth buffer and the
+ *  framebuffers.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateSwapchain()
+{
+	VkSurfaceCapabilitiesKHR capabilities;
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_physicalDevice, m_surface, &capabilities);
+
+	m_swapchainExtent = capabilities.currentExtent;
+	if (m_swapchainExtent.width == 0xFFFFFFFF)
+	{
+		int width = 0;
+		int height = 0;
+		glfwGetFramebufferSize(m_pWindow, &width, &height);
+		m_swapchainExtent.width = std::max(capabilities.minImageExtent.width,
+			std::min(capabilities.maxImageExtent.width, (uint32_t)width));
+		m_swapchainExtent.height = std::max(capabilities.minImageExtent.height,
+			std::min(capabilities.maxImageExtent.height, (uint32_t)height));
+	}
+
+	// a minimized window has no area to render to
+	if ((m_swapchainExtent.width == 0) || (m_swapchainExtent.height == 0))
+	{
+		return(false);
+	}
+
+	// present without waiting for the vertical blank when measuring
+	VkPresentModeKHR presentMode = VK_PRESENT_MODE_FIFO_KHR;
+	if (m_bDisableVsync)
+	{
+		uint32_t modeCount = 0;
+		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &modeCount, NULL);
+		std::vector<VkPresentModeKHR> modes(modeCount);
+		vkGetPhysicalDeviceSurfacePresentModesKHR(m_physicalDevice, m_surface, &modeCount, modes.data());
+		for (uint32_t i = 0; i < modeCount; i++)
+		{
+			if (modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR)
+			{
+				presentMode = modes[i];
+				break;
+			}
+			if (modes[i] == VK_PRESENT_MODE_MAILBOX_KHR)
+			{
+				presentMode = modes[i];
+			}
+		}
+	}
+
+	uint32_t imageCount = capabilities.minImageCount + 1;
+	if ((capabilities.maxImageCount > 0) && (imageCount > capabilities.maxImageCount))
+	{
+		imageCount = capabilities.maxImageCount;
+	}
+
+	VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	if ((capabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) == 0)
+	{
+		compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+	}
+
+	VkSwapchainCreateInfoKHR createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+	createInfo.surface = m_surface;
+	createInfo.minImageCount = imageCount;
+	createInfo.imageFormat = m_swapchainFormat;
+	createInfo.imageColorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+	createInfo.imageExtent = m_swapchainExtent;
+	createInfo.imageArrayLayers = 1;
+	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	createInfo.preTransform = capabilities.currentTransform;
+	createInfo.compositeAlpha = compositeAlpha;
+	createInfo.presentMode = presentMode;
+	createInfo.clipped = VK_TRUE;
+
+	if (vkCreateSwapchainKHR(m_device, &createInfo, NULL, &m_swapchain) != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create the Vulkan swapchain");
+		return(false);
+	}
+
+	vkGetSwapchainImagesKHR(m_device, m_swapchain, &imageCount, NULL);
+	m_swapchainImages.resize(imageCount);
+	vkGetSwapchainImagesKHR(m_device, m_swapchain, &imageCount, m_swapchainImages.data());
+
+	if (CreateImage(
+		m_swapchainExtent.width,
+		m_swapchainExtent.height,
+		VK_FORMAT_D32_SFLOAT,
+		VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+		VK_IMAGE_ASPECT_DEPTH_BIT,
+		m_depthImage,
+		m_depthMemory,
+		m_depthView) == false)
+	{
+		return(false);
+	}
+
+	m_swapchainViews.resize(imageCount, VK_NULL_HANDLE);
+	m_framebuffers.resize(imageCount, VK_NULL_HANDLE);
+	m_renderFinished.resize(imageCount, VK_NULL_HANDLE);
+	for (uint32_t i = 0; i < imageCount; i++)
+	{
+		VkImageViewCreateInfo viewInfo = {};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = m_swapchainImages[i];
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = m_swapchainFormat;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.levelCount = 1;
+		viewInfo.subresourceRange.layerCount = 1;
+		if (vkCreateImageView(m_device, &viewInfo, NULL, &m_swapchainViews[i]) != VK_SUCCESS)
+		{
+			return(false);
+		}
+
+		VkImageView views[2] = { m_swapchainViews[i], m_depthView };
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_renderPass;
+		framebufferInfo.attachmentCount = 2;
+		framebufferInfo.pAttachments = views;
+		framebufferInfo.width = m_swapchainExtent.width;
+		framebufferInfo.height = m_swapchainExtent.height;
+		framebufferInfo.layers = 1;
+		if (vkCreateFramebuffer(m_device, &framebufferInfo, NULL, &m_framebuffers[i]) != VK_SUCCESS)
+		{
+			return(false);
+		}
+
+		// the render finished semaphore is tied to the swapchain
+		// image, since it is only free again once that image is
+		// presented and acquired
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		if (vkCreateSemaphore(m_device, &semaphoreInfo, NULL, &m_renderFinished[i]) != VK_SUCCESS)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroySwapchain()
+ *
+ *  This method is used for freeing the swapchain and the
+ *  render targets that depend on the window size.
+ ***********************************************************/
+void VulkanRenderDevice::DestroySwapchain()
+{
+	for (size_t i = 0; i < m_framebuffers.size(); i++)
+	{
+		vkDestroyFramebuffer(m_device, m_framebuffers[i], NULL);
+		vkDestroyImageView(m_device, m_swapchainViews[i], NULL);
+		vkDestroySemaphore(m_device, m_renderFinished[i], NULL);
+	}
+	m_framebuffers.clear();
+	m_swapchainViews.clear();
+	m_renderFinished.clear();
+	m_swapchainImages.clear();
+
+	vkDestroyImageView(m_device, m_depthView, NULL);
+	vkDestroyImage(m_device, m_depthImage, NULL);
+	vkFreeMemory(m_device, m_depthMemory, NULL);
+	m_depthView = VK_NULL_HANDLE;
+	m_depthImage = VK_NULL_HANDLE;
+	m_depthMemory = VK_NULL_HANDLE;
+
+	vkDestroySwapchainKHR(m_device, m_swapchain, NULL);
+	m_swapchain = VK_NULL_HANDLE;
+}
+
+/***********************************************************
+ *  RecreateSwapchain()
+ *
+ *  This method is used for rebuilding the swapchain after
+ *  the window has been resized.
+ ***********************************************************/
+bool VulkanRenderDevice::RecreateSwapchain()
+{
+	vkDeviceWaitIdle(m_device);
+	DestroySwapchain();
+
+	return(CreateSwapchain());
+}
+
+/***********************************************************
+ *  CreateDescriptorLayouts()
+ *
+ *  This method is used for creating the descriptor set and
+ *  pipeline layouts shared by all of the shader variants.
+ *  Set 0 holds the uniform blocks as dynamic uniform buffers
+ *  in the per-frame ring buffer, and set 1 holds the texture
+ *  table, which is indexed with a push constant.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateDescriptorLayouts()
+{
+	VkDescriptorSetLayoutBinding blockBindings[UNIFORM_BLOCK_COUNT] = {};
+	for (uint32_t i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		blockBindings[i].binding = i;
+		blockBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		blockBindings[i].descriptorCount = 1;
+		blockBindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo blockLayoutInfo = {};
+	blockLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	blockLayoutInfo.bindingCount = UNIFORM_BLOCK_COUNT;
+	blockLayoutInfo.pBindings = blockBindings;
+	if (vkCreateDescriptorSetLayout(m_device, &blockLayoutInfo, NULL, &m_blockSetLayout) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkDescriptorSetLayoutBinding textureBinding = {};
+	textureBinding.binding = 0;
+	textureBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	textureBinding.descriptorCount = TEXTURE_SLOTS;
+	textureBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkDescriptorSetLayoutCreateInfo textureLayoutInfo = {};
+	textureLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	textureLayoutInfo.bindingCount = 1;
+	textureLayoutInfo.pBindings = &textureBinding;
+	if (vkCreateDescriptorSetLayout(m_device, &textureLayoutInfo, NULL, &m_textureSetLayout) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkDescriptorSetLayout setLayouts[2] = { m_blockSetLayout, m_textureSetLayout };
+	VkPushConstantRange pushRange = {};
+	pushRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushRange.offset = 0;
+	pushRange.size = sizeof(DRAW_CONSTANTS);
+
+	VkPipelineLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.setLayoutCount = 2;
+	layoutInfo.pSetLayouts = setLayouts;
+	layoutInfo.pushConstantRangeCount = 1;
+	layoutInfo.pPushConstantRanges = &pushRange;
+	if (vkCreatePipelineLayout(m_device, &layoutInfo, NULL, &m_pipelineLayout) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	// the overlay samples a single texture, and is positioned
+	// with the window size passed as a push constant
+	VkDescriptorSetLayoutBinding overlayBinding = {};
+	overlayBinding.binding = 0;
+	overlayBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	overlayBinding.descriptorCount = 1;
+	overlayBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+	VkDescriptorSetLayoutCreateInfo overlayLayoutInfo = {};
+	overlayLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	overlayLayoutInfo.bindingCount = 1;
+	overlayLayoutInfo.pBindings = &overlayBinding;
+	if (vkCreateDescriptorSetLayout(m_device, &overlayLayoutInfo, NULL, &m_overlaySetLayout) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkPushConstantRange overlayPushRange = {};
+	overlayPushRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	overlayPushRange.offset = 0;
+	overlayPushRange.size = sizeof(OVERLAY_CONSTANTS);
+
+	VkPipelineLayoutCreateInfo overlayPipelineLayoutInfo = {};
+	overlayPipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	overlayPipelineLayoutInfo.setLayoutCount = 1;
+	overlayPipelineLayoutInfo.pSetLayouts = &m_overlaySetLayout;
+	overlayPipelineLayoutInfo.pushConstantRangeCount = 1;
+	overlayPipelineLayoutInfo.pPushConstantRanges = &overlayPushRange;
+	if (vkCreatePipelineLayout(m_device, &overlayPipelineLayoutInfo, NULL, &m_overlayPipelineLayout) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkPipelineCacheCreateInfo cacheInfo = {};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	if (vkCreatePipelineCache(m_device, &cacheInfo, NULL, &m_pipelineCache) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkDescriptorPoolSize poolSizes[2] = {};
+	poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSizes[0].descriptorCount = UNIFORM_BLOCK_COUNT * FRAMES_IN_FLIGHT;
+	poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSizes[1].descriptorCount = (TEXTURE_SLOTS + 1) * FRAMES_IN_FLIGHT;
+
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = 3 * FRAMES_IN_FLIGHT;
+	poolInfo.poolSizeCount = 2;
+	poolInfo.pPoolSizes = poolSizes;
+	if (vkCreateDescriptorPool(m_device, &poolInfo, NULL, &m_descriptorPool) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	// same sampling as the OpenGL textures - linear with repeat
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = VK_FILTER_LINEAR;
+	samplerInfo.minFilter = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+	samplerInfo.maxLod = 0.0f;
+	if (vkCreateSampler(m_device, &samplerInfo, NULL, &m_sampler) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateFrameResources()
+ *
+ *  This method is used for creating the synchronization
+ *  objects, command buffers, uniform ring buffer and the
+ *  descriptor sets for each frame in flight.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateFrameResources()
+{
+	unsigned int cores = std::thread::hardware_concurrency();
+	unsigned int workerCount = (cores > 1) ? std::min(cores - 1, MAX_RECORD_WORKERS) : 0;
+
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		FRAME_RESOURCES& frame = m_frames[i];
+
+		// the fence starts signaled since the frame is not in use
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+		semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		if ((vkCreateFence(m_device, &fenceInfo, NULL, &frame.fence) != VK_SUCCESS) ||
+			(vkCreateSemaphore(m_device, &semaphoreInfo, NULL, &frame.imageAvailable) != VK_SUCCESS))
+		{
+			return(false);
+		}
+
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = m_queueFamily;
+		if (vkCreateCommandPool(m_device, &poolInfo, NULL, &frame.commandPool) != VK_SUCCESS)
+		{
+			return(false);
+		}
+
+		VkCommandBufferAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool = frame.commandPool;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(m_device, &allocateInfo, &frame.primaryCommands) != VK_SUCCESS)
+		{
+			return(false);
+		}
+
+		// the overlay is recorded by the main thread after the draws
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		if (vkAllocateCommandBuffers(m_device, &allocateInfo, &frame.overlayCommands) != VK_SUCCESS)
+		{
+			return(false);
+		}
+
+		// command pools are not thread safe, so every recording
+		// thread - the main thread and the workers - has its own
+		frame.recordPools.resize(workerCount + 1, VK_NULL_HANDLE);
+		frame.recordCommands.resize(workerCount + 1, VK_NULL_HANDLE);
+		for (unsigned int j = 0; j <= workerCount; j++)
+		{
+			if (vkCreateCommandPool(m_device, &poolInfo, NULL, &frame.recordPools[j]) != VK_SUCCESS)
+			{
+				return(false);
+			}
+
+			allocateInfo.commandPool = frame.recordPools[j];
+			allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			if (vkAllocateCommandBuffers(m_device, &allocateInfo, &frame.recordCommands[j]) != VK_SUCCESS)
+			{
+				return(false);
+			}
+		}
+
+		if (CreateBuffer(
+			UNIFORM_RING_SIZE,
+			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			frame.uniformRing) == false)
+		{
+			return(false);
+		}
+
+		if (CreateBuffer(
+			OVERLAY_VERTEX_CAPACITY * sizeof(OVERLAY_VERTEX),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			frame.overlayVertices) == false)
+		{
+			return(false);
+		}
+
+		VkDescriptorSetLayout setLayouts[3] = { m_blockSetLayout, m_textureSetLayout, m_overlaySetLayout };
+		VkDescriptorSet sets[3] = { VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE };
+		VkDescriptorSetAllocateInfo setInfo = {};
+		setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		setInfo.descriptorPool = m_descriptorPool;
+		setInfo.descriptorSetCount = 3;
+		setInfo.pSetLayouts = setLayouts;
+		if (vkAllocateDescriptorSets(m_device, &setInfo, sets) != VK_SUCCESS)
+		{
+			return(false);
+		}
+		frame.blockSet = sets[0];
+		frame.textureSet = sets[1];
+		frame.overlaySet = sets[2];
+
+		// the block bindings all view the ring buffer, and the
+		// offsets of the blocks are passed when drawing
+		VkDescriptorBufferInfo bufferInfos[UNIFORM_BLOCK_COUNT];
+		VkWriteDescriptorSet writes[UNIFORM_BLOCK_COUNT] = {};
+		for (uint32_t j = 0; j < UNIFORM_BLOCK_COUNT; j++)
+		{
+			bufferInfos[j].buffer = frame.uniformRing.buffer;
+			bufferInfos[j].offset = 0;
+			bufferInfos[j].range = BLOCK_SIZES[j];
+
+			writes[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[j].dstSet = frame.blockSet;
+			writes[j].dstBinding = j;
+			writes[j].descriptorCount = 1;
+			writes[j].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			writes[j].pBufferInfo = &bufferInfos[j];
+		}
+		vkUpdateDescriptorSets(m_device, UNIFORM_BLOCK_COUNT, writes, 0, NULL);
+
+		WriteTextureSet(frame);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateTimestampQueries()
+ *
+ *  This method is used for creating the query pool for the
+ *  timestamps written at the start and end of each frame,
+ *  when the queue supports timestamps.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateTimestampQueries()
+{
+	VkPhysicalDeviceProperties properties;
+	uint32_t familyCount = 0;
+
+	vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+	vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, NULL);
+	std::vector<VkQueueFamilyProperties> families(familyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, families.data());
+
+	uint32_t validBits = (m_queueFamily < familyCount) ? families[m_queueFamily].timestampValidBits : 0;
+	if ((validBits == 0) || (properties.limits.timestampPeriod <= 0.0f))
+	{
+		return(false);
+	}
+
+	m_timestampPeriod = properties.limits.timestampPeriod;
+	m_timestampMask = (validBits >= 64) ? ~0ull : ((1ull << validBits) - 1);
+
+	VkQueryPoolCreateInfo queryInfo = {};
+	queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryInfo.queryCount = 2 * FRAMES_IN_FLIGHT;
+	if (vkCreateQueryPool(m_device, &queryInfo, NULL, &m_timestampPool) != VK_SUCCESS)
+	{
+		m_timestampPool = VK_NULL_HANDLE;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMemoryType()
+ *
+ *  This method is used for finding a memory type that is
+ *  allowed by the type bits and has the passed in properties.
+ ***********************************************************/
+bool VulkanRenderDevice::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& typeIndex)
+{
+	for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+	{
+		if ((typeBits & (1u << i)) &&
+			((m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
+		{
+			typeIndex = i;
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a buffer and binding new
+ *  memory to it.  Host visible buffers are left mapped.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateBuffer(
+	VkDeviceSize size,
+	VkBufferUsageFlags usage,
+	VkMemoryPropertyFlags properties,
+	VK_BUFFER& buffer)
+{
+	buffer = VK_BUFFER();
+	buffer.size = size;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(m_device, &bufferInfo, NULL, &buffer.buffer) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, buffer.buffer, &requirements);
+
+	VkMemoryAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = requirements.size;
+	if ((FindMemoryType(requirements.memoryTypeBits, properties, allocateInfo.memoryTypeIndex) == false) ||
+		(vkAllocateMemory(m_device, &allocateInfo, NULL, &buffer.memory) != VK_SUCCESS))
+	{
+		LOG_ERROR("could not allocate the buffer memory", "bytes", (uint64_t)size);
+		DestroyBuffer(buffer);
+		return(false);
+	}
+	vkBindBufferMemory(m_device, buffer.buffer, buffer.memory, 0);
+
+	if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+	{
+		vkMapMemory(m_device, buffer.memory, 0, size, 0, &buffer.pMapped);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for freeing a buffer and its memory.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyBuffer(VK_BUFFER& buffer)
+{
+	if (VK_NULL_HANDLE != buffer.memory)
+	{
+		if (NULL != buffer.pMapped)
+		{
+			vkUnmapMemory(m_device, buffer.memory);
+		}
+		vkFreeMemory(m_device, buffer.memory, NULL);
+	}
+	if (VK_NULL_HANDLE != buffer.buffer)
+	{
+		vkDestroyBuffer(m_device, buffer.buffer, NULL);
+	}
+	buffer = VK_BUFFER();
+}
+
+/***********************************************************
+ *  CreateImage()
+ *
+ *  This method is used for creating a 2D image in device
+ *  local memory along with a view of it.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateImage(
+	uint32_t width,
+	uint32_t height,
+	VkFormat format,
+	VkImageUsageFlags usage,
+	VkImageAspectFlags aspect,
+	VkImage& image,
+	VkDeviceMemory& memory,
+	VkImageView& view)
+{
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = format;
+	imageInfo.extent.width = width;
+	imageInfo.extent.height = height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = usage;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	if (vkCreateImage(m_device, &imageInfo, NULL, &image) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(m_device, image, &requirements);
+
+	VkMemoryAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = requirements.size;
+	if ((FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocateInfo.memoryTypeIndex) == false) ||
+		(vkAllocateMemory(m_device, &allocateInfo, NULL, &memory) != VK_SUCCESS))
+	{
+		LOG_ERROR("could not allocate the image memory");
+		return(false);
+	}
+	vkBindImageMemory(m_device, image, memory, 0);
+
+	VkImageViewCreateInfo viewInfo = {};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format;
+	viewInfo.subresourceRange.aspectMask = aspect;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+	if (vkCreateImageView(m_device, &viewInfo, NULL, &view) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BeginUploadCommands()
+ *
+ *  This method is used for starting a command buffer for
+ *  copying resource data to the device.
+ ***********************************************************/
+VkCommandBuffer VulkanRenderDevice::BeginUploadCommands()
+{
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = m_uploadPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	return(commandBuffer);
+}
+
+/***********************************************************
+ *  EndUploadCommands()
+ *
+ *  This method is used for submitting the upload commands
+ *  and waiting for them to finish.
+ ***********************************************************/
+void VulkanRenderDevice::EndUploadCommands(VkCommandBuffer commandBuffer)
+{
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(m_queue);
+
+	vkFreeCommandBuffers(m_device, m_uploadPool, 1, &commandBuffer);
+}
+
+/***********************************************************
+ *  UploadBuffer()
+ *
+ *  This method is used for creating a device local buffer
+ *  and copying the passed in data into it.
+ ***********************************************************/
+bool VulkanRenderDevice::UploadBuffer(
+	const void* data,
+	VkDeviceSize size,
+	VkBufferUsageFlags usage,
+	VK_BUFFER& buffer)
+{
+	VK_BUFFER staging;
+
+	if (CreateBuffer(
+		size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		staging) == false)
+	{
+		return(false);
+	}
+	memcpy(staging.pMapped, data, (size_t)size);
+
+	if (CreateBuffer(
+		size,
+		usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		buffer) == false)
+	{
+		DestroyBuffer(staging);
+		return(false);
+	}
+
+	VkCommandBuffer commandBuffer = BeginUploadCommands();
+	VkBufferCopy region = {};
+	region.size = size;
+	vkCmdCopyBuffer(commandBuffer, staging.buffer, buffer.buffer, 1, &region);
+	EndUploadCommands(commandBuffer);
+
+	DestroyBuffer(staging);
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateDeviceTexture()
+ *
+ *  This method is used for creating a sampled image from
+ *  RGBA pixel data.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateDeviceTexture(
+	uint32_t width,
+	uint32_t height,
+	const unsigned char* rgbaPixels,
+	VK_TEXTURE& texture)
+{
+	VK_BUFFER staging;
+	VkDeviceSize size = (VkDeviceSize)width * height * 4;
+
+	texture = VK_TEXTURE();
+
+	if (CreateBuffer(
+		size,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		staging) == false)
+	{
+		return(false);
+	}
+	memcpy(staging.pMapped, rgbaPixels, (size_t)size);
+
+	if (CreateImage(
+		width,
+		height,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+		VK_IMAGE_ASPECT_COLOR_BIT,
+		texture.image,
+		texture.memory,
+		texture.view) == false)
+	{
+		DestroyBuffer(staging);
+		DestroyDeviceTexture(texture);
+		return(false);
+	}
+
+	VkCommandBuffer commandBuffer = BeginUploadCommands();
+
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+		0, 0, NULL, 0, NULL, 1, &barrier);
+
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent.width = width;
+	region.imageExtent.height = height;
+	region.imageExtent.depth = 1;
+	vkCmdCopyBufferToImage(commandBuffer, staging.buffer, texture.image,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	vkCmdPipelineBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		0, 0, NULL, 0, NULL, 1, &barrier);
+
+	EndUploadCommands(commandBuffer);
+	DestroyBuffer(staging);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyDeviceTexture()
+ *
+ *  This method is used for freeing a sampled image.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyDeviceTexture(VK_TEXTURE& texture)
+{
+	if (VK_NULL_HANDLE != texture.view)
+	{
+		vkDestroyImageView(m_device, texture.view, NULL);
+	}
+	if (VK_NULL_HANDLE != texture.image)
+	{
+		vkDestroyImage(m_device, texture.image, NULL);
+	}
+	if (VK_NULL_HANDLE != texture.memory)
+	{
+		vkFreeMemory(m_device, texture.memory, NULL);
+	}
+	texture = VK_TEXTURE();
+}
+
+/***********************************************************
+ *  LoadShaderModule()
+ *
+ *  This method is used for reading a SPIR-V binary file and
+ *  creating a shader module from it.
+ ***********************************************************/
+VkShaderModule VulkanRenderDevice::LoadShaderModule(const char* filename)
+{
+	VkShaderModule shaderModule = VK_NULL_HANDLE;
+
+	if (NULL == filename)
+	{
+		return(VK_NULL_HANDLE);
+	}
+
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		LOG_ERROR("could not open the shader binary", "file", filename);
+		return(VK_NULL_HANDLE);
+	}
+
+	std::streamsize size = file.tellg();
+	if ((size <= 0) || ((size % 4) != 0))
+	{
+		LOG_ERROR("the shader binary is not SPIR-V", "file", filename);
+		return(VK_NULL_HANDLE);
+	}
+
+	std::vector<uint32_t> code((size_t)size / 4);
+	file.seekg(0, std::ios::beg);
+	file.read((char*)code.data(), size);
+
+	VkShaderModuleCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = (size_t)size;
+	createInfo.pCode = code.data();
+	if (vkCreateShaderModule(m_device, &createInfo, NULL, &shaderModule) != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create a shader module", "file", filename);
+		return(VK_NULL_HANDLE);
+	}
+
+	return(shaderModule);
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating the graphics pipeline
+ *  for a shader variant.  The variants differ only by their
+ *  specialization constants, so a variant that was already
+ *  created is returned instead of building a new pipeline.
+ ***********************************************************/
+uint32_t VulkanRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	for (size_t i = 0; i < m_pipelines.size(); i++)
+	{
+		if ((m_pipelines[i].pipeline != VK_NULL_HANDLE) &&
+			(m_pipelines[i].activeLights == desc.activeLights) &&
+			(m_pipelines[i].bEnableLighting == desc.bEnableLighting) &&
+			(m_pipelines[i].bEnableSpecular == desc.bEnableSpecular))
+		{
+			return((uint32_t)i + 1);
+		}
+	}
+
+	VkShaderModule vertexModule = LoadShaderModule(desc.vulkanVertexBinaryPath);
+	VkShaderModule fragmentModule = LoadShaderModule(desc.vulkanFragmentBinaryPath);
+	if ((VK_NULL_HANDLE == vertexModule) || (VK_NULL_HANDLE == fragmentModule))
+	{
+		vkDestroyShaderModule(m_device, vertexModule, NULL);
+		vkDestroyShaderModule(m_device, fragmentModule, NULL);
+		return(0);
+	}
+
+	SPECIALIZATION_DATA specializationData;
+	specializationData.activeLights = desc.activeLights;
+	specializationData.bEnableLighting = desc.bEnableLighting ? VK_TRUE : VK_FALSE;
+	specializationData.bEnableSpecular = desc.bEnableSpecular ? VK_TRUE : VK_FALSE;
+
+	VkSpecializationMapEntry mapEntries[3];
+	mapEntries[0].constantID = 0;
+	mapEntries[0].offset = offsetof(SPECIALIZATION_DATA, activeLights);
+	mapEntries[0].size = sizeof(int32_t);
+	mapEntries[1].constantID = 1;
+	mapEntries[1].offset = offsetof(SPECIALIZATION_DATA, bEnableLighting);
+	mapEntries[1].size = sizeof(VkBool32);
+	mapEntries[2].constantID = 2;
+	mapEntries[2].offset = offsetof(SPECIALIZATION_DATA, bEnableSpecular);
+	mapEntries[2].size = sizeof(VkBool32);
+
+	VkSpecializationInfo specializationInfo = {};
+	specializationInfo.mapEntryCount = 3;
+	specializationInfo.pMapEntries = mapEntries;
+	specializationInfo.dataSize = sizeof(specializationData);
+	specializationInfo.pData = &specializationData;
+
+	VkPipelineShaderStageCreateInfo stages[2] = {};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = vertexModule;
+	stages[0].pName = "main";
+	stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = fragmentModule;
+	stages[1].pName = "main";
+	stages[1].pSpecializationInfo = &specializationInfo;
+
+	// interleaved position, normal and texture coordinate
+	VkVertexInputBindingDescription vertexBinding = {};
+	vertexBinding.binding = 0;
+	vertexBinding.stride = sizeof(MeshGenerator::MESH_VERTEX);
+	vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	VkVertexInputAttributeDescription vertexAttributes[3] = {};
+	vertexAttributes[0].location = 0;
+	vertexAttributes[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+	vertexAttributes[0].offset = offsetof(MeshGenerator::MESH_VERTEX, position);
+	vertexAttributes[1].location = 1;
+	vertexAttributes[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+	vertexAttributes[1].offset = offsetof(MeshGenerator::MESH_VERTEX, normal);
+	vertexAttributes[2].location = 2;
+	vertexAttributes[2].format = VK_FORMAT_R32G32_SFLOAT;
+	vertexAttributes[2].offset = offsetof(MeshGenerator::MESH_VERTEX, textureCoordinate);
+
+	VkPipelineVertexInputStateCreateInfo vertexInput = {};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = 1;
+	vertexInput.pVertexBindingDescriptions = &vertexBinding;
+	vertexInput.vertexAttributeDescriptionCount = 3;
+	vertexInput.pVertexAttributeDescriptions = vertexAttributes;
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	// no face culling, matching the OpenGL state
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode = VK_CULL_MODE_NONE;
+	rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization.lineWidth = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = VK_TRUE;
+	depthStencil.depthWriteEnable = VK_TRUE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+	// alpha blending for transparent rendering
+	VkPipelineColorBlendAttachmentState blendAttachment = {};
+	blendAttachment.blendEnable = VK_TRUE;
+	blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend = {};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blendAttachment;
+
+	// the viewport follows the swapchain size without rebuilding
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 2;
+	pipelineInfo.pStages = stages;
+	pipelineInfo.pVertexInputState = &vertexInput;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterization;
+	pipelineInfo.pMultisampleState = &multisample;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlend;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = m_pipelineLayout;
+	pipelineInfo.renderPass = m_renderPass;
+	pipelineInfo.subpass = 0;
+
+	VK_PIPELINE pipeline;
+	pipeline.pipeline = VK_NULL_HANDLE;
+	pipeline.activeLights = desc.activeLights;
+	pipeline.bEnableLighting = desc.bEnableLighting;
+	pipeline.bEnableSpecular = desc.bEnableSpecular;
+
+	VkResult result = vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, NULL, &pipeline.pipeline);
+
+	vkDestroyShaderModule(m_device, vertexModule, NULL);
+	vkDestroyShaderModule(m_device, fragmentModule, NULL);
+
+	if (result != VK_SUCCESS)
+	{
+		LOG_ERROR("could not create the Vulkan graphics pipeline");
+		return(0);
+	}
+
+	m_pipelines.push_back(pipeline);
+
+	return((uint32_t)m_pipelines.size());
+}
+
+/***********************************************************
+ *  BindPipeline()
+ *
+ *  This method is used for selecting the pipeline used by
+ *  the following draws.
+ ***********************************************************/
+void VulkanRenderDevice::BindPipeline(uint32_t pipeline)
+{
+	if ((pipeline == 0) || (pipeline > m_pipelines.size()) ||
+		(m_pipelines[pipeline - 1].pipeline == VK_NULL_HANDLE))
+	{
+		return;
+	}
+
+	m_boundPipeline = pipeline;
+	m_stats.pipelineBinds++;
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing the passed in pipeline,
+ *  once no frame in flight can still be using it.  The slot
+ *  is kept so that the handles of the other pipelines stay
+ *  the same, and it is not returned for its variant again.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyPipeline(uint32_t pipeline)
+{
+	if ((pipeline == 0) || (pipeline > m_pipelines.size()) ||
+		(m_pipelines[pipeline - 1].pipeline == VK_NULL_HANDLE))
+	{
+		return;
+	}
+
+	vkDeviceWaitIdle(m_device);
+	vkDestroyPipeline(m_device, m_pipelines[pipeline - 1].pipeline, NULL);
+	m_pipelines[pipeline - 1].pipeline = VK_NULL_HANDLE;
+
+	if (m_boundPipeline == pipeline)
+	{
+		m_boundPipeline = 0;
+	}
+}
+
+/***********************************************************
+ *  CreateOverlayPipeline()
+ *
+ *  This method is used for creating the pipeline that draws
+ *  the screen space overlay over the scene.  It is created
+ *  when the overlay is first drawn, so that the shaders are
+ *  only needed by applications that use the overlay.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateOverlayPipeline()
+{
+	VkShaderModule vertexModule = LoadShaderModule(OVERLAY_VERTEX_SHADER);
+	VkShaderModule fragmentModule = LoadShaderModule(OVERLAY_FRAGMENT_SHADER);
+	if ((VK_NULL_HANDLE == vertexModule) || (VK_NULL_HANDLE == fragmentModule))
+	{
+		vkDestroyShaderModule(m_device, vertexModule, NULL);
+		vkDestroyShaderModule(m_device, fragmentModule, NULL);
+		return(false);
+	}
+
+	VkPipelineShaderStageCreateInfo stages[2] = {};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = vertexModule;
+	stages[0].pName = "main";
+	stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = fragmentModule;
+	stages[1].pName = "main";
+
+	// interleaved pixel position, texture coordinate and color
+	VkVertexInputBindingDescription vertexBinding = {};
+	vertexBinding.binding = 0;
+	vertexBinding.stride = sizeof(OVERLAY_VERTEX);
+	vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	VkVertexInputAttributeDescription vertexAttributes[3] = {};
+	vertexAttributes[0].location = 0;
+	vertexAttributes[0].format = VK_FORMAT_R32G32_SFLOAT;
+	vertexAttributes[0].offset = offsetof(OVERLAY_VERTEX, x);
+	vertexAttributes[1].location = 1;
+	vertexAttributes[1].format = VK_FORMAT_R32G32_SFLOAT;
+	vertexAttributes[1].offset = offsetof(OVERLAY_VERTEX, u);
+	vertexAttributes[2].location = 2;
+	vertexAttributes[2].format = VK_FORMAT_R8G8B8A8_UNORM;
+	vertexAttributes[2].offset = offsetof(OVERLAY_VERTEX, color);
+
+	VkPipelineVertexInputStateCreateInfo vertexInput = {};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = 1;
+	vertexInput.pVertexBindingDescriptions = &vertexBinding;
+	vertexInput.vertexAttributeDescriptionCount = 3;
+	vertexInput.pVertexAttributeDescriptions = vertexAttributes;
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode = VK_CULL_MODE_NONE;
+	rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization.lineWidth = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	// the overlay is always drawn on top of the scene
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = VK_FALSE;
+	depthStencil.depthWriteEnable = VK_FALSE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+
+	VkPipelineColorBlendAttachmentState blendAttachment = {};
+	blendAttachment.blendEnable = VK_TRUE;
+	blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	VkPipelineColorBlendStateCreateInfo colorBlend = {};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blendAttachment;
+
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 2;
+	pipelineInfo.pStages = stages;
+	pipelineInfo.pVertexInputState = &vertexInput;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterization;
+	pipelineInfo.pMultisampleState = &multisample;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlend;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = m_overlayPipelineLayout;
+	pipelineInfo.renderPass = m_renderPass;
+	pipelineInfo.subpass = 0;
+
+	VkResult result = vkCreateGraphicsPipelines(m_device, m_pipelineCache, 1, &pipelineInfo, NULL, &m_overlayPipeline);
+
+	vkDestroyShaderModule(m_device, vertexModule, NULL);
+	vkDestroyShaderModule(m_device, fragmentModule, NULL);
+
+	if (result != VK_SUCCESS)
+	{
+		m_overlayPipeline = VK_NULL_HANDLE;
+		LOG_ERROR("could not create the Vulkan overlay pipeline");
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture from decoded
+ *  image data.  RGB images are expanded to RGBA, since three
+ *  channel formats are rarely supported for sampling.
+ ***********************************************************/
+uint32_t VulkanRenderDevice::CreateTexture(
+	int width,
+	int height,
+	int colorChannels,
+	const unsigned char* pixels)
+{
+	VK_TEXTURE texture;
+
+	// only RGB and RGBA images are supported
+	if ((colorChannels != 3) && (colorChannels != 4))
+	{
+		LOG_ERROR("images with this number of channels are not supported", "channels", colorChannels);
+		return(0);
+	}
+
+	if (colorChannels == 3)
+	{
+		std::vector<unsigned char> rgbaPixels((size_t)width * height * 4);
+		for (size_t i = 0; i < (size_t)width * height; i++)
+		{
+			rgbaPixels[(i * 4) + 0] = pixels[(i * 3) + 0];
+			rgbaPixels[(i * 4) + 1] = pixels[(i * 3) + 1];
+			rgbaPixels[(i * 4) + 2] = pixels[(i * 3) + 2];
+			rgbaPixels[(i * 4) + 3] = 255;
+		}
+		if (CreateDeviceTexture(width, height, rgbaPixels.data(), texture) == false)
+		{
+			return(0);
+		}
+	}
+	else if (CreateDeviceTexture(width, height, pixels, texture) == false)
+	{
+		return(0);
+	}
+
+	m_textures.push_back(texture);
+
+	return((uint32_t)m_textures.size());
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing the passed in texture,
+ *  once no frame in flight can still be sampling it.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyTexture(uint32_t texture)
+{
+	if ((texture == 0) || (texture > m_textures.size()))
+	{
+		return;
+	}
+
+	vkDeviceWaitIdle(m_device);
+	DestroyDeviceTexture(m_textures[texture - 1]);
+
+	for (int i = 0; i < TEXTURE_SLOTS; i++)
+	{
+		if (m_slotTextures[i] == texture)
+		{
+			m_slotTextures[i] = 0;
+		}
+	}
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_frames[i].bTexturesDirty = true;
+	}
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for placing the passed in texture in
+ *  one of the texture table slots.  The descriptor sets of
+ *  the frames are rewritten when each frame is next started.
+ ***********************************************************/
+void VulkanRenderDevice::BindTexture(int slot, uint32_t texture)
+{
+	if ((slot < 0) || (slot >= TEXTURE_SLOTS))
+	{
+		return;
+	}
+
+	m_slotTextures[slot] = texture;
+	for (int i = 0; i < FRAMES_IN_FLIGHT; i++)
+	{
+		m_frames[i].bTexturesDirty = true;
+	}
+	m_stats.textureBinds++;
+}
+
+/***********************************************************
+ *  SetTextureSlot()
+ *
+ *  This method is used for setting the texture table slot
+ *  sampled by the following draws.
+ ***********************************************************/
+void VulkanRenderDevice::SetTextureSlot(int slot)
+{
+	m_textureSlot = slot;
+}
+
+/***********************************************************
+ *  WriteTextureSet()
+ *
+ *  This method is used for writing the textures bound to
+ *  the slots into the texture table of a frame.
+ ***********************************************************/
+void VulkanRenderDevice::WriteTextureSet(FRAME_RESOURCES& frame)
+{
+	VkDescriptorImageInfo imageInfos[TEXTURE_SLOTS];
+
+	for (int i = 0; i < TEXTURE_SLOTS; i++)
+	{
+		uint32_t texture = m_slotTextures[i];
+
+		imageInfos[i].sampler = m_sampler;
+		imageInfos[i].imageView = m_defaultTexture.view;
+		imageInfos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		if ((texture > 0) && (texture <= m_textures.size()) &&
+			(VK_NULL_HANDLE != m_textures[texture - 1].view))
+		{
+			imageInfos[i].imageView = m_textures[texture - 1].view;
+		}
+	}
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = frame.textureSet;
+	write.dstBinding = 0;
+	write.descriptorCount = TEXTURE_SLOTS;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = imageInfos;
+	vkUpdateDescriptorSets(m_device, 1, &write, 0, NULL);
+
+	frame.bTexturesDirty = false;
+}
+
+/***********************************************************
+ *  UpdateBlock()
+ *
+ *  These methods are used for keeping a copy of the passed
+ *  in uniform block.  The copy is written into the ring
+ *  buffer by the next draw that uses it.
+ ***********************************************************/
+void VulkanRenderDevice::UpdateBlock(const CAMERA_BLOCK& block)
+{
+	m_cameraBlock = block;
+	m_blockDirty[CAMERA_BLOCK_BINDING] = true;
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+void VulkanRenderDevice::UpdateBlock(const LIGHT_BLOCK& block)
+{
+	m_lightBlock = block;
+	m_blockDirty[LIGHT_BLOCK_BINDING] = true;
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+void VulkanRenderDevice::UpdateBlock(const MATERIAL_BLOCK& block)
+{
+	m_materialBlock = block;
+	m_blockDirty[MATERIAL_BLOCK_BINDING] = true;
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+void VulkanRenderDevice::UpdateBlock(const INSTANCE_BLOCK& block)
+{
+	m_instanceBlock = block;
+	m_instanceViewMask = block.viewMask;
+	m_blockDirty[INSTANCE_BLOCK_BINDING] = true;
+	m_stats.blockUploads++;
+	m_stats.uploadBytes += sizeof(block);
+}
+
+/***********************************************************
+ *  WriteDirtyBlocks()
+ *
+ *  This method is used for writing the uniform blocks that
+ *  changed since the last draw into the ring buffer of the
+ *  current frame, and remembering their offsets.
+ ***********************************************************/
+bool VulkanRenderDevice::WriteDirtyBlocks()
+{
+	FRAME_RESOURCES& frame = m_frames[m_frameIndex];
+	const void* blockData[UNIFORM_BLOCK_COUNT] =
+	{
+		&m_cameraBlock,
+		&m_lightBlock,
+		&m_materialBlock,
+		&m_instanceBlock
+	};
+
+	for (int i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		if (m_blockDirty[i] == false)
+		{
+			continue;
+		}
+
+		VkDeviceSize offset = (frame.ringOffset + m_uniformAlignment - 1) & ~(m_uniformAlignment - 1);
+		if (offset + BLOCK_SIZES[i] > frame.uniformRing.size)
+		{
+			LOG_RATE_LIMITED(1000.0, LOG_WARNING, "the uniform ring buffer is full, draws are being dropped");
+			return(false);
+		}
+
+		memcpy((unsigned char*)frame.uniformRing.pMapped + offset, blockData[i], (size_t)BLOCK_SIZES[i]);
+		frame.ringOffset = offset + BLOCK_SIZES[i];
+		m_blockOffsets[i] = (uint32_t)offset;
+		m_blockDirty[i] = false;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  LoadMesh()
+ *
+ *  These methods are used for generating one of the basic
+ *  shape meshes, or taking the data generated ahead of time,
+ *  and uploading it into device local buffers.  The buffers
+ *  of a mesh that is replaced are freed once no frame in
+ *  flight can still be drawing them.
+ ***********************************************************/
+void VulkanRenderDevice::LoadMesh(MESH_TYPE mesh)
+{
+	MeshGenerator::MESH_DATA data;
+
+	if ((mesh < 0) || (mesh >= MESH_COUNT))
+	{
+		return;
+	}
+
+	MeshGenerator::GenerateMesh(mesh, MeshGenerator::DEFAULT_DETAIL, data);
+	LoadMesh(mesh, data);
+}
+
+void VulkanRenderDevice::LoadMesh(MESH_TYPE mesh, const MESH_DATA& data)
+{
+	if ((mesh < 0) || (mesh >= MESH_COUNT) || data.indices.empty())
+	{
+		return;
+	}
+
+	VK_MESH& deviceMesh = m_meshes[mesh];
+	if (deviceMesh.indexCount > 0)
+	{
+		vkDeviceWaitIdle(m_device);
+		DestroyBuffer(deviceMesh.vertexBuffer);
+		DestroyBuffer(deviceMesh.indexBuffer);
+		deviceMesh.indexCount = 0;
+	}
+	if ((UploadBuffer(
+			data.vertices.data(),
+			data.vertices.size() * sizeof(MeshGenerator::MESH_VERTEX),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			deviceMesh.vertexBuffer) == false) ||
+		(UploadBuffer(
+			data.indices.data(),
+			data.indices.size() * sizeof(uint32_t),
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+			deviceMesh.indexBuffer) == false))
+	{
+		LOG_ERROR("could not upload the mesh buffers");
+		DestroyBuffer(deviceMesh.vertexBuffer);
+		DestroyBuffer(deviceMesh.indexBuffer);
+		return;
+	}
+	deviceMesh.indexCount = (uint32_t)data.indices.size();
+}
+
+/***********************************************************
+ *  DrawMesh()
+ *
+ *  This method is used for collecting a draw of one of the
+ *  loaded meshes, with the current pipeline, texture slot
+ *  and uniform blocks.
+ ***********************************************************/
+void VulkanRenderDevice::DrawMesh(MESH_TYPE mesh)
+{
+	if ((m_bFrameStarted == false) || (m_boundPipeline == 0) ||
+		(mesh < 0) || (mesh >= MESH_COUNT) || (m_meshes[mesh].indexCount == 0))
+	{
+		return;
+	}
+
+	uint32_t viewMask = GetDrawViewMask();
+	uint32_t views = CountViews(viewMask);
+	if ((views == 0) || (WriteDirtyBlocks() == false))
+	{
+		return;
+	}
+
+	DRAW_ITEM draw;
+	draw.pipeline = m_boundPipeline;
+	draw.mesh = (uint32_t)mesh;
+	draw.textureSlot = m_textureSlot;
+	for (int i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		draw.blockOffsets[i] = m_blockOffsets[i];
+	}
+	draw.viewMask = viewMask;
+	m_draws.push_back(draw);
+
+	m_stats.drawCalls += views;
+	m_stats.triangles += (m_meshes[mesh].indexCount / 3) * views;
+}
+
+/***********************************************************
+ *  DrawOverlay()
+ *
+ *  This method is used for copying the overlay vertices
+ *  into the vertex buffer of the frame.  They are drawn
+ *  after the scene when the frame ends.
+ ***********************************************************/
+void VulkanRenderDevice::DrawOverlay(
+	const OVERLAY_VERTEX* vertices,
+	uint32_t vertexCount,
+	uint32_t texture)
+{
+	FRAME_RESOURCES& frame = m_frames[m_frameIndex];
+
+	if ((m_bFrameStarted == false) || (NULL == vertices) || (vertexCount == 0) ||
+		(texture == 0) || (texture > m_textures.size()))
+	{
+		return;
+	}
+
+	if ((VK_NULL_HANDLE == m_overlayPipeline) && (m_bOverlayFailed == false))
+	{
+		m_bOverlayFailed = !CreateOverlayPipeline();
+	}
+	if (m_bOverlayFailed)
+	{
+		return;
+	}
+
+	uint32_t space = OVERLAY_VERTEX_CAPACITY - frame.overlayVertexCount;
+	if (vertexCount > space)
+	{
+		LOG_RATE_LIMITED(1000.0, LOG_WARNING, "overlay vertices exceed the per frame capacity",
+			"capacity", OVERLAY_VERTEX_CAPACITY, "vertices", vertexCount);
+		vertexCount = space - (space % 3);
+	}
+
+	OVERLAY_VERTEX* pDestination = (OVERLAY_VERTEX*)frame.overlayVertices.pMapped;
+	memcpy(pDestination + frame.overlayVertexCount, vertices, vertexCount * sizeof(OVERLAY_VERTEX));
+	frame.overlayVertexCount += vertexCount;
+
+	// the overlay draws use a single texture, so the last
+	// one passed in the frame is used for all of them
+	if (frame.overlayTexture != texture)
+	{
+		VkDescriptorImageInfo imageInfo;
+		imageInfo.sampler = m_sampler;
+		imageInfo.imageView = m_textures[texture - 1].view;
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+		VkWriteDescriptorSet write = {};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = frame.overlaySet;
+		write.dstBinding = 0;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		write.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(m_device, 1, &write, 0, NULL);
+
+		frame.overlayTexture = texture;
+	}
+}
+
+/***********************************************************
+ *  GetGpuFrameTime()
+ *
+ *  This method is used for getting the GPU time of the
+ *  latest completed frame, measured between the timestamps
+ *  at the start and end of its command buffer.
+ ***********************************************************/
+bool VulkanRenderDevice::GetGpuFrameTime(double& milliseconds)
+{
+	if (m_bGpuTimeValid == false)
+	{
+		return(false);
+	}
+
+	milliseconds = m_gpuMilliseconds;
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for waiting until the GPU is done
+ *  with the resources of the next frame in flight, and then
+ *  resetting them for recording.
+ ***********************************************************/
+void VulkanRenderDevice::BeginFrame()
+{
+	ResetStats();
+
+	m_frameIndex = (m_frameIndex + 1) % FRAMES_IN_FLIGHT;
+	FRAME_RESOURCES& frame = m_frames[m_frameIndex];
+
+	vkWaitForFences(m_device, 1, &frame.fence, VK_TRUE, WAIT_FOREVER);
+
+	// the timestamps of the previous use of this frame are done
+	if (frame.bTimestampsWritten)
+	{
+		uint64_t timestamps[2] = { 0, 0 };
+		if (vkGetQueryPoolResults(m_device, m_timestampPool, (uint32_t)m_frameIndex * 2, 2,
+			sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+		{
+			uint64_t ticks = (timestamps[1] - timestamps[0]) & m_timestampMask;
+			m_gpuMilliseconds = ((double)ticks * m_timestampPeriod) / 1000000.0;
+			m_bGpuTimeValid = true;
+		}
+		frame.bTimestampsWritten = false;
+	}
+
+	vkResetCommandPool(m_device, frame.commandPool, 0);
+	for (size_t i = 0; i < frame.recordPools.size(); i++)
+	{
+		vkResetCommandPool(m_device, frame.recordPools[i], 0);
+	}
+
+	if (frame.bTexturesDirty)
+	{
+		WriteTextureSet(frame);
+	}
+
+	// the ring buffer of this frame starts empty, so every
+	// block is written again by the first draw
+	frame.ringOffset = 0;
+	for (int i = 0; i < UNIFORM_BLOCK_COUNT; i++)
+	{
+		m_blockDirty[i] = true;
+	}
+
+	m_draws.clear();
+	frame.overlayVertexCount = 0;
+	m_bFrameStarted = true;
+}
+
+/***********************************************************
+ *  SetViewport()
+ *
+ *  This method is used for setting the viewport and scissor
+ *  of a command buffer to the passed in part of the
+ *  swapchain.  The viewport is flipped so that the OpenGL
+ *  style projection matrices produce the same image.
+ ***********************************************************/
+void VulkanRenderDevice::SetViewport(VkCommandBuffer commandBuffer, const VIEWPORT& view)
+{
+	float width = (float)m_swapchainExtent.width;
+	float height = (float)m_swapchainExtent.height;
+
+	VkViewport viewport;
+	viewport.x = view.x * width;
+	viewport.y = (1.0f - view.y) * height;
+	viewport.width = view.width * width;
+	viewport.height = -view.height * height;
+	viewport.minDepth = 0.0f;
+	viewport.maxDepth = 1.0f;
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+	VkRect2D scissor;
+	scissor.offset.x = (int32_t)(view.x * width);
+	scissor.offset.y = (int32_t)((1.0f - view.y - view.height) * height);
+	scissor.extent.width = (uint32_t)(view.width * width);
+	scissor.extent.height = (uint32_t)(view.height * height);
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+/***********************************************************
+ *  RecordDraws()
+ *
+ *  This method is used for recording one range of the draws
+ *  collected in the frame into the secondary command buffer
+ *  of the recording thread.  Only the state that changes
+ *  between draws is bound again.
+ ***********************************************************/
+void VulkanRenderDevice::RecordDraws(FRAME_RESOURCES& frame, uint32_t imageIndex, int chunk)
+{
+	VkCommandBuffer commandBuffer = frame.recordCommands[chunk];
+	size_t begin = (m_draws.size() * chunk) / m_recordChunks;
+	size_t end = (m_draws.size() * (chunk + 1)) / m_recordChunks;
+
+	VkCommandBufferInheritanceInfo inheritance = {};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = m_renderPass;
+	inheritance.subpass = 0;
+	inheritance.framebuffer = m_framebuffers[imageIndex];
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	SetViewport(commandBuffer, m_viewports[0]);
+
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
+		1, 1, &frame.textureSet, 0, NULL);
+
+	uint32_t boundPipeline = 0;
+	uint32_t boundMesh = MESH_COUNT;
+	int32_t boundSlot = -1;
+	const uint32_t* boundOffsets = NULL;
+
+	for (size_t i = begin; i < end; i++)
+	{
+		const DRAW_ITEM& draw = m_draws[i];
+
+		if (draw.pipeline != boundPipeline)
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelines[draw.pipeline - 1].pipeline);
+			boundPipeline = draw.pipeline;
+		}
+
+		if ((NULL == boundOffsets) ||
+			(memcmp(boundOffsets, draw.blockOffsets, sizeof(draw.blockOffsets)) != 0))
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
+				0, 1, &frame.blockSet, UNIFORM_BLOCK_COUNT, draw.blockOffsets);
+			boundOffsets = draw.blockOffsets;
+		}
+
+		if (draw.mesh != boundMesh)
+		{
+			const VK_MESH& mesh = m_meshes[draw.mesh];
+			VkDeviceSize vertexOffset = 0;
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &mesh.vertexBuffer.buffer, &vertexOffset);
+			vkCmdBindIndexBuffer(commandBuffer, mesh.indexBuffer.buffer, 0, VK_INDEX_TYPE_UINT32);
+			boundMesh = draw.mesh;
+		}
+
+		if (draw.textureSlot != boundSlot)
+		{
+			DRAW_CONSTANTS constants;
+			constants.textureSlot = draw.textureSlot;
+			vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT,
+				0, sizeof(constants), &constants);
+			boundSlot = draw.textureSlot;
+		}
+
+		if (m_viewCount == 1)
+		{
+			vkCmdDrawIndexed(commandBuffer, m_meshes[draw.mesh].indexCount, 1, 0, 0, 0);
+			continue;
+		}
+
+		// the instance is passed as the first instance, the
+		// state bound for the draw is shared by its views
+		uint32_t instance = 0;
+		for (uint32_t view = 0; view < m_viewCount; view++)
+		{
+			if ((draw.viewMask & (1u << view)) == 0)
+			{
+				continue;
+			}
+			SetViewport(commandBuffer, m_viewports[view]);
+			vkCmdDrawIndexed(commandBuffer, m_meshes[draw.mesh].indexCount, 1, 0, 0, instance);
+			instance++;
+		}
+	}
+
+	vkEndCommandBuffer(commandBuffer);
+}
+
+/***********************************************************
+ *  RecordOverlay()
+ *
+ *  This method is used for recording the overlay vertices
+ *  of the frame into its overlay command buffer.
+ ***********************************************************/
+void VulkanRenderDevice::RecordOverlay(FRAME_RESOURCES& frame, uint32_t imageIndex)
+{
+	VkCommandBuffer commandBuffer = frame.overlayCommands;
+
+	VkCommandBufferInheritanceInfo inheritance = {};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = m_renderPass;
+	inheritance.subpass = 0;
+	inheritance.framebuffer = m_framebuffers[imageIndex];
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	// the overlay covers the whole window whatever the views
+	const VIEWPORT window = { 0.0f, 0.0f, 1.0f, 1.0f };
+	SetViewport(commandBuffer, window);
+
+	OVERLAY_CONSTANTS constants;
+	constants.screenSize[0] = (float)m_swapchainExtent.width;
+	constants.screenSize[1] = (float)m_swapchainExtent.height;
+
+	VkDeviceSize offset = 0;
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_overlayPipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_overlayPipelineLayout,
+		0, 1, &frame.overlaySet, 0, NULL);
+	vkCmdPushConstants(commandBuffer, m_overlayPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+		0, sizeof(constants), &constants);
+	vkCmdBindVertexBuffers(commandBuffer, 0, 1, &frame.overlayVertices.buffer, &offset);
+	vkCmdDraw(commandBuffer, frame.overlayVertexCount, 1, 0, 0);
+
+	vkEndCommandBuffer(commandBuffer);
+}
+
+/***********************************************************
+ *  StartWorkers()
+ *
+ *  This method is used for starting the worker threads that
+ *  record the draws, one less than the recording command
+ *  pools since the main thread records the first range.
+ ***********************************************************/
+void VulkanRenderDevice::StartWorkers()
+{
+	size_t workerCount = m_frames[0].recordPools.size() - 1;
+
+	m_bWorkersExit = false;
+	for (size_t i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&VulkanRenderDevice::WorkerMain, this, (int)i));
+	}
+}
+
+/***********************************************************
+ *  StopWorkers()
+ *
+ *  This method is used for stopping the worker threads.
+ ***********************************************************/
+void VulkanRenderDevice::StopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workerMutex);
+		m_bWorkersExit = true;
+	}
+	m_workerStart.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+}
+
+/***********************************************************
+ *  WorkerMain()
+ *
+ *  This method is used as the body of a recording worker
+ *  thread.  Each time the frame generation changes, the
+ *  worker records its range of the draws, if it has one.
+ ***********************************************************/
+void VulkanRenderDevice::WorkerMain(int worker)
+{
+	uint32_t generation = 0;
+
+	while (true)
+	{
+		std::unique_lock<std::mutex> lock(m_workerMutex);
+		m_workerStart.wait(lock, [&]() { return m_bWorkersExit || (m_workerGeneration != generation); });
+		if (m_bWorkersExit)
+		{
+			return;
+		}
+		generation = m_workerGeneration;
+		int chunk = worker + 1;
+		bool bRecord = (chunk < m_recordChunks);
+		lock.unlock();
+
+		if (bRecord)
+		{
+			RecordDraws(m_frames[m_frameIndex], m_recordImageIndex, chunk);
+		}
+
+		lock.lock();
+		m_workersPending--;
+		if (m_workersPending == 0)
+		{
+			m_workerDone.notify_one();
+		}
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for recording the draws collected in
+ *  the frame, splitting them across the worker threads when
+ *  there are enough of them, then submitting the commands
+ *  and presenting the swapchain image.
+ ***********************************************************/
+void VulkanRenderDevice::EndFrame()
+{
+	FRAME_RESOURCES& frame = m_frames[m_frameIndex];
+	uint32_t imageIndex = 0;
+
+	if (m_bFrameStarted == false)
+	{
+		return;
+	}
+	m_bFrameStarted = false;
+
+	if ((VK_NULL_HANDLE == m_swapchain) && (RecreateSwapchain() == false))
+	{
+		return;
+	}
+
+	VkResult result = vkAcquireNextImageKHR(m_device, m_swapchain, WAIT_FOREVER,
+		frame.imageAvailable, VK_NULL_HANDLE, &imageIndex);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+	{
+		RecreateSwapchain();
+		return;
+	}
+	if ((result != VK_SUCCESS) && (result != VK_SUBOPTIMAL_KHR))
+	{
+		return;
+	}
+
+	// record the draws into secondary command buffers
+	size_t chunks = (m_draws.size() + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK;
+	chunks = std::max<size_t>(1, std::min(chunks, frame.recordCommands.size()));
+	m_recordChunks = (int)chunks;
+	m_recordImageIndex = imageIndex;
+
+	if (chunks > 1)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_workerMutex);
+			m_workersPending = (int)m_workers.size();
+			m_workerGeneration++;
+		}
+		m_workerStart.notify_all();
+
+		RecordDraws(frame, imageIndex, 0);
+
+		std::unique_lock<std::mutex> lock(m_workerMutex);
+		m_workerDone.wait(lock, [&]() { return m_workersPending == 0; });
+	}
+	else
+	{
+		RecordDraws(frame, imageIndex, 0);
+	}
+
+	// the overlay is drawn after all of the scene draws
+	VkCommandBuffer secondaries[MAX_RECORD_WORKERS + 2];
+	uint32_t secondaryCount = 0;
+	for (size_t i = 0; i < chunks; i++)
+	{
+		secondaries[secondaryCount++] = frame.recordCommands[i];
+	}
+	if ((frame.overlayVertexCount > 0) && (VK_NULL_HANDLE != m_overlayPipeline))
+	{
+		RecordOverlay(frame, imageIndex);
+		secondaries[secondaryCount++] = frame.overlayCommands;
+	}
+
+	// the primary command buffer only runs the render pass,
+	// between the timestamps that measure the GPU frame time
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(frame.primaryCommands, &beginInfo);
+
+	if (VK_NULL_HANDLE != m_timestampPool)
+	{
+		vkCmdResetQueryPool(frame.primaryCommands, m_timestampPool, (uint32_t)m_frameIndex * 2, 2);
+		vkCmdWriteTimestamp(frame.primaryCommands, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			m_timestampPool, (uint32_t)m_frameIndex * 2);
+	}
+
+	VkClearValue clearValues[2];
+	clearValues[0].color.float32[0] = 0.0f;
+	clearValues[0].color.float32[1] = 0.0f;
+	clearValues[0].color.float32[2] = 0.0f;
+	clearValues[0].color.float32[3] = 1.0f;
+	clearValues[1].depthStencil.depth = 1.0f;
+	clearValues[1].depthStencil.stencil = 0;
+
+	VkRenderPassBeginInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = m_renderPass;
+	renderPassInfo.framebuffer = m_framebuffers[imageIndex];
+	renderPassInfo.renderArea.extent = m_swapchainExtent;
+	renderPassInfo.clearValueCount = 2;
+	renderPassInfo.pClearValues = clearValues;
+	vkCmdBeginRenderPass(frame.primaryCommands, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	vkCmdExecuteCommands(frame.primaryCommands, secondaryCount, secondaries);
+	vkCmdEndRenderPass(frame.primaryCommands);
+
+	if (VK_NULL_HANDLE != m_timestampPool)
+	{
+		vkCmdWriteTimestamp(frame.primaryCommands, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			m_timestampPool, ((uint32_t)m_frameIndex * 2) + 1);
+		frame.bTimestampsWritten = true;
+	}
+	vkEndCommandBuffer(frame.primaryCommands);
+
+	vkResetFences(m_device, 1, &frame.fence);
+
+	VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = &frame.imageAvailable;
+	submitInfo.pWaitDstStageMask = &waitStage;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &frame.primaryCommands;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &m_renderFinished[imageIndex];
+	vkQueueSubmit(m_queue, 1, &submitInfo, frame.fence);
+
+	VkPresentInfoKHR presentInfo = {};
+	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.waitSemaphoreCount = 1;
+	presentInfo.pWaitSemaphores = &m_renderFinished[imageIndex];
+	presentInfo.swapchainCount = 1;
+	presentInfo.pSwapchains = &m_swapchain;
+	presentInfo.pImageIndices = &imageIndex;
+	result = vkQueuePresentKHR(m_queue, &presentInfo);
+	if ((result == VK_ERROR_OUT_OF_DATE_KHR) || (result == VK_SUBOPTIMAL_KHR))
+	{
+		RecreateSwapchain();
+	}
+}
+
+#endif
@@ -0,0 +1,327 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderdevice.h
+// ============
+// render device backend that issues the commands to Vulkan
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// the Vulkan render device is only built when the project is
+// built with the Vulkan SDK
+#ifdef ENABLE_VULKAN
+
+#include "RenderDevice.h"
+#include "MeshGenerator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct GLFWwindow;
+
+/***********************************************************
+ *  VulkanRenderDevice
+ *
+ *  This class contains the Vulkan implementation of the
+ *  render device.  The draws issued by the scene code are
+ *  collected during the frame, along with the uniform block
+ *  data which is written into a per-frame ring buffer, and
+ *  at the end of the frame they are recorded into secondary
+ *  command buffers by a pool of worker threads.
+ *
+ *  The device has only been compiled against the Vulkan
+ *  headers.  It has not been run on a driver, lavapipe
+ *  included, and its draw throughput on the stress scenes
+ *  has not been compared with the OpenGL device yet.
+ ***********************************************************/
+class VulkanRenderDevice : public RenderDevice
+{
+public:
+	// constructor - a CPU implementation such as lavapipe is
+	// selected over the GPUs when bPreferCpuDevice is set
+	VulkanRenderDevice(bool bPreferCpuDevice, bool bDisableVsync);
+	// destructor
+	virtual ~VulkanRenderDevice();
+
+	// set the window that is presented to, which must be
+	// created without an OpenGL context
+	void SetWindow(GLFWwindow* pWindow);
+
+	virtual const char* GetName() const { return "vulkan"; }
+	virtual std::string GetAdapterName() const { return(m_adapterName); }
+
+	virtual bool Initialize();
+
+	virtual uint32_t CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void BindPipeline(uint32_t pipeline);
+	virtual void DestroyPipeline(uint32_t pipeline);
+
+	virtual uint32_t CreateTexture(
+		int width,
+		int height,
+		int colorChannels,
+		const unsigned char* pixels);
+	virtual void DestroyTexture(uint32_t texture);
+	virtual void BindTexture(int slot, uint32_t texture);
+	virtual void SetTextureSlot(int slot);
+
+	virtual void UpdateBlock(const CAMERA_BLOCK& block);
+	virtual void UpdateBlock(const LIGHT_BLOCK& block);
+	virtual void UpdateBlock(const MATERIAL_BLOCK& block);
+	virtual void UpdateBlock(const INSTANCE_BLOCK& block);
+
+	virtual void LoadMesh(MESH_TYPE mesh);
+	virtual void LoadMesh(MESH_TYPE mesh, const MESH_DATA& data);
+	virtual void DrawMesh(MESH_TYPE mesh);
+
+	virtual void DrawOverlay(
+		const OVERLAY_VERTEX* vertices,
+		uint32_t vertexCount,
+		uint32_t texture);
+
+	virtual void BeginFrame();
+	virtual void EndFrame();
+
+	virtual bool GetGpuFrameTime(double& milliseconds);
+
+	// number of texture slots in the texture table
+	static const int TEXTURE_SLOTS = 16;
+
+private:
+	// frames that can be recorded while the GPU is busy
+	static const int FRAMES_IN_FLIGHT = 2;
+
+	// buffer and the memory bound to it
+	struct VK_BUFFER
+	{
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		VkDeviceSize size;
+		void* pMapped;
+	};
+
+	// sampled image and the memory bound to it
+	struct VK_TEXTURE
+	{
+		VkImage image;
+		VkDeviceMemory memory;
+		VkImageView view;
+	};
+
+	// uploaded shape mesh
+	struct VK_MESH
+	{
+		VK_BUFFER vertexBuffer;
+		VK_BUFFER indexBuffer;
+		uint32_t indexCount;
+	};
+
+	// pipeline for one shader variant
+	struct VK_PIPELINE
+	{
+		VkPipeline pipeline;
+		int activeLights;
+		bool bEnableLighting;
+		bool bEnableSpecular;
+	};
+
+	// draw collected during the frame, with the ring buffer
+	// offsets of the uniform blocks that were current and the
+	// views that it is repeated in
+	struct DRAW_ITEM
+	{
+		uint32_t pipeline;
+		uint32_t mesh;
+		int32_t textureSlot;
+		uint32_t blockOffsets[UNIFORM_BLOCK_COUNT];
+		uint32_t viewMask;
+	};
+
+	// resources that are used by one frame in flight
+	struct FRAME_RESOURCES
+	{
+		VkFence fence;
+		VkSemaphore imageAvailable;
+		VkCommandPool commandPool;
+		VkCommandBuffer primaryCommands;
+		// one pool and secondary command buffer per recording thread
+		std::vector<VkCommandPool> recordPools;
+		std::vector<VkCommandBuffer> recordCommands;
+		// uniform block data written during the frame
+		VK_BUFFER uniformRing;
+		VkDeviceSize ringOffset;
+		VkDescriptorSet blockSet;
+		VkDescriptorSet textureSet;
+		bool bTexturesDirty;
+		// overlay vertices written during the frame, and the
+		// secondary command buffer that draws them
+		VK_BUFFER overlayVertices;
+		uint32_t overlayVertexCount;
+		VkDescriptorSet overlaySet;
+		uint32_t overlayTexture;
+		VkCommandBuffer overlayCommands;
+		// whether the GPU timestamps were written by the last
+		// submit of this frame
+		bool bTimestampsWritten;
+	};
+
+	// construction options
+	bool m_bPreferCpuDevice;
+	bool m_bDisableVsync;
+	GLFWwindow* m_pWindow;
+
+	// core objects
+	VkInstance m_instance;
+	VkSurfaceKHR m_surface;
+	VkPhysicalDevice m_physicalDevice;
+	// name and driver version of the physical device
+	std::string m_adapterName;
+	VkDevice m_device;
+	VkQueue m_queue;
+	uint32_t m_queueFamily;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	VkDeviceSize m_uniformAlignment;
+
+	// swapchain and the render targets
+	VkSwapchainKHR m_swapchain;
+	VkFormat m_swapchainFormat;
+	VkExtent2D m_swapchainExtent;
+	std::vector<VkImage> m_swapchainImages;
+	std::vector<VkImageView> m_swapchainViews;
+	std::vector<VkFramebuffer> m_framebuffers;
+	std::vector<VkSemaphore> m_renderFinished;
+	VkImage m_depthImage;
+	VkDeviceMemory m_depthMemory;
+	VkImageView m_depthView;
+	VkRenderPass m_renderPass;
+
+	// pipeline layout and descriptor state
+	VkDescriptorSetLayout m_blockSetLayout;
+	VkDescriptorSetLayout m_textureSetLayout;
+	VkPipelineLayout m_pipelineLayout;
+	VkPipelineCache m_pipelineCache;
+	VkDescriptorPool m_descriptorPool;
+	VkSampler m_sampler;
+	std::vector<VK_PIPELINE> m_pipelines;
+
+	// overlay pipeline, created by the first overlay draw
+	VkDescriptorSetLayout m_overlaySetLayout;
+	VkPipelineLayout m_overlayPipelineLayout;
+	VkPipeline m_overlayPipeline;
+	bool m_bOverlayFailed;
+
+	// GPU timestamps at the start and end of each frame in flight
+	VkQueryPool m_timestampPool;
+	double m_timestampPeriod;
+	uint64_t m_timestampMask;
+	double m_gpuMilliseconds;
+	bool m_bGpuTimeValid;
+
+	// resources created by the scene
+	std::vector<VK_TEXTURE> m_textures;
+	uint32_t m_slotTextures[TEXTURE_SLOTS];
+	VK_TEXTURE m_defaultTexture;
+	VK_MESH m_meshes[MESH_COUNT];
+	VkCommandPool m_uploadPool;
+
+	// per-frame resources and the frame being recorded
+	FRAME_RESOURCES m_frames[FRAMES_IN_FLIGHT];
+	int m_frameIndex;
+	bool m_bFrameStarted;
+
+	// state set by the scene code for the next draw
+	uint32_t m_boundPipeline;
+	int32_t m_textureSlot;
+	CAMERA_BLOCK m_cameraBlock;
+	LIGHT_BLOCK m_lightBlock;
+	MATERIAL_BLOCK m_materialBlock;
+	INSTANCE_BLOCK m_instanceBlock;
+	bool m_blockDirty[UNIFORM_BLOCK_COUNT];
+	uint32_t m_blockOffsets[UNIFORM_BLOCK_COUNT];
+
+	// draws collected for the current frame
+	std::vector<DRAW_ITEM> m_draws;
+
+	// recording worker threads
+	std::vector<std::thread> m_workers;
+	std::mutex m_workerMutex;
+	std::condition_variable m_workerStart;
+	std::condition_variable m_workerDone;
+	uint32_t m_workerGeneration;
+	int m_workersPending;
+	int m_recordChunks;
+	uint32_t m_recordImageIndex;
+	bool m_bWorkersExit;
+
+	// create the core objects
+	bool CreateInstance();
+	bool SelectPhysicalDevice();
+	bool CreateLogicalDevice();
+	bool CreateSwapchain();
+	void DestroySwapchain();
+	bool RecreateSwapchain();
+	bool CreateRenderPass();
+	bool CreateDescriptorLayouts();
+	bool CreateFrameResources();
+	bool CreateTimestampQueries();
+	bool CreateOverlayPipeline();
+
+	// create and free buffers and images
+	bool FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& typeIndex);
+	bool CreateBuffer(
+		VkDeviceSize size,
+		VkBufferUsageFlags usage,
+		VkMemoryPropertyFlags properties,
+		VK_BUFFER& buffer);
+	void DestroyBuffer(VK_BUFFER& buffer);
+	bool CreateImage(
+		uint32_t width,
+		uint32_t height,
+		VkFormat format,
+		VkImageUsageFlags usage,
+		VkImageAspectFlags aspect,
+		VkImage& image,
+		VkDeviceMemory& memory,
+		VkImageView& view);
+	bool CreateDeviceTexture(
+		uint32_t width,
+		uint32_t height,
+		const unsigned char* rgbaPixels,
+		VK_TEXTURE& texture);
+	void DestroyDeviceTexture(VK_TEXTURE& texture);
+	// copy data into a device local buffer through a staging buffer
+	bool UploadBuffer(
+		const void* data,
+		VkDeviceSize size,
+		VkBufferUsageFlags usage,
+		VK_BUFFER& buffer);
+	// run commands on the queue and wait for them to finish
+	VkCommandBuffer BeginUploadCommands();
+	void EndUploadCommands(VkCommandBuffer commandBuffer);
+
+	// load a SPIR-V binary into a shader module
+	VkShaderModule LoadShaderModule(const char* filename);
+
+	// write the dirty uniform blocks into the ring buffer
+	bool WriteDirtyBlocks();
+	// point the texture table at the textures bound to the slots
+	void WriteTextureSet(FRAME_RESOURCES& frame);
+
+	// record a range of the collected draws into a secondary
+	// command buffer
+	void RecordDraws(FRAME_RESOURCES& frame, uint32_t imageIndex, int chunk);
+	// record the overlay draw into its secondary command buffer
+	void RecordOverlay(FRAME_RESOURCES& frame, uint32_t imageIndex);
+	// set the flipped viewport and the scissor of a part of the
+	// swapchain for a command buffer
+	void SetViewport(VkCommandBuffer commandBuffer, const VIEWPORT& view);
+	// start and stop the recording worker threads
+	void StartWorkers();
+	void StopWorkers();
+	void WorkerMain(int worker);
+};
+
+#endif
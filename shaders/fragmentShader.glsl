@@ -1,11 +1,4 @@
-#version 440 core
-
-struct Material 
-{
-    vec3 diffuseColor;
-    vec3 specularColor;
-    float shininess;
-}; 
+#version 460 core
 
 struct LightSource 
 {
@@ -17,60 +10,149 @@ struct LightSource
 };
 
 #define TOTAL_LIGHTS 4
+#define SH_COEFFICIENTS 9
+#define SH_INSTANCE_VECTORS 7
+
+// the light count and feature toggles are specialization constants
+// when the shader is consumed as an offline compiled SPIR-V binary,
+// and macros defined after the #version line when the GLSL source
+// is compiled at runtime, which default to the full quality
+#if defined(GL_SPIRV) || defined(VULKAN)
+layout (constant_id = 0) const int ACTIVE_LIGHTS = TOTAL_LIGHTS;
+layout (constant_id = 1) const bool ENABLE_LIGHTING = true;
+layout (constant_id = 2) const bool ENABLE_SPECULAR = true;
+#else
+#ifndef ACTIVE_LIGHTS_VALUE
+#define ACTIVE_LIGHTS_VALUE TOTAL_LIGHTS
+#endif
+#ifndef ENABLE_LIGHTING_VALUE
+#define ENABLE_LIGHTING_VALUE true
+#endif
+#ifndef ENABLE_SPECULAR_VALUE
+#define ENABLE_SPECULAR_VALUE true
+#endif
+const int ACTIVE_LIGHTS = ACTIVE_LIGHTS_VALUE;
+const bool ENABLE_LIGHTING = ENABLE_LIGHTING_VALUE;
+const bool ENABLE_SPECULAR = ENABLE_SPECULAR_VALUE;
+#endif
+
+layout (location = 0) in vec3 fragmentPosition;
+layout (location = 1) in vec3 fragmentVertexNormal;
+layout (location = 2) in vec2 fragmentTextureCoordinate;
+layout (location = 3) flat in int fragmentViewIndex;
+
+layout (location = 0) out vec4 outFragmentColor;
+
+#define MAX_VIEWS 6
+
+struct CameraView
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
 
-in vec3 fragmentPosition;
-in vec3 fragmentVertexNormal;
-in vec2 fragmentTextureCoordinate;
-
-out vec4 outFragmentColor;
-
-uniform bool bUseTexture=false;
-uniform bool bUseLighting=false;
-uniform vec4 objectColor = vec4(1.0f);
-uniform sampler2D objectTexture;
-uniform vec3 viewPosition;
-uniform vec2 UVscale = vec2(1.0f, 1.0f);
-uniform LightSource lightSources[TOTAL_LIGHTS];
-uniform Material material;
-uniform vec3 globalAmbientColor;
-    
+// the uniform block layouts must match the structs in UniformBlocks.h
+layout (std140, binding = 0) uniform CameraBlock
+{
+    CameraView views[MAX_VIEWS];
+} camera;
+
+layout (std140, binding = 1) uniform LightBlock
+{
+    LightSource lightSources[TOTAL_LIGHTS];
+    vec3 globalAmbientColor;
+    vec4 irradiance[SH_COEFFICIENTS];
+    float environmentLevels;
+} lighting;
+
+layout (std140, binding = 2) uniform MaterialBlock
+{
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+    float reflectivity;
+    float roughness;
+} material;
+
+layout (std140, binding = 3) uniform InstanceBlock
+{
+    mat4 model;
+    vec4 objectColor;
+    vec2 UVscale;
+    bool bUseTexture;
+    bool bUseLighting;
+    uint viewMask;
+    vec4 lightProbe[SH_INSTANCE_VECTORS];
+} instance;
+
+#ifdef VULKAN
+// Vulkan samples from a texture table, indexed by the slot that
+// is pushed with each draw
+layout (set = 1, binding = 0) uniform sampler2D textureTable[16];
+
+layout (push_constant) uniform DrawConstants
+{
+    int textureSlot;
+} drawConstants;
+
+#define objectTexture textureTable[drawConstants.textureSlot]
+#else
+// explicit uniform location is required when this shader is
+// consumed as an offline compiled SPIR-V binary
+layout (location = 0) uniform sampler2D objectTexture;
+// prefiltered environment, the mip levels are blurred for
+// rougher surfaces
+layout (location = 1) uniform samplerCube environmentMap;
+#endif
 
 // function prototypes
 vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection);
+vec3 CalcEnvironment(vec3 lightNormal, vec3 viewDirection);
+vec3 CalcIrradiance(vec3 direction);
+vec3 CalcProbeLight(vec3 direction);
 
 void main()
 {
-   if(bUseLighting == true)
+   if(ENABLE_LIGHTING && instance.bUseLighting == true)
    {
       // properties
       vec3 lightNormal = normalize(fragmentVertexNormal);
-      vec3 viewDirection = normalize(viewPosition - fragmentPosition);
+      vec3 viewDirection = normalize(camera.views[fragmentViewIndex].viewPosition - fragmentPosition);
       vec3 phongResult = vec3(0.0f);
 
-      for(int i = 0; i < TOTAL_LIGHTS; i++)
+      for(int i = 0; i < ACTIVE_LIGHTS; i++)
       {
-         phongResult += CalcLightSource(lightSources[i], lightNormal, fragmentPosition, viewDirection); 
+         phongResult += CalcLightSource(lighting.lightSources[i], lightNormal, fragmentPosition, viewDirection); 
       }   
+
+      // light bounced off the scene, from the light probes around the object
+      phongResult += CalcProbeLight(lightNormal) * material.diffuseColor;
+
+      if(ENABLE_SPECULAR && material.reflectivity > 0.0)
+      {
+         phongResult += CalcEnvironment(lightNormal, viewDirection);
+      }
     
-      if(bUseTexture == true)
+      if(instance.bUseTexture == true)
       {
-         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         vec4 textureColor = texture(objectTexture, fragmentTextureCoordinate * instance.UVscale);
          outFragmentColor = vec4(phongResult * textureColor.xyz, 1.0);
       }
       else
       {
-         outFragmentColor = vec4(phongResult * objectColor.xyz, objectColor.w);
+         outFragmentColor = vec4(phongResult * instance.objectColor.xyz, instance.objectColor.w);
       }
    }
    else 
    {
-      if(bUseTexture == true)
+      if(instance.bUseTexture == true)
       {
-         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * UVscale);
+         outFragmentColor = texture(objectTexture, fragmentTextureCoordinate * instance.UVscale);
       }
       else
       {
-         outFragmentColor = objectColor;
+         outFragmentColor = instance.objectColor;
       }
    }
 }
@@ -84,7 +166,7 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
 
    //**Calculate Ambient lighting**
 
-   ambient = globalAmbientColor;
+   ambient = lighting.globalAmbientColor;
 
    //**Calculate Diffuse lighting**
 
@@ -97,6 +179,11 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
 
    //**Calculate Specular lighting**
 
+   if(ENABLE_SPECULAR == false)
+   {
+      return(ambient + diffuse);
+   }
+
    // Calculate reflection vector
    vec3 reflectDir = reflect(-lightDirection, lightNormal);
    // Calculate specular component
@@ -104,4 +191,64 @@ vec3 CalcLightSource(LightSource light, vec3 lightNormal, vec3 vertexPosition, v
    specular = (light.specularIntensity * material.shininess) * specularComponent * material.specularColor;
   
    return(ambient + diffuse + specular);
-}
\ No newline at end of file
+}
+
+// calculates the light of the environment reflected by the reflective materials.
+vec3 CalcEnvironment(vec3 lightNormal, vec3 viewDirection)
+{
+   // the diffuse light comes from the spherical harmonic coefficients
+   vec3 irradiance = CalcIrradiance(lightNormal);
+   vec3 reflectDir = reflect(-viewDirection, lightNormal);
+   vec3 reflection;
+
+#ifdef VULKAN
+   reflection = CalcIrradiance(reflectDir);
+#else
+   // the blur of the reflection is selected by the mip level, and
+   // without a cube map the diffuse light is reflected instead
+   if(lighting.environmentLevels > 0.0)
+   {
+      float level = material.roughness * (lighting.environmentLevels - 1.0);
+      reflection = textureLod(environmentMap, reflectDir, level).rgb;
+   }
+   else
+   {
+      reflection = CalcIrradiance(reflectDir);
+   }
+#endif
+
+   return(material.reflectivity * ((irradiance * material.diffuseColor) + (reflection * material.specularColor)));
+}
+
+// calculates the diffuse light of the environment facing a direction,
+// the constant factors are folded into the coefficients.
+vec3 CalcIrradiance(vec3 direction)
+{
+   vec3 n = direction;
+
+   return(lighting.irradiance[0].rgb
+      + (lighting.irradiance[1].rgb * n.y)
+      + (lighting.irradiance[2].rgb * n.z)
+      + (lighting.irradiance[3].rgb * n.x)
+      + (lighting.irradiance[4].rgb * (n.x * n.y))
+      + (lighting.irradiance[5].rgb * (n.y * n.z))
+      + (lighting.irradiance[6].rgb * ((3.0 * n.z * n.z) - 1.0))
+      + (lighting.irradiance[7].rgb * (n.x * n.z))
+      + (lighting.irradiance[8].rgb * ((n.x * n.x) - (n.y * n.y))));
+}
+
+// calculates the diffuse light of the light probes around the object facing
+// a direction, packed as two vectors for each color channel and one more.
+vec3 CalcProbeLight(vec3 direction)
+{
+   vec4 linear = vec4(direction, 1.0);
+   vec4 quadratic = direction.xyzz * direction.yzzx;
+   vec3 light;
+
+   light.r = dot(instance.lightProbe[0], linear) + dot(instance.lightProbe[3], quadratic);
+   light.g = dot(instance.lightProbe[1], linear) + dot(instance.lightProbe[4], quadratic);
+   light.b = dot(instance.lightProbe[2], linear) + dot(instance.lightProbe[5], quadratic);
+   light += instance.lightProbe[6].rgb * ((direction.x * direction.x) - (direction.y * direction.y));
+
+   return(max(light, vec3(0.0)));
+}
@@ -0,0 +1,17 @@
+#version 460 core
+layout (location = 0) in vec2 fragmentTextureCoordinate;
+layout (location = 1) in vec4 fragmentVertexColor;
+
+layout (location = 0) out vec4 outFragmentColor;
+
+// glyph atlas, which also has an opaque region for solid quads
+#ifdef VULKAN
+layout (set = 0, binding = 0) uniform sampler2D overlayTexture;
+#else
+layout (location = 1) uniform sampler2D overlayTexture;
+#endif
+
+void main()
+{
+   outFragmentColor = fragmentVertexColor * texture(overlayTexture, fragmentTextureCoordinate);
+}
@@ -0,0 +1,28 @@
+#version 460 core
+layout (location = 0) in vec2 inVertexPosition;
+layout (location = 1) in vec2 inTextureCoordinate;
+layout (location = 2) in vec4 inVertexColor;
+
+layout (location = 0) out vec2 fragmentTextureCoordinate;
+layout (location = 1) out vec4 fragmentVertexColor;
+
+// size of the window, the overlay vertices are positioned in
+// pixels from the top left corner
+#ifdef VULKAN
+layout (push_constant) uniform OverlayConstants
+{
+    vec2 screenSize;
+} overlay;
+#define screenSize overlay.screenSize
+#else
+layout (location = 0) uniform vec2 screenSize;
+#endif
+
+void main()
+{
+   vec2 position = (inVertexPosition / screenSize) * 2.0 - 1.0;
+   gl_Position = vec4(position.x, -position.y, 0.0, 1.0);
+
+   fragmentTextureCoordinate = inTextureCoordinate;
+   fragmentVertexColor = inVertexColor;
+}
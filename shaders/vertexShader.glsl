@@ -1,20 +1,85 @@
-#version 330 core
+#version 460 core
+// lets the vertex shader select the viewport of the view
+#extension GL_ARB_shader_viewport_layer_array : enable
+
 layout (location = 0) in vec3 inVertexPosition;
 layout (location = 1) in vec3 inVertexNormal;
 layout (location = 2) in vec2 inTextureCoordinate;
 
-out vec3 fragmentPosition;
-out vec3 fragmentVertexNormal;
-out vec2 fragmentTextureCoordinate;
+layout (location = 0) out vec3 fragmentPosition;
+layout (location = 1) out vec3 fragmentVertexNormal;
+layout (location = 2) out vec2 fragmentTextureCoordinate;
+layout (location = 3) flat out int fragmentViewIndex;
+
+#define MAX_VIEWS 6
+#define SH_INSTANCE_VECTORS 7
+
+struct CameraView
+{
+    mat4 view;
+    mat4 projection;
+    vec3 viewPosition;
+};
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// the uniform block layouts must match the structs in UniformBlocks.h
+layout (std140, binding = 0) uniform CameraBlock
+{
+    CameraView views[MAX_VIEWS];
+} camera;
+
+layout (std140, binding = 3) uniform InstanceBlock
+{
+    mat4 model;
+    vec4 objectColor;
+    vec2 UVscale;
+    bool bUseTexture;
+    bool bUseLighting;
+    uint viewMask;
+    vec4 lightProbe[SH_INSTANCE_VECTORS];
+} instance;
+
+// finds the view of an instance, each draw is instanced once
+// for each view in the view mask of the object
+int FindView(uint viewMask, int instanceIndex)
+{
+   if (viewMask == 0u)
+   {
+      return(instanceIndex);
+   }
+
+   // drop the views of the instances before this one
+   uint mask = viewMask;
+   for (int i = 0; i < instanceIndex; i++)
+   {
+      mask &= mask - 1u;
+   }
+   return(findLSB(mask));
+}
 
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
+   // each draw is instanced once per view, and a draw that is
+   // repeated per view passes the instance as its first one
+#ifdef VULKAN
+   int viewIndex = FindView(instance.viewMask, gl_InstanceIndex);
+#else
+   int viewIndex = FindView(instance.viewMask, gl_InstanceID + gl_BaseInstance);
+#endif
+   CameraView cameraView = camera.views[viewIndex];
+
+   fragmentPosition = vec3(instance.model * vec4(inVertexPosition, 1.0));
+   gl_Position = cameraView.projection * cameraView.view * instance.model * vec4(inVertexPosition, 1.0f);
+#ifdef VULKAN
+   // the projection matrices use the OpenGL depth range of -1 to 1
+   gl_Position.z = (gl_Position.z + gl_Position.w) * 0.5;
+#elif defined(GL_ARB_shader_viewport_layer_array)
+   // without the extension the render device sets the viewport
+   // before each view of a draw, the layer only matters when a
+   // layered target is bound
+   gl_ViewportIndex = viewIndex;
+   gl_Layer = viewIndex;
+#endif
+   fragmentViewIndex = viewIndex;
    fragmentVertexNormal = inVertexNormal;
    fragmentTextureCoordinate = inTextureCoordinate;
-}
\ No newline at end of file
+}